@@ -505,11 +505,12 @@ double battery_t::calculate_max_charge_kw(double *max_current_A) {
     double power_W = 0;
     double current = 0;
     size_t its = 0;
-    while (fabs(power_W - voltage->calculate_max_charge_w(q, qmax, thermal->T_battery(), &current)) > tolerance
-           && its++ < 10) {
-        power_W = voltage->calculate_max_charge_w(q, qmax, thermal->T_battery(), &current);
+    double max_W = voltage->calculate_max_charge_w(q, qmax, thermal->T_battery(), &current);
+    while (fabs(power_W - max_W) > tolerance && its++ < 10) {
+        power_W = max_W;
         thermal->updateTemperature(current, state->last_idx + 1);
         qmax = capacity->qmax() * thermal->capacity_percent() * 0.01 * SOC_ratio;
+        max_W = voltage->calculate_max_charge_w(q, qmax, thermal->T_battery(), &current);
     }
     if (max_current_A)
         *max_current_A = current;
@@ -525,11 +526,12 @@ double battery_t::calculate_max_discharge_kw(double *max_current_A) {
     double power_W = 0;
     double current = 0;
     size_t its = 0;
-    while (fabs(power_W - voltage->calculate_max_discharge_w(q, qmax, thermal->T_battery(), &current)) > tolerance
-           && its++ < 10) {
-        power_W = voltage->calculate_max_discharge_w(q, qmax, thermal->T_battery(), &current);
+    double max_W = voltage->calculate_max_discharge_w(q, qmax, thermal->T_battery(), &current);
+    while (fabs(power_W - max_W) > tolerance && its++ < 10) {
+        power_W = max_W;
         thermal->updateTemperature(current, state->last_idx + 1);
         qmax = capacity->qmax() * thermal->capacity_percent()  * 0.01 * SOC_ratio;
+        max_W = voltage->calculate_max_discharge_w(q, qmax, thermal->T_battery(), &current);
     }
     if (max_current_A)
         *max_current_A = current;
@@ -714,3 +716,19 @@ battery_params battery_t::get_params() { return *params; }
 void battery_t::set_state(const battery_state& tmp_state) {
     *state = tmp_state;
 }
+
+void battery_t::checkpoint(battery_state &snapshot) const {
+    snapshot = *state;
+}
+
+void battery_t::rollback(const battery_state &snapshot) {
+    *state = snapshot;
+}
+
+void battery_t::checkpoint(battery_t &copy) const {
+    *copy.state = *state;
+}
+
+void battery_t::rollback(const battery_t &copy) {
+    *state = *copy.state;
+}
@@ -377,6 +377,17 @@ public:
 
     void set_state(const battery_state& state);
 
+    // Save the state into a snapshot, created with the default constructor and reused, and return to it after trying
+    // a time step. Unlike get_state(), neither allocates once the snapshot's rainflow peaks have their storage.
+    void checkpoint(battery_state &snapshot) const;
+
+    void rollback(const battery_state &snapshot);
+
+    // The same, with a copy of this battery holding the checkpoint
+    void checkpoint(battery_t &copy) const;
+
+    void rollback(const battery_t &copy);
+
 private:
     std::unique_ptr<capacity_t> capacity;
     std::unique_ptr<thermal_t> thermal;
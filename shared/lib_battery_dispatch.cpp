@@ -21,6 +21,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "lib_battery_dispatch.h"
+#include "lib_battery_dispatch_lp.h"
 #include "lib_battery_powerflow.h"
 #include "lib_shared_inverter.h"
 #include "lib_utility_rate.h"
@@ -95,8 +96,8 @@ dispatch_t::dispatch_t(const dispatch_t& dispatch)
 // shallow copy from dispatch to this
 void dispatch_t::copy(const dispatch_t * dispatch)
 {
-	_Battery->set_state(dispatch->_Battery->get_state());
-	_Battery_initial->set_state(dispatch->_Battery_initial->get_state());
+	dispatch->_Battery->checkpoint(*_Battery);
+	dispatch->_Battery_initial->checkpoint(*_Battery_initial);
 	init(_Battery, dispatch->_dt_hour,  dispatch->_current_choice, dispatch->_t_min, dispatch->_mode);
 
 	// can't create shallow copy of unique ptr
@@ -122,7 +123,7 @@ dispatch_t::~dispatch_t()
 }
 void dispatch_t::finalize(size_t idx, double &I)
 {
-	_Battery->set_state(_Battery_initial->get_state());
+	_Battery->rollback(*_Battery_initial);
 	m_batteryPower->powerBatteryDC = 0;
 	m_batteryPower->powerBatteryAC = 0;
 	m_batteryPower->powerGridToBattery = 0;
@@ -243,7 +244,7 @@ bool dispatch_t::check_constraints(double &I, size_t count)
     // reset
 	if (iterate)
 	{
-		_Battery->set_state(_Battery_initial->get_state());
+		_Battery->rollback(*_Battery_initial);
         m_batteryPowerFlow->calculate();
     }
 
@@ -400,7 +401,7 @@ void dispatch_t::runDispatch(size_t year, size_t hour_of_year, size_t step)
 	double I = current_controller(m_batteryPower->powerBatteryDC);
 
 	// Setup battery iteration
-    _Battery_initial->set_state(_Battery->get_state());
+    _Battery->checkpoint(*_Battery_initial);
 
 	bool iterate = true;
 	size_t count = 0;
@@ -421,7 +422,7 @@ void dispatch_t::runDispatch(size_t year, size_t hour_of_year, size_t step)
 		    m_batteryPower->powerBatteryDC = I * _Battery->V() * util::watt_to_kilowatt;
 		}
 		else {
-		    _Battery->set_state(_Battery_initial->get_state());
+		    _Battery->rollback(*_Battery_initial);
 		}
 		count++;
 
@@ -627,7 +628,7 @@ bool dispatch_manual_t::check_constraints(double &I, size_t count)
 		// reset
 		if (iterate)
 		{
-            _Battery->set_state(_Battery_initial->get_state());
+            _Battery->rollback(*_Battery_initial);
 			m_batteryPower->powerBatteryAC = 0;
 			m_batteryPower->powerGridToBattery = 0;
 			m_batteryPower->powerBatteryToGrid = 0;
@@ -907,7 +908,7 @@ bool dispatch_automatic_t::check_constraints(double &I, size_t count)
 		// reset
 		if (iterate)
 		{
-            _Battery->set_state(_Battery_initial->get_state());
+            _Battery->rollback(*_Battery_initial);
 //			m_batteryPower->powerBatteryAC = 0;
 //			m_batteryPower->powerGridToBattery = 0;
 //			m_batteryPower->powerBatteryToGrid = 0;
@@ -1369,6 +1370,7 @@ dispatch_automatic_front_of_meter_t::dispatch_automatic_front_of_meter_t(
 	}
 
 	revenueToClipCharge = revenueToDischarge = revenueToGridCharge = revenueToPVCharge = 0;
+	m_lpIndexSolved = SIZE_MAX;
 
 	setup_cost_forecast_vector();
 }
@@ -1383,6 +1385,9 @@ void dispatch_automatic_front_of_meter_t::init_with_pointer(const dispatch_autom
 	m_etaPVCharge = tmp->m_etaPVCharge;
 	m_etaGridCharge = tmp->m_etaGridCharge;
 	m_etaDischarge = tmp->m_etaDischarge;
+
+	// the optimization model is rebuilt or re-solved on the next update rather than shared
+	m_lpIndexSolved = SIZE_MAX;
 }
 
 void dispatch_automatic_front_of_meter_t::setup_cost_forecast_vector()
@@ -1433,7 +1438,7 @@ void dispatch_automatic_front_of_meter_t::dispatch(size_t year,
 	dispatch_automatic_t::dispatch(year, hour_of_year, step);
 }
 
-void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, size_t , size_t lifetimeIndex)
+void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, size_t step, size_t lifetimeIndex)
 {
 	// Initialize
 	m_batteryPower->powerBatteryDC = 0;
@@ -1441,7 +1446,11 @@ void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, s
 	m_batteryPower->powerBatteryTarget = 0;
 
 
-	if (_mode != dispatch_t::FOM_CUSTOM_DISPATCH)
+	if (_mode == dispatch_t::FOM_OPTIMIZED)
+	{
+		m_batteryPower->powerBatteryTarget = optimized_power_target(hour_of_year, step, lifetimeIndex);
+	}
+	else if (_mode != dispatch_t::FOM_CUSTOM_DISPATCH)
 	{
 
 		// Power to charge (<0) or discharge (>0)
@@ -1613,6 +1622,79 @@ void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, s
 	m_batteryPower->powerBatteryDC = m_batteryPower->powerBatteryTarget;
 }
 
+double dispatch_automatic_front_of_meter_t::optimized_power_target(size_t hour_of_year, size_t step, size_t lifetimeIndex)
+{
+	size_t n_steps = _look_ahead_hours * _steps_per_hour;
+	if (!m_lp || m_lp.use_count() > 1 || m_lp->n_steps() != n_steps) {
+		m_lp = std::make_shared<dispatch_lp_t>(n_steps, _dt_hour);
+		m_lpIndexSolved = SIZE_MAX;
+	}
+
+	// Re-solve at the update frequency, or whenever the simulation is not within the last solved horizon
+	size_t steps_per_update = std::min(n_steps, std::max((size_t)1, (size_t)std::round(_dt_hour_update * _steps_per_hour)));
+	if (m_lpIndexSolved == SIZE_MAX || lifetimeIndex < m_lpIndexSolved || lifetimeIndex - m_lpIndexSolved >= steps_per_update)
+	{
+		/*! Cost to cycle the battery at all, using maximum DOD or user input */
+		costToCycle();
+
+		// The price forecast is a year with the look-ahead appended, wrap the start onto the year; PV and clipping
+		// are indexed by lifetime step, wrapping each step past the end of the forecast onto its start
+		size_t idx_price = _forecast_price_rt_series.size() > n_steps ? (hour_of_year * _steps_per_hour + step) % (_forecast_price_rt_series.size() - n_steps) : SIZE_MAX;
+
+		double energy_nominal = _Battery->energy_nominal();
+
+		// Battery power limits as the dispatch restricts them, current limits taken at the present voltage
+		double power_charge_max = m_batteryPower->powerBatteryChargeMaxDC;
+		double power_discharge_max = m_batteryPower->powerBatteryDischargeMaxDC;
+		if (_current_choice == RESTRICT_CURRENT || _current_choice == RESTRICT_BOTH) {
+			double power_charge_current = m_batteryPower->currentChargeMax * _Battery->V() * util::watt_to_kilowatt;
+			double power_discharge_current = m_batteryPower->currentDischargeMax * _Battery->V() * util::watt_to_kilowatt;
+			power_charge_max = _current_choice == RESTRICT_BOTH ? std::fmin(power_charge_max, power_charge_current) : power_charge_current;
+			power_discharge_max = _current_choice == RESTRICT_BOTH ? std::fmin(power_discharge_max, power_discharge_current) : power_discharge_current;
+		}
+
+		dispatch_lp_t::horizon_t horizon;
+		horizon.energy_initial = _Battery->SOC() * 0.01 * energy_nominal;
+		horizon.energy_min = m_batteryPower->stateOfChargeMin * 0.01 * energy_nominal;
+		horizon.energy_max = m_batteryPower->stateOfChargeMax * 0.01 * energy_nominal;
+		horizon.power_charge_max = power_charge_max;
+		horizon.can_pv_charge = m_batteryPower->canPVCharge;
+		horizon.can_clip_charge = m_batteryPower->canClipCharge;
+		horizon.can_grid_charge = m_batteryPower->canGridCharge;
+		horizon.eta_pv_charge = m_etaPVCharge;
+		horizon.eta_grid_charge = m_etaGridCharge;
+		horizon.eta_discharge = m_etaDischarge;
+		horizon.cycle_cost = m_cycleCost;
+
+		for (size_t t = 0; t != n_steps; t++)
+		{
+			double price = idx_price != SIZE_MAX ? _forecast_price_rt_series[idx_price + t] : 0.;
+			double pv = !_P_pv_ac.empty() ? _P_pv_ac[(lifetimeIndex + t) % _P_pv_ac.size()] : 0.;
+			double clipped = !_P_cliploss_dc.empty() ? _P_cliploss_dc[(lifetimeIndex + t) % _P_cliploss_dc.size()] : 0.;
+
+			double price_grid = price;
+			if (m_utilityRateCalculator)
+				price_grid = m_utilityRateCalculator->getEnergyRate((hour_of_year + (step + t) / _steps_per_hour) % 8760);
+
+			// DC-connected batteries share the PV inverter
+			double power_discharge_limit = power_discharge_max;
+			if (m_batteryPower->connectionMode == BatteryPower::DC_CONNECTED)
+				power_discharge_limit = std::fmin(power_discharge_limit, std::fmax(0., _inverter_paco - pv));
+
+			horizon.price.push_back(price);
+			horizon.price_grid.push_back(price_grid);
+			horizon.power_pv.push_back(pv);
+			horizon.power_clipped.push_back(clipped);
+			horizon.power_discharge_max.push_back(power_discharge_limit);
+		}
+
+		// an unsolved horizon leaves the battery idle until the next update
+		m_lp->solve(horizon);
+		m_lpIndexSolved = lifetimeIndex;
+	}
+	return m_lp->power_target(lifetimeIndex - m_lpIndexSolved);
+}
+
 void dispatch_automatic_front_of_meter_t::update_cliploss_data(double_vec P_cliploss)
 {
 	_P_cliploss_dc = P_cliploss;
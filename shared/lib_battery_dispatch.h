@@ -34,6 +34,7 @@ struct BatteryPower;
 class BatteryPowerFlow;
 class UtilityRate;
 class UtilityRateCalculator;
+class dispatch_lp_t;
 
 namespace battery_dispatch
 {
@@ -47,7 +48,7 @@ class dispatch_t
 {
 public:
 
-	enum FOM_MODES { FOM_LOOK_AHEAD, FOM_LOOK_BEHIND, FOM_FORECAST, FOM_CUSTOM_DISPATCH, FOM_MANUAL, FOM_RESILIENCE };
+	enum FOM_MODES { FOM_LOOK_AHEAD, FOM_LOOK_BEHIND, FOM_FORECAST, FOM_CUSTOM_DISPATCH, FOM_MANUAL, FOM_RESILIENCE, FOM_OPTIMIZED };
 	enum BTM_MODES { LOOK_AHEAD, LOOK_BEHIND, MAINTAIN_TARGET, CUSTOM_DISPATCH, MANUAL, RESILIENCE };
 	enum METERING { BEHIND, FRONT };
 	enum PV_PRIORITY { MEET_LOAD, CHARGE_BATTERY };
@@ -91,7 +92,7 @@ public:
 	/// Method to recalculate the battery state based upon the final constrained current
 	virtual void finalize(size_t index, double &I);
 
-	battery_t * battery_model(){ return _Battery; }
+	battery_t * battery_model() const { return _Battery; }
 
 	// ac outputs
 	double power_tofrom_battery();
@@ -153,7 +154,7 @@ protected:
 	/**
 	The dispatch mode.
 	For behind-the-meter dispatch: 0 = LOOK_AHEAD, 1 = LOOK_BEHIND, 2 = MAINTAIN_TARGET, 3 = CUSTOM, 4 = MANUAL, 5 = RESILIENCE
-	For front-of-meter dispatch: 0 = LOOK_AHEAD, 1 = LOOK_BEHIND, 2 = INPUT FORECAST, 3 = CUSTOM, 4 = MANUAL, 5 = RESILIENCE
+	For front-of-meter dispatch: 0 = LOOK_AHEAD, 1 = LOOK_BEHIND, 2 = INPUT FORECAST, 3 = CUSTOM, 4 = MANUAL, 5 = RESILIENCE, 6 = OPTIMIZED
 	*/
 	int _mode;
 
@@ -507,6 +508,9 @@ public:
 	 2. Charging from the grid during times of low electricity buy-rates (if grid charging allowed)
 	 3. Charging from the PV array during times of low PPA sell rates
 	 4. Charging from the PV array during times where the PV power would be clipped due to inverter limits (if DC-connected)
+
+	 With dispatch_t::FOM_OPTIMIZED the charge and discharge schedule is instead the solution of a mixed-integer
+	 linear program over the look-ahead window, re-solved every dispatch update with the battery's current state of charge.
 	*/
 	dispatch_automatic_front_of_meter_t(
 		battery_t * Battery,
@@ -581,6 +585,9 @@ protected:
 	void init_with_pointer(const dispatch_automatic_front_of_meter_t* tmp);
 	void setup_cost_forecast_vector();
 
+	/*! Battery power target from the optimized schedule, re-solving the look-ahead window when an update is due [kW] */
+	double optimized_power_target(size_t hour_of_year, size_t step, size_t lifetimeIndex);
+
 	/*! Full clipping loss due to AC power limits vector [kW] */
 	double_vec _P_cliploss_dc;
 
@@ -610,6 +617,12 @@ protected:
 	double revenueToGridCharge;
 	double revenueToClipCharge;
 	double revenueToDischarge;
+
+	/*! Optimization model for FOM_OPTIMIZED, built on first use and reused for every horizon, copies detach before solving */
+	std::shared_ptr<dispatch_lp_t> m_lp;
+
+	/*! Lifetime index of the last optimized horizon, SIZE_MAX if none */
+	size_t m_lpIndexSolved;
 };
 
 /*! Battery metrics class */
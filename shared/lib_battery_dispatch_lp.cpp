@@ -0,0 +1,220 @@
+/**
+BSD-3-Clause
+Copyright 2019 Alliance for Sustainable Energy, LLC
+Redistribution and use in source and binary forms, with or without modification, are permitted provided
+that the following conditions are met :
+1.	Redistributions of source code must retain the above copyright notice, this list of conditions
+and the following disclaimer.
+2.	Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+and the following disclaimer in the documentation and/or other materials provided with the distribution.
+3.	Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER, CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES
+DEPARTMENT OF ENERGY, NOR ANY OF THEIR EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+OR CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "lib_battery_dispatch_lp.h"
+#include "lp_lib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// power below which a charge or discharge is considered zero [kW]
+static const double tolerance = 1e-6;
+
+dispatch_lp_t::dispatch_lp_t(size_t n_steps, double dt_hour) :
+	_lp(nullptr),
+	_n_steps(n_steps),
+	_dt_hour(dt_hour),
+	_solution(N_VARIABLES * n_steps, 0.),
+	_integer(n_steps, false),
+	_objective(0.),
+	_iterations(0),
+	_big_m_charge(1.),
+	_big_m_discharge(1.)
+{
+	if (_n_steps == 0)
+		throw std::runtime_error("dispatch_lp_t: the optimization horizon must have at least one step");
+	build();
+}
+
+dispatch_lp_t::~dispatch_lp_t()
+{
+	if (_lp)
+		delete_lp(_lp);
+}
+
+void dispatch_lp_t::build()
+{
+	_lp = make_lp(0, (int)(N_VARIABLES * _n_steps));
+	if (!_lp)
+		throw std::runtime_error("dispatch_lp_t: failed to create the battery dispatch optimization problem");
+
+	set_verbose(_lp, NEUTRAL);
+	// flat prices leave many equally good schedules to branch over, and the horizon is re-solved at the next
+	// update anyway, so the first integer schedule is taken
+	set_break_at_first(_lp, TRUE);
+	set_maxim(_lp);
+	set_add_rowmode(_lp, TRUE);
+
+	REAL row[6];
+	int col[6];
+
+	// stored energy balance, E_t - E_t-1 - dt * (charge) + dt * discharge = 0, the first row carries E_0 on its right hand side
+	for (size_t t = 0; t != _n_steps; t++)
+	{
+		int i = 0;
+		col[i] = column(ENERGY, t);			row[i++] = 1.;
+		col[i] = column(CHARGE_PV, t);		row[i++] = -_dt_hour;
+		col[i] = column(CHARGE_CLIP, t);	row[i++] = -_dt_hour;
+		col[i] = column(CHARGE_GRID, t);	row[i++] = -_dt_hour;
+		col[i] = column(DISCHARGE, t);		row[i++] = _dt_hour;
+		if (t > 0) {
+			col[i] = column(ENERGY, t - 1);	row[i++] = -1.;
+		}
+		add_constraintex(_lp, i, row, col, EQ, 0.);
+	}
+
+	// total charge power limit in charging steps, charge - P_charge_max * y_t <= 0
+	for (size_t t = 0; t != _n_steps; t++)
+	{
+		col[0] = column(CHARGE_PV, t);		row[0] = 1.;
+		col[1] = column(CHARGE_CLIP, t);	row[1] = 1.;
+		col[2] = column(CHARGE_GRID, t);	row[2] = 1.;
+		col[3] = column(CHARGING, t);		row[3] = -_big_m_charge;
+		add_constraintex(_lp, 4, row, col, LE, 0.);
+	}
+
+	// no discharge in charging steps, discharge + P_discharge_max * y_t <= P_discharge_max
+	for (size_t t = 0; t != _n_steps; t++)
+	{
+		col[0] = column(DISCHARGE, t);		row[0] = 1.;
+		col[1] = column(CHARGING, t);		row[1] = _big_m_discharge;
+		add_constraintex(_lp, 2, row, col, LE, _big_m_discharge);
+	}
+
+	set_add_rowmode(_lp, FALSE);
+
+	for (size_t t = 0; t != _n_steps; t++)
+		set_upbo(_lp, column(CHARGING, t), 1.);
+}
+
+void dispatch_lp_t::set_power_limits(double power_charge_max, double power_discharge_max)
+{
+	// only touch the matrix when the limits change, so the factorization carries over between horizons
+	size_t n = _n_steps;
+	if (power_charge_max != _big_m_charge)
+	{
+		_big_m_charge = power_charge_max;
+		for (size_t t = 0; t != n; t++)
+			set_mat(_lp, (int)(n + t + 1), column(CHARGING, t), -_big_m_charge);
+	}
+	if (power_discharge_max != _big_m_discharge)
+	{
+		_big_m_discharge = power_discharge_max;
+		for (size_t t = 0; t != n; t++) {
+			set_mat(_lp, (int)(2 * n + t + 1), column(CHARGING, t), _big_m_discharge);
+			set_rh(_lp, (int)(2 * n + t + 1), _big_m_discharge);
+		}
+	}
+}
+
+bool dispatch_lp_t::solve(const horizon_t &h)
+{
+	size_t n = _n_steps;
+	if (h.price.size() < n || h.price_grid.size() < n || h.power_pv.size() < n ||
+		h.power_clipped.size() < n || h.power_discharge_max.size() < n)
+		throw std::runtime_error("dispatch_lp_t: horizon series are shorter than the optimization horizon");
+
+	// keep the problem feasible if the battery starts outside of its operating range
+	double energy_min = std::fmin(h.energy_min, h.energy_initial);
+	double energy_max = std::fmax(h.energy_max, h.energy_initial);
+
+	double power_charge_max = std::fmax(h.power_charge_max, 0.);
+	double power_discharge_max = 0;
+	for (size_t t = 0; t != n; t++)
+		power_discharge_max = std::fmax(power_discharge_max, h.power_discharge_max[t]);
+	set_power_limits(std::fmax(power_charge_max, 1.), std::fmax(power_discharge_max, 1.));
+
+	std::vector<REAL> objective(N_VARIABLES * n + 1, 0.);
+	for (size_t t = 0; t != n; t++)
+	{
+		// the PV inverter is saturated while clipping, so discharge can't be sold and would only recycle clipped energy
+		bool clipping = h.can_clip_charge && h.power_clipped[t] > 0;
+
+		// break ties between equally priced steps toward the earliest, so that a shortfall against the plan can
+		// still be made up when the horizon is re-solved; scaled to the horizon so that it stays below a
+		// millionth of the price however many steps there are
+		double earlier = 1e-6 * t / n;
+
+		objective[column(CHARGE_PV, t)] = -_dt_hour * h.price[t] / h.eta_pv_charge * (1. + earlier);
+		objective[column(CHARGE_GRID, t)] = -_dt_hour * h.price_grid[t] / h.eta_grid_charge * (1. + earlier);
+		objective[column(DISCHARGE, t)] = _dt_hour * (h.price[t] * h.eta_discharge - h.cycle_cost) * (1. - earlier);
+
+		set_upbo(_lp, column(CHARGE_PV, t), h.can_pv_charge ? std::fmax(h.power_pv[t], 0.) : 0.);
+		set_upbo(_lp, column(CHARGE_CLIP, t), h.can_clip_charge ? std::fmax(h.power_clipped[t], 0.) : 0.);
+		set_upbo(_lp, column(CHARGE_GRID, t), h.can_grid_charge ? power_charge_max : 0.);
+		set_upbo(_lp, column(DISCHARGE, t), clipping ? 0. : std::fmax(h.power_discharge_max[t], 0.));
+		set_bounds(_lp, column(ENERGY, t), energy_min, energy_max);
+
+		// charging and discharging in the same step only wastes energy, unless the sale is worth more than the
+		// charge costs; only those steps need a binary charging state, the others would branch for nothing
+		double discharge_value = objective[column(DISCHARGE, t)];
+		set_integer(t, (h.can_pv_charge && h.power_pv[t] > 0 && discharge_value + objective[column(CHARGE_PV, t)] > 0) ||
+			(h.can_grid_charge && discharge_value + objective[column(CHARGE_GRID, t)] > 0));
+	}
+	set_obj_fn(_lp, objective.data());
+	set_rh(_lp, 1, h.energy_initial);
+
+	// the basis of the previous horizon is kept by lp_solve and is the starting point of the root relaxation
+	int ret = ::solve(_lp);
+	_iterations = get_total_iter(_lp);
+
+	if (ret != OPTIMAL && ret != SUBOPTIMAL)
+	{
+		std::fill(_solution.begin(), _solution.end(), 0.);
+		_objective = 0.;
+		default_basis(_lp);
+		return false;
+	}
+	get_variables(_lp, _solution.data());
+	_objective = get_objective(_lp);
+	return true;
+}
+
+void dispatch_lp_t::set_integer(size_t step, bool integer)
+{
+	if (_integer[step] != integer) {
+		set_int(_lp, column(CHARGING, step), integer ? TRUE : FALSE);
+		_integer[step] = integer;
+	}
+}
+
+double dispatch_lp_t::charge(size_t step) const
+{
+	return _solution[column(CHARGE_PV, step) - 1] + _solution[column(CHARGE_CLIP, step) - 1]
+		+ _solution[column(CHARGE_GRID, step) - 1];
+}
+
+double dispatch_lp_t::power_target(size_t step) const
+{
+	size_t t = std::min(step, _n_steps - 1);
+	return _solution[column(DISCHARGE, t) - 1] - charge(t);
+}
+
+double dispatch_lp_t::energy(size_t step) const
+{
+	return _solution[column(ENERGY, std::min(step, _n_steps - 1)) - 1];
+}
+
+double dispatch_lp_t::objective() const { return _objective; }
+
+long long dispatch_lp_t::iterations() const { return _iterations; }
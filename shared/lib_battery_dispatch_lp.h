@@ -0,0 +1,135 @@
+/**
+BSD-3-Clause
+Copyright 2019 Alliance for Sustainable Energy, LLC
+Redistribution and use in source and binary forms, with or without modification, are permitted provided
+that the following conditions are met :
+1.	Redistributions of source code must retain the above copyright notice, this list of conditions
+and the following disclaimer.
+2.	Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+and the following disclaimer in the documentation and/or other materials provided with the distribution.
+3.	Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER, CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES
+DEPARTMENT OF ENERGY, NOR ANY OF THEIR EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+OR CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __LIB_BATTERY_DISPATCH_LP_H__
+#define __LIB_BATTERY_DISPATCH_LP_H__
+
+#include <cstddef>
+#include <vector>
+
+// Forward declaration so that only the translation unit needs the lp_solve headers
+struct _lprec;
+
+/**
+* \class dispatch_lp_t
+*
+* Rolling-horizon mixed-integer linear program for front-of-meter battery dispatch.
+*
+* Over a horizon of n steps the program chooses, for every step, the battery-side power charged from PV, from
+* clipped PV and from the grid, and the battery-side power discharged, to maximize
+*
+*   sum_t dt * ( price_t * eta_d * P_discharge_t - cycle_cost * P_discharge_t
+*              - price_t / eta_pv * P_pv_t - price_grid_t / eta_grid * P_grid_t )
+*
+* subject to the stored energy balance E_t = E_t-1 + dt * (P_pv_t + P_clip_t + P_grid_t - P_discharge_t),
+* E_min <= E_t <= E_max and the charge and discharge power limits. A binary charging state keeps the battery from
+* charging and discharging in the same step, which would otherwise be profitable whenever the sale is worth more
+* than the charge costs; it is only made integer in those steps, and branch and bound stops at the first integer
+* schedule. Clipped energy is free to store, so it is captured whenever there is room for it, and the battery
+* does not discharge in steps that clip.
+*
+* The model is built once for a fixed horizon length; each call to solve() only rewrites bounds, objective
+* coefficients, the initial energy and, if they changed, the power limits, so lp_solve restarts the simplex
+* from the previous horizon's basis.
+*/
+class dispatch_lp_t
+{
+public:
+
+	/// Inputs describing one horizon, each series has one entry per step
+	struct horizon_t
+	{
+		double energy_initial;			// [kWh]
+		double energy_min;				// [kWh]
+		double energy_max;				// [kWh]
+		double power_charge_max;		// [kW]
+
+		std::vector<double> price;				// price received for discharged energy, and forgone by charging from PV [$/kWh]
+		std::vector<double> price_grid;			// price paid for grid charging [$/kWh]
+		std::vector<double> power_pv;			// PV power available to charge [kW]
+		std::vector<double> power_clipped;		// clipped PV power available to charge [kW]
+		std::vector<double> power_discharge_max;// [kW]
+
+		bool can_pv_charge;
+		bool can_clip_charge;
+		bool can_grid_charge;
+
+		double eta_pv_charge;			// [0-1]
+		double eta_grid_charge;			// [0-1]
+		double eta_discharge;			// [0-1]
+		double cycle_cost;				// degradation cost per unit energy discharged [$/kWh]
+	};
+
+	dispatch_lp_t(size_t n_steps, double dt_hour);
+	~dispatch_lp_t();
+
+	/// Solve the horizon, returns false if lp_solve did not find an optimal solution
+	bool solve(const horizon_t &horizon);
+
+	/// Battery power target at a step of the last solution, [kW] (< 0 is charging)
+	double power_target(size_t step) const;
+
+	/// Stored energy at the end of a step of the last solution [kWh]
+	double energy(size_t step) const;
+
+	/// Objective value of the last solution [$]
+	double objective() const;
+
+	/// Simplex iterations used by the last solve
+	long long iterations() const;
+
+	size_t n_steps() const { return _n_steps; }
+
+private:
+
+	enum VARIABLES { CHARGE_PV, CHARGE_CLIP, CHARGE_GRID, DISCHARGE, ENERGY, CHARGING, N_VARIABLES };
+
+	/// lp_solve column (1-based) of a variable at a step
+	int column(int variable, size_t step) const { return (int)(variable * _n_steps + step + 1); }
+
+	void build();
+
+	/// Update the big-M coefficients that tie charge and discharge to the charging state
+	void set_power_limits(double power_charge_max, double power_discharge_max);
+
+	/// Make the charging state of a step binary or continuous
+	void set_integer(size_t step, bool integer);
+
+	/// Total battery-side charge power of the current solution at a step [kW]
+	double charge(size_t step) const;
+
+	dispatch_lp_t(const dispatch_lp_t &);
+	dispatch_lp_t & operator=(const dispatch_lp_t &);
+
+	_lprec * _lp;
+	size_t _n_steps;
+	double _dt_hour;
+
+	std::vector<double> _solution;
+	std::vector<bool> _integer;
+	double _objective;
+	long long _iterations;
+	double _big_m_charge;
+	double _big_m_discharge;
+};
+
+#endif
@@ -20,6 +20,7 @@ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
 #include <cmath>
 
 #include "lib_battery_lifetime.h"
@@ -42,6 +43,7 @@ bool cycle_state::operator==(const cycle_state &p) {
 void lifetime_cycle_t::initialize() {
     if (params->cycling_matrix.nrows() < 3 || params->cycling_matrix.ncols() != 3)
         throw std::runtime_error("lifetime_cycle_t error: Battery lifetime matrix must have three columns and at least three rows");
+    initialize_brackets();
     state = std::make_shared<cycle_state>();
     state->n_cycles = 0;
     state->q_relative_cycle = bilinear(0., 0);
@@ -65,6 +67,7 @@ lifetime_cycle_t::lifetime_cycle_t(std::shared_ptr<lifetime_params> params_ptr)
 
 lifetime_cycle_t::lifetime_cycle_t(const lifetime_cycle_t &rhs) {
     state = std::make_shared<cycle_state>(*rhs.state);
+    params = std::make_shared<lifetime_params>(*rhs.params);
     operator=(rhs);
 }
 
@@ -72,10 +75,21 @@ lifetime_cycle_t &lifetime_cycle_t::operator=(const lifetime_cycle_t &rhs) {
     if (this != &rhs) {
         *state = *rhs.state;
         *params = *rhs.params;
+        initialize_brackets();
     }
     return *this;
 }
 
+void lifetime_cycle_t::initialize_brackets() {
+    cycling_DODs.clear();
+    cycling_brackets.clear();
+    for (size_t i = 0; i < params->cycling_matrix.nrows(); i++) {
+        double D = params->cycling_matrix.at(i, lifetime_params::DOD);
+        if (std::find(cycling_DODs.begin(), cycling_DODs.end(), D) == cycling_DODs.end())
+            cycling_DODs.push_back(D);
+    }
+}
+
 lifetime_cycle_t *lifetime_cycle_t::clone() {
     return new lifetime_cycle_t(*this);
 }
@@ -170,11 +184,8 @@ int lifetime_cycle_t::rainflow_compareRanges() {
             state->q_relative_cycle = 0.;
 
         // discard peak & valley of Y
-        double save = state->rainflow_peaks[state->rainflow_jlt];
-        state->rainflow_peaks.pop_back();
-        state->rainflow_peaks.pop_back();
-        state->rainflow_peaks.pop_back();
-        state->rainflow_peaks.push_back(save);
+        state->rainflow_peaks[state->rainflow_jlt - 2] = state->rainflow_peaks[state->rainflow_jlt];
+        state->rainflow_peaks.resize(state->rainflow_peaks.size() - 2);
         state->rainflow_jlt -= 2;
         // stay in while loop
         retCode = cycle_state::LT_RERANGE;
@@ -209,114 +220,106 @@ double lifetime_cycle_t::capacity_percent() { return state->q_relative_cycle; }
 
 cycle_state lifetime_cycle_t::get_state() { return *state; }
 
-double lifetime_cycle_t::bilinear(double DOD, int cycle_number) {
+const lifetime_cycle_t::cycling_bracket &lifetime_cycle_t::bracket(double DOD) {
+    // get where DOD is bracketed [D_lo, DOD, D_hi]
+    double D_lo = 0;
+    double D_hi = 100;
+    for (double D : cycling_DODs) {
+        if (D < DOD && D > D_lo)
+            D_lo = D;
+        else if (D >= DOD && D < D_hi)
+            D_hi = D;
+    }
+    for (auto &b : cycling_brackets) {
+        if (b.D_lo == D_lo && b.D_hi == D_hi)
+            return b;
+    }
+
     /*
     Work could be done to make this simpler
     Current idea is to interpolate first along the C = f(n) curves for each DOD to get C_DOD_, C_DOD_+
     Then interpolate C_, C+ to get C at the DOD of interest
     */
-
-    std::vector<double> D_unique_vect;
     std::vector<double> C_n_low_vect;
-    std::vector<double> D_high_vect;
     std::vector<double> C_n_high_vect;
     std::vector<int> low_indices;
     std::vector<int> high_indices;
     double D = 0.;
-    size_t n = 0;
-    double C = 100;
     int n_rows = params->cycling_matrix.nrows();
 
-    // get unique values of D
-    D_unique_vect.push_back(params->cycling_matrix.at(0, lifetime_params::DOD));
+    // Separate table into bins
+    double D_min = 100.;
+    double D_max = 0.;
+
     for (int i = 0; i < n_rows; i++) {
-        bool contained = false;
-        for (int j = 0; j < (int) D_unique_vect.size(); j++) {
-            if (params->cycling_matrix.at(i, lifetime_params::DOD) == D_unique_vect[j]) {
-                contained = true;
-                break;
-            }
-        }
-        if (!contained) {
-            D_unique_vect.push_back(params->cycling_matrix.at(i, lifetime_params::DOD));
-        }
+        D = params->cycling_matrix.at(i, lifetime_params::DOD);
+        if (D == D_lo)
+            low_indices.push_back(i);
+        else if (D == D_hi)
+            high_indices.push_back(i);
+
+        if (D < D_min) { D_min = D; }
+        else if (D > D_max) { D_max = D; }
     }
-    n = D_unique_vect.size();
-
-    if (n > 1) {
-        // get where DOD is bracketed [D_lo, DOD, D_hi]
-        double D_lo = 0;
-        double D_hi = 100;
-
-        for (int i = 0; i < n_rows; i++) {
-            D = params->cycling_matrix.at(i, lifetime_params::DOD);
-            if (D < DOD && D > D_lo)
-                D_lo = D;
-            else if (D >= DOD && D < D_hi)
-                D_hi = D;
-        }
 
-        // Separate table into bins
-        double D_min = 100.;
-        double D_max = 0.;
-
-        for (int i = 0; i < n_rows; i++) {
-            D = params->cycling_matrix.at(i, lifetime_params::DOD);
-            if (D == D_lo)
-                low_indices.push_back(i);
-            else if (D == D_hi)
+    // if we're out of the bounds, just make the upper bound equal to the highest input
+    if (high_indices.empty()) {
+        for (int i = 0; i != n_rows; i++) {
+            if (params->cycling_matrix.at(i, lifetime_params::DOD) == D_max)
                 high_indices.push_back(i);
-
-            if (D < D_min) { D_min = D; }
-            else if (D > D_max) { D_max = D; }
         }
+    }
 
-        // if we're out of the bounds, just make the upper bound equal to the highest input
-        if (high_indices.empty()) {
-            for (int i = 0; i != n_rows; i++) {
-                if (params->cycling_matrix.at(i, lifetime_params::DOD) == D_max)
-                    high_indices.push_back(i);
-            }
-        }
+    size_t n_rows_lo = low_indices.size();
+    size_t n_rows_hi = high_indices.size();
+    size_t n_cols = 2;
 
-        size_t n_rows_lo = low_indices.size();
-        size_t n_rows_hi = high_indices.size();
-        size_t n_cols = 2;
-
-        // If we aren't bounded, fill in values
-        if (n_rows_lo == 0) {
-            // Assumes 0% DOD
-            for (int i = 0; i < (int) n_rows_hi; i++) {
-                C_n_low_vect.push_back(0. + i * 500); // cycles
-                C_n_low_vect.push_back(100.); // 100 % capacity
-            }
+    // If we aren't bounded, fill in values
+    if (n_rows_lo == 0) {
+        // Assumes 0% DOD
+        for (int i = 0; i < (int) n_rows_hi; i++) {
+            C_n_low_vect.push_back(0. + i * 500); // cycles
+            C_n_low_vect.push_back(100.); // 100 % capacity
         }
+    }
 
-        if (n_rows_lo != 0) {
-            for (int i = 0; i < (int) n_rows_lo; i++) {
-                C_n_low_vect.push_back(params->cycling_matrix.at(low_indices[i], lifetime_params::CYCLE));
-                C_n_low_vect.push_back(params->cycling_matrix.at(low_indices[i], lifetime_params::CAPACITY_CYCLE));
-            }
+    if (n_rows_lo != 0) {
+        for (int i = 0; i < (int) n_rows_lo; i++) {
+            C_n_low_vect.push_back(params->cycling_matrix.at(low_indices[i], lifetime_params::CYCLE));
+            C_n_low_vect.push_back(params->cycling_matrix.at(low_indices[i], lifetime_params::CAPACITY_CYCLE));
         }
-        if (n_rows_hi != 0) {
-            for (int i = 0; i < (int) n_rows_hi; i++) {
-                C_n_high_vect.push_back(params->cycling_matrix.at(high_indices[i], lifetime_params::CYCLE));
-                C_n_high_vect.push_back(params->cycling_matrix.at(high_indices[i], lifetime_params::CAPACITY_CYCLE));
-            }
+    }
+    if (n_rows_hi != 0) {
+        for (int i = 0; i < (int) n_rows_hi; i++) {
+            C_n_high_vect.push_back(params->cycling_matrix.at(high_indices[i], lifetime_params::CYCLE));
+            C_n_high_vect.push_back(params->cycling_matrix.at(high_indices[i], lifetime_params::CAPACITY_CYCLE));
         }
-        n_rows_lo = C_n_low_vect.size() / n_cols;
-        n_rows_hi = C_n_high_vect.size() / n_cols;
+    }
+    n_rows_lo = C_n_low_vect.size() / n_cols;
+    n_rows_hi = C_n_high_vect.size() / n_cols;
 
-        if (n_rows_lo == 0 || n_rows_hi == 0) {
-            // need a safeguard here
-        }
+    if (n_rows_lo == 0 || n_rows_hi == 0) {
+        // need a safeguard here
+    }
+
+    cycling_bracket b;
+    b.D_lo = D_lo;
+    b.D_hi = D_hi;
+    b.C_n_low = util::matrix_t<double>(n_rows_lo, n_cols, &C_n_low_vect);
+    b.C_n_high = util::matrix_t<double>(n_rows_lo, n_cols, &C_n_high_vect);
+    cycling_brackets.push_back(b);
+    return cycling_brackets.back();
+}
+
+double lifetime_cycle_t::bilinear(double DOD, int cycle_number) {
+    double C = 100;
 
-        util::matrix_t<double> C_n_low(n_rows_lo, n_cols, &C_n_low_vect);
-        util::matrix_t<double> C_n_high(n_rows_lo, n_cols, &C_n_high_vect);
+    if (cycling_DODs.size() > 1) {
+        const cycling_bracket &b = bracket(DOD);
 
         // Compute C(D_lo, n), C(D_hi, n)
-        double C_Dlo = util::linterp_col(C_n_low, 0, cycle_number, 1);
-        double C_Dhi = util::linterp_col(C_n_high, 0, cycle_number, 1);
+        double C_Dlo = util::linterp_col(b.C_n_low, 0, cycle_number, 1);
+        double C_Dhi = util::linterp_col(b.C_n_high, 0, cycle_number, 1);
 
         if (C_Dlo < 0.)
             C_Dlo = 0.;
@@ -324,7 +327,7 @@ double lifetime_cycle_t::bilinear(double DOD, int cycle_number) {
             C_Dhi = 100.;
 
         // Interpolate to get C(D, n)
-        C = util::interpolate(D_lo, C_Dlo, D_hi, C_Dhi, DOD);
+        C = util::interpolate(b.D_lo, C_Dlo, b.D_hi, C_Dhi, DOD);
     }
         // just have one row, single level interpolation
     else {
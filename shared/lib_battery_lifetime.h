@@ -130,12 +130,29 @@ protected:
     /// Bilinear interpolation, given the depth-of-discharge and cycle number, return the capacity percent
     double bilinear(double DOD, int cycle_number);
 
+    /// Capacity vs cycle number curves of the cycling matrix at the depths-of-discharge bracketing a DOD
+    struct cycling_bracket {
+        double D_lo;
+        double D_hi;
+        util::matrix_t<double> C_n_low;
+        util::matrix_t<double> C_n_high;
+    };
+
+    /// Return the curves bracketing DOD, building them the first time the bracket is used
+    const cycling_bracket &bracket(double DOD);
+
     std::shared_ptr<cycle_state> state;
     std::shared_ptr<lifetime_params> params;
 
+    /// distinct depths-of-discharge in the cycling matrix, which is fixed once the model is constructed
+    std::vector<double> cycling_DODs;
+    std::vector<cycling_bracket> cycling_brackets;
+
 private:
     void initialize();
 
+    void initialize_brackets();
+
     friend class lifetime_t;
 };
 
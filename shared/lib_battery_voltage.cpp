@@ -22,6 +22,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include "6par_newton.h"
 
 #include "lib_battery_voltage.h"
@@ -262,8 +263,6 @@ double voltage_table_t::calculate_current_for_target_w(double P_watts, double q,
 }
 
 // Dynamic voltage model
-typedef void (voltage_dynamic_t::*voltage_dynamic_fptr)(const double *, double *);
-
 void voltage_dynamic_t::initialize() {
     if ((params->dynamic.Vfull < params->dynamic.Vexp) ||
             (params->dynamic.Vexp < params->dynamic.Vnom)) {
@@ -409,40 +408,47 @@ double voltage_dynamic_t::calculate_current_for_target_w(double P_watts, double
     solver_power = fabs(P_watts) / (params->num_cells_series * params->num_strings);
     solver_q = q / params->num_strings;
     solver_Q = qmax / params->num_strings;
-
-    std::function<void(const double *, double *)> f;
-    double direction = 1.;
-    if (P_watts > 0)
-        f = std::bind(&voltage_dynamic_t::solve_current_for_discharge_power, this, _1, _2);
-    else {
-        f = std::bind(&voltage_dynamic_t::solve_current_for_charge_power, this, _1, _2);
-        direction = -1.;
+    double direction = P_watts > 0 ? 1. : -1.;
+
+    // Newton's method on the analytic derivative, falling back to bisection whenever a step leaves the bracket or
+    // fails to halve it. Power rises with charging current, and with discharging current up to the maximum discharge
+    // power, so the bracket tightens towards the smallest current that delivers the power.
+    double lo = 0;
+    double hi = direction > 0 ? solver_q / params->dt_hr : std::numeric_limits<double>::max();
+    double cell_voltage = state->cell_voltage != 0 ? state->cell_voltage : params->dynamic.Vnom;
+    double I = fmin(solver_power / cell_voltage, 0.5 * hi);
+    double step_prev = hi - lo;
+    for (size_t its = 0; its < 200; its++) {
+        double dP_dI;
+        double f = solve_current_for_power(I, direction, &dP_dI);
+        if (fabs(f) <= 1e-10 * solver_power)
+            break;
+        if (f < 0 && dP_dI > 0)
+            lo = I;
+        else
+            hi = I;
+        double I_next = dP_dI > 0 ? I - f / dP_dI : hi;
+        if (!(I_next > lo && I_next < hi) || fabs(I_next - I) > 0.5 * step_prev) {
+            if (hi == std::numeric_limits<double>::max())
+                I_next = 2. * I;
+            else
+                I_next = 0.5 * (lo + hi);
+        }
+        step_prev = fabs(I_next - I);
+        I = I_next;
+        if (step_prev <= 1e-12 * fmax(I, 1.))
+            break;
     }
-
-    double x[1], resid[1];
-    if (state->cell_voltage != 0)
-        x[0] = solver_power / state->cell_voltage * params->dt_hr;
-    else
-        x[0] = solver_power / params->dynamic.Vnom * params->dt_hr;
-    bool check = false;
-
-    newton<double, std::function<void(const double *, double *)>, 1>(x, resid, check, f,
-                                                                     100, 1e-6, 1e-6, 0.7);
-    return x[0] * params->num_strings * direction;
+    return I * params->num_strings * direction;
 }
 
-void voltage_dynamic_t::solve_current_for_charge_power(const double *x, double *f) {
-    double I = x[0];
-    double V = _E0 - _K * solver_Q / (solver_q + I * params->dt_hr) +
-               _A * exp(-_B0 * (solver_Q - (solver_q + I * params->dt_hr))) + params->resistance * I;
-    f[0] = I * V - solver_power;
-}
-
-void voltage_dynamic_t::solve_current_for_discharge_power(const double *x, double *f) {
-    double I = x[0];
-    double V = _E0 - _K * solver_Q / (solver_q - I * params->dt_hr) +
-               _A * exp(-_B0 * (solver_Q - (solver_q - I * params->dt_hr))) - params->resistance * I;
-    f[0] = I * V - solver_power;
+double voltage_dynamic_t::solve_current_for_power(double I, double direction, double *dP_dI) {
+    double q = solver_q - direction * I * params->dt_hr;
+    double exp_term = _A * exp(-_B0 * (solver_Q - q));
+    double V = _E0 - _K * solver_Q / q + exp_term - direction * params->resistance * I;
+    double dV_dI = -direction * params->dt_hr * (_K * solver_Q / (q * q) + _B0 * exp_term) - direction * params->resistance;
+    *dP_dI = V + I * dV_dI;
+    return I * V - solver_power;
 }
 
 // Vanadium redox flow model
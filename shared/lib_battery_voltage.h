@@ -207,9 +207,8 @@ protected:
     double solver_cutoff_voltage;
     double solver_power;
 
-    void solve_current_for_charge_power(const double *x, double *f);
-
-    void solve_current_for_discharge_power(const double *x, double *f);
+    // cell power less solver_power for a discharging (direction 1) or charging (direction -1) current I > 0
+    double solve_current_for_power(double I, double direction, double *dP_dI);
 
 private:
     void initialize();
@@ -20,6 +20,7 @@ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -1056,29 +1057,14 @@ void irrad::set_sun_component(size_t index, double value)
 	}
 }
 
-int irrad::calc()
+void irrad::calc_sunrise_sunset(double &t_sunrise, double &t_sunset)
 {
-	int code = check();
-	if ( code < 0 )
-		return -100+code;
-/*
-	calculates effective sun position at current timestep, with delt specified in hours
-
-	sunAnglesRadians: results from solarpos
-	timeStepSunPosition: [0]  effective hour of day used for sun position
-			[1]  effective minute of hour used for sun position
-			[2]  is sun up?  (0=no, 1=midday, 2=sunup, 3=sundown)
-	surfaceAnglesRadians: result from incidence
-	planeOfArrayIrradianceFront: result from sky model
-	diff: broken out diffuse components from sky model
-*/	
-	double t_cur = hour + minute/60.0;
-
 	// calculate sunrise and sunset hours in local standard time for the current day
-	solarpos( year, month, day, 12, 0.0, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
+	double sunanglesnoon[9];
+	solarpos( year, month, day, 12, 0.0, latitudeDegrees, longitudeDegrees, timezone, sunanglesnoon );
 
-	double t_sunrise = sunAnglesRadians[4];
-	double t_sunset = sunAnglesRadians[5];
+	t_sunrise = sunanglesnoon[4];
+	t_sunset = sunanglesnoon[5];
 
 	if (t_sunset > 24.0 && t_sunset != 100.0) //sunset is legitimately the next day but we're not in endless days, so recalculate sunset from the previous day
 	{
@@ -1113,6 +1099,33 @@ int irrad::calc()
 		else if (sunanglestemp[4] < 0.0)
 			t_sunrise = sunanglestemp[4] + 24.0;
 	}
+}
+
+int irrad::calc()
+{
+	int code = check();
+	if ( code < 0 )
+		return -100+code;
+
+	double t_sunrise, t_sunset;
+	calc_sunrise_sunset(t_sunrise, t_sunset);
+	return calc_timestep(t_sunrise, t_sunset);
+}
+
+int irrad::calc_timestep(double t_sunrise, double t_sunset)
+{
+/*
+	calculates effective sun position at current timestep, with delt specified in hours
+
+	sunAnglesRadians: results from solarpos
+	timeStepSunPosition: [0]  effective hour of day used for sun position
+			[1]  effective minute of hour used for sun position
+			[2]  is sun up?  (0=no, 1=midday, 2=sunup, 3=sundown)
+	surfaceAnglesRadians: result from incidence
+	planeOfArrayIrradianceFront: result from sky model
+	diff: broken out diffuse components from sky model
+*/	
+	double t_cur = hour + minute/60.0;
 
 	// recall: if delt <= 0.0, do not interpolate sunrise and sunset hours, just use specified time stamp
 	// time step encompasses the sunrise
@@ -1161,7 +1174,11 @@ int irrad::calc()
 		timeStepSunPosition[2] = 0;
 	}
 
-			
+	return calc_surface();
+}
+
+int irrad::calc_surface()
+{
 	planeOfArrayIrradianceFront[0]=planeOfArrayIrradianceFront[1]=planeOfArrayIrradianceFront[2] = 0;
 	diffuseIrradianceFront[0]=diffuseIrradianceFront[1]=diffuseIrradianceFront[2] = 0;
 	surfaceAnglesRadians[0]=surfaceAnglesRadians[1]=surfaceAnglesRadians[2]=surfaceAnglesRadians[3]=surfaceAnglesRadians[4] = 0;
@@ -1234,6 +1251,83 @@ int irrad::calc()
 
 }
 
+void irrad_batch::resize(size_t n)
+{
+	year.resize(n);
+	month.resize(n);
+	day.resize(n);
+	hour.resize(n);
+	minute.resize(n);
+	globalHorizontal.resize(n);
+	directNormal.resize(n);
+	diffuseHorizontal.resize(n);
+}
+
+int irrad::calc_batch(irrad_batch &batch, double delt_hr)
+{
+	size_t n = batch.size();
+	int mode = batch.radiationMode;
+	if (mode < irrad::DN_DF || mode >= irrad::POA_R)
+		return -100 - 3; // POA decomposition carries state between steps and is only available through calc()
+	if (batch.month.size() != n || batch.day.size() != n || batch.hour.size() != n || batch.minute.size() != n
+		|| (!batch.albedo.empty() && batch.albedo.size() != n))
+		return -100 - 1;
+
+	const std::vector<double> *first = mode == irrad::DN_DF ? &batch.directNormal : &batch.globalHorizontal;
+	const std::vector<double> *second = mode == irrad::DN_GH ? &batch.directNormal : &batch.diffuseHorizontal;
+	if (first->size() != n || second->size() != n)
+		return -100 - 1;
+
+	std::vector<double> *outputs[] = { &batch.sunAzimuth, &batch.sunZenith, &batch.sunElevation, &batch.sunDeclination, &batch.sunrise, &batch.sunset,
+		&batch.angleOfIncidence, &batch.surfaceTilt, &batch.surfaceAzimuth, &batch.axisRotation, &batch.backtrackDifference,
+		&batch.poaBeam, &batch.poaSkyDiffuse, &batch.poaGroundDiffuse, &batch.poaIsotropic, &batch.poaCircumsolar, &batch.poaHorizon };
+	for (auto out : outputs)
+		out->resize(n);
+	batch.sunUp.resize(n);
+	batch.code.resize(n);
+
+	double albedoDefault = albedo;
+	double t_sunrise = 0, t_sunset = 0;
+	int sunYear = -1, sunMonth = -1, sunDay = -1;
+	int result = 0;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		set_time(batch.year[i], batch.month[i], batch.day[i], batch.hour[i], batch.minute[i], delt_hr);
+		albedo = batch.albedo.empty() ? albedoDefault : batch.albedo[i];
+		if (mode == irrad::DN_DF) set_beam_diffuse(batch.directNormal[i], batch.diffuseHorizontal[i]);
+		else if (mode == irrad::DN_GH) set_global_beam(batch.globalHorizontal[i], batch.directNormal[i]);
+		else set_global_diffuse(batch.globalHorizontal[i], batch.diffuseHorizontal[i]);
+
+		int code = check();
+		if (code < 0)
+			code = -100 + code;
+		else
+		{
+			// sunrise and sunset only depend on the day, so compute them once per day rather than once per step
+			if (year != sunYear || month != sunMonth || day != sunDay)
+			{
+				calc_sunrise_sunset(t_sunrise, t_sunset);
+				sunYear = year;
+				sunMonth = month;
+				sunDay = day;
+			}
+			code = calc_timestep(t_sunrise, t_sunset);
+		}
+
+		batch.code[i] = code;
+		if (code < 0 && result == 0)
+			result = code;
+
+		get_sun(&batch.sunAzimuth[i], &batch.sunZenith[i], &batch.sunElevation[i], &batch.sunDeclination[i],
+			&batch.sunrise[i], &batch.sunset[i], &batch.sunUp[i], 0, 0, 0);
+		get_angles(&batch.angleOfIncidence[i], &batch.surfaceTilt[i], &batch.surfaceAzimuth[i], &batch.axisRotation[i], &batch.backtrackDifference[i]);
+		get_poa(&batch.poaBeam[i], &batch.poaSkyDiffuse[i], &batch.poaGroundDiffuse[i], &batch.poaIsotropic[i], &batch.poaCircumsolar[i], &batch.poaHorizon[i]);
+	}
+	albedo = albedoDefault;
+	return result;
+}
+
 int irrad::calc_rear_side(double transmissionFactor, double groundClearanceHeight, double slopeLength)
 {
 	// do irradiance calculations if sun is up
@@ -1282,10 +1376,115 @@ int irrad::calc_rear_side(double transmissionFactor, double groundClearanceHeigh
 	return true;
 }
 
-void irrad::getSkyConfigurationFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> & rearSkyConfigFactors, std::vector<double> & frontSkyConfigFactors)
+int irrad::calc_rear_side(double transmissionFactor, const bifacial_view_factors &viewFactors)
+{
+	if (timeStepSunPosition[2] <= 0)
+		return true;
+
+	double tiltRadian = surfaceAnglesRadians[1];
+	const bifacial_view_factors::entry *lower, *upper;
+	double weight = 0;
+	if (!viewFactors.lookup(tiltRadian * RTOD, lower, upper, weight))
+		return calc_rear_side(transmissionFactor, viewFactors.ground_clearance_height(), viewFactors.slope_length());
+
+	// System geometry at the actual tilt for the ground shading, as in calc_rear_side()
+	double slopeLength = viewFactors.slope_length();
+	double groundClearanceHeight = viewFactors.ground_clearance_height();
+	if (this->trackingMode == 1) {
+		groundClearanceHeight = groundClearanceHeight - (0.5 * slopeLength) * sin(fabs(tiltRadian));
+	}
+	double rowToRow = slopeLength / this->groundCoverageRatio;
+	double clearanceGround = groundClearanceHeight;
+	double distanceBetweenRows = rowToRow - cos(tiltRadian);
+	double verticalHeight = slopeLength * sin(tiltRadian);
+	double horizontalLength = slopeLength * cos(tiltRadian);
+
+	size_t intervals = viewFactors.ground_segments();
+	double pvBackShadeFraction, pvFrontShadeFraction, maxShadow;
+	pvBackShadeFraction = pvFrontShadeFraction = maxShadow = 0;
+	std::vector<int> rearGroundShade, frontGroundShade;
+	rearGroundShade.reserve(intervals);
+	frontGroundShade.reserve(intervals);
+	this->getGroundShadeFactors(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, sunAnglesRadians[0], sunAnglesRadians[2], rearGroundShade, frontGroundShade, maxShadow, pvBackShadeFraction, pvFrontShadeFraction, intervals);
+
+	// Sky components seen by the ground and by the cell rows, each calculated once for all cell rows
+	double solarAzimuthRadians = sunAnglesRadians[0];
+	double solarZenithRadians = sunAnglesRadians[1];
+	double surfaceAzimuthRadians = surfaceAnglesRadians[2];
+	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, solarZenithRadians, 0.0, solarZenithRadians, planeOfArrayIrradianceRear, diffuseIrradianceRear);
+	double incidentBeam = planeOfArrayIrradianceRear[0];
+	double isotropicDiffuse = diffuseIrradianceRear[0];
+	double circumsolarDiffuse = diffuseIrradianceRear[1];
+
+	double surfaceAnglesRadians90[5] = { 0,0,0,0,0 };
+	incidence(0, 90.0, 180.0, 45.0, solarZenithRadians, solarAzimuthRadians, this->enableBacktrack, this->groundCoverageRatio, this->forceToStow, this->stowAngleDegrees, surfaceAnglesRadians90);
+	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians90[0], surfaceAnglesRadians90[1], solarZenithRadians, planeOfArrayIrradianceRear, diffuseIrradianceRear);
+	double horizonDiffuse = diffuseIrradianceRear[2];
+
+	// Direct and circumsolar irradiance on the back of the module, leaving the surface angles for the back as calc_rear_side() does
+	incidence(0, 180.0 - tiltRadian * RTOD, (surfaceAzimuthRadians * RTOD - 180.0), 45.0, solarZenithRadians, solarAzimuthRadians, this->enableBacktrack,
+		this->groundCoverageRatio, this->forceToStow, this->stowAngleDegrees, surfaceAnglesRadians);
+	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians[0], surfaceAnglesRadians[1], solarZenithRadians, planeOfArrayIrradianceRear, diffuseIrradianceRear);
+
+	const size_t cellRows = bifacial_view_factors::cellRows;
+	double rearBeam[cellRows];
+	double iamMod = surfaceAnglesRadians[0] < M_PI / 2.0 ? iamSjerpsKoomen(1.526, surfaceAnglesRadians[0]) : 0;
+	for (size_t i = 0; i != cellRows; i++)
+	{
+		double cellShade = fmin(1.0, fmax(0.0, pvBackShadeFraction * cellRows - i));
+		rearBeam[i] = 0;
+		if (cellShade < 1.0 && surfaceAnglesRadians[0] < M_PI / 2.0)
+			rearBeam[i] = (1.0 - cellShade) * (planeOfArrayIrradianceRear[0] + diffuseIrradianceRear[1]) * iamMod;
+	}
+
+	// Average rear irradiance with the factors of one table entry
+	std::vector<double> groundGHI(intervals);
+	auto rearAverage = [&](const bifacial_view_factors::entry &e)
+	{
+		for (size_t k = 0; k != intervals; k++)
+		{
+			groundGHI[k] = e.skyConfigFactors[k] * isotropicDiffuse;
+			if (rearGroundShade[k] == 0)
+				groundGHI[k] += incidentBeam + circumsolarDiffuse;
+			else
+				groundGHI[k] += (incidentBeam + circumsolarDiffuse) * transmissionFactor;
+		}
+
+		double frontReflected[cellRows];
+		for (size_t i = 0; i != cellRows; i++)
+		{
+			const double *w = &e.frontReflectedGround[i * intervals];
+			double ground = 0;
+			for (size_t k = 0; k != intervals; k++)
+				ground += w[k] * groundGHI[k];
+			frontReflected[i] = e.frontReflectedIsotropic[i] * isotropicDiffuse + e.frontReflectedHorizon[i] * horizonDiffuse + ground * this->albedo;
+		}
+
+		double average = 0;
+		for (size_t i = 0; i != cellRows; i++)
+		{
+			const double *w = &e.rearGround[i * intervals];
+			double ground = 0;
+			for (size_t k = 0; k != intervals; k++)
+				ground += w[k] * groundGHI[k];
+			double reflected = 0;
+			for (size_t k = 0; k != cellRows; k++)
+				reflected += e.rearReflected[i * cellRows + k] * frontReflected[k];
+			double rearIrradiance = e.rearIsotropic[i] * isotropicDiffuse + e.rearHorizon[i] * horizonDiffuse + reflected + ground * this->albedo + rearBeam[i];
+			average += rearIrradiance / cellRows;
+		}
+		return average;
+	};
+
+	planeOfArrayIrradianceRearAverage = rearAverage(*lower);
+	if (weight > 0)
+		planeOfArrayIrradianceRearAverage += weight * (rearAverage(*upper) - planeOfArrayIrradianceRearAverage);
+	return true;
+}
+
+// sky configuration factors of points at the middle of each interval of the ground from the leading edge of one row to the next
+static void sky_configuration_factors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, size_t intervals, std::vector<double> & skyConfigFactors)
 {
-	// Calculate sky configuration factors using 100 intervals
-	size_t intervals = 100;
 	double deltaInterval = static_cast<double>(rowToRow / intervals);
 	double x = -deltaInterval / 2.0;
 
@@ -1340,15 +1539,20 @@ void irrad::getSkyConfigurationFactors(double rowToRow, double verticalHeight, d
 		}
 		skyAll = sky1 + sky2 + sky3;
 
-		rearSkyConfigFactors.push_back(skyAll);
-		frontSkyConfigFactors.push_back(skyAll);
+		skyConfigFactors.push_back(skyAll);
 	}
 }
 
-void irrad::getGroundShadeFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double solarAzimuthRadians, double solarElevationRadians, std::vector<int> & rearGroundShade, std::vector<int> & frontGroundShade, double & maxShadow, double & pvBackSurfaceShadeFraction, double & pvFrontSurfaceShadeFraction)
+void irrad::getSkyConfigurationFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> & rearSkyConfigFactors, std::vector<double> & frontSkyConfigFactors, size_t intervals)
 {
-	// calculate ground shade factors using 100 intervals
-	size_t intervals = 100;
+	// Calculate sky configuration factors, the same for the ground in front of and behind the row
+	sky_configuration_factors(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, intervals, rearSkyConfigFactors);
+	frontSkyConfigFactors = rearSkyConfigFactors;
+}
+
+void irrad::getGroundShadeFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double solarAzimuthRadians, double solarElevationRadians, std::vector<int> & rearGroundShade, std::vector<int> & frontGroundShade, double & maxShadow, double & pvBackSurfaceShadeFraction, double & pvFrontSurfaceShadeFraction, size_t intervals)
+{
+	// calculate ground shade factors for each interval
 	double deltaInterval = static_cast<double>(rowToRow / intervals);
 	double surfaceAzimuthAngleRadians = surfaceAnglesRadians[2];
 	double shadingStart1, shadingStart2, shadingEnd1, shadingEnd2;
@@ -1872,6 +2076,255 @@ void irrad::getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRo
 	}
 }
 
+bifacial_view_factors::bifacial_view_factors()
+	: groundCoverageRatio(0), groundClearanceHeight(0), slopeLength(0), singleAxisTracking(false), groundSegments(100)
+{
+}
+
+void bifacial_view_factors::setup(double groundCoverageRatioIn, double groundClearanceHeightIn, double slopeLengthIn, bool singleAxisTrackingIn,
+	std::vector<double> tiltDegrees, size_t groundSegmentsIn)
+{
+	groundCoverageRatio = groundCoverageRatioIn;
+	groundClearanceHeight = groundClearanceHeightIn;
+	slopeLength = slopeLengthIn;
+	singleAxisTracking = singleAxisTrackingIn;
+	groundSegments = groundSegmentsIn > 0 ? groundSegmentsIn : 100;
+
+	std::sort(tiltDegrees.begin(), tiltDegrees.end());
+	tiltDegrees.erase(std::unique(tiltDegrees.begin(), tiltDegrees.end()), tiltDegrees.end());
+	entries.assign(tiltDegrees.size(), entry());
+	for (size_t i = 0; i < tiltDegrees.size(); i++)
+	{
+		entries[i].tiltDegrees = tiltDegrees[i];
+		tabulate(entries[i]);
+	}
+}
+
+std::vector<double> bifacial_view_factors::tilt_range(double stepDegrees)
+{
+	std::vector<double> tilts;
+	size_t n = (size_t)ceil(90.0 / stepDegrees - 1e-9);
+	for (size_t i = 0; i < n; i++)
+		tilts.push_back(i * stepDegrees);
+	tilts.push_back(90.0);
+	return tilts;
+}
+
+bool bifacial_view_factors::lookup(double tiltDegrees, const entry *&lower, const entry *&upper, double &weight) const
+{
+	const double tolerance = 1e-6;
+	if (entries.empty() || tiltDegrees < entries.front().tiltDegrees - tolerance || tiltDegrees > entries.back().tiltDegrees + tolerance)
+		return false;
+
+	size_t i = 0;
+	while (i + 1 < entries.size() && entries[i].tiltDegrees < tiltDegrees - tolerance)
+		i++;
+	upper = &entries[i];
+	if (i == 0 || fabs(entries[i].tiltDegrees - tiltDegrees) <= tolerance) {
+		lower = upper;
+		weight = 0;
+	}
+	else {
+		lower = &entries[i - 1];
+		weight = (tiltDegrees - lower->tiltDegrees) / (upper->tiltDegrees - lower->tiltDegrees);
+	}
+	return true;
+}
+
+// weight the ground segments seen in a one-degree field of view, with the projection on the ground given in segments
+static void add_ground_weights(double *weights, size_t intervals, double projectedX1, double projectedX2, int index1, int index2, double factor)
+{
+	int n = (int)intervals;
+	if (index1 == index2) {
+		weights[((index1 % n) + n) % n] += factor;
+		return;
+	}
+	for (int k = index1; k <= index2; k++)
+	{
+		double length = 1.0;
+		if (k == index1)
+			length = k + 1.0 - projectedX1;
+		else if (k == index2)
+			length = projectedX2 - k;
+		weights[((k % n) + n) % n] += factor * length / (projectedX2 - projectedX1);
+	}
+}
+
+// whole degrees in an angle in radians, as the arc ranges of getFrontSurfaceIrradiances() and getBackSurfaceIrradiances()
+static size_t whole_degrees(double radians)
+{
+	return (size_t)fmin(180.0, fmax(0.0, round(radians / DTOR)));
+}
+
+void bifacial_view_factors::tabulate(entry &e) const
+{
+	// the same geometry and fields of view as getFrontSurfaceIrradiances() and getBackSurfaceIrradiances(), without the irradiance
+	size_t intervals = groundSegments;
+	double tiltRadians = e.tiltDegrees * DTOR;
+	double clearanceGround = groundClearanceHeight;
+	if (singleAxisTracking)
+		clearanceGround -= (0.5 * slopeLength) * sin(fabs(tiltRadians));
+	double rowToRow = slopeLength / groundCoverageRatio;
+	double distanceBetweenRows = rowToRow - cos(tiltRadians);
+	double verticalHeight = slopeLength * sin(tiltRadians);
+	double horizontalLength = slopeLength * cos(tiltRadians);
+
+	e.skyConfigFactors.clear();
+	sky_configuration_factors(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, intervals, e.skyConfigFactors);
+
+	double n2 = 1.526;
+	double reflectanceNormalIncidence = pow((n2 - 1.0) / (n2 + 1.0), 2.0);
+
+	e.frontReflectedIsotropic.assign(cellRows, 0);
+	e.frontReflectedHorizon.assign(cellRows, 0);
+	e.frontReflectedGround.assign(cellRows * intervals, 0);
+	e.rearIsotropic.assign(cellRows, 0);
+	e.rearHorizon.assign(cellRows, 0);
+	e.rearReflected.assign(cellRows * cellRows, 0);
+	e.rearGround.assign(cellRows * intervals, 0);
+
+	// front surface of the row behind, seen from the rear of this one
+	double PbotX = -rowToRow;
+	double PbotY = clearanceGround;
+	double PtopX = -distanceBetweenRows;
+	double PtopY = verticalHeight + clearanceGround;
+	for (size_t i = 0; i != cellRows; i++)
+	{
+		double PcellX = horizontalLength * (i + 0.5) / ((double)cellRows);
+		double PcellY = clearanceGround + verticalHeight * (i + 0.5) / ((double)cellRows);
+		double elevationAngleUp = atan((PtopY - PcellY) / (PcellX - PtopX));
+		double elevationAngleDown = atan((PcellY - PbotY) / (PcellX - PbotX));
+		size_t iStopIso = whole_degrees(M_PI - tiltRadians - elevationAngleUp);
+		size_t iHorBright = whole_degrees(fmax(0.0, 6.0 * DTOR - elevationAngleUp));
+		size_t iStartGrd = whole_degrees(M_PI - tiltRadians + elevationAngleDown);
+
+		for (size_t j = 0; j != iStopIso; j++)
+		{
+			double reflected = 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * (1.0 - MarionAOICorrectionFactorsGlass[j] * (1.0 - reflectanceNormalIncidence));
+			e.frontReflectedIsotropic[i] += reflected;
+			if ((iStopIso - j) <= iHorBright)
+				e.frontReflectedHorizon[i] += reflected / 0.052246;
+		}
+
+		double *weights = &e.frontReflectedGround[i * intervals];
+		for (size_t j = iStartGrd; j < 180; j++)
+		{
+			double reflected = 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * (1.0 - MarionAOICorrectionFactorsGlass[j] * (1.0 - reflectanceNormalIncidence));
+			double startElevationDown = (j - iStartGrd) * DTOR + elevationAngleDown;
+			double stopElevationDown = (j + 1 - iStartGrd) * DTOR + elevationAngleDown;
+			double projectedX1 = PcellX - PcellY / tan(startElevationDown);
+			double projectedX2 = PcellX - PcellY / tan(stopElevationDown);
+			if (fabs(projectedX1 - projectedX2) > 0.99 * rowToRow)
+			{
+				for (size_t k = 0; k != intervals; k++)
+					weights[k] += reflected / intervals;
+				continue;
+			}
+			projectedX1 = intervals * projectedX1 / rowToRow;
+			projectedX2 = intervals * projectedX2 / rowToRow;
+			while (projectedX1 < 0.0 || projectedX2 < 0.0)
+			{
+				projectedX1 += intervals;
+				projectedX2 += intervals;
+			}
+			add_ground_weights(weights, intervals, projectedX1, projectedX2, (int)projectedX1, (int)projectedX2, reflected);
+		}
+	}
+
+	// rear surface of this row
+	PbotX = rowToRow;
+	PtopX = rowToRow + horizontalLength;
+	for (size_t i = 0; i != cellRows; i++)
+	{
+		double PcellX = horizontalLength * (i + 0.5) / ((double)cellRows);
+		double PcellY = clearanceGround + verticalHeight * (i + 0.5) / ((double)cellRows);
+		double elevationAngleUp = atan((PtopY - PcellY) / (PtopX - PcellX));
+		double elevationAngleDown = atan((PcellY - PbotY) / (PbotX - PcellX));
+		size_t iStopIso = whole_degrees(tiltRadians - elevationAngleUp);
+		size_t iHorBright = whole_degrees(fmax(0.0, 6.0 * DTOR - elevationAngleUp));
+		size_t iStartGrd = whole_degrees(tiltRadians + elevationAngleDown);
+
+		for (size_t j = 0; j != iStopIso; j++)
+		{
+			double seen = 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * MarionAOICorrectionFactorsGlass[j];
+			e.rearIsotropic[i] += seen;
+			if ((iStopIso - j) <= iHorBright)
+				e.rearHorizon[i] += seen / 0.052264;
+		}
+
+		// reflections from the front cell rows of the row behind
+		for (size_t j = iStopIso; j < iStartGrd; j++)
+		{
+			double diagonalDistance = (PbotX - PcellX) / cos(elevationAngleDown);
+			double startAlpha = -(double)(j - iStopIso) * DTOR + elevationAngleUp + elevationAngleDown;
+			double stopAlpha = -(double)(j + 1 - iStopIso) * DTOR + elevationAngleUp + elevationAngleDown;
+			double m = diagonalDistance * sin(startAlpha);
+			double theta = M_PI - elevationAngleDown - (M_PI / 2.0 - startAlpha) - tiltRadians;
+			double projectedX2 = m / cos(theta);
+
+			m = diagonalDistance * sin(stopAlpha);
+			theta = M_PI - elevationAngleDown - (M_PI / 2.0 - stopAlpha) - tiltRadians;
+			double projectedX1 = m / cos(theta);
+			projectedX1 = fmax(0.0, projectedX1);
+
+			double seen = 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * MarionAOICorrectionFactorsGlass[j];
+			double deltaCell = 1.0 / cellRows;
+			double tolerance = 0.0001;
+			for (size_t k = 0; k < cellRows; k++)
+			{
+				double cellBottom = k * deltaCell;
+				double cellTop = (k + 1) * deltaCell;
+				double cellLengthSeen = 0.0;
+
+				if (cellBottom >= projectedX1 - tolerance && cellTop <= projectedX2 + tolerance) {
+					cellLengthSeen = cellTop - cellBottom;
+				}
+				else if (cellBottom <= projectedX1 + tolerance && cellTop >= projectedX2 - tolerance) {
+					cellLengthSeen = projectedX2 - projectedX1;
+				}
+				else if (cellBottom >= projectedX1 - tolerance && projectedX2 > cellBottom - tolerance && cellTop >= projectedX2 - tolerance) {
+					cellLengthSeen = projectedX2 - cellBottom;
+				}
+				else if (cellBottom <= projectedX1 + tolerance && projectedX1 < cellTop + tolerance && cellTop <= projectedX2 + tolerance) {
+					cellLengthSeen = cellTop - projectedX1;
+				}
+				e.rearReflected[i * cellRows + k] += seen * cellLengthSeen / (projectedX2 - projectedX1);
+			}
+		}
+
+		double *weights = &e.rearGround[i * intervals];
+		for (size_t j = iStartGrd; j < 180; j++)
+		{
+			double seen = 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * MarionAOICorrectionFactorsGlass[j];
+			double startElevationDown = (double)(j - iStartGrd) * DTOR + elevationAngleDown;
+			double stopElevationDown = (double)(j + 1 - iStartGrd) * DTOR + elevationAngleDown;
+			double projectedX2 = PcellX + PcellY / tan(startElevationDown);
+			double projectedX1 = PcellX + PcellY / tan(stopElevationDown);
+			if (fabs(projectedX1 - projectedX2) > 0.99 * rowToRow)
+			{
+				for (size_t k = 0; k != intervals; k++)
+					weights[k] += seen / intervals;
+				continue;
+			}
+			projectedX1 = intervals * projectedX1 / rowToRow;
+			projectedX2 = intervals * projectedX2 / rowToRow;
+			while (projectedX1 >= intervals || projectedX2 >= intervals)
+			{
+				projectedX1 -= intervals;
+				projectedX2 -= intervals;
+			}
+			while (projectedX1 < -(int)intervals || projectedX2 < -(int)intervals)
+			{
+				projectedX1 += intervals;
+				projectedX2 += intervals;
+			}
+			int index1 = static_cast<int>(projectedX1 + intervals) - (int)intervals;
+			int index2 = static_cast<int>(projectedX2 + intervals) - (int)intervals;
+			add_ground_weights(weights, intervals, projectedX1, projectedX2, index1, index2, seen);
+		}
+	}
+}
+
 static double vec_dot(double a[3], double b[3])
 {
 	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
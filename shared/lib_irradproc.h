@@ -51,6 +51,7 @@
 #define __irradproc_h
 
 #include <memory>
+#include <vector>
 
 #include "lib_weatherfile.h"
 
@@ -278,6 +279,98 @@ double shadeFraction1x(double solazi, double solzen, double tilt, double azimuth
 double backtrack(double solazi, double solzen, double tilt, double azimuth, double rotlim, double gcr, double rotation);
 
 
+/**
+* \struct irrad_batch
+*
+*  Column inputs and outputs for irrad::calc_batch(), one entry per time step in struct-of-arrays form.
+*  Only the irradiance columns required by radiationMode need to be filled. Leave albedo empty to use
+*  the value given to irrad::set_sky_model(). Output angles are in degrees, as returned by irrad::get_sun() and irrad::get_angles().
+*/
+struct irrad_batch
+{
+	/// Size all input columns for n time steps
+	void resize(size_t n);
+
+	/// Number of time steps
+	size_t size() const { return year.size(); }
+
+	// Inputs
+	int radiationMode = 0;	///< irradiance columns supplied, as defined in irrad::RADMODE (DN_DF, DN_GH or GH_DF)
+	std::vector<int> year, month, day, hour;
+	std::vector<double> minute;
+	std::vector<double> globalHorizontal, directNormal, diffuseHorizontal;
+	std::vector<double> albedo;
+
+	// Sun outputs
+	std::vector<double> sunAzimuth, sunZenith, sunElevation, sunDeclination, sunrise, sunset;
+	std::vector<int> sunUp;
+
+	// Surface outputs
+	std::vector<double> angleOfIncidence, surfaceTilt, surfaceAzimuth, axisRotation, backtrackDifference;
+
+	// Front-side plane-of-array outputs (W/m2)
+	std::vector<double> poaBeam, poaSkyDiffuse, poaGroundDiffuse, poaIsotropic, poaCircumsolar, poaHorizon;
+
+	/// Return code of each time step, as from irrad::calc()
+	std::vector<int> code;
+};
+
+/**
+* \class bifacial_view_factors
+*
+*  Geometry factors of the rear-side irradiance model in irrad::calc_rear_side(), tabulated by surface tilt for one row geometry.
+*  The sky configuration factors of the ground and the views of each cell row to the sky, the ground and the next row depend only
+*  on the geometry, so irrad::calc_rear_side() with a table only has to find the ground shading and sky components for the sun.
+*  Fixed and seasonal tilt subarrays need one entry per tilt. Trackers need a table over the range of rotation, and the rear-side
+*  irradiance is interpolated between the two nearest tilts.
+*/
+class bifacial_view_factors
+{
+public:
+	/// Number of cell rows on each side of a module, as assumed by irrad::calc_rear_side()
+	static const size_t cellRows = 6;
+
+	/// Factors for one surface tilt. Irradiance on the front cell rows reflected toward the next row and on the rear cell rows is
+	/// a weighted sum of the isotropic and horizon sky diffuse, the ground irradiance of each segment times the albedo, and,
+	/// for the rear, the irradiance reflected by the front cell rows of the next row
+	struct entry
+	{
+		double tiltDegrees;
+		std::vector<double> skyConfigFactors;		///< sky configuration factor of each ground segment
+		std::vector<double> frontReflectedIsotropic, frontReflectedHorizon;	///< per front cell row
+		std::vector<double> frontReflectedGround;	///< per front cell row and ground segment
+		std::vector<double> rearIsotropic, rearHorizon;	///< per rear cell row
+		std::vector<double> rearReflected;			///< per rear cell row and front cell row of the next row
+		std::vector<double> rearGround;				///< per rear cell row and ground segment
+	};
+
+	bifacial_view_factors();
+
+	/// Tabulate the factors at the given surface tilts for a row geometry, with the ground clearance height and slope length as
+	/// given to irrad::calc_rear_side(). The clearance of single-axis trackers falls as the rows rotate.
+	void setup(double groundCoverageRatio, double groundClearanceHeight, double slopeLength, bool singleAxisTracking,
+		std::vector<double> tiltDegrees, size_t groundSegments = 100);
+
+	/// Tilts from 0 to 90 degrees in steps of stepDegrees, for surfaces that rotate
+	static std::vector<double> tilt_range(double stepDegrees);
+
+	bool empty() const { return entries.empty(); }
+	size_t ground_segments() const { return groundSegments; }
+	double ground_clearance_height() const { return groundClearanceHeight; }
+	double slope_length() const { return slopeLength; }
+
+	/// Find the entries on either side of a tilt and the interpolation weight of the upper one, returning false if the tilt is outside the table
+	bool lookup(double tiltDegrees, const entry *&lower, const entry *&upper, double &weight) const;
+
+private:
+	double groundCoverageRatio, groundClearanceHeight, slopeLength;
+	bool singleAxisTracking;
+	size_t groundSegments;
+	std::vector<entry> entries;		///< sorted by tilt
+
+	void tabulate(entry &e) const;
+};
+
 /**
 * \class irrad
 *
@@ -333,6 +426,12 @@ protected:
 	int timeStepSunPosition[3];				///< [0] effective hour of day used for sun position, [1] effective minute of hour used for sun position, [2] is sun up?  (0=no, 1=midday, 2=sunup, 3=sundown)
 	double planeOfArrayIrradianceRearAverage; ///< Average rear side plane-of-array irradiance (W/m2)
 
+	/// Calculate the sunrise and sunset hours in local standard time for the current day
+	void calc_sunrise_sunset(double &t_sunrise, double &t_sunset);
+
+	/// Calculate the sun position, surface angles and plane-of-array irradiance for the current time step of a day
+	int calc_timestep(double t_sunrise, double t_sunset);
+
 public:
 
 	/// Directive to indicate that if delt_hr is less than zero, do not interpolate sunrise and sunset hours
@@ -391,8 +490,17 @@ public:
 	/// Run the irradiance processor and calculate the plane-of-array irradiance and diffuse components of irradiance
 	int calc();
 
+	/// Recalculate the surface angles and plane-of-array irradiance for the sun position of the last calc(), after changing the surface with set_surface()
+	int calc_surface();
+
+	/// Run the irradiance processor over columns of time steps using the current location, sky model and surface, returning the first error code or 0
+	int calc_batch(irrad_batch &batch, double delt_hr);
+
 	/// Run the irradiance processor for the rear-side of the surface to calculate rear-side plane-of-array irradiance
 	int calc_rear_side(double transmissionFactor, double groundClearanceHeight, double slopeLength);
+
+	/// Run the irradiance processor for the rear-side of the surface with view factors tabulated for its geometry, falling back to the full calculation for tilts outside the table
+	int calc_rear_side(double transmissionFactor, const bifacial_view_factors &viewFactors);
 	
 	/// Return the calculated sun angles, some of which are converted to degrees
 	void get_sun( double *solazi,
@@ -433,10 +541,10 @@ public:
 	double getAlbedo();
 
 	/// Return the sky configuration factors, used by \link calc_rear_side()
-	void getSkyConfigurationFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> & rearSkyConfigFactors, std::vector<double> & frontSkyConfigFactors);
+	void getSkyConfigurationFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> & rearSkyConfigFactors, std::vector<double> & frontSkyConfigFactors, size_t intervals = 100);
 
 	/// Return the ground-shade factors, describing which segments of the ground are shaded by the array, used by \link calc_rear_side()
-	void getGroundShadeFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double solarAzimuthRadians, double solarElevationRadians, std::vector<int> & rearGroundFactors, std::vector<int> & frontGroundFactors, double & maxShadow, double & pvBackShadeFraction, double & pvFrontShadeFraction);
+	void getGroundShadeFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double solarAzimuthRadians, double solarElevationRadians, std::vector<int> & rearGroundFactors, std::vector<int> & frontGroundFactors, double & maxShadow, double & pvBackShadeFraction, double & pvFrontShadeFraction, size_t intervals = 100);
 
 	/// Return the ground global-horizonal irradiance, used by \link calc_rear_side()
 	void getGroundGHI(double transmissionFactor, std::vector<double> rearSkyConfigFactors, std::vector<double> frontSkyConfigFactors, std::vector<int> rearGroundShadeFactors, std::vector<int> frontGroundShadeFactors, std::vector<double> & rearGroundGHI, std::vector<double> & frontGroundGHI);
@@ -256,18 +256,27 @@ bool mlmodel_module_t::operator() (pvinput_t &input, double T_C, double opvoltag
 
 			R_sh = R_shref + (R_sh0 - R_shref) * exp(-R_shexp * (S / S_ref));
 
-			V_oc = openvoltage_5par_rec(V_oc, a, I_L, I_0, R_sh, D2MuTau, Vbi);
+			// without recombination losses the explicit single-diode solution applies
+			bool explicitSolution = D2MuTau == 0;
+			if (explicitSolution)
+				V_oc = openvoltage_5par_lambertw(V_oc, a, I_L, I_0, R_sh);
+			else
+				V_oc = openvoltage_5par_rec(V_oc, a, I_L, I_0, R_sh, D2MuTau, Vbi);
 			I_sc = I_L / (1 + R_s / R_sh);
 
 			if (opvoltage < 0)
 			{
-				P = maxpower_5par_rec(V_oc, a, I_L, I_0, R_s, R_sh, D2MuTau, Vbi, &V, &I);
+				if (explicitSolution)
+					P = maxpower_5par_lambertw(V_oc, a, I_L, I_0, R_s, R_sh, &V, &I);
+				else
+					P = maxpower_5par_rec(V_oc, a, I_L, I_0, R_s, R_sh, D2MuTau, Vbi, &V, &I);
 			}
 			else
 			{ // calculate power at specified operating voltage
 				V = opvoltage;
 
 				if (V >= V_oc) I = 0;
+				else if (explicitSolution) I = current_5par_lambertw(V, a, I_L, I_0, R_s, R_sh);
 				else I = current_5par_rec(V, 0.9*I_L, a, I_L, I_0, R_s, R_sh, D2MuTau, Vbi);
 				P = V*I;
 			}
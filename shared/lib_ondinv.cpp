@@ -54,6 +54,7 @@
 
 #include <math.h>
 #include <cmath>
+#include <algorithm>
 #include <limits>
 #include <vector>
 #include <stdexcept>
@@ -64,6 +65,8 @@
 
 
 const int TEMP_DERATE_ARRAY_LENGTH = 6;
+// Points tabulated on each efficiency spline, which keeps linear interpolation within 5e-7 of the spline relative to the efficiency
+const int EFF_TABLE_POINTS = 2048;
 // test commit
 
 ond_inverter::ond_inverter()
@@ -75,6 +78,7 @@ ond_inverter::ond_inverter()
 	NbInputs = NbMPPT = 0;
 	ondIsInitialized = false;
 	doAllowOverpower = doUseTemperatureLimit = true;
+	m_effTableStep[0] = m_effTableStep[1] = m_effTableStep[2] = 0;
 }
 
 // Initialize - Calculates values that only need calculation once
@@ -296,12 +300,35 @@ void ond_inverter::initializeManual()
 			}
 			m_bspline3[j] = BSpline::Builder(samples).degree(3).build();
 
+			// tabulate the spline, whose evaluation allocates, for calcEfficiency
+			m_effTable[j].resize(EFF_TABLE_POINTS);
+			m_effTableStep[j] = (x_max[j] - x_lim[j]) / (EFF_TABLE_POINTS - 1);
+			for (int k = 0; k < EFF_TABLE_POINTS; k++)
+				m_effTable[j][k] = calcEfficiencySpline(x_lim[j] + k * m_effTableStep[j], j);
 		}
 		ondIsInitialized = true;
 	}
 }
 
 double ond_inverter::calcEfficiency(double Pdc, int index_eta) {
+	if (Pdc > x_max[index_eta])
+	{
+		Pdc = x_max[index_eta];
+	}
+	if (Pdc <= 0) {
+		return 0;
+	}
+	else if (Pdc >= x_lim[index_eta] && m_effTableStep[index_eta] > 0)
+	{
+		const std::vector<double> &table = m_effTable[index_eta];
+		double x = (Pdc - x_lim[index_eta]) / m_effTableStep[index_eta];
+		size_t k = std::min((size_t)x, table.size() - 2);
+		return table[k] + (x - k) * (table[k + 1] - table[k]);
+	}
+	return calcEfficiencySpline(Pdc, index_eta);
+}
+
+double ond_inverter::calcEfficiencySpline(double Pdc, int index_eta) {
 	double eta;
 //	int splineIndex;
 	DenseVector x(1);
@@ -90,10 +90,16 @@ public:
 		double *dcloss,		/* DC power loss (Wdc) */
 		double *acloss		/* AC power loss (Wac) */
 	);
+	// efficiency of one curve, interpolated in a table of the curve's spline built at initialization
 	double calcEfficiency(
 		double Pdc,
 		int index_eta
 	);
+	// efficiency of one curve evaluated on the spline itself
+	double calcEfficiencySpline(
+		double Pdc,
+		int index_eta
+	);
 	double tempDerateAC(
 		double arrayT[],
 		double arrayPAC[],
@@ -110,6 +116,8 @@ private:
 	BSpline m_bspline3[3];
 	double x_max[3];
 	double x_lim[3];
+	std::vector<double> m_effTable[3];
+	double m_effTableStep[3];
 	double Pdc_threshold;
 	double a[3];
 	double b[3];
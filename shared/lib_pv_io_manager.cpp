@@ -13,10 +13,6 @@ PVIOManager::PVIOManager(compute_module*  cm, std::string cmName)
 	std::unique_ptr<Simulation_IO> ptr2(new Simulation_IO(cm, *m_IrradianceIO));
 	m_SimulationIO = std::move(ptr2);
 
-	std::unique_ptr<ShadeDB8_mpp> shadeDatabase(new ShadeDB8_mpp());
-	m_shadeDatabase = std::move(shadeDatabase);
-	m_shadeDatabase->init();
-
 	std::unique_ptr<Inverter_IO> ptrInv(new Inverter_IO(cm, cmName));
 	m_InverterIO = std::move(ptrInv);
 
@@ -35,6 +31,13 @@ PVIOManager::PVIOManager(compute_module*  cm, std::string cmName)
 		}
 	}
 
+	// The partial shading database is shared by all runs in the process and only loaded when a subarray uses it
+	for (size_t nn = 0; nn < m_SubarraysIO.size(); nn++)
+		if (m_SubarraysIO[nn]->shadeCalculator.use_shade_db())
+			m_shadeDatabase = ShadeDB8_mpp::shared();
+	if (m_shadeDatabase && !m_shadeDatabase->get_error().empty())
+		throw exec_error(cmName, "failed to load the partial shading database: " + m_shadeDatabase->get_error());
+
 	// Aggregate Subarray outputs in different structure
 	std::unique_ptr<PVSystem_IO> pvSystem(new PVSystem_IO(cm, cmName, m_SimulationIO.get(), m_IrradianceIO.get(), getSubarrays(), m_InverterIO.get()));
 	m_PVSystemIO = std::move(pvSystem);
@@ -55,7 +58,7 @@ void PVIOManager::allocateOutputs(compute_module* cm)
 Irradiance_IO * PVIOManager::getIrradianceIO() { return m_IrradianceIO.get(); }
 compute_module * PVIOManager::getComputeModule() { return m_computeModule; }
 Subarray_IO * PVIOManager::getSubarrayIO(size_t subarrayNumber) { return m_SubarraysIO[subarrayNumber].get(); }
-ShadeDB8_mpp * PVIOManager::getShadeDatabase() { return m_shadeDatabase.get(); }
+const ShadeDB8_mpp * PVIOManager::getShadeDatabase() { return m_shadeDatabase.get(); }
 
 std::vector<Subarray_IO *> PVIOManager::getSubarrays()
 {
@@ -87,6 +90,9 @@ Simulation_IO::Simulation_IO(compute_module* cm, Irradiance_IO & IrradianceIO)
 	}
 	numberOfSteps = numberOfYears * numberOfWeatherFileRecords;
 	annualSimulation = IrradianceIO.weatherDataProvider->annualSimulation();
+
+	irradianceThreads = 1;
+	if (cm->is_assigned("irrad_threads")) irradianceThreads = cm->as_integer("irrad_threads");
 }
 
 Irradiance_IO::Irradiance_IO(compute_module* cm, std::string cmName)
@@ -102,7 +108,7 @@ Irradiance_IO::Irradiance_IO(compute_module* cm, std::string cmName)
 		if (weatherFile->has_message()) cm->log(weatherFile->message(), SSC_WARNING);
 	}
 	else if (cm->is_assigned("solar_resource_data")) {
-		weatherDataProvider = std::unique_ptr<weather_data_provider>(new weatherdata(cm->lookup("solar_resource_data")));
+		weatherDataProvider = std::unique_ptr<weather_data_provider>(new weatherdata(cm->lookup_const("solar_resource_data")));
 		if (weatherDataProvider->has_message()) cm->log(weatherDataProvider->message(), SSC_WARNING);
 	}
 	else {
@@ -371,7 +377,8 @@ Subarray_IO::Subarray_IO(compute_module* cm, std::string cmName, size_t subarray
 		selfShadingInputs.nmodx = cm->as_integer(prefix + "nmodx"); //same as above
 		selfShadingInputs.nstrx = selfShadingInputs.nmodx / nModulesPerString;
 		poa.nonlinearDCShadingDerate = 1;
-        selfShadingSkyDiffTable.init(tiltDegrees, groundCoverageRatio);
+        selfShadingSkyDiffTable.init(tiltDegrees, groundCoverageRatio, cm->as_boolean(prefix + "selfshade_table"));
+        bifacialTrackerTable = cm->as_boolean(prefix + "bifacial_table");
 
         if (trackMode == irrad::FIXED_TILT || trackMode == irrad::SEASONAL_TILT || (trackMode == irrad::SINGLE_AXIS))
 		{
@@ -722,6 +729,7 @@ PVSystem_IO::PVSystem_IO(compute_module* cm, std::string cmName, Simulation_IO *
 
 	//Subarray mismatch calculations
 	enableMismatchVoltageCalc = cm->as_boolean("enable_mismatch_vmax_calc");
+	mismatchSearch = cm->as_integer("mismatch_search");
 	if (enableMismatchVoltageCalc &&
 		Subarrays[0]->Module->modulePowerModel != MODULE_CEC_DATABASE &&
 		Subarrays[0]->Module->modulePowerModel != MODULE_CEC_USER_INPUT &&
@@ -25,6 +25,7 @@
 
 enum modulePowerModelList { MODULE_SIMPLE_EFFICIENCY, MODULE_CEC_DATABASE, MODULE_CEC_USER_INPUT, MODULE_SANDIA, MODULE_IEC61853, MODULE_PVYIELD };
 enum inverterTypeList { INVERTER_CEC_DATABASE, INVERTER_DATASHEET, INVERTER_PARTLOAD, INVERTER_COEFFICIENT_GEN, INVERTER_PVYIELD };
+enum mismatchSearchList { MISMATCH_SWEEP, MISMATCH_BRACKETED };
 
 /// Structure containing data relevent at the SimulationManager level
 struct Simulation_IO;
@@ -129,7 +130,7 @@ public:
 	PVSystem_IO * getPVSystemIO();
 
 	/// Get Shade Database
-	ShadeDB8_mpp * getShadeDatabase();
+	const ShadeDB8_mpp * getShadeDatabase();
 
 public:
 
@@ -141,7 +142,7 @@ public:
 	std::unique_ptr<PVSystem_IO> m_PVSystemIO;
 	std::unique_ptr<Inverter_IO> m_InverterIO;
 	std::vector<std::unique_ptr<Subarray_IO>> m_SubarraysIO;
-	std::unique_ptr<ShadeDB8_mpp> m_shadeDatabase;
+	std::shared_ptr<const ShadeDB8_mpp> m_shadeDatabase;
 	size_t nSubarrays;
 
 private:
@@ -229,6 +230,7 @@ struct Simulation_IO
 	flag useLifetimeOutput;
 	flag saveLifetimeVars;
 	flag annualSimulation; //flag to determine if the simulation is a normal, annual simulation with a single continuous year, or a non-annual/single timestep simulation
+	int irradianceThreads; //number of threads that calculate the irradiance on the subarrays, 0 for one per processor
 };
 
 /***
@@ -266,6 +268,7 @@ struct PVSystem_IO
 	flag clipMpptWindow;
 	std::vector<std::vector<int> > mpptMapping;	///< vector to hold the mapping between subarrays and mppt inputs
 	flag enableMismatchVoltageCalc;		///< Whether or not to compute mismatch between multiple subarrays attached to the same mppt input
+	int mismatchSearch;					///< How the mismatch calculation finds the maximum power string voltage, as defined in mismatchSearchList
 
 	std::vector<double> dcDegradationFactor;
 	std::vector<double> dcLifetimeLosses;
@@ -429,6 +432,8 @@ public:
     shading_factor_calculator shadeCalculator;        // The shading calculator model for self-shading
     flag subarrayEnableSnow;                          //a copy of the enableSnowModel flag has to exist in each subarray for setting up snow model inputs specific to each subarray
     pvsnowmodel snowModel;                            // A structure to store the geometry inputs for the snow model for this subarray- even though the snow model is system wide, its effect is subarray-dependent
+    bifacial_view_factors bifacialViewFactors;        // Rear-side view factors of the subarray geometry, tabulated by tilt for bifacial modules
+    flag bifacialTrackerTable;                        // Interpolate the rear-side view factors of a tracker between tabulated tilts instead of computing them each time step
 
 	/// Calculated plane-of-array (POA) irradiace for the subarray and related geometry
 	struct {
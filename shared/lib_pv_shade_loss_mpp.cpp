@@ -25,8 +25,11 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <algorithm>    // std::sort
 #include <math.h> // logarithm function
 #include <cstring> // memcpy
+#include <cstdio>
+#include <mutex>
 
 #include "lib_miniz.h" // decompression
+#include "lib_util.h" // mapped_file
 #include "DB8_vmpp_impp_uint8_bin.h" // char* of binary compressed file
 
 // define the following to use ssc message formatting 
@@ -38,7 +41,7 @@ typedef unsigned char uint8;
 typedef unsigned short uint16;
 typedef unsigned int uint;
 
-short ShadeDB8_mpp::get_vmpp(size_t i)
+short ShadeDB8_mpp::get_vmpp(size_t i) const
 {
 	if (i < 6045840) // uint16 check
 		return (short)((p_vmpp[2 * i + 1] << 8) | p_vmpp[2 * i]); 
@@ -46,7 +49,7 @@ short ShadeDB8_mpp::get_vmpp(size_t i)
 		return -1;
 };
 
-short ShadeDB8_mpp::get_impp(size_t i)
+short ShadeDB8_mpp::get_impp(size_t i) const
 { 
 	if (i < 6045840) // uint16 check
 		return (short)((p_impp[2 * i + 1] << 8) | p_impp[2 * i]); 
@@ -55,7 +58,7 @@ short ShadeDB8_mpp::get_impp(size_t i)
 };
 
 
-bool ShadeDB8_mpp::get_index(const size_t &N, const size_t &d, const  size_t &t, const size_t &S, const  db_type &DB_TYPE, size_t* ret_ndx)
+bool ShadeDB8_mpp::get_index(const size_t &N, const size_t &d, const  size_t &t, const size_t &S, const  db_type &DB_TYPE, size_t* ret_ndx) const
 {
 	bool ret_val = false;
 	//size_t ret_ndx=-1;
@@ -115,7 +118,7 @@ bool ShadeDB8_mpp::get_index(const size_t &N, const size_t &d, const  size_t &t,
 	return ret_val;
 }
 
-size_t ShadeDB8_mpp::n_choose_k(size_t n, size_t k)
+size_t ShadeDB8_mpp::n_choose_k(size_t n, size_t k) const
 {
 	if (k > n) return 0;
 	if (k * 2 > n) k = n - k;
@@ -129,7 +132,7 @@ size_t ShadeDB8_mpp::n_choose_k(size_t n, size_t k)
 	return result;
 }
 
-std::vector<double> ShadeDB8_mpp::get_vector(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE)
+std::vector<double> ShadeDB8_mpp::get_vector(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE) const
 {
 	std::vector<double> ret_vec;
 	size_t length = 0;
@@ -157,56 +160,127 @@ std::vector<double> ShadeDB8_mpp::get_vector(const size_t &N, const size_t &d, c
 	return ret_vec;
 }
 
+static const char sdb_magic[8] = { 'S', 'D', 'B', '8', 'M', 'P', 'P', '1' };
+
+// FNV-1a of the embedded compressed database, so that a cache written by a build with different data is not used
+static unsigned long long sdb_source_hash(const unsigned char *p, size_t n)
+{
+	unsigned long long h = 14695981039346656037ULL;
+	for (size_t i = 0; i < n; i++)
+	{
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
 void ShadeDB8_mpp::init()
+{
+	init(cache_file());
+}
+
+bool ShadeDB8_mpp::init(const std::string &cache)
 {
 	p_error_msg = "";
 	p_warning_msg = "";
 	p_vmpp_uint8_size = 12091680; // uint8 size from matlab
 	p_impp_uint8_size = 12091680; // uint8 size from matlab
-	p_vmpp = (unsigned char *)malloc(p_vmpp_uint8_size);//malloc(12091680); uint8 size
-	p_impp = (unsigned char *)malloc(p_impp_uint8_size);//malloc(12091680); uint8 size
 	p_compressed_size = 3133517; // from modified example5.c in miniz project
-	decompress_file_to_uint8();
-}
-
-ShadeDB8_mpp::~ShadeDB8_mpp()
-{
-	if (p_vmpp)
-		free(p_vmpp);
-	if (p_impp)
-		free(p_impp);
-}
 
+	if (!cache.empty() && load_cache(cache))
+		return true;
 
+	if (!decompress_file_to_uint8())
+		return false;
+	if (!cache.empty())
+		write_cache(cache);
+	return true;
+}
 
 bool ShadeDB8_mpp::decompress_file_to_uint8()
 {
 	size_t status;
-	uint8 *pTmp_data;
-
 	size_t mem_size = p_vmpp_uint8_size + p_impp_uint8_size;
 
-	pTmp_data = (uint8 *)malloc(mem_size);
-
-	status = tinfl_decompress_mem_to_mem((void *)pTmp_data, mem_size, pCmp_data, p_compressed_size, TINFL_FLAG_PARSE_ZLIB_HEADER);
+	std::shared_ptr<std::vector<uint8>> data = std::make_shared<std::vector<uint8>>(mem_size);
+	status = tinfl_decompress_mem_to_mem((void *)data->data(), mem_size, pCmp_data, p_compressed_size, TINFL_FLAG_PARSE_ZLIB_HEADER);
 
-	memcpy(p_vmpp, pTmp_data, p_vmpp_uint8_size);
-	memcpy(p_impp, pTmp_data + p_vmpp_uint8_size, p_impp_uint8_size);
-
-	free(pTmp_data);
+	p_vmpp = data->data();
+	p_impp = data->data() + p_vmpp_uint8_size;
+	p_data = data;
 
 	if (status == TINFL_DECOMPRESS_MEM_TO_MEM_FAILED)
 	{
 		std::stringstream outm;
 		outm << "tinfl_decompress_mem_to_mem() failed with status " << (int)status;
 		p_error_msg = outm.str();
-		return EXIT_FAILURE;
+		return false;
 	}
 
 	return true;
 };
 
-double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<double> &shade_frac, bool use_pv_cell_temp, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi)
+bool ShadeDB8_mpp::load_cache(const std::string &file)
+{
+	size_t header_size = sizeof(sdb_magic) + sizeof(unsigned long long);
+	std::shared_ptr<util::mapped_file> map = std::make_shared<util::mapped_file>(file);
+	if (!map->ok() || map->size() != header_size + p_vmpp_uint8_size + p_impp_uint8_size)
+		return false;
+
+	unsigned long long hash;
+	memcpy(&hash, map->data() + sizeof(sdb_magic), sizeof(hash));
+	if (memcmp(map->data(), sdb_magic, sizeof(sdb_magic)) != 0
+		|| hash != sdb_source_hash(pCmp_data, p_compressed_size))
+		return false;
+
+	p_vmpp = (const uint8 *)map->data() + header_size;
+	p_impp = p_vmpp + p_vmpp_uint8_size;
+	p_data = map;
+	return true;
+}
+
+bool ShadeDB8_mpp::write_cache(const std::string &file) const
+{
+	unsigned long long hash = sdb_source_hash(pCmp_data, p_compressed_size);
+	return util::write_file_atomic(file, [&](FILE *fp) {
+		return fwrite(sdb_magic, sizeof(sdb_magic), 1, fp) == 1
+			&& fwrite(&hash, sizeof(hash), 1, fp) == 1
+			&& fwrite(p_vmpp, 1, p_vmpp_uint8_size, fp) == p_vmpp_uint8_size
+			&& fwrite(p_impp, 1, p_impp_uint8_size, fp) == p_impp_uint8_size;
+	});
+}
+
+static std::mutex s_shared_lock;
+static std::shared_ptr<const ShadeDB8_mpp> s_shared_db;
+static std::string s_cache_file;
+
+std::shared_ptr<const ShadeDB8_mpp> ShadeDB8_mpp::shared()
+{
+	// held while decompressing so that simultaneous first callers wait for one copy
+	std::lock_guard<std::mutex> lock(s_shared_lock);
+	if (!s_shared_db)
+	{
+		std::shared_ptr<ShadeDB8_mpp> db = std::make_shared<ShadeDB8_mpp>();
+		if (!db->init(s_cache_file))
+			return db; // not kept, so the caller sees get_error() and the next caller tries again
+		s_shared_db = db;
+	}
+	return s_shared_db;
+}
+
+void ShadeDB8_mpp::set_cache_file(const std::string &file)
+{
+	std::lock_guard<std::mutex> lock(s_shared_lock);
+	s_cache_file = file;
+}
+
+std::string ShadeDB8_mpp::cache_file()
+{
+	std::lock_guard<std::mutex> lock(s_shared_lock);
+	return s_cache_file;
+}
+
+double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<double> &shade_frac, bool use_pv_cell_temp, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi) const
 {
 	double shade_loss = 0;
 	// shading fractions for each string
@@ -29,9 +29,11 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 #include <stdlib.h>
 #include <string>
+#include <memory>
 
 extern const unsigned char pCmp_data[3133517];
 // shading database with up to 8 strings
+// lookups are const and may be made from several threads on one instance once init() has returned
 class ShadeDB8_mpp
 {
 public:
@@ -40,33 +42,44 @@ public:
 		p_vmpp = NULL;
 		p_impp=NULL ;
 	};
-	~ShadeDB8_mpp();
 	void init();
-	short vmpp(size_t ndx){
+	short vmpp(size_t ndx) const {
 		return get_vmpp(ndx);
 	};
-	short impp(size_t ndx){
+	short impp(size_t ndx) const {
 		return get_impp(ndx);
 	};
-	std::vector<double> get_vector(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE);
-	size_t n_choose_k(size_t n, size_t k);
-	bool get_index(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE, size_t* ret_ndx);
+	std::vector<double> get_vector(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE) const;
+	size_t n_choose_k(size_t n, size_t k) const;
+	bool get_index(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE, size_t* ret_ndx) const;
 
-	double get_shade_loss(double &gpoa, double &dpoa, std::vector<double> &shade_frac, bool use_pv_cell_temp = false, double pv_cell_temp = 0, int mods_per_str = 0, double str_vmp_stc = 0, double mppt_lo = 0, double mppt_hi = 0);
-	std::string get_warning() { return p_warning_msg; }
-	std::string get_error() { return p_error_msg; }
+	double get_shade_loss(double &gpoa, double &dpoa, std::vector<double> &shade_frac, bool use_pv_cell_temp = false, double pv_cell_temp = 0, int mods_per_str = 0, double str_vmp_stc = 0, double mppt_lo = 0, double mppt_hi = 0) const;
+	std::string get_warning() const { return p_warning_msg; }
+	std::string get_error() const { return p_error_msg; }
 
+	// process-wide database, initialized on first use and kept for the life of the process once it
+	// has loaded. If loading fails the instance returned holds the error and is not kept.
+	static std::shared_ptr<const ShadeDB8_mpp> shared();
+
+	// uncompressed copy of the database that init() memory-maps instead of decompressing,
+	// written by the first init() that has to decompress. Empty (the default) turns the cache off.
+	static void set_cache_file(const std::string &file);
+	static std::string cache_file();
 
 private:
-	unsigned char *p_vmpp;
-	unsigned char *p_impp;
-	short get_vmpp(size_t i);
-	short get_impp(size_t i);
+	const unsigned char *p_vmpp;
+	const unsigned char *p_impp;
+	std::shared_ptr<void> p_data; // owns the memory p_vmpp and p_impp point into
+	short get_vmpp(size_t i) const;
+	short get_impp(size_t i) const;
+	bool init(const std::string &cache);
 	bool decompress_file_to_uint8();
+	bool load_cache(const std::string &file);
+	bool write_cache(const std::string &file) const;
 	size_t p_vmpp_uint8_size;
 	size_t p_impp_uint8_size;
 	size_t p_compressed_size;
-	std::string p_warning_msg;
+	mutable std::string p_warning_msg; // only written by SHADE_DB_DEBUG builds, which are not reentrant
 	std::string p_error_msg;
 };
 
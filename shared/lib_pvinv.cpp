@@ -46,13 +46,8 @@ bool partload_inverter_t::acpower(
 	double *Pntloss /* Power loss due to night time tare loss (Wac) */
 )
 {
-	//pass through inputs to the multiple MPPT function as an array with only one entry
-	std::vector<double> Pdc_vec;
-	Pdc_vec.push_back(Pdc);
-	if (!acpower(Pdc_vec, Pac, Ppar, Plr, Eff, Pcliploss, Pntloss))
-		return false;
-
-	return true;
+	//same as the multiple MPPT function with one entry, without building a vector for it
+	return acpower_total(Pdc, Pac, Ppar, Plr, Eff, Pcliploss, Pntloss);
 }
 
 bool partload_inverter_t::acpower(
@@ -71,6 +66,11 @@ bool partload_inverter_t::acpower(
 	double Pdc_total = 0;
 	for (size_t m = 0; m < Pdc.size(); m++)
 		Pdc_total += Pdc[m];
+	return acpower_total(Pdc_total, Pac, Ppar, Plr, Eff, Pcliploss, Pntloss);
+}
+
+bool partload_inverter_t::acpower_total(double Pdc_total, double *Pac, double *Ppar, double *Plr, double *Eff, double *Pcliploss, double *Pntloss)
+{
 	if ( Pdco <= 0 ) return false;
 
 	// handle limits - can send error back or record out of range values
@@ -146,5 +146,33 @@ bool partload_inverter_t::acpower(
 	return true;
 }
 
+double partload_inverter_t::dcpower( double Pac )
+{
+	int n = (int)Partload.size();
+	if (Pac > Paco) Pac = Paco;
+	if (Pac <= 0 || Pdco <= 0 || n < 2 || Partload[n - 1] <= Partload[0]) return -1;
 
-
+	// on each segment of the curve the efficiency is linear in Pdc, so Pac = q * Pdc^2 + l * Pdc.
+	// Below the first point the efficiency is constant and the last segment extends past the end.
+	for (int k = -1; k < n - 1; k++)
+	{
+		double q = 0, l = Efficiency[0] / 100.0;
+		if (k >= 0)
+		{
+			double slope = (Efficiency[k + 1] - Efficiency[k]) / (Partload[k + 1] - Partload[k]);
+			q = slope / Pdco;
+			l = (Efficiency[k] - slope * Partload[k]) / 100.0;
+		}
+		double disc = l * l + 4 * q * Pac;
+		if (disc < 0 || l + sqrt(disc) <= 0) continue;
+		double Pdc = 2 * Pac / (l + sqrt(disc));
+
+		// take the first segment that contains its root, which is the smallest DC power producing Pac
+		double x = 100.0 * Pdc / Pdco;
+		double lo = (k < 0) ? -std::numeric_limits<double>::infinity() : Partload[k];
+		double hi = (k + 1 >= n - 1) ? std::numeric_limits<double>::infinity() : Partload[k + 1];
+		if (x >= lo * (1 - 1e-12) && x <= hi * (1 + 1e-12))
+			return Pdc;
+	}
+	return -1;
+}
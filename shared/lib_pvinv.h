@@ -68,6 +68,12 @@ public:
 		double *Pntloss /* Power loss due to night time tare loss (Wac) */
 		);
 
+	// DC power (Wdc) at which the inverter produces Pac (Wac), solving the quadratic on each segment of the curve.
+	// Pac above Paco gives the DC power where clipping starts; returns -1 when Pac cannot be reached
+	double dcpower( double Pac );
+
+private:
+	bool acpower_total(double Pdc_total, double *Pac, double *Ppar, double *Plr, double *Eff, double *Pcliploss, double *Pntloss);
 } ;
 
 #endif
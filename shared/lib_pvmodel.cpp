@@ -22,6 +22,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "lib_pvmodel.h"
 #include <math.h>
+#include <cmath>
 #include <limits>
 #include <iostream>
 
@@ -439,6 +440,163 @@ double maxpower_5par( double Voc_ubound, double a, double Il, double Io, double
 	return P;
 }
 
+double lambertw_exp( double logx )
+{
+/*
+	Principal branch of the Lambert W function at x = exp(logx), i.e. the solution of
+	w + ln(w) = logx.  Working in the log domain keeps the single-diode arguments, which
+	routinely exceed the range of exp(), finite.
+*/
+	if ( logx < -20 )
+	{
+		double x = exp(logx);
+		return x*(1-x);
+	}
+
+	double w;
+	if ( logx < 0 )
+	{
+		// Pade approximant about x = 0 as the starting guess
+		double x = exp(logx);
+		w = x*(1 + 4*x/3)/(1 + 7*x/3 + 5*x*x/6);
+	}
+	else
+	{
+		// Winitzki's approximation as the starting guess, with ln(1+x) ~ logx for large x
+		double l1 = logx > 36 ? logx : log1p(exp(logx));
+		w = l1*(1 - log1p(l1)/(2+l1));
+	}
+
+	// Fritsch iteration, which converges with fourth order: once a step is below 1e-5 of w,
+	// the remaining error is below double precision
+	for ( int it = 0; it < 4; it++ )
+	{
+		double z = logx - log(w) - w;
+		double q = 2*(1+w)*(1+w+2*z/3);
+		double dw = w*z/(1+w)*(q-z)/(q-2*z);
+		w += dw;
+		if ( fabs(dw) < 1e-5*w )
+			break;
+	}
+	return w;
+}
+
+static bool lambertw_applies( double a, double IL, double IO, double RS, double RSH )
+{
+	return a > 0 && IO > 0 && IL >= 0 && RS >= 0 && RSH > 0 && std::isfinite(RSH);
+}
+
+/*
+	Explicit current of the five-parameter model at one operating condition, with its first two
+	derivatives with respect to voltage:
+		I = (IL + IO - V/RSH)/g - (a/RS) W(theta),  theta = RS IO/(a g) exp((V + RS (IL + IO))/(a g)),  g = 1 + RS/RSH
+	which reduces to the diode equation itself when RS = 0.
+*/
+class singlediode_lambertw
+{
+	double a, IL, IO, RS, RSH, g, logprefactor;
+public:
+	singlediode_lambertw( double a_, double IL_, double IO_, double RS_, double RSH_ )
+		: a(a_), IL(IL_), IO(IO_), RS(RS_), RSH(RSH_), g(1 + RS_/RSH_), logprefactor(0)
+	{
+		if ( RS > 0 )
+			logprefactor = log(RS*IO/(a*g)) + RS*(IL+IO)/(a*g);
+	}
+
+	double current( double V, double *dIdV = 0, double *d2IdV2 = 0 ) const
+	{
+		if ( RS == 0 )
+		{
+			double e = IO*exp(V/a);
+			if ( dIdV ) *dIdV = -e/a - 1/RSH;
+			if ( d2IdV2 ) *d2IdV2 = -e/(a*a);
+			return IL - (e - IO) - V/RSH;
+		}
+
+		double w = lambertw_exp( logprefactor + V/(a*g) );
+		if ( dIdV ) *dIdV = -1/(RSH*g) - w/((1+w)*RS*g);
+		if ( d2IdV2 ) *d2IdV2 = -w/((1+w)*(1+w)*(1+w)*RS*a*g*g);
+		return (IL + IO - V/RSH)/g - a/RS*w;
+	}
+};
+
+double current_5par_lambertw( double V, double a, double IL, double IO, double RS, double RSH )
+{
+	if ( !lambertw_applies( a, IL, IO, RS, RSH ) )
+		return current_5par( V, 0.9*IL, a, IL, IO, RS, RSH );
+
+	return max( 0.0, singlediode_lambertw( a, IL, IO, RS, RSH ).current( V ) );
+}
+
+void current_5par_lambertw( size_t n, const double *V, double *I, double a, double IL, double IO, double RS, double RSH )
+{
+	if ( !lambertw_applies( a, IL, IO, RS, RSH ) )
+	{
+		for ( size_t i = 0; i < n; i++ )
+			I[i] = current_5par( V[i], 0.9*IL, a, IL, IO, RS, RSH );
+		return;
+	}
+
+	singlediode_lambertw diode( a, IL, IO, RS, RSH );
+	for ( size_t i = 0; i < n; i++ )
+		I[i] = max( 0.0, diode.current( V[i] ) );
+}
+
+void current_5par_lambertw( size_t n, const double *V, double *I, const double *a, const double *IL, const double *IO, const double *RS, const double *RSH )
+{
+	for ( size_t i = 0; i < n; i++ )
+		I[i] = current_5par_lambertw( V[i], a[i], IL[i], IO[i], RS[i], RSH[i] );
+}
+
+double openvoltage_5par_lambertw( double Voc0, double a, double IL, double IO, double Rsh )
+{
+	if ( !lambertw_applies( a, IL, IO, 0, Rsh ) )
+		return openvoltage_5par( Voc0, a, IL, IO, Rsh );
+
+	// Voc = (IL + IO) Rsh - a W(theta), theta = IO Rsh/a exp((IL + IO) Rsh/a).  Since W + ln(W) = ln(theta),
+	// this is a ln(a W/(IO Rsh)), which avoids subtracting two large terms when Rsh is large.
+	double logc = log(IO*Rsh/a);
+	double w = lambertw_exp( logc + (IL+IO)*Rsh/a );
+	return a*(log(w) - logc);
+}
+
+double maxpower_5par_lambertw( double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double *__Vmp, double *__Imp )
+{
+	if ( !lambertw_applies( a, Il, Io, Rs, Rsh ) || Voc_ubound <= 0 )
+		return maxpower_5par( Voc_ubound, a, Il, Io, Rs, Rsh, __Vmp, __Imp );
+
+/*
+	Power is strictly concave in voltage below open circuit, so Newton's method on dP/dV = I + V dI/dV
+	converges quadratically to the maximum.  Steps leaving the bracket fall back to bisection.
+*/
+	singlediode_lambertw diode( a, Il, Io, Rs, Rsh );
+	double lo = 0, hi = Voc_ubound;
+	double V = Voc_ubound - a*log(1 + Voc_ubound/a); // maximum power voltage of an ideal diode
+	double I = 0;
+	for ( int it = 0; it < 100; it++ )
+	{
+		double dI, d2I;
+		I = diode.current( V, &dI, &d2I );
+		double dP = I + V*dI;
+		if ( dP > 0 ) lo = V;
+		else hi = V;
+
+		double Vnew = V - dP/(2*dI + V*d2I);
+		if ( !(Vnew > lo && Vnew < hi) )
+			Vnew = (lo + hi)/2;
+
+		bool converged = fabs(Vnew - V) < 1e-9*Voc_ubound;
+		V = Vnew;
+		if ( converged )
+			break;
+	}
+	I = max( 0.0, diode.current( V ) );
+
+	if ( __Vmp ) *__Vmp = V;
+	if ( __Imp ) *__Imp = I;
+	return V*I;
+}
+
 double maxpower_5par_rec( double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double D2MuTau, double Vbi, double *__Vmp, double *__Imp )
 {
 	double P, V, I;
@@ -147,6 +147,21 @@ double openvoltage_5par( double Voc0, double a, double IL, double IO, double Rsh
 double openvoltage_5par_rec(double Voc0, double a, double IL, double IO, double Rsh, double D2MuTau, double Vbi);
 double maxpower_5par( double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double *Vmp=0, double *Imp=0);
 double maxpower_5par_rec(double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double D2MuTau, double Vbi, double *__Vmp=0, double *__Imp=0);
+
+/*
+	Explicit single-diode solutions using the Lambert W function.  They agree with the iterative
+	solvers above to within the latter's convergence tolerance at a fraction of the cost, and fall
+	back to them for parameters outside the physical range the explicit form requires.
+	The array forms of current_5par_lambertw evaluate n voltages at one operating condition, or n points
+	that each have their own voltage and parameters, such as a time series of irradiance and cell temperature.
+*/
+double lambertw_exp( double logx );
+double current_5par_lambertw( double V, double a, double IL, double IO, double RS, double RSH );
+void current_5par_lambertw( size_t n, const double *V, double *I, double a, double IL, double IO, double RS, double RSH );
+void current_5par_lambertw( size_t n, const double *V, double *I, const double *a, const double *IL, const double *IO, const double *RS, const double *RSH );
+double openvoltage_5par_lambertw( double Voc0, double a, double IL, double IO, double Rsh );
+double maxpower_5par_lambertw( double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double *Vmp=0, double *Imp=0);
+
 double air_mass_modifier( double Zenith_deg, double Elev_m, double a[5] );
 
 
@@ -60,21 +60,33 @@ struct ssoutputs	// self-shading outputs
 
 // look up table for calculating the diffuse reduction due to gcr and tilt of the panels for self-shading
 // added to removing duplicate computations for speed up (https://github.com/NREL/ssc/issues/384)
+// with interpolation on, derates come from a grid over tilt and ground coverage ratio that is computed once per process
 class sssky_diffuse_table
 {
     std::unordered_map<std::string, double> derates_table;      // stores pairs of surface tilts and derates
     double gcr;                                                 // 0.01 - 0.99
+    bool interpolate;                                           // look up derates in the precomputed grid
 
     double compute(double surface_tilt);
 
 public:
-    sssky_diffuse_table(): gcr(0) {}
+    sssky_diffuse_table(): gcr(0), interpolate(false) {}
 
     // initialize with the ground coverage ratio (fixed per PV simulation) and the starting tilt
-    void init(double surface_tilt, double groundCoverageRatio) { gcr = groundCoverageRatio; compute(surface_tilt); }
+    void init(double surface_tilt, double groundCoverageRatio, bool interpolated = false) {
+        gcr = groundCoverageRatio;
+        interpolate = interpolated;
+        if (!interpolate) compute(surface_tilt);
+    }
 
     // return the sky diffuse derate for the panel at given surface_tilt
     double lookup(double surface_tilt);
+
+    // sky diffuse derate integrated over the shaded part of the row, without the table
+    static double integrate(double surface_tilt, double groundCoverageRatio);
+
+    // sky diffuse derate interpolated bilinearly from the precomputed grid, or -1 if outside it
+    static double interpolated(double surface_tilt, double groundCoverageRatio);
 };
 
 
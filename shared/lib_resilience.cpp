@@ -43,6 +43,13 @@ dispatch_resilience::dispatch_resilience(const dispatch_t &orig, size_t start_in
     m_batteryPower->stateOfChargeMax = 100;
 }
 
+void dispatch_resilience::start_outage(const dispatch_t &orig, size_t start_index) {
+    orig.battery_model()->checkpoint(*_Battery);
+    start_outage_index = start_index;
+    current_outage_index = start_index;
+    met_loads_kw = 0;
+}
+
 dispatch_resilience::~dispatch_resilience() {
 	delete_clone();
 	_Battery_initial = nullptr;
@@ -74,14 +81,14 @@ bool dispatch_resilience::run_outage_step_ac(double crit_load_kwac, double pv_kw
             double discharge_kwdc = required_kwdc;
 
             // iterate in case the dispatched power is slightly less (by tolerance) than required
-            auto Battery_initial = _Battery->get_state();
+            _Battery->checkpoint(step_initial);
             double battery_dispatched_kwdc = dispatch_kw(discharge_kwdc);
             if (fabs(battery_dispatched_kwdc - required_kwdc) > tolerance) {
                 while (discharge_kwdc < max_discharge_kwdc) {
                     if (battery_dispatched_kwdc - required_kwdc > tolerance)
                         break;
                     discharge_kwdc *= 1.01;
-                    _Battery->set_state(Battery_initial);
+                    _Battery->rollback(step_initial);
                     battery_dispatched_kwdc = dispatch_kw(discharge_kwdc);
                 }
             }
@@ -133,7 +140,7 @@ bool dispatch_resilience::run_outage_step_dc(double crit_load_kwac, double pv_kw
 
             // iterate in case the dispatched power is slightly less (by tolerance) than required
             double discharge_kwdc = required_kwdc;
-            auto Battery_initial = _Battery->get_state();
+            _Battery->checkpoint(step_initial);
 
             battery_dispatched_kwdc = dispatch_kw(discharge_kwdc);
             inverter->calculateACPower(battery_dispatched_kwdc * dc_dc_eff, V_pv, tdry);
@@ -143,7 +150,7 @@ bool dispatch_resilience::run_outage_step_dc(double crit_load_kwac, double pv_kw
                     if (battery_dispatched_kwac - required_kwac > tolerance)
                         break;
                     discharge_kwdc *= 1.01;
-                    _Battery->set_state(Battery_initial);
+                    _Battery->rollback(step_initial);
                     battery_dispatched_kwdc = dispatch_kw(discharge_kwdc);
                     inverter->calculateACPower(battery_dispatched_kwdc * dc_dc_eff, V_pv, tdry);
                     battery_dispatched_kwac = inverter->powerAC_kW;
@@ -193,10 +200,20 @@ resilience_runner::resilience_runner(const std::shared_ptr<battstor>& battery)
 }
 
 void resilience_runner::add_battery_at_outage_timestep(const dispatch_t& orig, size_t index){
-    if (battery_per_outage_start.find(index) != battery_per_outage_start.end())
+    if (battery_per_outage_start.find(index) != battery_per_outage_start.end()) {
         logs.emplace_back(
                 "Replacing battery which already existed at index " + to_string(index) + ".");
-    battery_per_outage_start.insert({index, std::make_shared<dispatch_resilience>(orig, index)});
+        return;
+    }
+    std::shared_ptr<dispatch_resilience> batt_system;
+    if (depleted_batteries.empty())
+        batt_system = std::make_shared<dispatch_resilience>(orig, index);
+    else {
+        batt_system = depleted_batteries.back();
+        depleted_batteries.pop_back();
+        batt_system->start_outage(orig, index);
+    }
+    battery_per_outage_start.insert({index, batt_system});
 }
 
 void resilience_runner::run_surviving_batteries(double crit_loads_kwac, double pv_kwac, double pv_kwdc, double V,
@@ -225,6 +242,7 @@ void resilience_runner::run_surviving_batteries(double crit_loads_kwac, double p
         auto b = battery_per_outage_start[i];
         indices_survived[i] = b->get_indices_survived();
         total_load_met[i] = b->get_met_loads();
+        depleted_batteries.emplace_back(b);
         battery_per_outage_start.erase(i);
     }
 }
@@ -242,6 +260,7 @@ void resilience_runner::run_surviving_batteries_by_looping(double* crit_loads_kw
             run_surviving_batteries(crit_loads_kwac[i % nrec], pv_kwac[i]);
         i++;
     }
+    depleted_batteries.clear();
 
     if (battery_per_outage_start.empty())
         return;
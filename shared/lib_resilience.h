@@ -55,6 +55,9 @@ public:
     /// Construct from fully-initialized dispatch_t
     dispatch_resilience(const dispatch_t &orig, size_t start_index);
 
+    /// Restart for an outage beginning at start_index from the battery state of orig, reusing this instance's models
+    void start_outage(const dispatch_t &orig, size_t start_index);
+
 	/// Delete battery and battery initial
 	~dispatch_resilience();
 
@@ -78,6 +81,9 @@ protected:
     size_t current_outage_index;
     double met_loads_kw;
 
+    /// battery state restored between attempts at meeting the load within a time step
+    battery_state step_initial;
+
     /// valid inverter required for DC-connected batteries
     std::unique_ptr<SharedInverter> inverter;
 
@@ -130,6 +136,9 @@ private:
     /// Outage simulations mapped by the index at which the outage started
     std::map<size_t, std::shared_ptr<dispatch_resilience>> battery_per_outage_start;
 
+    /// Depleted outage simulations, restarted by later outages instead of copying the dispatch and battery models again
+    std::vector<std::shared_ptr<dispatch_resilience>> depleted_batteries;
+
     /// i-th entry is the number of time steps survived for an outage starting at time step i
     std::vector<size_t> indices_survived;
 
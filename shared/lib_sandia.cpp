@@ -366,13 +366,10 @@ bool sandia_inverter_t::acpower(
 	double *Pntloss /* Power loss due to night time tare loss (Wac) */
 )
 {
-	//pass through inputs to the multiple MPPT function as an array with only one entry
-	std::vector<double> Pdc_vec, Vdc_vec;
-	Pdc_vec.push_back(Pdc);
-	Vdc_vec.push_back(Vdc);
-	if (!acpower(Pdc_vec, Vdc_vec, Pac, Ppar, Plr, Eff, Pcliploss, Psoloss, Pntloss))
-		return false;
-
+	//same as the multiple MPPT function with one entry, without building vectors for it
+	double Pac_one, PacNoPso_one;
+	acpower_input(Pdc, Vdc, &Pac_one, &PacNoPso_one);
+	acpower_total(Pdc, Pac_one, PacNoPso_one - Pac_one, Pac, Ppar, Plr, Eff, Pcliploss, Psoloss, Pntloss);
 	return true;
 }
 
@@ -391,36 +388,49 @@ bool sandia_inverter_t::acpower(
 	double *Pntloss /* Power loss due to night time tare loss (Wac) */
 	)
 {
-	//initialize values
-	*Pac = 0;
-	*Ppar = 0.0;
-	*Psoloss = 0.0; // Power consumption during operation
-	*Pntloss = 0.0;
-	*Pcliploss = 0.0;
 	double Pdc_total = 0;
-	std::vector<double> Pac_each;
-	std::vector<double> PacNoPso_each;
+	double Pac_sum = 0;
+	double Psoloss_sum = 0;
 
 	//loop through each MPPT input
 	for (size_t m = 0; m < Pdc.size(); m++) 
 	{
-		Pac_each.push_back(0);
-		PacNoPso_each.push_back(0);
+		double Pac_each, PacNoPso_each;
+		acpower_input(Pdc[m], Vdc[m], &Pac_each, &PacNoPso_each);
+		Psoloss_sum += PacNoPso_each - Pac_each;
+		Pac_sum += Pac_each;
+		Pdc_total += Pdc[m];
+	}
 
-		double A = Pdco * (1.0 + C1 * (Vdc[m] - Vdco));
-		double B = Pso * (1.0 + C2 * (Vdc[m] - Vdco));
-		double C = C0 * (1.0 + C3 * (Vdc[m] - Vdco));
+	acpower_total(Pdc_total, Pac_sum, Psoloss_sum, Pac, Ppar, Plr, Eff, Pcliploss, Psoloss, Pntloss);
+	return true;
+}
 
-		// crummy kludge to make sure B parameter has a resonable value (not negative!!)
-		// even for inverters with weird input ranges and power levels, i.e. LeadSolar LS700
-		// assumption is that Pso can't be less than half or more than double its nominal value
-		if (B < 0.5 * Pso) B = 0.5 * Pso;
-		if (B > 2.0 * Pso) B = 2.0 * Pso;
+void sandia_inverter_t::acpower_input( double Pdc, double Vdc, double *Pac, double *PacNoPso )
+{
+	double A = Pdco * (1.0 + C1 * (Vdc - Vdco));
+	double B = Pso * (1.0 + C2 * (Vdc - Vdco));
+	double C = C0 * (1.0 + C3 * (Vdc - Vdco));
+
+	// crummy kludge to make sure B parameter has a resonable value (not negative!!)
+	// even for inverters with weird input ranges and power levels, i.e. LeadSolar LS700
+	// assumption is that Pso can't be less than half or more than double its nominal value
+	if (B < 0.5 * Pso) B = 0.5 * Pso;
+	if (B > 2.0 * Pso) B = 2.0 * Pso;
+
+	*Pac = ((Paco / (A - B)) - C * (A - B)) * (Pdc - B) + C0 * (Pdc - B) * (Pdc - B); //calculate Pac for this MPPT input
+	*PacNoPso = ((Paco / A) - C * A) * Pdc + C0 * Pdc * Pdc; //calculate Pac without operating losses (Pso = 0) to store as Pso losses later
+}
 
-		Pac_each[m] = ((Paco / (A - B)) - C * (A - B)) * (Pdc[m] - B) + C0 * (Pdc[m] - B) * (Pdc[m] - B); //calculate Pac for this MPPT input and save it
-		PacNoPso_each[m] = ((Paco / A) - C * A) * Pdc[m] + C0 * Pdc[m] * Pdc[m]; //calculate Pac without operating losses (Pso = 0) for each MPPT input to store as Pso losses later
-		Pdc_total += Pdc[m];
-	}
+void sandia_inverter_t::acpower_total( double Pdc_total, double Pac_sum, double Psoloss_sum,
+	double *Pac, double *Ppar, double *Plr, double *Eff, double *Pcliploss, double *Psoloss, double *Pntloss )
+{
+	//initialize values
+	*Pac = 0;
+	*Ppar = 0.0;
+	*Psoloss = 0.0; // Power consumption during operation
+	*Pntloss = 0.0;
+	*Pcliploss = 0.0;
 
 	// night time: power is equal to nighttime power loss (note that if PacNoPso > Pso and Pac < Pso then the night time loss could be considered an operating power loss)
 	if (Pdc_total <= Pso)
@@ -431,11 +441,10 @@ bool sandia_inverter_t::acpower(
 	}
 	// day time: calculate total Pac; power loss is the Pso loss, use values calculated above
 	else
-		for (size_t m = 0; m < Vdc.size(); m++)
-		{
-			*Psoloss += PacNoPso_each[m] - Pac_each[m];
-			*Pac += Pac_each[m];
-		}
+	{
+		*Psoloss = Psoloss_sum;
+		*Pac = Pac_sum;
+	}
 	
 	// clipping loss Wac (note that the Pso=0 may have no clipping)
 	double PacNoClip = *Pac;
@@ -448,8 +457,28 @@ bool sandia_inverter_t::acpower(
 	*Plr = Pdc_total / Pdco;
 	*Eff = *Pac / Pdc_total;
 	if ( *Eff < 0.0 ) *Eff = 0.0;
+}
 
-	return true;
+double sandia_inverter_t::dcpower( double Pac, double Vdc )
+{
+	if (Pac > Paco) Pac = Paco;
+	if (Pac <= 0) return -1;
+
+	double A = Pdco * (1.0 + C1 * (Vdc - Vdco));
+	double B = Pso * (1.0 + C2 * (Vdc - Vdco));
+	double C = C0 * (1.0 + C3 * (Vdc - Vdco));
+	if (B < 0.5 * Pso) B = 0.5 * Pso;
+	if (B > 2.0 * Pso) B = 2.0 * Pso;
+
+	// Pac = lin * u + C0 * u^2 with u = Pdc - B; take the smaller positive root, in a form that is stable as C0 goes to zero
+	double lin = (Paco / (A - B)) - C * (A - B);
+	double disc = lin * lin + 4 * C0 * Pac;
+	if (disc < 0 || lin + sqrt(disc) <= 0) return -1;
+	double Pdc = B + 2 * Pac / (lin + sqrt(disc));
+
+	// below Pso the inverter is off
+	if (Pdc <= Pso) return -1;
+	return Pdc;
 }
 
 
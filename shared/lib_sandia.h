@@ -129,6 +129,16 @@ public:
 		double *Pntloss /* Power loss due to night time tare loss (Wac) */
 	);
 
+	// DC power (Wdc) at which a single MPPT input produces Pac (Wac), solving the quadratic in acpower.
+	// Pac above Paco gives the DC power where clipping starts; returns -1 when Pac cannot be reached
+	double dcpower( double Pac, double Vdc );
+
+private:
+	// AC power of one MPPT input with and without the Pso operating loss (Wac)
+	void acpower_input( double Pdc, double Vdc, double *Pac, double *PacNoPso );
+	// combines the MPPT inputs: night tare, clipping, part load and efficiency
+	void acpower_total( double Pdc_total, double Pac_sum, double Psoloss_sum,
+		double *Pac, double *Ppar, double *Plr, double *Eff, double *Pcliploss, double *Psoloss, double *Pntloss );
 } ;
 
 #endif
@@ -269,9 +269,33 @@ void SharedInverter::solve_kwdc_for_kwac(const double *x, double *f){
     f[0] = powerAC_kW - solver_AC;
 }
 
+bool SharedInverter::invertACPower(const double kwAC, const double DCStringV, double& kwDC){
+    // Power quantities go in and come out in units of W for a single inverter
+    double powerAC_Watts = std::fabs(kwAC) * util::kilowatt_to_watt / m_numInverters;
+    double powerDC_Watts = -1;
+    if (m_inverterType == SANDIA_INVERTER || m_inverterType == DATASHEET_INVERTER || m_inverterType == COEFFICIENT_GENERATOR)
+        powerDC_Watts = m_sandiaInverter->dcpower(powerAC_Watts, DCStringV);
+    else if (m_inverterType == PARTLOAD_INVERTER)
+        powerDC_Watts = m_partloadInverter->dcpower(powerAC_Watts);
+    else if (m_inverterType == NONE && powerAC_Watts > 0)
+        powerDC_Watts = powerAC_Watts / NONE_INVERTER_EFF;
+    if (powerDC_Watts < 0)
+        return false;
+
+    // negative DC power charges a battery through the same curve
+    kwDC = powerDC_Watts * m_numInverters * util::watt_to_kilowatt;
+    if (kwAC < 0)
+        kwDC *= -1;
+    return true;
+}
+
 using namespace std::placeholders;
 double SharedInverter::calculateRequiredDCPower(const double kwAC, const double DCStringV, double tempC){
 
+    double kwDC;
+    if (!m_tempEnabled && invertACPower(kwAC, DCStringV, kwDC))
+        return kwDC;
+
     SharedInverter clone = SharedInverter(*this);
 
     // set up solver values
@@ -38,6 +38,7 @@ public:
 	void calculateACPower(const std::vector<double> powerDC_kW, const std::vector<double> DCStringVoltage, double tempC);
 
 	/// Given a target AC power production, calculate the required DC power if possible, otherwise if eff is too low return kwAC. Does not modify state
+	/// Inverts the Sandia, partload and no-inverter models directly when temperature derating is off, and solves iteratively otherwise
 	double calculateRequiredDCPower(const double kwAC, const double DCStringV, double tempC);
 
 	/// Return the nominal DC voltage input
@@ -92,6 +93,9 @@ private:
 	// x[0] is dc power input in kW, x[1] is target ac power output in kW
 	void solve_kwdc_for_kwac(const double *x, double *f);
 
+	/// DC power in kW for an AC power in kW from the inverse of the inverter model, false if the model has none
+	bool invertACPower(const double kwAC, const double DCStringV, double& kwDC);
+
 	double solver_AC;
 };
 
@@ -161,3 +161,26 @@ bool pvsnowmodel::getLoss(float poa, float tilt, float , float tdry, float snowD
 	if (isGood) return true;
 	else return false;
 }
+
+bool pvsnowmodel::getLosses(size_t n, const double *poa, const double *tilt, const double *wspd, const double *tdry, const double *snowDepth, const double *sunup, float dt, float *returnLoss){
+
+	bool isGood = true;
+	size_t i = 0;
+	while (i < n){
+		size_t start = i;
+		while (i < n && snowFree((float)snowDepth[i]))
+			returnLoss[i++] = 0;
+		if (i > start)
+			skipSnowFree((float)snowDepth[i - 1]);
+
+		// run the model through the span with snow, or with snow depths that need checking
+		for (; i < n && !snowFree((float)snowDepth[i]); i++){
+			if (!getLoss((float)poa[i], (float)tilt[i], (float)wspd[i], (float)tdry[i], (float)snowDepth[i], (int)sunup[i], dt, returnLoss[i])){
+				isGood = false;
+				if (!good) return false;
+			}
+		}
+	}
+
+	return isGood;
+}
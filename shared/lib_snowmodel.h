@@ -23,6 +23,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef __lib_snowmodel_h
 #define __lib_snowmodel_h
 
+#include <cstddef>
 #include <string>
 
 class pvsnowmodel
@@ -35,6 +36,15 @@ public:
 
 	bool getLoss(float poa, float tilt, float wspd, float tdry, float snowDepth, int sunup, float dt, float &returnLoss);
 
+	// a valid snow depth below the snowfall threshold leaves no coverage and no loss, whatever the other inputs
+	bool snowFree(float snowDepth) const { return snowDepth >= 0 && snowDepth < depthThreshold; }
+
+	// advance over a snow-free time step without running the model
+	void skipSnowFree(float snowDepth) { previousDepth = snowDepth; coverage = pCvg = 0; }
+
+	// losses over n time steps: snow-free spans are found by scanning the snow depths and skipped
+	bool getLosses(size_t n, const double *poa, const double *tilt, const double *wspd, const double *tdry, const double *snowDepth, const double *sunup, float dt, float *returnLoss);
+
 	float baseTilt,		// The default tilt for 1-axis tracking systems
 		mSlope,			// This is a value given by fig. 4 in [1]
 		sSlope,			// This is a value given by fig. 7 in [1]
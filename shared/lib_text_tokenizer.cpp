@@ -0,0 +1,302 @@
+/**
+BSD-3-Clause
+Copyright 2019 Alliance for Sustainable Energy, LLC
+Redistribution and use in source and binary forms, with or without modification, are permitted provided 
+that the following conditions are met :
+1.	Redistributions of source code must retain the above copyright notice, this list of conditions 
+and the following disclaimer.
+2.	Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+and the following disclaimer in the documentation and/or other materials provided with the distribution.
+3.	Neither the name of the copyright holder nor the names of its contributors may be used to endorse 
+or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER, CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES 
+DEPARTMENT OF ENERGY, NOR ANY OF THEIR EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+
+#include "lib_text_tokenizer.h"
+
+text_tokenizer::text_tokenizer()
+	: m_cur(0), m_end(0), m_line(0), m_lineLen(0), m_eof(false)
+{
+}
+
+text_tokenizer::text_tokenizer( const std::string &file )
+	: m_cur(0), m_end(0), m_line(0), m_lineLen(0), m_eof(false)
+{
+	open( file );
+}
+
+bool text_tokenizer::open( const std::string &file )
+{
+	close();
+	if ( !m_file.open( file ) )
+		return false;
+
+	rewind();
+	return true;
+}
+
+void text_tokenizer::close()
+{
+	m_file.close();
+	m_cur = m_end = m_line = 0;
+	m_lineLen = 0;
+	m_eof = false;
+	m_fields.clear();
+}
+
+void text_tokenizer::rewind()
+{
+	m_cur = m_file.data();
+	m_end = m_cur + m_file.size();
+	m_line = m_cur;
+	m_lineLen = 0;
+	m_eof = false;
+	m_fields.clear();
+}
+
+bool text_tokenizer::next_line()
+{
+	m_fields.clear();
+	if ( m_cur >= m_end )
+	{
+		m_line = m_end;
+		m_lineLen = 0;
+		m_eof = true;
+		return false;
+	}
+
+	const char *nl = (const char*)memchr( m_cur, '\n', m_end - m_cur );
+	m_line = m_cur;
+	if ( nl )
+	{
+		m_lineLen = nl - m_cur;
+		m_cur = nl + 1;
+	}
+	else
+	{
+		m_lineLen = m_end - m_cur;
+		m_cur = m_end;
+		m_eof = true;
+	}
+	return true;
+}
+
+size_t text_tokenizer::count_lines( bool stop_at_empty ) const
+{
+	size_t n = 0;
+	const char *p = m_cur;
+	while ( p < m_end )
+	{
+		const char *nl = (const char*)memchr( p, '\n', m_end - p );
+		if ( stop_at_empty && nl == p )
+			break;
+		n++;
+		p = nl ? nl + 1 : m_end;
+	}
+	return n;
+}
+
+void text_tokenizer::trim_line( const char *leading, const char *trailing )
+{
+	while ( m_lineLen > 0 && *m_line && strchr( leading, *m_line ) )
+	{
+		m_line++;
+		m_lineLen--;
+	}
+	while ( m_lineLen > 0 && m_line[m_lineLen - 1] && strchr( trailing, m_line[m_lineLen - 1] ) )
+		m_lineLen--;
+}
+
+size_t text_tokenizer::split( char delim )
+{
+	m_fields.clear();
+	const char *p = m_line;
+	const char *end = m_line + m_lineLen;
+	while ( p < end )
+	{
+		const char *d = (const char*)memchr( p, delim, end - p );
+		span s = { p, (size_t)( ( d ? d : end ) - p ) };
+		m_fields.push_back( s );
+		p = d ? d + 1 : end;
+	}
+	return m_fields.size();
+}
+
+/* Scans a decimal number. The value is mant * 10^exp10, and exact is false when the digits don't
+fit in mant or the exponent is out of any useful range. Returns 0 for anything else that the
+C library might still accept (hex, inf, nan). */
+static const char *scan_decimal( const char *p, const char *end, bool *neg, uint64_t *mant, int *exp10, bool *exact )
+{
+	while ( p < end && isspace( (unsigned char)*p ) ) p++;
+
+	*neg = false;
+	if ( p < end && ( *p == '+' || *p == '-' ) )
+		*neg = ( *p++ == '-' );
+
+	*mant = 0;
+	*exp10 = 0;
+	*exact = true;
+	int ndigits = 0, nsig = 0;
+	for ( ; p < end && isdigit( (unsigned char)*p ); p++, ndigits++ )
+	{
+		if ( *mant == 0 && *p == '0' ) continue;
+		if ( ++nsig > 19 ) *exact = false;
+		else *mant = *mant * 10 + ( *p - '0' );
+		if ( nsig > 19 ) ( *exp10 )++;
+	}
+	if ( p < end && ( *p == 'x' || *p == 'X' ) )
+		return 0;
+
+	if ( p < end && *p == '.' )
+	{
+		for ( p++; p < end && isdigit( (unsigned char)*p ); p++, ndigits++ )
+		{
+			if ( *mant == 0 && *p == '0' )
+			{
+				( *exp10 )--;
+				continue;
+			}
+			if ( ++nsig > 19 ) *exact = false;
+			else
+			{
+				*mant = *mant * 10 + ( *p - '0' );
+				( *exp10 )--;
+			}
+		}
+	}
+	if ( ndigits == 0 )
+		return 0;
+
+	if ( p < end && ( *p == 'e' || *p == 'E' ) )
+	{
+		const char *q = p + 1;
+		bool eneg = false;
+		if ( q < end && ( *q == '+' || *q == '-' ) )
+			eneg = ( *q++ == '-' );
+		if ( q < end && isdigit( (unsigned char)*q ) )
+		{
+			int e = 0;
+			for ( ; q < end && isdigit( (unsigned char)*q ); q++ )
+				if ( e < 100000 ) e = e * 10 + ( *q - '0' );
+			if ( e >= 100000 ) *exact = false;
+			*exp10 += eneg ? -e : e;
+			p = q;
+		}
+	}
+	return p;
+}
+
+template< typename T >
+static const char *parse_with_library( const char *p, const char *end, T *x, T ( *conv )( const char *, char ** ) )
+{
+	char buf[64];
+	std::string longbuf;
+	size_t n = end - p;
+	const char *s;
+	if ( n < sizeof( buf ) )
+	{
+		memcpy( buf, p, n );
+		buf[n] = 0;
+		s = buf;
+	}
+	else
+	{
+		longbuf.assign( p, n );
+		s = longbuf.c_str();
+	}
+
+	char *q = 0;
+	errno = 0;
+	T v = conv( s, &q );
+	if ( q == s || errno == ERANGE )
+		return 0;
+
+	*x = v;
+	return p + ( q - s );
+}
+
+static float lib_strtof( const char *s, char **q ) { return strtof( s, q ); }
+static double lib_strtod( const char *s, char **q ) { return strtod( s, q ); }
+
+// powers of ten that are exact in the floating point type
+static const float pow10f[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+static const double pow10d[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+const char *text_tokenizer::parse_float( const char *p, const char *end, float *x )
+{
+	bool neg, exact;
+	uint64_t mant;
+	int exp10;
+	const char *q = scan_decimal( p, end, &neg, &mant, &exp10, &exact );
+
+	// an integer mantissa and power of ten that are both exact give a correctly rounded result
+	// from a single multiply or divide
+	if ( q && exact && mant <= ( 1ULL << 24 ) && exp10 >= -10 && exp10 <= 10 )
+	{
+		float f = (float)mant;
+		f = exp10 < 0 ? f / pow10f[-exp10] : f * pow10f[exp10];
+		*x = neg ? -f : f;
+		return q;
+	}
+	return parse_with_library( p, end, x, lib_strtof );
+}
+
+const char *text_tokenizer::parse_double( const char *p, const char *end, double *x )
+{
+	bool neg, exact;
+	uint64_t mant;
+	int exp10;
+	const char *q = scan_decimal( p, end, &neg, &mant, &exp10, &exact );
+
+	if ( q && exact && mant <= ( 1ULL << 53 ) && exp10 >= -22 && exp10 <= 22 )
+	{
+		double d = (double)mant;
+		d = exp10 < 0 ? d / pow10d[-exp10] : d * pow10d[exp10];
+		*x = neg ? -d : d;
+		return q;
+	}
+	return parse_with_library( p, end, x, lib_strtod );
+}
+
+const char *text_tokenizer::parse_int( const char *p, const char *end, int *x )
+{
+	while ( p < end && isspace( (unsigned char)*p ) ) p++;
+
+	bool neg = false;
+	if ( p < end && ( *p == '+' || *p == '-' ) )
+		neg = ( *p++ == '-' );
+
+	const char *digits = p;
+	long long v = 0;
+	for ( ; p < end && isdigit( (unsigned char)*p ); p++ )
+	{
+		v = v * 10 + ( *p - '0' );
+		if ( v > (long long)INT_MAX + 1 )
+			return 0;
+	}
+	if ( p == digits )
+		return 0;
+
+	v = neg ? -v : v;
+	if ( v > INT_MAX || v < INT_MIN )
+		return 0;
+
+	*x = (int)v;
+	return p;
+}
@@ -0,0 +1,90 @@
+/**
+BSD-3-Clause
+Copyright 2019 Alliance for Sustainable Energy, LLC
+Redistribution and use in source and binary forms, with or without modification, are permitted provided 
+that the following conditions are met :
+1.	Redistributions of source code must retain the above copyright notice, this list of conditions 
+and the following disclaimer.
+2.	Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+and the following disclaimer in the documentation and/or other materials provided with the distribution.
+3.	Neither the name of the copyright holder nor the names of its contributors may be used to endorse 
+or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER, CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES 
+DEPARTMENT OF ENERGY, NOR ANY OF THEIR EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __lib_text_tokenizer_h
+#define __lib_text_tokenizer_h
+
+#include <string>
+#include <vector>
+#include "lib_util.h"
+
+/**
+* Reads a delimited text file line by line from a memory-mapped copy of the file. Lines and fields
+* are views into the mapping and the field table is reused from line to line, so reading a file does
+* not allocate per line or per field. Lines and fields follow std::getline: a line ends at '\n' (a
+* '\r' before it stays part of the line), and splitting "a,b," gives two fields.
+*/
+class text_tokenizer
+{
+public:
+	text_tokenizer();
+	explicit text_tokenizer( const std::string &file );
+
+	bool open( const std::string &file );
+	void close();
+	bool ok() const { return m_file.ok(); }
+
+	/// Moves to the next line. Returns false if there are no more lines.
+	bool next_line();
+	/// True once a line was ended by the end of the file instead of '\n', like std::istream::eof()
+	bool eof() const { return m_eof; }
+	/// Counts the lines after the current one without moving; optionally stops at the first empty line
+	size_t count_lines( bool stop_at_empty = false ) const;
+	void rewind();
+
+	const char *line() const { return m_line; }
+	size_t line_length() const { return m_lineLen; }
+	std::string line_str() const { return std::string( m_line, m_lineLen ); }
+
+	/// Splits the current line, or the part of it left by trim_line(), into fields
+	size_t split( char delim = ',' );
+	/// Removes the given leading and trailing characters from the current line
+	void trim_line( const char *leading = " \t", const char *trailing = " \t\r\n" );
+	size_t nfields() const { return m_fields.size(); }
+	const char *field( size_t i ) const { return m_fields[i].p; }
+	size_t field_length( size_t i ) const { return m_fields[i].len; }
+	std::string field_str( size_t i ) const { return std::string( m_fields[i].p, m_fields[i].len ); }
+
+	/* Parse a number at the start of [p,end) with the same rules as strtof/strtod/strtol (leading
+	whitespace, optional sign, trailing characters ignored). Return the position after the number,
+	or 0 if there is none or it is out of range. Common short decimals are converted exactly without
+	library calls; other input falls back to the C library, so results are identical to strtof/strtod. */
+	static const char *parse_float( const char *p, const char *end, float *x );
+	static const char *parse_double( const char *p, const char *end, double *x );
+	static const char *parse_int( const char *p, const char *end, int *x );
+
+private:
+	struct span {
+		const char *p;
+		size_t len;
+	};
+
+	util::mapped_file m_file;
+	const char *m_cur;
+	const char *m_end;
+	const char *m_line;
+	size_t m_lineLen;
+	bool m_eof;
+	std::vector<span> m_fields;
+};
+
+#endif
@@ -27,14 +27,18 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <limits>
 #include <numeric>
 #include <algorithm>
+#include <chrono>
+#include <thread>
 
 #ifdef _WIN32
 #include <direct.h>
 #include <Windows.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #endif
 
 #include "lib_util.h"
@@ -332,6 +336,116 @@ std::string util::read_file( const std::string &file )
 	return buf;
 }
 
+util::mapped_file::mapped_file(const std::string &file, bool copy_on_write)
+	: m_data(0), m_size(0), m_writable(false), m_ok(false), m_handle(0)
+{
+	open(file, copy_on_write);
+}
+
+bool util::mapped_file::open(const std::string &file, bool copy_on_write)
+{
+	close();
+#ifdef _WIN32
+	HANDLE hfile = ::CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hfile == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER len;
+	if (!::GetFileSizeEx(hfile, &len))
+	{
+		::CloseHandle(hfile);
+		return false;
+	}
+	m_size = (size_t)len.QuadPart;
+	if (m_size > 0)
+	{
+		// the mapping object keeps the file open, so the file handle can be closed right away
+		HANDLE hmap = ::CreateFileMappingA(hfile, NULL, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+		::CloseHandle(hfile);
+		if (!hmap) return false;
+		m_data = (char*)::MapViewOfFile(hmap, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+		if (!m_data)
+		{
+			::CloseHandle(hmap);
+			return false;
+		}
+		m_handle = hmap;
+	}
+	else
+		::CloseHandle(hfile);
+#else
+	int fd = ::open(file.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		::close(fd);
+		return false;
+	}
+	m_size = (size_t)st.st_size;
+	if (m_size > 0)
+	{
+		void *p = ::mmap(0, m_size, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ,
+			MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED)
+		{
+			::close(fd);
+			m_size = 0;
+			return false;
+		}
+		m_data = (char*)p;
+	}
+	::close(fd);
+#endif
+	m_writable = copy_on_write;
+	m_ok = true;
+	return true;
+}
+
+void util::mapped_file::close()
+{
+	if (m_data)
+	{
+#ifdef _WIN32
+		::UnmapViewOfFile(m_data);
+		::CloseHandle((HANDLE)m_handle);
+#else
+		::munmap(m_data, m_size);
+#endif
+	}
+	m_data = 0;
+	m_size = 0;
+	m_writable = false;
+	m_ok = false;
+	m_handle = 0;
+}
+
+bool util::write_file_atomic(const std::string &file, const std::function<bool(FILE *)> &write)
+{
+	// unique to the writer, so that simultaneous writers of the same file don't share a temporary
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%llx.tmp",
+		(unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count()
+		^ (unsigned long long)std::hash<std::thread::id>()(std::this_thread::get_id()));
+	std::string tmp = file + suffix;
+	stdfile fp(tmp, "wb");
+	if (!fp.ok()) return false;
+
+	bool ok = write(fp) && fflush(fp) == 0;
+	fp.close();
+
+	if (ok && ::rename(tmp.c_str(), file.c_str()) != 0)
+	{
+		// rename does not replace an existing file on Windows
+		remove_file(file.c_str());
+		ok = ::rename(tmp.c_str(), file.c_str()) == 0;
+	}
+	if (!ok)
+		remove_file(tmp.c_str());
+	return ok;
+}
+
 bool util::read_line( FILE *fp, std::string &buf, int prealloc )
 {
 	int c;
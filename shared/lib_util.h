@@ -24,6 +24,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __lib_util_h
 
 #include <cstdio>
+#include <functional>
 #include <string>
 #include <vector>
 #include <cassert>
@@ -200,6 +201,35 @@ namespace util
 		FILE *p;
 	};
 
+	/// Read-only view of a whole file mapped into memory. With copy_on_write the view may be
+	/// modified through writable_data(); changes stay private to this mapping and never reach the file.
+	class mapped_file
+	{
+	public:
+		mapped_file() : m_data(0), m_size(0), m_writable(false), m_ok(false), m_handle(0) { }
+		mapped_file(const std::string &file, bool copy_on_write = false);
+		~mapped_file() { close(); }
+		bool open(const std::string &file, bool copy_on_write = false);
+		void close();
+		bool ok() const { return m_ok; }
+		const char *data() const { return m_data; }
+		char *writable_data() { return m_writable ? m_data : 0; }
+		size_t size() const { return m_size; }
+	private:
+		mapped_file(const mapped_file &);
+		mapped_file &operator=(const mapped_file &);
+		char *m_data;
+		size_t m_size;
+		bool m_writable;
+		bool m_ok;
+		void *m_handle; // file mapping object on Windows
+	};
+
+	/// Write a file through a callback into a temporary file beside it, then move it into place so that
+	/// concurrent readers, such as a mapped_file, never see it partially written. Returns false, leaving
+	/// no temporary file behind, if the callback returns false or the file can't be written or moved.
+	bool write_file_atomic(const std::string &file, const std::function<bool(FILE *)> &write);
+
 	template< typename T, size_t n_rows, size_t n_cols >
 	class matrix_static_t
 	{
@@ -271,10 +301,12 @@ namespace util
 	protected:
 		T *t_array;
 		size_t n_rows, n_cols;
+		bool t_borrowed; // t_array refers to memory owned by someone else, see borrow()
 	public:
 
 		matrix_t()
 		{
+			t_borrowed = false;
 			t_array = new T[1];
 			n_rows = n_cols = 1;
 		}
@@ -283,6 +315,7 @@ namespace util
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			copy( cc );
 		}
 		
@@ -290,6 +323,7 @@ namespace util
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			if (len < 1) len = 1;
 			resize( 1, len );
 		}
@@ -298,6 +332,7 @@ namespace util
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			if (nr < 1) nr = 1;
 			if (nc < 1) nc = 1;
 			resize(nr,nc);
@@ -307,6 +342,7 @@ namespace util
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			if (nr < 1) nr = 1;
 			if (nc < 1) nc = 1;
 			resize(nr,nc);
@@ -316,6 +352,7 @@ namespace util
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			if (nr < 1) nr = 1;
 			if (nc < 1) nc = 1;
 			resize(nr, nc);
@@ -327,14 +364,51 @@ namespace util
 
 		virtual ~matrix_t()
 		{
-			if (t_array) delete [] t_array;
+			if (t_array && !t_borrowed) delete [] t_array;
 		}
 		
 		void clear()
 		{
-			if (t_array) delete [] t_array;
+			if (t_array && !t_borrowed) delete [] t_array;
 			n_rows = n_cols = 1;
 			t_array = new T[1];
+			t_borrowed = false;
+		}
+
+		/* refer to externally owned memory without copying it. the memory must outlive
+		   this object and is treated as read-only: any resize, assign, fill, set_value or copy
+		   into this matrix first detaches it onto its own storage. the element references
+		   returned by at(), operator(), operator[] and data() are not guarded and point into
+		   the borrowed memory, so they may only be read until detach() is called */
+		void borrow( T *pvalues, size_t nr, size_t nc )
+		{
+			if (!pvalues || nr < 1 || nc < 1)
+			{
+				clear();
+				return;
+			}
+			if (t_array && !t_borrowed) delete [] t_array;
+			t_array = pvalues;
+			n_rows = nr;
+			n_cols = nc;
+			t_borrowed = true;
+		}
+
+		inline bool is_borrowed() const
+		{
+			return t_borrowed;
+		}
+
+		/* take a private copy of borrowed memory so that it can be written to */
+		void detach()
+		{
+			if (!t_borrowed) return;
+			size_t ncells = n_rows*n_cols;
+			T *p = new T[ncells];
+			for (size_t i=0;i<ncells;i++)
+				p[i] = t_array[i];
+			t_array = p;
+			t_borrowed = false;
 		}
 		
 		void copy( const matrix_t &rhs )
@@ -382,7 +456,7 @@ namespace util
 			return *this;
 		}
 		
-		inline operator T()
+		inline operator T() const
 		{
 			return t_array[0];
 		}
@@ -412,6 +486,7 @@ namespace util
 		
 		void fill( const T &val )
 		{
+			detach();
 			size_t ncells = n_rows*n_cols;
 			for (size_t i=0;i<ncells;i++)
 				t_array[i] = val;
@@ -419,10 +494,11 @@ namespace util
 		void resize(size_t nr, size_t nc)
 		{
 			if (nr < 1 || nc < 1) return;
-			if (nr == n_rows && nc == n_cols) return;
+			if (nr == n_rows && nc == n_cols && !t_borrowed) return;
 			
-			if (t_array) delete [] t_array;
+			if (t_array && !t_borrowed) delete [] t_array;
 			t_array = new T[ nr * nc ];
+			t_borrowed = false;
 			n_rows = nr;
 			n_cols = nc;
 		}
@@ -454,6 +530,7 @@ namespace util
 
 		void set_value(const T &val, size_t r, size_t c)
 		{
+			detach();
 			t_array[n_cols*r + c] = val;
 		}
 		inline T &at(size_t i)
@@ -578,6 +655,11 @@ namespace util
 			return t_array;
 		}
 
+		inline const T *data() const
+		{
+			return t_array;
+		}
+
 		inline T value() const
 		{
 			return t_array[0];
@@ -31,6 +31,12 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <list>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #if defined(__WINDOWS__)||defined(WIN32)||defined(_WIN32)
 #define CASECMP(a,b) _stricmp(a,b)
@@ -41,6 +47,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #include "lib_util.h"
+#include "lib_text_tokenizer.h"
 #include "lib_weatherfile.h"
 
 using std::stof;
@@ -108,6 +115,69 @@ static float col_or_nan(const std::string &s)
 		return std::numeric_limits<float>::quiet_NaN();;
 }
 
+/// col_or_nan for a field in place; anything the fast parser doesn't take goes through the string version
+static float col_or_nan(const char *s, size_t len)
+{
+	const char *end = s + len;
+	if (std::none_of(s, end, [](char c) { return ::isdigit((unsigned char)c) != 0; }))
+		return std::numeric_limits<float>::quiet_NaN();
+
+	float x;
+	if (::isdigit((unsigned char)s[0]))
+	{
+		if (text_tokenizer::parse_float(s, end, &x))
+			return x;
+	}
+	else if (text_tokenizer::parse_float(s + 1, end, &x))
+		return (s[0] == '-') ? (float)(0.0 - x) : x;
+
+	return col_or_nan(std::string(s, len));
+}
+
+static float col_or_nan(const text_tokenizer &tok, size_t i)
+{
+	if (i >= tok.nfields()) return std::numeric_limits<float>::quiet_NaN();
+	return col_or_nan(tok.field(i), tok.field_length(i));
+}
+
+/// same as stoi over [p,end)
+static int int_or_throw(const char *p, const char *end)
+{
+	int x;
+	if (text_tokenizer::parse_int(p, end, &x))
+		return x;
+	return stoi(std::string(p, end));
+}
+
+static int int_or_throw(const text_tokenizer &tok, size_t i)
+{
+	if (i >= tok.nfields()) return stoi(std::string());
+	return int_or_throw(tok.field(i), tok.field(i) + tok.field_length(i));
+}
+
+/// trimboth for a field in place
+static float trimmed_col_or_nan(const text_tokenizer &tok, size_t i)
+{
+	const char *p = tok.field(i);
+	size_t len = tok.field_length(i);
+	while (len > 0 && (*p == ' ' || *p == '\t'))
+	{
+		p++;
+		len--;
+	}
+	while (len > 0 && strchr(" \t\r\n", p[len - 1]))
+		len--;
+	if (len == 0) return std::numeric_limits<float>::quiet_NaN();
+	return col_or_nan(p, len);
+}
+
+static bool read_line(text_tokenizer &tok, std::string &buf)
+{
+	bool ok = tok.next_line();
+	buf.assign(tok.line(), tok.line_length());
+	return ok;
+}
+
 static double conv_deg_min_sec(double degrees,
 	double minutes,
 	double seconds,
@@ -134,6 +204,23 @@ static int cmp_ext(const std::string &file, const std::string &ext)
 	  return CASENCMP(extp, ext.c_str(), len_ext) == 0;
 }
 
+/// FNV-1a style hash over 8-byte words, used to detect changes to a cached weather file
+static unsigned long long content_hash(const char *p, size_t n)
+{
+	uint64_t h = 14695981039346656037ULL;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		uint64_t w;
+		memcpy(&w, p + i, 8);
+		h = (h ^ w) * 1099511628211ULL;
+		h ^= h >> 32;
+	}
+	for (; i < n; i++)
+		h = (h ^ (unsigned char)p[i]) * 1099511628211ULL;
+	return h;
+}
+
 
 std::string weatherfile::normalize_city(const std::string &in)
 {
@@ -413,18 +500,149 @@ void weather_record::reset()
 
 #define NBUF 2048
 
+// identifies one version of a file on disk for the shared memory cache
+struct shared_weather_key
+{
+	std::string file;
+	unsigned long long size;
+	long long mtime_ns;
+
+	bool operator==(const shared_weather_key &rhs) const
+	{
+		return size == rhs.size && mtime_ns == rhs.mtime_ns && file == rhs.file;
+	}
+};
+
+static bool shared_key(const std::string &file, shared_weather_key &key)
+{
+	key.file = file;
+#ifdef _WIN32
+	struct _stat64 st;
+	if (_stat64(file.c_str(), &st) != 0)
+		return false;
+	key.mtime_ns = (long long)st.st_mtime * 1000000000LL;
+#else
+	struct stat st;
+	if (stat(file.c_str(), &st) != 0)
+		return false;
+#if defined(__APPLE__)
+	key.mtime_ns = (long long)st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+	key.mtime_ns = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+#endif
+	key.size = (unsigned long long)st.st_size;
+	return true;
+}
+
+// most recently used first
+static std::mutex s_shared_lock;
+static std::list<std::pair<shared_weather_key, std::shared_ptr<const weatherfile> > > s_shared;
+static size_t s_shared_size = 8;
+
+static bool load_shared(const std::string &file, weatherfile &wf)
+{
+	shared_weather_key key;
+	if (!shared_key(file, key))
+		return false;
+
+	std::lock_guard<std::mutex> lock(s_shared_lock);
+	for (auto it = s_shared.begin(); it != s_shared.end(); ++it)
+	{
+		if (it->first == key)
+		{
+			s_shared.splice(s_shared.begin(), s_shared, it);
+			wf = *it->second;
+			return true;
+		}
+	}
+	return false;
+}
+
+static void store_shared(const std::string &file, const weatherfile &wf)
+{
+	shared_weather_key key;
+	if (!shared_key(file, key))
+		return;
+
+	std::shared_ptr<const weatherfile> entry = std::make_shared<weatherfile>(wf);
+	std::lock_guard<std::mutex> lock(s_shared_lock);
+	if (s_shared_size == 0)
+		return;
+
+	// another thread may have loaded the same file in the meantime
+	for (auto it = s_shared.begin(); it != s_shared.end(); ++it)
+	{
+		if (it->first.file == file)
+		{
+			s_shared.erase(it);
+			break;
+		}
+	}
+	s_shared.push_front(std::make_pair(key, entry));
+	while (s_shared.size() > s_shared_size)
+		s_shared.pop_back();
+}
+
+void weatherfile::set_shared_cache_size(size_t n_files)
+{
+	std::lock_guard<std::mutex> lock(s_shared_lock);
+	s_shared_size = n_files;
+	while (s_shared.size() > s_shared_size)
+		s_shared.pop_back();
+}
+
+size_t weatherfile::shared_cache_size()
+{
+	std::lock_guard<std::mutex> lock(s_shared_lock);
+	return s_shared_size;
+}
+
+void weatherfile::clear_shared_cache()
+{
+	std::lock_guard<std::mutex> lock(s_shared_lock);
+	s_shared.clear();
+}
+
 
 weatherfile::weatherfile()
 {
 	reset();
 }
 
+weatherfile::weatherfile(const weatherfile &rhs)
+	: weather_data_provider(rhs)
+{
+	*this = rhs;
+}
+
+weatherfile &weatherfile::operator=(const weatherfile &rhs)
+{
+	if (this == &rhs) return *this;
+
+	weather_data_provider::operator=(rhs);
+	m_type = rhs.m_type;
+	m_file = rhs.m_file;
+
+	// the column values are shared, not copied
+	m_data = rhs.m_data;
+	for (size_t i = 0; i < _MAXCOL_; i++)
+		m_columns[i] = rhs.m_columns[i];
+	return *this;
+}
+
 weatherfile::weatherfile(const std::string &file, bool header_only)
 {
 	reset();
+	if (!header_only && load_shared(file, *this))
+		return;
+
 	m_ok = open(file, header_only);
 	if (m_ok && !header_only)
-        start_hours_at_0();
+	{
+		start_hours_at_0();
+		store_shared(file, *this);
+	}
 }
 
 weatherfile::~weatherfile()
@@ -449,6 +667,29 @@ void weatherfile::reset()
 
 	m_hdr.reset();
 	//m_rec.reset();
+
+	m_data.reset();
+	for (size_t i = 0; i < _MAXCOL_; i++)
+	{
+		m_columns[i].index = -1;
+		m_columns[i].data = 0;
+	}
+}
+
+void weatherfile::detach()
+{
+	if (!m_data || m_data.use_count() == 1)
+		return;
+
+	std::shared_ptr<std::vector<float> > block = std::make_shared<std::vector<float> >(_MAXCOL_ * m_nRecords);
+	for (size_t i = 0; i < _MAXCOL_; i++)
+	{
+		if (!m_columns[i].data) continue;
+		float *data = block->data() + i * m_nRecords;
+		std::copy(m_columns[i].data, m_columns[i].data + m_nRecords, data);
+		m_columns[i].data = data;
+	}
+	m_data = block;
 }
 
 
@@ -475,6 +716,8 @@ float check_missing(double v, double missing = -999.) {
 }
 
 void weatherfile::handle_missing_field(size_t index, int col) {
+	detach();
+
 	size_t prev = index - 1;
 	size_t next = index + 1;
 	if (index == 0) prev = m_nRecords - 1;
@@ -552,6 +795,45 @@ bool weatherfile::timeStepChecks(int hdr_step_sec) {
 }
 
 bool weatherfile::open(const std::string &file, bool header_only)
+{
+	m_data.reset();
+
+	if (cmp_ext(file, "wfc"))
+	{
+		if (read_cache(file, 0, 0, false))
+			return true;
+		m_message = "could not read weather cache file: " + file;
+		return false;
+	}
+
+	// look for a cache of this exact file content before parsing the text
+	std::string cache_path;
+	unsigned long long hash = 0, size = 0;
+	if (!header_only && !(cache_path = cache_file(file)).empty())
+	{
+		util::mapped_file source(file);
+		if (source.ok())
+		{
+			size = source.size();
+			hash = content_hash(source.data(), source.size());
+			if (read_cache(cache_path, hash, size, true))
+				return true;
+		}
+		else
+			cache_path.clear();
+	}
+
+	if (!parse(file, header_only))
+		return false;
+
+	// failing to write the cache only means the file is parsed again next time
+	if (!cache_path.empty())
+		write_cache(cache_path, hash, size);
+
+	return true;
+}
+
+bool weatherfile::parse(const std::string &file, bool header_only)
 {
 	if (file.empty())
 	{
@@ -576,9 +858,9 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	}
 
 	std::string buf, buf1;
-	std::ifstream ifs(file);
+	text_tokenizer tok(file);
 
-	if (!ifs.is_open())
+	if (!tok.ok())
 	{
 		m_message = "could not open file for reading: " + file;
 		m_type = INVALID;
@@ -589,16 +871,15 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	{
 		// if we opened a csv file, it could be SAM/WFCSV format or TMY3
 		// try to autodetect a TMY3
-		getline(ifs, buf);
-		getline(ifs, buf1);
+		read_line(tok, buf);
+		read_line(tok, buf1);
 		int ncols = (int)split(buf).size();
 		int ncols1 = (int)split(buf1).size();
 
 		if (ncols == 7 && (ncols1 == 68 || ncols1 == 71))
 			m_type = TMY3;
 
-		ifs.clear();
-		ifs.seekg(0);
+		tok.rewind();
 	}
 
 
@@ -613,7 +894,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		char pl[256], pc[256], ps[256];
 		int dlat, mlat, dlon, mlon, ielv;
 
-		getline(ifs, buf);
+		read_line(tok, buf);
 		sscanf(buf.c_str(),
 			"%s %s %s %lg %s %d %d %s %d %d %d",
 			pl, pc, ps,
@@ -635,7 +916,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	else if (m_type == TMY3)
 	{
 		/*  724699,"BROOMFIELD/JEFFCO [BOULDER - SURFRAD]",CO,-7.0,40.130,-105.240,1689 */
-		getline(ifs, buf);
+		read_line(tok, buf);
 		auto cols = split(buf);
 		if (cols.size() != 7)
 		{
@@ -656,24 +937,19 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		m_stepSec = 3600;
 		m_nRecords = 8760;
 
-		getline(ifs, buf); // skip over labels line
+		read_line(tok, buf); // skip over labels line
 	}
 	else if (m_type == EPW)
 	{
-		m_nRecords = 0;
-
-		while (getline(ifs, buf) && buf.length() > 0)
-			m_nRecords++;
-
+		m_nRecords = tok.count_lines(true);
 		m_nRecords -= 8;	// remove header lines
-		ifs.clear();
-		ifs.seekg(0);
+		tok.rewind();
 
 		if (!timeStepChecks()) return false;
 
 		/*  LOCATION,Cairo Intl Airport,Al Qahirah,EGY,ETMY,623660,30.13,31.40,2.0,74.0 */
 		/*  LOCATION,Alice Springs Airport,NT,AUS,RMY,943260,-23.80,133.88,9.5,547.0 */
-		getline(ifs, buf);
+		read_line(tok, buf);
 		auto cols = split(buf);
 
 		if (cols.size() != 10)
@@ -695,18 +971,18 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 		/* skip over excess header lines */
 
-		getline(ifs, buf);  // DESIGN CONDITIONS
-		getline(ifs, buf);  // TYPICAL/EXTREME PERIODS
-		getline(ifs, buf);  // GROUND TEMPERATURES
-		getline(ifs, buf);  // HOLIDAY/DAYLIGHT SAVINGS
-		getline(ifs, buf);  // COMMENTS 1
-		getline(ifs, buf);  // COMMENTS 2
-		getline(ifs, buf);  // DATA PERIODS
+		read_line(tok, buf);  // DESIGN CONDITIONS
+		read_line(tok, buf);  // TYPICAL/EXTREME PERIODS
+		read_line(tok, buf);  // GROUND TEMPERATURES
+		read_line(tok, buf);  // HOLIDAY/DAYLIGHT SAVINGS
+		read_line(tok, buf);  // COMMENTS 1
+		read_line(tok, buf);  // COMMENTS 2
+		read_line(tok, buf);  // DATA PERIODS
 
 	}
 	else if (m_type == SMW)
 	{
-		getline(ifs, buf);
+		read_line(tok, buf);
 		auto cols = split(buf);
 
 		if (cols.size() != 10)
@@ -748,13 +1024,10 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			m_time = start_hour * 3600 + start_min * 60 + start_sec;
 			m_startSec = (size_t)m_time;
 
-			m_nRecords = 0;
-			while (getline(ifs, buf))
-				m_nRecords++;
+			m_nRecords = tok.count_lines();
 
-			ifs.clear();
-			ifs.seekg(0);
-			getline(ifs, buf);
+			tok.rewind();
+			read_line(tok, buf);
 
 			if (m_nRecords % 8784 == 0)
 			{
@@ -768,10 +1041,10 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	}
 	else if (m_type == WFCSV)
 	{
-		getline(ifs, buf);
+		read_line(tok, buf);
 		auto cols = split(buf);
 		int ncols = (int)cols.size();
-		getline(ifs, buf1);
+		read_line(tok, buf1);
 		auto cols1 = split(buf1);
 		int ncols1 = (int)split(buf1).size();
 
@@ -867,21 +1140,17 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			m_stepSec = 3600;
 			m_nRecords = 8760;
 
-			getline(ifs, buf);  // col names
+			read_line(tok, buf);  // col names
 			if (m_hdr.hasunits)
-				getline(ifs, buf);  // col units
+				read_line(tok, buf);  // col units
 
-			m_nRecords = 0; // figure out how many records there are
-
-			while (getline(ifs, buf) && buf.length() > 0)
-				m_nRecords++;
+			m_nRecords = tok.count_lines(true); // figure out how many records there are
 
 
 			// reposition to where we were
-			ifs.clear();
-			ifs.seekg(0);
-			getline(ifs, buf);  // header names
-			getline(ifs, buf);  // header values
+			tok.rewind();
+			read_line(tok, buf);  // header names
+			read_line(tok, buf);  // header values
 
 			if (!timeStepChecks(hdr_step_sec)) return false;
 		}
@@ -899,17 +1168,19 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	}
 
 	// preallocate memory for data
+	std::shared_ptr<std::vector<float> > block = std::make_shared<std::vector<float> >(_MAXCOL_ * m_nRecords, std::numeric_limits<float>::quiet_NaN());
 	for (size_t i = 0; i < _MAXCOL_; i++)
 	{
 		m_columns[i].index = -1;
-		m_columns[i].data.resize(m_nRecords, std::numeric_limits<float>::quiet_NaN());
+		m_columns[i].data = block->data() + i * m_nRecords;
 	}
+	m_data = block;
 
 	if (m_type == WFCSV)
 	{
 		// if it's a WFCSV format file, we need to determine which columns of data exist
-		getline(ifs, buf);  // read column names
-		if (ifs.eof())
+		read_line(tok, buf);  // read column names
+		if (tok.eof())
 		{
 			m_message = "could not read column names";
 			return false;
@@ -920,8 +1191,8 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 		if (m_hdr.hasunits)
 		{
-			getline(ifs, buf);  // read column units
-			if (ifs.eof())
+			read_line(tok, buf);  // read column units
+			if (tok.eof())
 			{
 				m_message = "could not read column units";
 				return false;
@@ -1064,7 +1335,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 			for (;;)
 			{
-				getline(ifs, buf);
+				read_line(tok, buf);
 				nread = sscanf(buf.c_str(),
 					"%2d%2d%2d%2d"
 					"%4d%4d"
@@ -1132,7 +1403,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			}
 
 
-			if (nread != 79 || ifs.eof())
+			if (nread != 79 || tok.eof())
 			{
 				m_message = "TMY2: data line does not have at exactly 79 characters at record " + util::to_string(i);
 				return false;
@@ -1143,35 +1414,36 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		{
 			for (;;)
 			{
-				getline(ifs, buf);
-				auto cols = split(buf);
+				tok.next_line();
+				tok.split();
 				//				if (cols.size() < 68)
 				//				{
 				//					m_message = "TMY3: data line does not have at least 68 fields at record " + util::to_string(i);
 				//					return false;
 				//				}
 
-				const char *p = cols[0].c_str();
+				const char *p = tok.nfields() > 0 ? tok.field(0) : tok.line();
+				const char *end = p + (tok.nfields() > 0 ? tok.field_length(0) : 0);
 
-				int month = stoi(p);
-				p = strchr(p, '/');
+				int month = int_or_throw(p, end);
+				p = (const char*)memchr(p, '/', end - p);
 				if (!p)
 				{
 					m_message = "TMY3: invalid date format at record " + util::to_string(i);
 					return false;
 				}
 				p++;
-				int day = stoi(p);
-				p = strchr(p, '/');
+				int day = int_or_throw(p, end);
+				p = (const char*)memchr(p, '/', end - p);
 				if (!p)
 				{
 					m_message = "TMY3: invalid date format at record " + util::to_string(i);
 					return false;
 				}
 				p++;
-				int year = stoi(p);
+				int year = int_or_throw(p, end);
 
-				int hour = stoi(cols[1]) - tmy3_hour_shift;  // hour goes 0-23, not 1-24
+				int hour = int_or_throw(tok, 1) - tmy3_hour_shift;  // hour goes 0-23, not 1-24
 				if (i == 0 && hour < 0)
 				{
 					// this was a TMY3 file but with hours going 0-23 (against the tmy3 spec)
@@ -1191,21 +1463,21 @@ bool weatherfile::open(const std::string &file, bool header_only)
 				m_columns[DAY].data[i] = (float)day;
 				m_columns[HOUR].data[i] = (float)hour;
 				m_columns[MINUTE].data[i] = 30;
-				m_columns[GHI].data[i] = col_or_nan(cols[4]);
-				m_columns[DNI].data[i] = col_or_nan(cols[7]);
-				m_columns[DHI].data[i] = col_or_nan(cols[10]);
+				m_columns[GHI].data[i] = col_or_nan(tok, 4);
+				m_columns[DNI].data[i] = col_or_nan(tok, 7);
+				m_columns[DHI].data[i] = col_or_nan(tok, 10);
 				m_columns[POA].data[i] = (float)(-999);       /* No POA in TMY3 */
 
-				m_columns[TDRY].data[i] = col_or_nan(cols[31]);
-				m_columns[TDEW].data[i] = col_or_nan(cols[34]);
+				m_columns[TDRY].data[i] = col_or_nan(tok, 31);
+				m_columns[TDEW].data[i] = col_or_nan(tok, 34);
 
-				m_columns[WSPD].data[i] = col_or_nan(cols[46]);
-				m_columns[WDIR].data[i] = col_or_nan(cols[43]);
+				m_columns[WSPD].data[i] = col_or_nan(tok, 46);
+				m_columns[WDIR].data[i] = col_or_nan(tok, 43);
 
-				m_columns[RH].data[i] = col_or_nan(cols[37]);
-				m_columns[PRES].data[i] = col_or_nan(cols[40]);
+				m_columns[RH].data[i] = col_or_nan(tok, 37);
+				m_columns[PRES].data[i] = col_or_nan(tok, 40);
 				m_columns[SNOW].data[i] = -999.0; // no snowfall in TMY3
-				m_columns[ALB].data[i] = col_or_nan(cols[61]);
+				m_columns[ALB].data[i] = col_or_nan(tok, 61);
 				m_columns[AOD].data[i] = -999; /* no AOD in TMY3 */
 
 				m_columns[TWET].data[i]
@@ -1217,7 +1489,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 				break;
 			}
 
-			if (ifs.eof() && i < ((int)m_nRecords - 1))
+			if (tok.eof() && i < ((int)m_nRecords - 1))
 			{
 				m_message = "TMY3: data line formatting error at record " + util::to_string(i);
 				return false;
@@ -1227,17 +1499,16 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		{
 			for (;;)
 			{
-				getline(ifs, buf);
-				auto cols = split(buf);
+				tok.next_line();
 
-				if (cols.size() < 32)
+				if (tok.split() < 32)
 				{
 					m_message = "EPW: data line does not have at least 32 fields at record " + util::to_string(i);
 					return false;
 				}
 
-				int month = stoi(cols[1]);
-				int day = stoi(cols[2]);
+				int month = int_or_throw(tok, 1);
+				int day = int_or_throw(tok, 2);
 
 				if (month == 2 && day == 29)
 				{
@@ -1245,27 +1516,27 @@ bool weatherfile::open(const std::string &file, bool header_only)
 					continue;
 				}
 
-				m_columns[YEAR].data[i] = (float)stoi(cols[0]);
-				m_columns[MONTH].data[i] = (float)stoi(cols[1]);
-				m_columns[DAY].data[i] = (float)stoi(cols[2]);
-				m_columns[HOUR].data[i] = (float)stoi(cols[3]) - 1;  // hour goes 0-23, not 1-24;
-				m_columns[MINUTE].data[i] = (float)stoi(cols[4]);
+				m_columns[YEAR].data[i] = (float)int_or_throw(tok, 0);
+				m_columns[MONTH].data[i] = (float)month;
+				m_columns[DAY].data[i] = (float)day;
+				m_columns[HOUR].data[i] = (float)int_or_throw(tok, 3) - 1;  // hour goes 0-23, not 1-24;
+				m_columns[MINUTE].data[i] = (float)int_or_throw(tok, 4);
 
-				m_columns[GHI].data[i] = check_missing(col_or_nan(cols[13]), 9999.);
-				m_columns[DNI].data[i] = check_missing(col_or_nan(cols[14]), 9999.);
-				m_columns[DHI].data[i] = check_missing(col_or_nan(cols[15]), 9999.);
+				m_columns[GHI].data[i] = check_missing(col_or_nan(tok, 13), 9999.);
+				m_columns[DNI].data[i] = check_missing(col_or_nan(tok, 14), 9999.);
+				m_columns[DHI].data[i] = check_missing(col_or_nan(tok, 15), 9999.);
 				m_columns[POA].data[i] = (float)(-999);       /* No POA in EPW */
 
-				m_columns[WSPD].data[i] = check_missing(col_or_nan(cols[21]), 999.);
-				m_columns[WDIR].data[i] = check_missing(col_or_nan(cols[20]), 999.);
+				m_columns[WSPD].data[i] = check_missing(col_or_nan(tok, 21), 999.);
+				m_columns[WDIR].data[i] = check_missing(col_or_nan(tok, 20), 999.);
 
-				m_columns[TDRY].data[i] = check_missing(col_or_nan(cols[6]), 99.9);
+				m_columns[TDRY].data[i] = check_missing(col_or_nan(tok, 6), 99.9);
 
-				m_columns[TDEW].data[i] = check_missing(col_or_nan(cols[7]), 99.9);
+				m_columns[TDEW].data[i] = check_missing(col_or_nan(tok, 7), 99.9);
 
-				m_columns[RH].data[i] = check_missing(col_or_nan(cols[8]), 999.);
-				m_columns[PRES].data[i] = check_missing(col_or_nan(cols[9]) * 0.01, 999999.*0.01);
-				m_columns[SNOW].data[i] = check_missing(col_or_nan(cols[30]), 999.); // snowfall
+				m_columns[RH].data[i] = check_missing(col_or_nan(tok, 8), 999.);
+				m_columns[PRES].data[i] = check_missing(col_or_nan(tok, 9) * 0.01, 999999.*0.01);
+				m_columns[SNOW].data[i] = check_missing(col_or_nan(tok, 30), 999.); // snowfall
 				m_columns[ALB].data[i] = -999; /* no albedo in EPW file */
 				m_columns[AOD].data[i] = -999; /* no AOD in EPW */
 
@@ -1274,7 +1545,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 				break;
 			}
 
-			if (ifs.eof() && i < ((int)m_nRecords - 1))
+			if (tok.eof() && i < ((int)m_nRecords - 1))
 			{
 				m_message = "EPW: data line formatting error at record " + util::to_string(i);
 				return false;
@@ -1282,10 +1553,9 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		}
 		else if (m_type == SMW)
 		{
-			getline(ifs, buf);
-			auto cols = split(buf);
+			tok.next_line();
 
-			if (cols.size() < 12)
+			if (tok.split() < 12)
 			{
 				m_message = "SMW: data line does not have at least 12 fields at record " + util::to_string(i);
 				return false;
@@ -1301,25 +1571,25 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 			m_time += m_stepSec; // increment by step
 
-			m_columns[GHI].data[i] = col_or_nan(cols[7]);
-			m_columns[DNI].data[i] = col_or_nan(cols[8]);
-			m_columns[DHI].data[i] = col_or_nan(cols[9]);
+			m_columns[GHI].data[i] = col_or_nan(tok, 7);
+			m_columns[DNI].data[i] = col_or_nan(tok, 8);
+			m_columns[DHI].data[i] = col_or_nan(tok, 9);
 			m_columns[POA].data[i] = (double)(-999);       /* No POA in SMW */
 
-			m_columns[WSPD].data[i] = col_or_nan(cols[4]);
-			m_columns[WDIR].data[i] = col_or_nan(cols[5]);
+			m_columns[WSPD].data[i] = col_or_nan(tok, 4);
+			m_columns[WDIR].data[i] = col_or_nan(tok, 5);
 
-			m_columns[TDRY].data[i] = col_or_nan(cols[0]);
-			m_columns[TDEW].data[i] = col_or_nan(cols[1]);
-			m_columns[TWET].data[i] = col_or_nan(cols[2]);
+			m_columns[TDRY].data[i] = col_or_nan(tok, 0);
+			m_columns[TDEW].data[i] = col_or_nan(tok, 1);
+			m_columns[TWET].data[i] = col_or_nan(tok, 2);
 
-			m_columns[RH].data[i] = col_or_nan(cols[3]);
-			m_columns[PRES].data[i] = col_or_nan(cols[6]);
-			m_columns[SNOW].data[i] = col_or_nan(cols[11]);
-			m_columns[ALB].data[i] = col_or_nan(cols[10]);
+			m_columns[RH].data[i] = col_or_nan(tok, 3);
+			m_columns[PRES].data[i] = col_or_nan(tok, 6);
+			m_columns[SNOW].data[i] = col_or_nan(tok, 11);
+			m_columns[ALB].data[i] = col_or_nan(tok, 10);
 			m_columns[AOD].data[i] = -999; /* no AOD in SMW */
 
-			if (ifs.eof())
+			if (tok.eof())
 			{
 				m_message = "SMW: data line formatting error at record " + util::to_string(i);
 				return false;
@@ -1330,16 +1600,15 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 			for (;;)
 			{
-				getline(ifs, buf);
-				buf = trimboth(buf);
-				if (buf.length() == 0)
+				tok.next_line();
+				tok.trim_line();
+				if (tok.line_length() == 0)
 				{
 					m_message = "CSV: data line formatting error at record " + util::to_string(i);
 					return false;
 				}
 
-				auto cols = split(buf);
-				int ncols = (int)cols.size();
+				int ncols = (int)tok.split();
 				for (size_t k = 0; k < _MAXCOL_; k++)
 				{
 					if (m_columns[k].index >= 0
@@ -1347,14 +1616,14 @@ bool weatherfile::open(const std::string &file, bool header_only)
 					{
 						if (k == YEAR) {
 							try {
-								m_columns[k].data[i] = col_or_nan(trimboth(cols[m_columns[k].index]));
+								m_columns[k].data[i] = trimmed_col_or_nan(tok, m_columns[k].index);
 							}
 							catch (const std::exception& ) {
 								m_columns[k].data[i] = 1990;
 							}
 						}
 						else
-							m_columns[k].data[i] = col_or_nan(trimboth(cols[m_columns[k].index]));
+							m_columns[k].data[i] = trimmed_col_or_nan(tok, m_columns[k].index);
 					}
 				}
 
@@ -1614,13 +1883,13 @@ bool weatherfile::read_average(weather_record *r, std::vector<int> &cols, size_t
 }
 
 void weatherfile::start_hours_at_0() {
-    auto& hours =  m_columns[HOUR].data;
-    auto max_hr = *std::max_element(hours.begin(), hours.end());
-    auto min_hr = *std::min_element(hours.begin(), hours.end());
+    float *hours = m_columns[HOUR].data;
+    auto max_hr = *std::max_element(hours, hours + m_nRecords);
+    auto min_hr = *std::min_element(hours, hours + m_nRecords);
     if (max_hr - min_hr != 23)
         m_message = "Weather file hour range was not (0-23) or (1-24)";
     else if (max_hr == 24)
-        for (auto &i : hours) i -= 1.;
+        for (size_t i = 0; i < m_nRecords; i++) hours[i] -= 1.;
 }
 
 bool weatherfile::read( weather_record *r )
@@ -1659,6 +1928,208 @@ bool weatherfile::has_data_column( size_t id )
 	return m_columns[id].index >= 0;
 }
 
+/*
+Binary weather cache (.wfc) layout, in native byte order:
+	wfc_header
+	header strings: location, city, state, country, source, description, url, message,
+		each as a uint32_t length followed by the characters
+	zero padding up to data_offset
+	_MAXCOL_ columns of n_records floats, column_stride bytes apart
+data_offset and column_stride are multiples of 64 bytes so the columns can be used in place
+from the memory-mapped file.
+*/
+static const char wfc_magic[8] = { 'S', 'S', 'C', 'W', 'F', 'C', 0, 0 };
+static const uint32_t wfc_version = 1;
+static const size_t wfc_align = 64;
+
+struct wfc_header
+{
+	char magic[8];
+	uint32_t version;
+	int32_t type;
+	uint64_t source_hash;
+	uint64_t source_size;
+	uint64_t start_sec;
+	uint64_t step_sec;
+	uint64_t n_records;
+	double time;
+	double tz, lat, lon, elev;
+	int32_t start_year;
+	int32_t has_leap_year;
+	int32_t continuous_year;
+	int32_t hasunits;
+	int32_t n_columns;
+	int32_t column_index[weather_data_provider::_MAXCOL_];
+	uint64_t strings_size;
+	uint64_t data_offset;
+	uint64_t column_stride;
+};
+
+static size_t wfc_round_up(size_t n)
+{
+	return (n + wfc_align - 1) / wfc_align * wfc_align;
+}
+
+static std::mutex s_cache_dir_lock;
+static std::string s_cache_dir;
+
+void weatherfile::set_cache_dir(const std::string &dir)
+{
+	std::lock_guard<std::mutex> lock(s_cache_dir_lock);
+	s_cache_dir = dir;
+}
+
+std::string weatherfile::cache_dir()
+{
+	std::lock_guard<std::mutex> lock(s_cache_dir_lock);
+	return s_cache_dir;
+}
+
+std::string weatherfile::cache_file(const std::string &file)
+{
+	std::string dir = cache_dir();
+	if (dir.empty() || file.empty()) return std::string();
+
+	// files with the same name in different folders get different caches
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%016llx.wfc", content_hash(file.c_str(), file.length()));
+	return dir + util::path_separator() + util::name_only(file) + suffix;
+}
+
+bool weatherfile::read_cache(const std::string &cache_file, unsigned long long source_hash, unsigned long long source_size, bool validate)
+{
+	// map copy-on-write: start_hours_at_0 and handle_missing_field may adjust values in place
+	std::shared_ptr<util::mapped_file> map = std::make_shared<util::mapped_file>(cache_file, true);
+	if (!map->ok() || map->size() < sizeof(wfc_header))
+		return false;
+
+	wfc_header h;
+	memcpy(&h, map->data(), sizeof(h));
+	if (memcmp(h.magic, wfc_magic, sizeof(wfc_magic)) != 0
+		|| h.version != wfc_version
+		|| h.n_columns != _MAXCOL_)
+		return false;
+
+	if (validate && (h.source_hash != source_hash || h.source_size != source_size))
+		return false;
+
+	if (h.data_offset % wfc_align != 0
+		|| h.data_offset < sizeof(h) + h.strings_size
+		|| h.column_stride < h.n_records * sizeof(float)
+		|| h.data_offset + _MAXCOL_ * h.column_stride > map->size())
+		return false;
+
+	weather_header hdr;
+	std::string message;
+	std::string *strings[] = { &hdr.location, &hdr.city, &hdr.state, &hdr.country,
+		&hdr.source, &hdr.description, &hdr.url, &message };
+	const char *p = map->data() + sizeof(h);
+	const char *end = p + h.strings_size;
+	for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++)
+	{
+		uint32_t len;
+		if (end - p < (ptrdiff_t)sizeof(len)) return false;
+		memcpy(&len, p, sizeof(len));
+		p += sizeof(len);
+		if (end - p < (ptrdiff_t)len) return false;
+		strings[i]->assign(p, len);
+		p += len;
+	}
+	hdr.hasunits = h.hasunits != 0;
+	hdr.tz = h.tz;
+	hdr.lat = h.lat;
+	hdr.lon = h.lon;
+	hdr.elev = h.elev;
+
+	m_type = h.type;
+	m_hdr = hdr;
+	m_message = message;
+	m_startSec = (size_t)h.start_sec;
+	m_stepSec = (size_t)h.step_sec;
+	m_nRecords = (size_t)h.n_records;
+	m_time = h.time;
+	m_startYear = h.start_year;
+	m_hasLeapYear = h.has_leap_year != 0;
+	m_continuousYear = h.continuous_year != 0;
+	m_index = 0;
+
+	char *data = map->writable_data() + h.data_offset;
+	for (size_t i = 0; i < _MAXCOL_; i++)
+	{
+		m_columns[i].index = h.column_index[i];
+		m_columns[i].data = (float*)(data + i * h.column_stride);
+	}
+
+	m_data = map;
+	return true;
+}
+
+bool weatherfile::write_cache(const std::string &cache_file, unsigned long long source_hash, unsigned long long source_size)
+{
+	std::string strings;
+	const std::string *fields[] = { &m_hdr.location, &m_hdr.city, &m_hdr.state, &m_hdr.country,
+		&m_hdr.source, &m_hdr.description, &m_hdr.url, &m_message };
+	for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+	{
+		uint32_t len = (uint32_t)fields[i]->length();
+		strings.append((const char*)&len, sizeof(len));
+		strings.append(*fields[i]);
+	}
+
+	wfc_header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, wfc_magic, sizeof(wfc_magic));
+	h.version = wfc_version;
+	h.type = m_type;
+	h.source_hash = source_hash;
+	h.source_size = source_size;
+	h.start_sec = m_startSec;
+	h.step_sec = m_stepSec;
+	h.n_records = m_nRecords;
+	h.time = m_time;
+	h.tz = m_hdr.tz;
+	h.lat = m_hdr.lat;
+	h.lon = m_hdr.lon;
+	h.elev = m_hdr.elev;
+	h.start_year = m_startYear;
+	h.has_leap_year = m_hasLeapYear ? 1 : 0;
+	h.continuous_year = m_continuousYear ? 1 : 0;
+	h.hasunits = m_hdr.hasunits ? 1 : 0;
+	h.n_columns = _MAXCOL_;
+	for (size_t i = 0; i < _MAXCOL_; i++)
+		h.column_index[i] = m_columns[i].index;
+	h.strings_size = strings.length();
+	h.data_offset = wfc_round_up(sizeof(h) + strings.length());
+	h.column_stride = wfc_round_up(m_nRecords * sizeof(float));
+
+	return util::write_file_atomic(cache_file, [&](FILE *fp) {
+		std::vector<char> zeros(wfc_align, 0);
+		bool ok = fwrite(&h, sizeof(h), 1, fp) == 1
+			&& fwrite(strings.data(), 1, strings.length(), fp) == strings.length()
+			&& fwrite(zeros.data(), 1, h.data_offset - sizeof(h) - strings.length(), fp) == h.data_offset - sizeof(h) - strings.length();
+		for (size_t i = 0; ok && i < _MAXCOL_; i++)
+		{
+			size_t pad = h.column_stride - m_nRecords * sizeof(float);
+			ok = (m_nRecords == 0 || fwrite(m_columns[i].data, sizeof(float), m_nRecords, fp) == m_nRecords)
+				&& fwrite(zeros.data(), 1, pad, fp) == pad;
+		}
+		return ok;
+	});
+}
+
+bool weatherfile::convert_to_cache(const std::string &input, const std::string &output)
+{
+	weatherfile wf;
+	if (!wf.open(input) || !wf.m_columns[0].data)
+		return false;
+
+	util::mapped_file source(input);
+	if (!source.ok())
+		return false;
+
+	return wf.write_cache(output, content_hash(source.data(), source.size()), source.size());
+}
+
 bool weatherfile::convert_to_wfcsv( const std::string &input, const std::string &output )
 {
 	weatherfile wf( input );
@@ -27,6 +27,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <memory>
 
 
 
@@ -215,11 +216,20 @@ private:
 	struct column
 	{
 		int index; // used for wfcsv to get column index in CSV file from which to read
-		std::vector<float> data;
+		float *data; // m_nRecords values in the block owned by m_data
 	};
 	column m_columns[_MAXCOL_];
+	// owns the column values: a block filled by the parser or a mapped cache file.
+	// copies share it, so it is only written while this object is its sole owner
+	std::shared_ptr<void> m_data;
 
     void start_hours_at_0();
+	/// Gives this object its own copy of the column values before they are modified
+	void detach();
+
+	bool parse( const std::string &file, bool header_only );
+	bool read_cache( const std::string &cache_file, unsigned long long source_hash, unsigned long long source_size, bool validate );
+	bool write_cache( const std::string &cache_file, unsigned long long source_hash, unsigned long long source_size );
 
 public:
 	weatherfile();
@@ -227,6 +237,8 @@ public:
 	and read weather record information.
 	Calculates twet if missing*/
 	weatherfile( const std::string &file, bool header_only = false );
+	weatherfile( const weatherfile &rhs );
+	weatherfile &operator=( const weatherfile &rhs );
 	virtual ~weatherfile();
 
 	void reset();
@@ -248,6 +260,24 @@ public:
 	
 	static std::string normalize_city( const std::string &in );
 	static bool convert_to_wfcsv( const std::string &input, const std::string &output );
+
+	/* Binary column cache: when a cache directory is set, open() stores the parsed columns of each
+	weather file there and memory-maps them on later opens of the same, unchanged file instead of
+	parsing the text again. Empty (the default) disables caching. */
+	static void set_cache_dir( const std::string &dir );
+	static std::string cache_dir();
+	/// Name of the cache file used for a weather file in the current cache directory
+	static std::string cache_file( const std::string &file );
+	/// Parses a weather file and writes it as a binary cache (.wfc) file that open() reads directly
+	static bool convert_to_cache( const std::string &input, const std::string &output );
+
+	/* Shared memory cache: the file constructor keeps up to this many recently opened weather files
+	in memory, keyed by path, size and modification time, and later constructions of the same file
+	copy them. Copies share the column values, so each is only a read cursor over one loaded file.
+	Zero disables sharing. */
+	static void set_shared_cache_size( size_t n_files );
+	static size_t shared_cache_size();
+	static void clear_shared_cache();
 	
 };
 
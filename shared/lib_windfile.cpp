@@ -57,6 +57,12 @@ static void trim(std::string &buf)
 	  	buf.pop_back();
 }
 
+static void next_line(text_tokenizer &tok, std::string &buf)
+{
+	tok.next_line();
+	buf.assign(tok.line(), tok.line_length());
+}
+
 static int locate2(std::string buf, std::vector<std::string> &vstring, char delim)
 {
 	trim(buf);
@@ -267,12 +273,12 @@ windfile::windfile( const std::string &file )
 
 windfile::~windfile()
 {
-  	m_ifs.close();
+	m_tok.close();
 }
 
 bool windfile::ok()
 {
-  	return m_ifs.good();
+	return m_tok.ok() && !m_tok.eof();
 }
 
 
@@ -291,8 +297,7 @@ bool windfile::open( const std::string &file )
 		return false;
 		*/
 
-	m_ifs.open(file);
-	if (!m_ifs.good())
+	if (!m_tok.open(file))
 	{
 		m_errorMsg = "could not open file for reading: " + file;
 		return false;
@@ -301,14 +306,14 @@ bool windfile::open( const std::string &file )
 	/* read header information */
 	
 	// read line 1 (header info)
-	getline(m_ifs, m_buf);
+	next_line(m_tok, m_buf);
 	std::vector<std::string> cols;
 	int ncols = locate2(m_buf, cols, ',');
 
 	if (ncols < 8)
 	{
 		m_errorMsg = util::format("error reading header (line 1).  At least 8 columns required, %d found.", ncols);
-		m_ifs.close();
+		m_tok.close();
 		return false;
 	}
 
@@ -327,16 +332,16 @@ bool windfile::open( const std::string &file )
 	catch (const std::invalid_argument &) {/* nothing to do */ };
 
 	// read line 2, description
-	getline(m_ifs, desc);
+	next_line(m_tok, desc);
 	trim(desc);
 	
 	// read line 3, column names (must be pressure, temperature, speed, direction)
-	getline(m_ifs, m_buf);
+	next_line(m_tok, m_buf);
 	ncols = locate2( m_buf, cols, ',' );
 	if (ncols < 3)
 	{
 		m_errorMsg = util::format("too few data column types found: %d.  at least 3 required.", ncols);
-		m_ifs.close();
+		m_tok.close();
 		return false;
 	}
 	
@@ -354,7 +359,7 @@ bool windfile::open( const std::string &file )
 		else if ( ctype.length() > 0 )
 		{
 			m_errorMsg = util::format( "error reading data column type specifier in col %d of %d: '%s' len: %d", i+1, ncols, ctype.c_str(), ctype.length() );
-			m_ifs.close();
+			m_tok.close();
 			return false;
 		}
 	}
@@ -363,15 +368,15 @@ bool windfile::open( const std::string &file )
 
 
 	// read line 4, units for each column (ignore this for now)
-	getline(m_ifs, m_buf);
+	next_line(m_tok, m_buf);
 
 	// read line 5, height in meters for each data column
-	getline(m_ifs, m_buf);
+	next_line(m_tok, m_buf);
 	ncols = locate2( m_buf, cols, ',' );
 	if ( ncols < (int)m_heights.size() )
 	{
 		m_errorMsg = util::format("too few columns in the height row.  %d required but only %d found", (int)m_heights.size(), ncols);
-		m_ifs.close();
+		m_tok.close();
 		return false;
 	}
 
@@ -380,15 +385,7 @@ bool windfile::open( const std::string &file )
 	
 
 	// read all the lines to determine the nubmer of records in the file
-	m_nrec = 0;
-	while (getline(m_ifs, m_buf))
-		m_nrec++;
-
-	// rewind the file and reposition right after the header information
-	m_ifs.clear();
-	m_ifs.seekg(0);
-	for (size_t i = 0; i < 5; i++)
-		getline(m_ifs, m_buf);
+	m_nrec = m_tok.count_lines();
 
 	
 	// ready to read line-by-line.  subsequent columns of data correspond to the
@@ -399,7 +396,7 @@ bool windfile::open( const std::string &file )
 
 void windfile::close()
 {
-  	m_ifs.close();
+  	m_tok.close();
 
 	m_file.clear();
 	city.clear();
@@ -421,15 +418,21 @@ bool windfile::read_line( std::vector<double> &values )
 {
 	if ( !ok() ) return false;
 
-	std::vector<std::string> cols;
-	getline(m_ifs, m_buf);
-	int ncols = locate2(m_buf, cols, ',');
+	m_tok.next_line();
+	m_tok.trim_line("", "\r");
+	int ncols = (int)m_tok.split(',');
 	if (ncols >= (int)m_heights.size() 
 		&& ncols >= (int)m_dataid.size())
 	{
 		values.resize( m_heights.size(), 0.0 );
 		for (size_t i=0;i<m_heights.size();i++)
-			values[i] = stof( cols[i] );
+		{
+			float x;
+			if ( text_tokenizer::parse_float( m_tok.field(i), m_tok.field(i) + m_tok.field_length(i), &x ) )
+				values[i] = x;
+			else
+				values[i] = stof( m_tok.field_str(i) ); // throws for bad values, as before
+		}
 
 		return true;
 	}
@@ -24,8 +24,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __lib_windfile_h
 
 #include <string>
-#include <fstream>
 #include "lib_util.h"
+#include "lib_text_tokenizer.h"
 
 class winddata_provider
 {
@@ -87,7 +87,7 @@ protected:
 class windfile : public winddata_provider
 {
 private:
-  	std::ifstream m_ifs;
+	text_tokenizer m_tok;
 	std::string m_buf;
 	std::string m_file;
 	size_t m_nrec;
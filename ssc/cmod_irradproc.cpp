@@ -168,89 +168,58 @@ public:
 		ssc_number_t *p_sunrise = allocate("sunrise", count);
 		ssc_number_t *p_sunset = allocate("sunset", count);
 		
-		for (size_t i = 0; i < count ;i ++ )
+		irrad_batch batch;
+		batch.resize(count);
+		batch.radiationMode = irrad_mode == 1 ? irrad::DN_GH : (irrad_mode == 2 ? irrad::GH_DF : irrad::DN_DF);
+		batch.albedo.resize(count);
+		for (size_t i = 0; i < count; i++)
 		{
-			double t_cur = hour[i] + minute[i]/60.0;
-			double delt = 1.0;
-			if ( i == 0 )
-			{
-				double t_next = hour[i+1] + minute[i+1]/60.0;
-				if (t_cur > t_next) t_next += 24;
-				delt = t_next - t_cur;
-			}
-			else
-			{
-				double t_prev = hour[i-1] + minute[i-1]/60.0;
-				if (t_cur < t_prev) t_cur += 24;
-				delt = t_cur - t_prev;
-			}
-
-			// double precsion issue (15 digits IEEE 754) encountered by Anthony Lopez 4/29/13 for 
-			// minutes other than 15,30,45 and 60
-			if (fabs(delt-1.0)<1e-14) delt=1.0;
+			batch.year[i] = (int)year[i];
+			batch.month[i] = (int)month[i];
+			batch.day[i] = (int)day[i];
+			batch.hour[i] = (int)hour[i];
+			batch.minute[i] = minute[i];
+			if (glob != 0) batch.globalHorizontal[i] = glob[i];
+			if (beam != 0) batch.directNormal[i] = beam[i];
+			if (diff != 0) batch.diffuseHorizontal[i] = diff[i];
 
-			double alb = alb_const;
 			// if we have array of albedo values, use it
+			batch.albedo[i] = alb_const;
 			if ( albvec != 0  && albvec[i] >= 0 && albvec[i] <= (ssc_number_t)1.0)
-				alb = albvec[i];
-
-			irrad x;
-
-			x.set_time( (int)year[i], (int)month[i], (int)day[i], (int)hour[i], minute[i], IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET );
-			x.set_location( lat, lon, tz );
-			x.set_sky_model( sky_model, alb );
-			if ( irrad_mode == 1 ) x.set_global_beam( glob[i], beam[i] );
-			else if (irrad_mode == 2) x.set_global_diffuse(glob[i], diff[i]);
-			else x.set_beam_diffuse( beam[i], diff[i] );
-			x.set_surface( track_mode, tilt, azimuth, rotlim, en_backtrack, gcr, false, 0.0 ); //last two inputs are to force to a stow angle, which doesn't make sense for irradproc as a standalone cmod
-			
-			int code = x.calc();
-			if (code < 0)
-				throw general_error( util::format("irradiance processor issued error code %d", code ));
-
-			double solazi, solzen, solelv, soldec, sunrise, sunset;
-			int sunup;
+				batch.albedo[i] = albvec[i];
+		}
 
-			x.get_sun( &solazi,
-				&solzen,
-				&solelv,
-				&soldec,
-				&sunrise,
-				&sunset,
-				&sunup,
-				0,
-				0,
-				0 );
-			
-			p_azm[i] = (ssc_number_t) solazi;
-			p_zen[i] = (ssc_number_t) solzen;
-			p_elv[i] = (ssc_number_t) solelv;
-			p_dec[i] = (ssc_number_t) soldec;	
-			p_sunrise[i] = (ssc_number_t) sunrise;
-			p_sunset[i] = (ssc_number_t) sunset;
-			p_sunup[i] = (ssc_number_t) sunup;
-			
-			
-			double aoi, stilt, sazi, rot, btd;
-			x.get_angles( &aoi, &stilt, &sazi, &rot, &btd );
+		irrad x;
+		x.set_location( lat, lon, tz );
+		x.set_sky_model( sky_model, alb_const );
+		x.set_surface( track_mode, tilt, azimuth, rotlim, en_backtrack, gcr, false, 0.0 ); //last two inputs are to force to a stow angle, which doesn't make sense for irradproc as a standalone cmod
 
-			// assign outputs
-			p_inc[i] = (ssc_number_t) aoi;
-			p_surftilt[i] = (ssc_number_t) stilt;
-			p_surfazm[i] = (ssc_number_t) sazi;
-			p_rot[i] = (ssc_number_t) rot;
-			p_btdiff[i] = (ssc_number_t) btd;
-			
-			double beam, skydiff, gnddiff, iso, cir, hor;
-			x.get_poa( &beam, &skydiff, &gnddiff, &iso, &cir, &hor );
+		int code = x.calc_batch( batch, IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET );
+		if (code < 0)
+			throw general_error( util::format("irradiance processor issued error code %d", code ));
 
-			p_poa_beam[i] = (ssc_number_t) beam;
-			p_poa_skydiff[i] = (ssc_number_t) skydiff;
-			p_poa_gnddiff[i] = (ssc_number_t) gnddiff;
-			p_poa_skydiff_iso[i] = (ssc_number_t) iso;
-			p_poa_skydiff_cir[i] = (ssc_number_t) cir;
-			p_poa_skydiff_hor[i] = (ssc_number_t) hor;
-			
+		for (size_t i = 0; i < count ;i ++ )
+		{
+			p_azm[i] = (ssc_number_t) batch.sunAzimuth[i];
+			p_zen[i] = (ssc_number_t) batch.sunZenith[i];
+			p_elv[i] = (ssc_number_t) batch.sunElevation[i];
+			p_dec[i] = (ssc_number_t) batch.sunDeclination[i];
+			p_sunrise[i] = (ssc_number_t) batch.sunrise[i];
+			p_sunset[i] = (ssc_number_t) batch.sunset[i];
+			p_sunup[i] = (ssc_number_t) batch.sunUp[i];
+
+			p_inc[i] = (ssc_number_t) batch.angleOfIncidence[i];
+			p_surftilt[i] = (ssc_number_t) batch.surfaceTilt[i];
+			p_surfazm[i] = (ssc_number_t) batch.surfaceAzimuth[i];
+			p_rot[i] = (ssc_number_t) batch.axisRotation[i];
+			p_btdiff[i] = (ssc_number_t) batch.backtrackDifference[i];
+
+			p_poa_beam[i] = (ssc_number_t) batch.poaBeam[i];
+			p_poa_skydiff[i] = (ssc_number_t) batch.poaSkyDiffuse[i];
+			p_poa_gnddiff[i] = (ssc_number_t) batch.poaGroundDiffuse[i];
+			p_poa_skydiff_iso[i] = (ssc_number_t) batch.poaIsotropic[i];
+			p_poa_skydiff_cir[i] = (ssc_number_t) batch.poaCircumsolar[i];
+			p_poa_skydiff_hor[i] = (ssc_number_t) batch.poaHorizon[i];
 		}
 	}
 };
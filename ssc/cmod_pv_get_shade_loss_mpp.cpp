@@ -136,8 +136,10 @@ public:
 
 		if (num_strings > 0)
 		{
-			ShadeDB8_mpp db8;
-			db8.init();
+			std::shared_ptr<const ShadeDB8_mpp> db = ShadeDB8_mpp::shared();
+			if (!db->get_error().empty())
+				throw exec_error("pv_get_shade_loss_mpp", "failed to load the partial shading database: " + db->get_error());
+			const ShadeDB8_mpp &db8 = *db;
 
 			for (size_t irec = 0; irec < nrec; irec++)
 			{
@@ -20,6 +20,11 @@ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <tuple>
+
 #include "cmod_pvsamv1.h"
 #include "lib_pv_io_manager.h"
 #include "lib_resilience.h"
@@ -55,8 +60,11 @@ static var_info _cm_vtab_pvsamv1[] = {
     {SSC_INPUT, SSC_ARRAY,    "albedo",                               "User specified ground albedo",                        "0..1",   "",                                                                                                                                                                                      "Solar Resource",                                        "*",                                  "LENGTH=12",           "" },
     {SSC_INPUT, SSC_NUMBER,   "irrad_mode",                           "Irradiance input translation mode",                   "",       "0=beam&diffuse,1=total&beam,2=total&diffuse,3=poa_reference,4=poa_pyranometer",                                                                                                         "Solar Resource",                                        "?=0",                                "INTEGER,MIN=0,MAX=4", "" },
     {SSC_INPUT, SSC_NUMBER,   "sky_model",                            "Diffuse sky model",                                   "",       "0=isotropic,1=hkdr,2=perez",                                                                                                                                                            "Solar Resource",                                        "?=2",                                "INTEGER,MIN=0,MAX=2", "" },
+    {SSC_INPUT, SSC_NUMBER,   "irrad_threads",                        "Threads to calculate subarray irradiance",            "",       "1=each timestep in turn,0=one per processor,>1=the first year ahead of the timesteps on this many threads",                                                                             "Solar Resource",                                        "?=1",                                "INTEGER,MIN=0",       "" },
+    {SSC_INPUT, SSC_NUMBER,   "bifacial_ground_segments",             "Ground segments between rows for rear-side irradiance","",      "",                                                                                                                                                                                      "Solar Resource",                                        "?=100",                              "INTEGER,MIN=1",       "" },
     {SSC_INPUT, SSC_NUMBER,   "inverter_count",                       "Number of inverters",                                 "",       "",                                                                                                                                                                                      "System Design",                                         "*",                                  "INTEGER,POSITIVE",    "" },
     {SSC_INPUT, SSC_NUMBER,   "enable_mismatch_vmax_calc",            "Enable mismatched subarray Vmax calculation",         "",       "",                                                                                                                                                                                      "System Design",                                         "?=0",                                "BOOLEAN",             "" },
+    {SSC_INPUT, SSC_NUMBER,   "mismatch_search",                      "Mismatched subarray Vmax search method",              "",       "0=100 point voltage sweep,1=bracketed search with sweep fallback for multiple peaks",                                                                                                   "System Design",                                         "?=0",                                "INTEGER,MIN=0,MAX=1", "" },
 
 	  // subarray 1
     {SSC_INPUT, SSC_NUMBER,   "subarray1_nstrings",                   "Sub-array 1 Number of parallel strings",              "",       "",                                                                                                                                                                                      "System Design",                                         "",                                   "INTEGER",             "" },
@@ -68,6 +76,8 @@ static var_info _cm_vtab_pvsamv1[] = {
     {SSC_INPUT, SSC_NUMBER,   "subarray1_track_mode",                 "Sub-array 1 Tracking mode",                           "",       "0=fixed,1=1axis,2=2axis,3=azi,4=monthly",                                                                                                                                               "System Design",                                         "*",                                  "INTEGER,MIN=0,MAX=4", "" },
     {SSC_INPUT, SSC_NUMBER,   "subarray1_rotlim",                     "Sub-array 1 Tracker rotation limit",                  "deg",    "",                                                                                                                                                                                      "System Design",                                         "?=45",                               "MIN=0,MAX=85",        "" },
     {SSC_INPUT, SSC_NUMBER,   "subarray1_shade_mode",                 "Sub-array 1 shading mode (fixed tilt or 1x tracking)","0/1/2",  "0=none,1=standard(non-linear),2=thin film(linear)",                                                                                                                                     "Shading",                                               "*",                                  "INTEGER,MIN=0,MAX=2", "" },
+    {SSC_INPUT, SSC_NUMBER,   "subarray1_selfshade_table",            "Sub-array 1 self-shading sky diffuse from table",     "0/1",    "0=integrate at each tilt,1=interpolate precomputed tilt and GCR table",                                                                                                                 "Shading",                                               "?=0",                                "BOOLEAN",             "" },
+    {SSC_INPUT, SSC_NUMBER,   "subarray1_bifacial_table",             "Sub-array 1 tracker rear-side view factors from table", "0/1",    "0=compute at each tilt,1=interpolate precomputed 1 degree tilt table",                                                                                                                  "Solar Resource",                                        "?=0",                                "BOOLEAN",             "" },
     {SSC_INPUT, SSC_NUMBER,   "subarray1_gcr",                        "Sub-array 1 Ground coverage ratio",                   "0..1",   "",                                                                                                                                                                                      "System Design",                                         "?=0.3",                              "MIN=0.01,MAX=0.99",   "" },
     {SSC_INPUT, SSC_ARRAY,    "subarray1_monthly_tilt",               "Sub-array 1 monthly tilt input",                      "deg",    "",                                                                                                                                                                                      "System Design",                                         "subarray1_track_mode=4",             "LENGTH=12",           "" },
     {SSC_INPUT, SSC_NUMBER,   "subarray1_shading:string_option",      "Sub-array 1 shading string option",                   "",       "0=shadingdb,1=shadingdb_notc,2=average,3=maximum,4=minimum",                                                                                                                            "Shading",                                               "?=-1",                               "INTEGER,MIN=-1,MAX=4","" },
@@ -128,6 +138,8 @@ static var_info _cm_vtab_pvsamv1[] = {
     {SSC_INPUT, SSC_NUMBER,   "subarray2_track_mode",                 "Sub-array 2 Tracking mode",                           "",       "0=fixed,1=1axis,2=2axis,3=azi,4=monthly",                                                                                                                                               "System Design",                                         "subarray2_enable=1",                 "INTEGER,MIN=0,MAX=4", "" },
     {SSC_INPUT, SSC_NUMBER,   "subarray2_rotlim",                     "Sub-array 2 Tracker rotation limit",                  "deg",    "",                                                                                                                                                                                      "System Design",                                         "?=45",                               "MIN=0,MAX=85",        "" },
     {SSC_INPUT, SSC_NUMBER,   "subarray2_shade_mode",                 "Sub-array 2 Shading mode (fixed tilt or 1x tracking)","0/1/2",  "0=none,1=standard(non-linear),2=thin film(linear)",                                                                                                                                     "Shading",                                               "subarray2_enable=1",                 "INTEGER,MIN=0,MAX=2", "" },
+    {SSC_INPUT, SSC_NUMBER,   "subarray2_selfshade_table",            "Sub-array 2 self-shading sky diffuse from table",     "0/1",    "0=integrate at each tilt,1=interpolate precomputed tilt and GCR table",                                                                                                                 "Shading",                                               "?=0",                                "BOOLEAN",             "" },
+    {SSC_INPUT, SSC_NUMBER,   "subarray2_bifacial_table",             "Sub-array 2 tracker rear-side view factors from table", "0/1",    "0=compute at each tilt,1=interpolate precomputed 1 degree tilt table",                                                                                                                  "Solar Resource",                                        "?=0",                                "BOOLEAN",             "" },
     {SSC_INPUT, SSC_NUMBER,   "subarray2_gcr",                        "Sub-array 2 Ground coverage ratio",                   "0..1",   "",                                                                                                                                                                                      "System Design",                                         "?=0.3",                              "MIN=0.01,MAX=0.99",   "" },
     {SSC_INPUT, SSC_ARRAY,    "subarray2_monthly_tilt",               "Sub-array 2 Monthly tilt input",                      "deg",    "",                                                                                                                                                                                      "System Design",                                         "",                                   "LENGTH=12",           "" },
     {SSC_INPUT, SSC_NUMBER,   "subarray2_shading:string_option",      "Sub-array 2 Shading string option",                   "",       "0=shadingdb,1=shadingdb_notc,2=average,3=maximum,4=minimum",                                                                                                                            "Shading",                                               "?=-1",                               "INTEGER,MIN=-1,MAX=4","" },
@@ -152,6 +164,8 @@ static var_info _cm_vtab_pvsamv1[] = {
     { SSC_INPUT, SSC_NUMBER,   "subarray3_track_mode",                 "Sub-array 3 Tracking mode",                           "",       "0=fixed,1=1axis,2=2axis,3=azi,4=monthly",                                                                                                                                               "System Design",                                         "subarray3_enable=1",                 "INTEGER,MIN=0,MAX=4", "" },
     { SSC_INPUT, SSC_NUMBER,   "subarray3_rotlim",                     "Sub-array 3 Tracker rotation limit",                  "deg",    "",                                                                                                                                                                                      "System Design",                                         "?=45",                               "MIN=0,MAX=85",        "" },
     { SSC_INPUT, SSC_NUMBER,   "subarray3_shade_mode",                 "Sub-array 3 Shading mode (fixed tilt or 1x tracking)","0/1/2",  "0=none,1=standard(non-linear),2=thin film(linear)",                                                                                                                                     "Shading",                                               "subarray3_enable=1",                 "INTEGER,MIN=0,MAX=2", "" },
+    { SSC_INPUT, SSC_NUMBER,   "subarray3_selfshade_table",            "Sub-array 3 self-shading sky diffuse from table",     "0/1",    "0=integrate at each tilt,1=interpolate precomputed tilt and GCR table",                                                                                                                 "Shading",                                               "?=0",                                "BOOLEAN",             "" },
+    { SSC_INPUT, SSC_NUMBER,   "subarray3_bifacial_table",             "Sub-array 3 tracker rear-side view factors from table", "0/1",    "0=compute at each tilt,1=interpolate precomputed 1 degree tilt table",                                                                                                                  "Solar Resource",                                        "?=0",                                "BOOLEAN",             "" },
     { SSC_INPUT, SSC_NUMBER,   "subarray3_gcr",                        "Sub-array 3 Ground coverage ratio",                   "0..1",   "",                                                                                                                                                                                      "System Design",                                         "?=0.3",                              "MIN=0.01,MAX=0.99",   "" },
     { SSC_INPUT, SSC_ARRAY,    "subarray3_monthly_tilt",               "Sub-array 3 Monthly tilt input",                      "deg",    "",                                                                                                                                                                                      "System Design",                                         "",                                   "LENGTH=12",           "" },
     { SSC_INPUT, SSC_NUMBER,   "subarray3_shading:string_option",      "Sub-array 3 Shading string option",                   "",       "0=shadingdb,1=shadingdb_notc,2=average,3=maximum,4=minimum",                                                                                                                            "Shading",                                               "?=-1",                               "INTEGER,MIN=-1,MAX=4","" },
@@ -176,6 +190,8 @@ static var_info _cm_vtab_pvsamv1[] = {
     { SSC_INPUT, SSC_NUMBER,   "subarray4_track_mode",                 "Sub-array 4 Tracking mode",                           "",       "0=fixed,1=1axis,2=2axis,3=azi,4=monthly",                                                                                                                                               "System Design",                                         "subarray4_enable=1",                 "INTEGER,MIN=0,MAX=4", "" },
     { SSC_INPUT, SSC_NUMBER,   "subarray4_rotlim",                     "Sub-array 4 Tracker rotation limit",                  "deg",    "",                                                                                                                                                                                      "System Design",                                         "?=45",                               "MIN=0,MAX=85",        "" },
     { SSC_INPUT, SSC_NUMBER,   "subarray4_shade_mode",                 "Sub-array 4 shading mode (fixed tilt or 1x tracking)","0/1/2",  "0=none,1=standard(non-linear),2=thin film(linear)",                                                                                                                                     "Shading",                                               "subarray4_enable=1",                 "INTEGER,MIN=0,MAX=2", "" },
+    { SSC_INPUT, SSC_NUMBER,   "subarray4_selfshade_table",            "Sub-array 4 self-shading sky diffuse from table",     "0/1",    "0=integrate at each tilt,1=interpolate precomputed tilt and GCR table",                                                                                                                 "Shading",                                               "?=0",                                "BOOLEAN",             "" },
+    { SSC_INPUT, SSC_NUMBER,   "subarray4_bifacial_table",             "Sub-array 4 tracker rear-side view factors from table", "0/1",    "0=compute at each tilt,1=interpolate precomputed 1 degree tilt table",                                                                                                                  "Solar Resource",                                        "?=0",                                "BOOLEAN",             "" },
     { SSC_INPUT, SSC_NUMBER,   "subarray4_gcr",                        "Sub-array 4 Ground coverage ratio",                   "0..1",   "",                                                                                                                                                                                      "System Design",                                         "?=0.3",                              "MIN=0.01,MAX=0.99",   "" },
     { SSC_INPUT, SSC_ARRAY,    "subarray4_monthly_tilt",               "Sub-array 4 Monthly tilt input",                      "deg",    "",                                                                                                                                                                                      "System Design",                                         "",                                   "LENGTH=12",           "" },
     { SSC_INPUT, SSC_NUMBER,   "subarray4_shading:string_option",      "Sub-array 4 Shading string option",                   "",       "0=shadingdb,1=shadingdb_notc,2=average,3=maximum,4=minimum",                                                                                                                            "Shading",                                               "?=-1",                               "INTEGER,MIN=-1,MAX=4","" },
@@ -935,7 +951,7 @@ void cm_pvsamv1::exec( )
 	Irradiance_IO * Irradiance = IOManager->getIrradianceIO();
 	std::vector<Subarray_IO *> Subarrays = IOManager->getSubarrays();
 	PVSystem_IO * PVSystem = IOManager->getPVSystemIO();
-	ShadeDB8_mpp * shadeDatabase = IOManager->getShadeDatabase();
+	const ShadeDB8_mpp * shadeDatabase = IOManager->getShadeDatabase();
 
 	size_t nrec = Simulation->numberOfWeatherFileRecords;
 	size_t nlifetime = Simulation->numberOfSteps;
@@ -1001,6 +1017,31 @@ void cm_pvsamv1::exec( )
 		Subarrays[nn]->selfShadingInputs.row_space = b / Subarrays[nn]->groundCoverageRatio;
 	}
 
+	// REAR-SIDE VIEW FACTORS of each subarray geometry for bifacial modules, at each tilt of a fixed or seasonal tilt subarray, or over the rotation
+	// of a tracker when interpolating between tilts is enabled; otherwise a tracker's table is empty and calc_rear_side() computes the factors at each time step
+	if (Subarrays[0]->Module->isBifacial)
+	{
+		size_t groundSegments = (size_t)as_integer("bifacial_ground_segments");
+		for (size_t nn = 0; nn < num_subarrays; nn++)
+		{
+			if (!Subarrays[nn]->enable)
+				continue;
+			double slopeLength = Subarrays[nn]->selfShadingInputs.length * Subarrays[nn]->selfShadingInputs.nmody;
+			if (Subarrays[nn]->selfShadingInputs.mod_orient == 1)
+				slopeLength = Subarrays[nn]->selfShadingInputs.width * Subarrays[nn]->selfShadingInputs.nmody;
+
+			std::vector<double> tilts;
+			if (Subarrays[nn]->trackMode == irrad::FIXED_TILT)
+				tilts.push_back(Subarrays[nn]->tiltDegrees);
+			else if (Subarrays[nn]->trackMode == irrad::SEASONAL_TILT)
+				tilts = Subarrays[nn]->monthlyTiltDegrees;
+			else if (Subarrays[nn]->bifacialTrackerTable)
+				tilts = bifacial_view_factors::tilt_range(1.0);
+			Subarrays[nn]->bifacialViewFactors.setup(Subarrays[nn]->groundCoverageRatio, Subarrays[0]->Module->groundClearanceHeight, slopeLength,
+				Subarrays[nn]->trackMode == irrad::SINGLE_AXIS, tilts, groundSegments);
+		}
+	}
+
 	double nameplate_kw = 0;
 	for (size_t nn = 0; nn < num_subarrays; nn++)
 	{
@@ -1148,483 +1189,790 @@ void cm_pvsamv1::exec( )
 		dcStringVoltage.push_back(tmp);
 	}
 
-	//idx is the LIFETIME index in the (possibly subhourly) year of weather data, or the normal index in a non-annual array (lifetime is 1)
-	size_t idx = 0;
-	//for normal annual simulations, this works as expected. for non-annual weather data inputs, nyears is 1,
-	//so iyear will always be 0, meaning that timeseries outputs will be output for the entire length of nrec
-	for (size_t iyear = 0; iyear < nyears; iyear++)
+	// sun position, tracking, shading and soiling are the same in every year, so lifetime simulations calculate
+	// the irradiance on each subarray in the first year only. POA input modes are excluded because the
+	// POA decomposition carries state from one timestep to the next.
+	std::unique_ptr<PVIrradianceYear> irradianceYear;
+	if (nyears > 1 && radmode != irrad::POA_R && radmode != irrad::POA_P)
+		irradianceYear = std::unique_ptr<PVIrradianceYear>(new PVIrradianceYear(nrec, num_subarrays));
+
+	if (Subarrays[0]->Module->isBifacial)
+		bifaciality = Subarrays[0]->Module->bifaciality;
+
+	// irradiance incident on subarray nn in one timestep after shading, self-shading and soiling. the shading state is passed in
+	// so that each thread can work on its own copy, and messages are returned rather than logged so that they can be reported in
+	// timestep order. the weather file and calculated irradiance outputs are the same for every subarray, so only the caller that
+	// sets irradianceOutputs writes them.
+	auto subarrayIrradiance = [&](size_t nn, size_t iyear, size_t inrec, const weather_record &wf, bool irradianceOutputs,
+		shading_factor_calculator &shadeCalculator, sssky_diffuse_table &skyDiffuseTable, ssoutputs &selfShadingOutputs,
+		PVSubarrayStepIrradiance &step, std::vector<log_item> &messages)
 	{
-		for (size_t inrec = 0; inrec < nrec; inrec++)
+		auto message = [&messages](const std::string &text, int type, float time) { messages.push_back(log_item(type, text, time)); };
+
+		size_t idx = inrec + iyear * nrec;
+		size_t hour = wf.hour;
+		size_t hour_of_year = util::hour_of_year(wf.month, wf.day, wf.hour);
+
+		step = PVSubarrayStepIrradiance();
+		step.nonlinearDCShadingDerate = Subarrays[nn]->poa.nonlinearDCShadingDerate;
+
+		double solazi = 0, solzen = 0, solalt = 0, alb = 0;
+		int sunup = 0;
+		double ipoa = 0, ipoa_front = 0, ipoa_rear = 0, ipoa_rear_after_losses = 0;
+
+		irrad irr(wf, Irradiance->weatherHeader,
+			Irradiance->skyModel, Irradiance->radiationMode, Subarrays[nn]->trackMode,
+			Irradiance->useWeatherFileAlbedo, Irradiance->instantaneous, Subarrays[nn]->backtrackingEnabled, false,
+			Irradiance->dtHour, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->trackerRotationLimitDegrees, 0.0, Subarrays[nn]->groundCoverageRatio,
+			Subarrays[nn]->monthlyTiltDegrees, Irradiance->userSpecifiedMonthlyAlbedo,
+			Subarrays[nn]->poa.poaAll.get());
+
+		int code = irr.calc();
+
+		if (code < 0) //jmf updated 11/30/18 so that negative numbers are errors, positive numbers are warnings, 0 is everything correct. implemented in patch for POA model only, will be added to develop for other irrad models as well
+			throw exec_error("pvsamv1",
+			util::format("failed to calculate irradiance incident on surface (POA) %d (code: %d) [y:%d m:%d d:%d h:%d]",
+			nn + 1, code, wf.year, wf.month, wf.day, wf.hour));
+
+		if (code == 40)
+			message(util::format("SAM calculated negative direct normal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+				wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+		else if (code == 41)
+			message(util::format("SAM calculated negative diffuse horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+				wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+		else if (code == 42)
+			message(util::format("SAM calculated negative global horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+				wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+
+		// p_irrad_calc is only weather file records long...
+		if (iyear == 0 && irradianceOutputs)
 		{
-			idx = inrec + iyear * nrec;
-			if (!wdprov->read(&Irradiance->weatherRecord))
-				throw exec_error("pvsamv1", "could not read data line " + util::to_string((int)(inrec + 1)) + " in weather file");
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P) {
+				double gh_temp, df_temp, dn_temp;
+				gh_temp = df_temp = dn_temp = 0;
+				irr.get_irrad(&gh_temp, &dn_temp, &df_temp);
+				Irradiance->p_IrradianceCalculated[1][idx] = (ssc_number_t)df_temp;
+				Irradiance->p_IrradianceCalculated[2][idx] = (ssc_number_t)dn_temp;
+			}
+		}
+		// beam, skydiff, and grounddiff IN THE PLANE OF ARRAY (W/m2)
+		double ibeam, iskydiff, ignddiff;
+		double aoi, stilt, sazi, rot, btd;
+
+		// Ensure that the usePOAFromWF flag is false unless a reference cell has been used.
+		//  This will later get forced to false if any shading has been applied (in any scenario)
+		//  also this will also be forced to false if using the cec mcsp thermal model OR if using the spe module model with a diffuse util. factor < 1.0
+		bool usePOAFromWF = false;
+		if (radmode == irrad::POA_R){
+			ipoa = wf.poa;
+			usePOAFromWF = true;
+		}
+		else if (radmode == irrad::POA_P){
+			ipoa = wf.poa;
+		}
 
-			weather_record wf = Irradiance->weatherRecord;
-			size_t hour = wf.hour; //this is the current timestamp hour from 0-24 from the weather file
-			size_t hour_of_year = util::hour_of_year(wf.month, wf.day, wf.hour); //this is the index of the hour in the year (0-8759) given the weather file date & timestamp
+		if (Subarrays[nn]->Module->simpleEfficiencyForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){  // only will be true if using a poa model AND spe module model AND spe_fp is < 1
+			usePOAFromWF = false;
+			if (idx == 0)
+				message("The combination of POA irradiance as in input, single point efficiency module model, and module diffuse utilization factor less than one means that SAM must use a POA decomposition model to calculate the incident diffuse irradiance", SSC_WARNING, -1);
+		}
 
-			// report progress updates to the caller
-			ireport++;
-			if (ireport - ireplast > irepfreq)
+		if (Subarrays[nn]->Module->mountingSpecificCellTemperatureForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){
+			usePOAFromWF = false;
+			if (idx == 0)
+				message("The combination of POA irradiance as input and heat transfer method for cell temperature means that SAM must use a POA decomposition model to calculate the beam irradiance required by the cell temperature model", SSC_WARNING, -1);
+		}
+
+
+		// Get Incident angles and irradiances
+		irr.get_sun(&solazi, &solzen, &solalt, 0, 0, 0, &sunup, 0, 0, 0);
+		irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
+		irr.get_poa(&ibeam, &iskydiff, &ignddiff, 0, 0, 0);
+		alb = irr.getAlbedo();
+
+		if (iyear == 0 && irradianceOutputs)
+			Irradiance->p_sunPositionTime[idx] = (ssc_number_t)irr.get_sunpos_calc_hour();
+
+		// save weather file beam, diffuse, and global for output and for use later in pvsamv1- year 1 only
+		/*jmf 2016: these calculations are currently redundant with calculations in irrad.calc() because ibeam and idiff in that function are DNI and DHI, **NOT** in the plane of array
+		we'll have to fix this redundancy in the pvsamv1 rewrite. it will require allowing irradproc to report the errors below
+		and deciding what to do if the weather file DOES contain the third component but it's not being used in the calculations.*/
+		if (iyear == 0)
+		{
+			// Apply all irradiance component data from weather file (if it exists)
+			if (irradianceOutputs)
 			{
-				percent_complete = percent_baseline + 100.0f *(float)(idx) / (float)(insteps);
-				if (!update("", percent_complete))
-					throw exec_error("pvsamv1", "simulation canceled at hour " + util::to_string(hour_of_year + 1.0) + " in year " + util::to_string((int)iyear + 1) + "in dc loop");
-				ireplast = ireport;
+				Irradiance->p_weatherFilePOA[0][idx] = (ssc_number_t)wf.poa;
+				Irradiance->p_weatherFileDNI[idx] = (ssc_number_t)wf.dn;
+				Irradiance->p_weatherFileGHI[idx] = (ssc_number_t)(wf.gh);
+				Irradiance->p_weatherFileDHI[idx] = (ssc_number_t)(wf.df);
 			}
 
-			// Reset dcPower calculation for new timestep
-			dcPowerNetTotalSystem = 0;
-
-			//update POA data structure indicies if radmode is POA model is enabled
-			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-				for (size_t nn = 0; nn < num_subarrays; nn++){
-					if (!Subarrays[nn]->enable) continue;
+			// calculate beam if global & diffuse are selected as inputs
+			if (radmode == irrad::GH_DF)
+			{
+				ssc_number_t calculated = (ssc_number_t)((wf.gh - wf.df) / cos(solzen*3.1415926 / 180));
+				if (calculated < -1)
+				{
+					message(util::format("SAM calculated negative direct normal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
+						calculated, wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+					calculated = 0;
+				}
+				if (irradianceOutputs)
+					Irradiance->p_IrradianceCalculated[2][idx] = calculated;
+			}
 
-					Subarrays[nn]->poa.poaAll->tDew = wf.tdew;
-					Subarrays[nn]->poa.poaAll->i = inrec;
-					if (wf.hour == 0 && (inrec % step_per_hour == 0)) {
-						Subarrays[nn]->poa.poaAll->dayStart = inrec;
-						Subarrays[nn]->poa.poaAll->doy += 1;
-					}
+			// calculate global if beam & diffuse are selected as inputs
+			if (radmode == irrad::DN_DF)
+			{
+				ssc_number_t calculated = (ssc_number_t)(wf.df + wf.dn * cos(solzen*3.1415926 / 180));
+				if (calculated < -1)
+				{
+					message(util::format("SAM calculated negative global horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
+						calculated, wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+					calculated = 0;
 				}
+				if (irradianceOutputs)
+					Irradiance->p_IrradianceCalculated[0][idx] = calculated;
 			}
 
-			double solazi = 0, solzen = 0, solalt = 0;
-			int sunup = 0;
+			// calculate diffuse if total & beam are selected as inputs
+			if (radmode == irrad::DN_GH)
+			{
+				ssc_number_t calculated = (ssc_number_t)(wf.gh - wf.dn * cos(solzen*3.1415926 / 180));
+				if (calculated < -1)
+				{
+					message(util::format("SAM calculated negative diffuse horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
+						calculated, wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+					calculated = 0;
+				}
+				if (irradianceOutputs)
+					Irradiance->p_IrradianceCalculated[1][idx] = calculated;
+			}
+		}
 
-			// accumulators for radiation power (W) over this
-			// timestep from each subarray
-			double ts_accum_poa_front_nom = 0.0;
-			double ts_accum_poa_front_beam_nom = 0.0;
-			double ts_accum_poa_front_shaded = 0.0;
-			double ts_accum_poa_front_shaded_soiled = 0.0;
-			double ts_accum_poa_front_total = 0.0;
-			double ts_accum_poa_rear = 0.0;
-			double ts_accum_poa_rear_after_losses = 0.0;
-			double ts_accum_poa_total_eff = 0.0;
-			double ts_accum_poa_front_beam_eff = 0.0;
+		// record sub-array plane of array output before computing shading and soiling
+		if (iyear == 0 || save_full_lifetime_variables == 1)
+		{
+			if (radmode != irrad::POA_R)
+				PVSystem->p_poaNominalFront[nn][idx] = (ssc_number_t)((ibeam + iskydiff + ignddiff));
+			else
+				PVSystem->p_poaNominalFront[nn][idx] = (ssc_number_t)((ipoa));
+		}
 
-			// calculate incident irradiance on each subarray
-			std::vector<double> ipoa_rear, ipoa_rear_after_losses, ipoa_front, ipoa;
-			double alb;
-			alb = 0;
 
-			for (size_t nn = 0; nn < num_subarrays; nn++)
-			{
-				ipoa_rear.push_back(0);
-				ipoa_rear_after_losses.push_back(0);
-				ipoa_front.push_back(0);
-				ipoa.push_back(0);
+		// record sub-array contribution to total POA power for this time step  (W)
+		if (radmode != irrad::POA_R)
+			step.powerFrontNominal = (ibeam + iskydiff + ignddiff) * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+		else
+			step.powerFrontNominal = (ipoa)* ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 
-				if (!Subarrays[nn]->enable
-					|| Subarrays[nn]->nStrings < 1)
-					continue; // skip disabled subarrays
+		// record sub-array contribution to total POA beam power for this time step (W)
+		step.powerFrontBeamNominal = ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 
-				irrad irr(Irradiance->weatherRecord, Irradiance->weatherHeader,
-					Irradiance->skyModel, Irradiance->radiationMode, Subarrays[nn]->trackMode,
-					Irradiance->useWeatherFileAlbedo, Irradiance->instantaneous, Subarrays[nn]->backtrackingEnabled, false,
-					Irradiance->dtHour, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->trackerRotationLimitDegrees, 0.0, Subarrays[nn]->groundCoverageRatio,
-					Subarrays[nn]->monthlyTiltDegrees, Irradiance->userSpecifiedMonthlyAlbedo,
-					Subarrays[nn]->poa.poaAll.get());
+		// for non-linear shading from shading database
+		if (shadeCalculator.use_shade_db())
+		{
+			double shadedb_gpoa = ibeam + iskydiff + ignddiff;
+			double shadedb_dpoa = iskydiff + ignddiff;
 
-				int code = irr.calc();
+			// update cell temperature - unshaded value per Sara 1/25/16
+			double tcell = wf.tdry;
+			if (sunup > 0)
+			{
+				// calculate cell temperature using selected temperature model
+				pvinput_t in(ibeam, iskydiff, ignddiff, 0, ipoa,
+					wf.tdry, wf.tdew, wf.wspd, wf.wdir, wf.pres,
+					solzen, aoi, hdr.elev,
+					stilt, sazi,
+					((double)wf.hour) + wf.minute / 60.0,
+					radmode, usePOAFromWF);
+				// voltage set to -1 for max power
+				(*Subarrays[nn]->Module->cellTempModel)(in, *Subarrays[nn]->Module->moduleModel, -1.0, tcell);
+			}
+			double shadedb_str_vmp_stc = Subarrays[nn]->nModulesPerString * Subarrays[nn]->Module->voltageMaxPower;
+			double shadedb_mppt_lo = PVSystem->Inverter->mpptLowVoltage;
+			double shadedb_mppt_hi = PVSystem->Inverter->mpptHiVoltage;
 
-				if (code < 0) //jmf updated 11/30/18 so that negative numbers are errors, positive numbers are warnings, 0 is everything correct. implemented in patch for POA model only, will be added to develop for other irrad models as well
-					throw exec_error("pvsamv1",
-					util::format("failed to calculate irradiance incident on surface (POA) %d (code: %d) [y:%d m:%d d:%d h:%d]",
-					nn + 1, code, wf.year, wf.month, wf.day, wf.hour));
+			// shading database if necessary
+			if (!shadeCalculator.fbeam_shade_db(shadeDatabase, hour_of_year, wf.minute, solalt, solazi, shadedb_gpoa, shadedb_dpoa, tcell, Subarrays[nn]->nModulesPerString, shadedb_str_vmp_stc, shadedb_mppt_lo, shadedb_mppt_hi))
+			{
+				throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d", nn));
+			}
+			if (iyear == 0 || save_full_lifetime_variables == 1)
+			{
+#ifdef SHADE_DB_OUTPUTS
+				p_shadedb_gpoa[nn][idx] = (ssc_number_t)shadedb_gpoa;
+				p_shadedb_dpoa[nn][idx] = (ssc_number_t)shadedb_dpoa;
+				p_shadedb_pv_cell_temp[nn][idx] = (ssc_number_t)tcell;
+				p_shadedb_mods_per_str[nn][idx] = (ssc_number_t)Subarrays[nn]->nModulesPerString;
+				p_shadedb_str_vmp_stc[nn][idx] = (ssc_number_t)shadedb_str_vmp_stc;
+				p_shadedb_mppt_lo[nn][idx] = (ssc_number_t)shadedb_mppt_lo;
+				p_shadedb_mppt_hi[nn][idx] = (ssc_number_t)shadedb_mppt_hi;
+				message("shade db hour " + util::to_string((int)hour_of_year) +"\n" + shadeCalculator.get_warning(), SSC_NOTICE, -1);
+#endif
+				// fraction shaded for comparison
+				PVSystem->p_shadeDBShadeFraction[nn][idx] = (ssc_number_t)(shadeCalculator.dc_shade_factor());
+			}
+		}
+		else
+		{
+			if (!shadeCalculator.fbeam(hour_of_year, wf.minute, solalt, solazi))
+			{
+				throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d at index %d", nn, (float)idx));
+			}
+		}
 
-				if (code == 40)
-					log(util::format("SAM calculated negative direct normal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
-						wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-				else if (code == 41)
-					log(util::format("SAM calculated negative diffuse horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
-						wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-				else if (code == 42)
-					log(util::format("SAM calculated negative global horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+		// apply hourly shading factors to beam (if none enabled, factors are 1.0)
+		// shj 3/21/16 - update to handle negative shading loss
+		if (shadeCalculator.beam_shade_factor() != 1.0){
+			//							if (sa[nn].shad.beam_shade_factor() < 1.0){
+			// Sara 1/25/16 - shading database derate applied to dc only
+			// shading loss applied to beam if not from shading database
+			ibeam *= shadeCalculator.beam_shade_factor();
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+				usePOAFromWF = false;
+				if (Subarrays[nn]->poa.poaShadWarningCount == 0){
+					message(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
 						wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-
-				// p_irrad_calc is only weather file records long...
-				if (iyear == 0)
-				{
-					if (radmode == irrad::POA_R || radmode == irrad::POA_P) {
-						double gh_temp, df_temp, dn_temp;
-						gh_temp = df_temp = dn_temp = 0;
-						irr.get_irrad(&gh_temp, &dn_temp, &df_temp);
-						Irradiance->p_IrradianceCalculated[1][idx] = (ssc_number_t)df_temp;
-						Irradiance->p_IrradianceCalculated[2][idx] = (ssc_number_t)dn_temp;
-					}
-				}
-				// beam, skydiff, and grounddiff IN THE PLANE OF ARRAY (W/m2)
-				double ibeam, iskydiff, ignddiff;
-				double aoi, stilt, sazi, rot, btd;
-
-				// Ensure that the usePOAFromWF flag is false unless a reference cell has been used.
-				//  This will later get forced to false if any shading has been applied (in any scenario)
-				//  also this will also be forced to false if using the cec mcsp thermal model OR if using the spe module model with a diffuse util. factor < 1.0
-				Subarrays[nn]->poa.usePOAFromWF = false;
-				if (radmode == irrad::POA_R){
-					ipoa[nn] = wf.poa;
-					Subarrays[nn]->poa.usePOAFromWF = true;
 				}
-				else if (radmode == irrad::POA_P){
-					ipoa[nn] = wf.poa;
+				else{
+					message(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
+						wf.year, wf.month, wf.day, wf.hour), SSC_NOTICE, (float)idx);
 				}
+				Subarrays[nn]->poa.poaShadWarningCount++;
+			}
+		}
 
-				if (Subarrays[nn]->Module->simpleEfficiencyForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){  // only will be true if using a poa model AND spe module model AND spe_fp is < 1
-					Subarrays[nn]->poa.usePOAFromWF = false;
-					if (idx == 0)
-						log("The combination of POA irradiance as in input, single point efficiency module model, and module diffuse utilization factor less than one means that SAM must use a POA decomposition model to calculate the incident diffuse irradiance", SSC_WARNING);
-				}
+		// apply sky diffuse shading factor (specified as constant, nominally 1.0 if disabled in UI)
+		if (shadeCalculator.fdiff() < 1.0){
+			iskydiff *= shadeCalculator.fdiff();
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+				if (idx == 0)
+					message("Combining POA irradiance as input with the diffuse shading losses forces SAM to use a POA decomposition model to calculate incident diffuse irradiance", SSC_WARNING, -1);
+				usePOAFromWF = false;
+			}
+		}
 
-				if (Subarrays[nn]->Module->mountingSpecificCellTemperatureForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){
-					Subarrays[nn]->poa.usePOAFromWF = false;
-					if (idx == 0)
-						log("The combination of POA irradiance as input and heat transfer method for cell temperature means that SAM must use a POA decomposition model to calculate the beam irradiance required by the cell temperature model", SSC_WARNING);
-				}
+		double beam_shading_factor = shadeCalculator.beam_shade_factor();
 
+		//self-shading calculations
+		if (((Subarrays[nn]->trackMode == 0 || Subarrays[nn]->trackMode == 4) && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2)) //fixed tilt or timeseries tilt, self-shading (linear or non-linear) OR
+			|| (Subarrays[nn]->trackMode == 1 && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2))) //one-axis tracking (both backtracking and true tracking), self-shading (linear or non-linear)
+		{
 
-				// Get Incident angles and irradiances
-				irr.get_sun(&solazi, &solzen, &solalt, 0, 0, 0, &sunup, 0, 0, 0);
-				irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
-				irr.get_poa(&ibeam, &iskydiff, &ignddiff, 0, 0, 0);
-				alb = irr.getAlbedo();
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+				if (idx == 0)
+					message("Combining POA irradiance as input with self shading forces SAM to employ a POA decomposition model to calculate incident beam irradiance", SSC_WARNING, -1);
+				usePOAFromWF = false;
+			}
 
-				if (iyear == 0)
-					Irradiance->p_sunPositionTime[idx] = (ssc_number_t)irr.get_sunpos_calc_hour();
+			// info to be passed to self-shading function
+			bool trackbool = (Subarrays[nn]->trackMode == 1);	// 0 for fixed tilt and timeseries tilt, 1 for one-axis
+			bool linear = (Subarrays[nn]->shadeMode == 2); //0 for full self-shading, 1 for linear self-shading
+
+			//geometric fraction of the array that is shaded for one-axis trackers.
+			//USES A DIFFERENT FUNCTION THAN THE SELF-SHADING BECAUSE SS IS MEANT FOR FIXED ONLY. shadeFraction1x IS FOR TRUE-TRACKING ONE-AXIS TRACKERS ONLY.
+			//used in the non-linear self-shading calculator for one-axis tracking only
+			double shad1xf = 0.0;
+			if (trackbool && (Subarrays[nn]->backtrackingEnabled == false))
+				shad1xf = shadeFraction1x(solazi, solzen, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->groundCoverageRatio, rot);
+
+			//execute self-shading calculations
+			ssc_number_t beam_to_use; //some self-shading calculations require DNI, NOT ibeam (beam in POA). Need to know whether to use DNI from wf or calculated, depending on radmode
+			ssc_number_t dhi_to_use; //some self-shading calculations require DHI, NOT iskydiff (sky diff in POA). Need to know whether to use DHI from wf or calculated, depending on radmode
+			if (radmode == irrad::DN_DF || radmode == irrad::DN_GH) beam_to_use = (ssc_number_t)wf.dn;
+			else beam_to_use = Irradiance->p_IrradianceCalculated[2][hour * step_per_hour]; // top of hour in first year
+			if (radmode == irrad::DN_DF || radmode == irrad::GH_DF) dhi_to_use = (ssc_number_t)wf.df;
+			else dhi_to_use = Irradiance->p_IrradianceCalculated[1][hour * step_per_hour]; // top of hour in first year
+
+				if (ss_exec(Subarrays[nn]->selfShadingInputs,
+				        stilt, sazi, solzen, solazi, beam_to_use, dhi_to_use, ibeam, iskydiff, ignddiff, alb, trackbool, linear, shad1xf,
+				        skyDiffuseTable,
+				        selfShadingOutputs))
+			{
 
-				// save weather file beam, diffuse, and global for output and for use later in pvsamv1- year 1 only
-				/*jmf 2016: these calculations are currently redundant with calculations in irrad.calc() because ibeam and idiff in that function are DNI and DHI, **NOT** in the plane of array
-				we'll have to fix this redundancy in the pvsamv1 rewrite. it will require allowing irradproc to report the errors below
-				and deciding what to do if the weather file DOES contain the third component but it's not being used in the calculations.*/
-				if (iyear == 0)
+				if (linear && trackbool) //one-axis linear
 				{
-					// Apply all irradiance component data from weather file (if it exists)
-					Irradiance->p_weatherFilePOA[0][idx] = (ssc_number_t)wf.poa;
-					Irradiance->p_weatherFileDNI[idx] = (ssc_number_t)wf.dn;
-					Irradiance->p_weatherFileGHI[idx] = (ssc_number_t)(wf.gh);
-					Irradiance->p_weatherFileDHI[idx] = (ssc_number_t)(wf.df);
-
-					// calculate beam if global & diffuse are selected as inputs
-					if (radmode == irrad::GH_DF)
-					{
-						Irradiance->p_IrradianceCalculated[2][idx] = (ssc_number_t)((wf.gh - wf.df) / cos(solzen*3.1415926 / 180));
-						if (Irradiance->p_IrradianceCalculated[2][idx] < -1)
-						{
-							log(util::format("SAM calculated negative direct normal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
-								Irradiance->p_IrradianceCalculated[2][idx], wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-							Irradiance->p_IrradianceCalculated[2][idx] = 0;
-						}
-					}
+                            ibeam *= (1 - shad1xf); //derate beam irradiance linearly by the geometric shading fraction calculated above per Chris Deline 2/10/16
+                            beam_shading_factor *= (1 - shad1xf);
+                            // Sky diffuse and ground-reflected diffuse are derated according to C. Deline's algorithm
+                            iskydiff *= selfShadingOutputs.m_diffuse_derate;
+                            ignddiff *= selfShadingOutputs.m_reflected_derate;
 
-					// calculate global if beam & diffuse are selected as inputs
-					if (radmode == irrad::DN_DF)
-					{
-						Irradiance->p_IrradianceCalculated[0][idx] = (ssc_number_t)(wf.df + wf.dn * cos(solzen*3.1415926 / 180));
-						if (Irradiance->p_IrradianceCalculated[0][idx] < -1)
-						{
-							log(util::format("SAM calculated negative global horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
-								Irradiance->p_IrradianceCalculated[0][idx], wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-							Irradiance->p_IrradianceCalculated[0][idx] = 0;
-						}
-					}
+                            if (iyear == 0 || save_full_lifetime_variables == 1)
+                            {
+                                PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
+                                PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - shad1xf);
+                                PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)selfShadingOutputs.m_diffuse_derate;
+                                PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)selfShadingOutputs.m_reflected_derate;
+                            }
+                        }
 
-					// calculate diffuse if total & beam are selected as inputs
-					if (radmode == irrad::DN_GH)
+				else if (linear) //fixed tilt linear
+				{
+					ibeam *= (1 - selfShadingOutputs.m_shade_frac_fixed);
+					beam_shading_factor *= (1 - selfShadingOutputs.m_shade_frac_fixed);
+					iskydiff *= selfShadingOutputs.m_diffuse_derate;
+                            ignddiff *= selfShadingOutputs.m_reflected_derate;
+
+					if (iyear == 0 || save_full_lifetime_variables == 1)
 					{
-						Irradiance->p_IrradianceCalculated[1][idx] = (ssc_number_t)(wf.gh - wf.dn * cos(solzen*3.1415926 / 180));
-						if (Irradiance->p_IrradianceCalculated[1][idx] < -1)
-						{
-							log(util::format("SAM calculated negative diffuse horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
-								Irradiance->p_IrradianceCalculated[1][idx], wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-							Irradiance->p_IrradianceCalculated[1][idx] = 0;
-						}
+						PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
+						PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - selfShadingOutputs.m_shade_frac_fixed);
+						PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)selfShadingOutputs.m_diffuse_derate;
+						PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)selfShadingOutputs.m_reflected_derate;
 					}
 				}
 
-				// record sub-array plane of array output before computing shading and soiling
-				if (iyear == 0 || save_full_lifetime_variables == 1)
-				{
-					if (radmode != irrad::POA_R)
-						PVSystem->p_poaNominalFront[nn][idx] = (ssc_number_t)((ibeam + iskydiff + ignddiff));
-					else
-						PVSystem->p_poaNominalFront[nn][idx] = (ssc_number_t)((ipoa[nn]));
-				}
-
-
-				// record sub-array contribution to total POA power for this time step  (W)
-				if (radmode != irrad::POA_R)
-					ts_accum_poa_front_nom += (ibeam + iskydiff + ignddiff) * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-				else
-					ts_accum_poa_front_nom += (ipoa[nn])* ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-
-				// record sub-array contribution to total POA beam power for this time step (W)
-				ts_accum_poa_front_beam_nom += ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-
-				// for non-linear shading from shading database
-				if (Subarrays[nn]->shadeCalculator.use_shade_db())
+				else if (trackbool && (Subarrays[nn]->backtrackingEnabled == true)) //non-linear backtracking one-axis
 				{
-					double shadedb_gpoa = ibeam + iskydiff + ignddiff;
-					double shadedb_dpoa = iskydiff + ignddiff;
-
-					// update cell temperature - unshaded value per Sara 1/25/16
-					double tcell = wf.tdry;
-					if (sunup > 0)
-					{
-						// calculate cell temperature using selected temperature model
-						pvinput_t in(ibeam, iskydiff, ignddiff, 0, ipoa[nn],
-							wf.tdry, wf.tdew, wf.wspd, wf.wdir, wf.pres,
-							solzen, aoi, hdr.elev,
-							stilt, sazi,
-							((double)wf.hour) + wf.minute / 60.0,
-							radmode, Subarrays[nn]->poa.usePOAFromWF);
-						// voltage set to -1 for max power
-						(*Subarrays[nn]->Module->cellTempModel)(in, *Subarrays[nn]->Module->moduleModel, -1.0, tcell);
-					}
-					double shadedb_str_vmp_stc = Subarrays[nn]->nModulesPerString * Subarrays[nn]->Module->voltageMaxPower;
-					double shadedb_mppt_lo = PVSystem->Inverter->mpptLowVoltage;
-					double shadedb_mppt_hi = PVSystem->Inverter->mpptHiVoltage;
+					iskydiff *= selfShadingOutputs.m_diffuse_derate;
+					ignddiff *= selfShadingOutputs.m_reflected_derate;
 
-					// shading database if necessary
-					if (!Subarrays[nn]->shadeCalculator.fbeam_shade_db(shadeDatabase, hour_of_year, wf.minute, solalt, solazi, shadedb_gpoa, shadedb_dpoa, tcell, Subarrays[nn]->nModulesPerString, shadedb_str_vmp_stc, shadedb_mppt_lo, shadedb_mppt_hi))
-					{
-						throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d", nn));
-					}
 					if (iyear == 0 || save_full_lifetime_variables == 1)
 					{
-#ifdef SHADE_DB_OUTPUTS
-						p_shadedb_gpoa[nn][idx] = (ssc_number_t)shadedb_gpoa;
-						p_shadedb_dpoa[nn][idx] = (ssc_number_t)shadedb_dpoa;
-						p_shadedb_pv_cell_temp[nn][idx] = (ssc_number_t)tcell;
-						p_shadedb_mods_per_str[nn][idx] = (ssc_number_t)Subarrays[nn]->nModulesPerString;
-						p_shadedb_str_vmp_stc[nn][idx] = (ssc_number_t)shadedb_str_vmp_stc;
-						p_shadedb_mppt_lo[nn][idx] = (ssc_number_t)shadedb_mppt_lo;
-						p_shadedb_mppt_hi[nn][idx] = (ssc_number_t)shadedb_mppt_hi;
-						log("shade db hour " + util::to_string((int)hour_of_year) +"\n" + shadeCalculator->get_warning());
-#endif
-						// fraction shaded for comparison
-						PVSystem->p_shadeDBShadeFraction[nn][idx] = (ssc_number_t)(Subarrays[nn]->shadeCalculator.dc_shade_factor());
+						PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
+                                PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)1;
+						PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)selfShadingOutputs.m_diffuse_derate;
+						PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)selfShadingOutputs.m_reflected_derate;
 					}
 				}
-				else
+
+				else //non-linear: fixed tilt AND one-axis true-tracking
 				{
-					if (!Subarrays[nn]->shadeCalculator.fbeam(hour_of_year, wf.minute, solalt, solazi))
+                            // Beam is not derated- all beam derate effects (linear and non-linear) are taken into account in the nonlinear_dc_shading_derate
+					step.nonlinearDCShadingDerate = selfShadingOutputs.m_dc_derate;
+
+					iskydiff *= selfShadingOutputs.m_diffuse_derate;
+					ignddiff *= selfShadingOutputs.m_reflected_derate;
+
+					if (iyear == 0 || save_full_lifetime_variables == 1)
 					{
-						throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d at index %d", nn, (float)idx));
+						PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)selfShadingOutputs.m_diffuse_derate;
+						PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)selfShadingOutputs.m_reflected_derate;
+						PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)selfShadingOutputs.m_dc_derate;
+						PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)1;
 					}
 				}
+			}
+			else
+				throw exec_error("pvsamv1", util::format("Self-shading calculation failed at %d", (int)idx));
+		}
 
-				// apply hourly shading factors to beam (if none enabled, factors are 1.0)
-				// shj 3/21/16 - update to handle negative shading loss
-				if (Subarrays[nn]->shadeCalculator.beam_shade_factor() != 1.0){
-					//							if (sa[nn].shad.beam_shade_factor() < 1.0){
-					// Sara 1/25/16 - shading database derate applied to dc only
-					// shading loss applied to beam if not from shading database
-					ibeam *= Subarrays[nn]->shadeCalculator.beam_shade_factor();
-					if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-						Subarrays[nn]->poa.usePOAFromWF = false;
-						if (Subarrays[nn]->poa.poaShadWarningCount == 0){
-							log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
-								wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-						}
-						else{
-							log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
-								wf.year, wf.month, wf.day, wf.hour), SSC_NOTICE, (float)idx);
-						}
-						Subarrays[nn]->poa.poaShadWarningCount++;
-					}
-				}
+			double poashad = (radmode == irrad::POA_R) ? ipoa : (ibeam + iskydiff + ignddiff);
 
-				// apply sky diffuse shading factor (specified as constant, nominally 1.0 if disabled in UI)
-				if (Subarrays[nn]->shadeCalculator.fdiff() < 1.0){
-					iskydiff *= Subarrays[nn]->shadeCalculator.fdiff();
-					if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-						if (idx == 0)
-							log("Combining POA irradiance as input with the diffuse shading losses forces SAM to use a POA decomposition model to calculate incident diffuse irradiance", SSC_WARNING);
-						Subarrays[nn]->poa.usePOAFromWF = false;
-					}
-				}
+		// determine sub-array contribution to total shaded plane of array for this hour
+		step.powerFrontShaded = poashad * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 
-				double beam_shading_factor = Subarrays[nn]->shadeCalculator.beam_shade_factor();
+		// apply soiling derate to all components of irradiance
+		double soiling_factor = 1.0;
+		int month_idx = wf.month - 1;
+		if (month_idx >= 0 && month_idx < 12)
+		{
+			soiling_factor = Subarrays[nn]->monthlySoiling[month_idx];
+			ibeam *= soiling_factor;
+			iskydiff *= soiling_factor;
+			ignddiff *= soiling_factor;
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+				ipoa *= soiling_factor;
+				if (soiling_factor < 1 && idx == 0)
+					message("Soiling may already be accounted for in the input POA data. Please confirm that the input data does not contain soiling effects, or remove the additional losses on the Losses page.", SSC_WARNING, -1);
+			}
+			beam_shading_factor *= soiling_factor;
+		}
 
-				//self-shading calculations
-				if (((Subarrays[nn]->trackMode == 0 || Subarrays[nn]->trackMode == 4) && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2)) //fixed tilt or timeseries tilt, self-shading (linear or non-linear) OR
-					|| (Subarrays[nn]->trackMode == 1 && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2))) //one-axis tracking (both backtracking and true tracking), self-shading (linear or non-linear)
-				{
+		// Calculate total front irradiation after soiling added to shading
+		ipoa_front = ibeam + iskydiff + ignddiff;
+		step.powerFrontShadedSoiled = ipoa_front * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 
-					if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-						if (idx == 0)
-							log("Combining POA irradiance as input with self shading forces SAM to employ a POA decomposition model to calculate incident beam irradiance", SSC_WARNING);
-						Subarrays[nn]->poa.usePOAFromWF = false;
-					}
+		// Calculate rear-side irradiance for bifacial modules
+		if (Subarrays[0]->Module->isBifacial)
+		{
+			irr.calc_rear_side(Subarrays[0]->Module->bifacialTransmissionFactor, Subarrays[nn]->bifacialViewFactors);
+			ipoa_rear = irr.get_poa_rear();
+			ipoa_rear_after_losses = ipoa_rear * (1 - Subarrays[nn]->rearIrradianceLossPercent);
+		}
 
-					// info to be passed to self-shading function
-					bool trackbool = (Subarrays[nn]->trackMode == 1);	// 0 for fixed tilt and timeseries tilt, 1 for one-axis
-					bool linear = (Subarrays[nn]->shadeMode == 2); //0 for full self-shading, 1 for linear self-shading
-
-					//geometric fraction of the array that is shaded for one-axis trackers.
-					//USES A DIFFERENT FUNCTION THAN THE SELF-SHADING BECAUSE SS IS MEANT FOR FIXED ONLY. shadeFraction1x IS FOR TRUE-TRACKING ONE-AXIS TRACKERS ONLY.
-					//used in the non-linear self-shading calculator for one-axis tracking only
-					double shad1xf = 0.0;
-					if (trackbool && (Subarrays[nn]->backtrackingEnabled == false))
-						shad1xf = shadeFraction1x(solazi, solzen, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->groundCoverageRatio, rot);
-
-					//execute self-shading calculations
-					ssc_number_t beam_to_use; //some self-shading calculations require DNI, NOT ibeam (beam in POA). Need to know whether to use DNI from wf or calculated, depending on radmode
-					ssc_number_t dhi_to_use; //some self-shading calculations require DHI, NOT iskydiff (sky diff in POA). Need to know whether to use DHI from wf or calculated, depending on radmode
-					if (radmode == irrad::DN_DF || radmode == irrad::DN_GH) beam_to_use = (ssc_number_t)wf.dn;
-					else beam_to_use = Irradiance->p_IrradianceCalculated[2][hour * step_per_hour]; // top of hour in first year
-					if (radmode == irrad::DN_DF || radmode == irrad::GH_DF) dhi_to_use = (ssc_number_t)wf.df;
-					else dhi_to_use = Irradiance->p_IrradianceCalculated[1][hour * step_per_hour]; // top of hour in first year
-
-						if (ss_exec(Subarrays[nn]->selfShadingInputs,
-						        stilt, sazi, solzen, solazi, beam_to_use, dhi_to_use, ibeam, iskydiff, ignddiff, alb, trackbool, linear, shad1xf,
-						        Subarrays[nn]->selfShadingSkyDiffTable,
-						        Subarrays[nn]->selfShadingOutputs))
-					{
+		step.powerRear = ipoa_rear * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 
-						if (linear && trackbool) //one-axis linear
-						{
-                            ibeam *= (1 - shad1xf); //derate beam irradiance linearly by the geometric shading fraction calculated above per Chris Deline 2/10/16
-                            beam_shading_factor *= (1 - shad1xf);
-                            // Sky diffuse and ground-reflected diffuse are derated according to C. Deline's algorithm
-                            iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-                            ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
+		if (iyear == 0 || save_full_lifetime_variables == 1)
+		{
+			// save sub-array level outputs
+			PVSystem->p_poaShadedFront[nn][idx] = (ssc_number_t)poashad;
+			PVSystem->p_poaShadedSoiledFront[nn][idx] = (ssc_number_t)ipoa_front;
+			PVSystem->p_poaBeamFront[nn][idx] = (ssc_number_t)ibeam;
+			PVSystem->p_poaDiffuseFront[nn][idx] = (ssc_number_t)(iskydiff + ignddiff);
+			PVSystem->p_poaRear[nn][idx] = (ssc_number_t)(ipoa_rear_after_losses);
+			PVSystem->p_beamShadingFactor[nn][idx] = (ssc_number_t)beam_shading_factor;
+			PVSystem->p_axisRotation[nn][idx] = (ssc_number_t)rot;
+			PVSystem->p_idealRotation[nn][idx] = (ssc_number_t)(rot - btd);
+			PVSystem->p_angleOfIncidence[nn][idx] = (ssc_number_t)aoi;
+			PVSystem->p_surfaceTilt[nn][idx] = (ssc_number_t)stilt;
+			PVSystem->p_surfaceAzimuth[nn][idx] = (ssc_number_t)sazi;
+			PVSystem->p_derateSoiling[nn][idx] = (ssc_number_t)soiling_factor;
+		}
 
-                            if (iyear == 0 || save_full_lifetime_variables == 1)
-                            {
-                                PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
-                                PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - shad1xf);
-                                PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-                                PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-                            }
-                        }
+		// accumulate incident total radiation (W) in this timestep (all subarrays)
+		step.powerFrontBeamEff = ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+
+		// save the required irradiance inputs on array plane for the module output calculations.
+		step.poaBeamFront = ibeam;
+		step.poaDiffuseFront = iskydiff;
+		step.poaGroundFront = ignddiff;
+		step.poaRear = ipoa_rear_after_losses;
+		step.poaTotal = (radmode == irrad::POA_R) ? ipoa :(ipoa_front + ipoa_rear_after_losses * bifaciality);
+		step.poaInput = ipoa;
+		step.poaFrontAfterSoiling = ipoa_front;
+		step.angleOfIncidence = aoi;
+		step.sunUp = sunup;
+		step.surfaceTilt = stilt;
+		step.surfaceAzimuth = sazi;
+		step.dcShadeFactor = shadeCalculator.dc_shade_factor();
+		step.usePOAFromWF = usePOAFromWF;
+		step.sunAzimuth = solazi;
+		step.sunZenith = solzen;
+		step.sunAltitude = solalt;
+		step.albedo = alb;
+	};
+
+	// sums the irradiance power on the enabled subarrays in subarray order, with the sun position of the last of them
+	auto combineIrradiance = [&](const PVSubarrayStepIrradiance *steps, double *totals)
+	{
+		for (int i = 0; i < PVIrradianceYear::N_TIMESTEP_VALUES; i++)
+			totals[i] = 0;
 
-						else if (linear) //fixed tilt linear
-						{
-							ibeam *= (1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
-							beam_shading_factor *= (1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
-							iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-                            ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
+		for (size_t nn = 0; nn < num_subarrays; nn++)
+		{
+			if (!Subarrays[nn]->enable
+				|| Subarrays[nn]->nStrings < 1)
+				continue;
+
+			const PVSubarrayStepIrradiance &step = steps[nn];
+			totals[PVIrradianceYear::SUN_AZIMUTH] = step.sunAzimuth;
+			totals[PVIrradianceYear::SUN_ZENITH] = step.sunZenith;
+			totals[PVIrradianceYear::SUN_ALTITUDE] = step.sunAltitude;
+			totals[PVIrradianceYear::SUN_UP] = step.sunUp;
+			totals[PVIrradianceYear::ALBEDO] = step.albedo;
+			totals[PVIrradianceYear::ACCUM_FRONT_NOMINAL] += step.powerFrontNominal;
+			totals[PVIrradianceYear::ACCUM_FRONT_BEAM_NOMINAL] += step.powerFrontBeamNominal;
+			totals[PVIrradianceYear::ACCUM_FRONT_SHADED] += step.powerFrontShaded;
+			totals[PVIrradianceYear::ACCUM_FRONT_SHADED_SOILED] += step.powerFrontShadedSoiled;
+			totals[PVIrradianceYear::ACCUM_REAR] += step.powerRear;
+			totals[PVIrradianceYear::ACCUM_REAR_AFTER_LOSSES] = totals[PVIrradianceYear::ACCUM_REAR] * (1 - Subarrays[nn]->rearIrradianceLossPercent);
+			totals[PVIrradianceYear::ACCUM_FRONT_BEAM_EFF] += step.powerFrontBeamEff;
+		}
+	};
+
+	// with more than one thread, the irradiance of the first year is calculated ahead of the timestep loop, which replays it.
+	// each thread takes one subarray over part of the year. the first day is calculated in turn beforehand because self-shading
+	// reads the beam and diffuse calculated at the top of each hour of that day. self-shaded subarrays whose tilt changes keep
+	// their year on one thread, because the sky diffuse table stores the derate of the first tilt that rounds to each entry.
+	// the shading database is shared by all subarrays and POA input modes carry state between timesteps, so both keep the
+	// calculation in the timestep loop.
+	bool irradiancePrecalculated = false;
+	bool useShadeDatabase = false;
+	std::vector<size_t> enabledSubarrays;
+	for (size_t nn = 0; nn < num_subarrays; nn++)
+	{
+		if (!Subarrays[nn]->enable
+			|| Subarrays[nn]->nStrings < 1)
+			continue;
+		enabledSubarrays.push_back(nn);
+		if (Subarrays[nn]->shadeCalculator.use_shade_db())
+			useShadeDatabase = true;
+	}
+	size_t irradianceThreads = (Simulation->irradianceThreads > 0) ? (size_t)Simulation->irradianceThreads : (size_t)std::thread::hardware_concurrency();
 
-							if (iyear == 0 || save_full_lifetime_variables == 1)
-							{
-								PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
-								PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
-								PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-								PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-							}
-						}
+	if (irradianceThreads > 1 && !enabledSubarrays.empty() && !useShadeDatabase && radmode != irrad::POA_R && radmode != irrad::POA_P)
+	{
+		if (!irradianceYear)
+			irradianceYear = std::unique_ptr<PVIrradianceYear>(new PVIrradianceYear(nrec, num_subarrays));
+		irradiancePrecalculated = true;
 
-						else if (trackbool && (Subarrays[nn]->backtrackingEnabled == true)) //non-linear backtracking one-axis
-						{
-							iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-							ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
+		std::vector<weather_record> records(nrec);
+		for (size_t inrec = 0; inrec < nrec; inrec++)
+			if (!wdprov->read(&records[inrec]))
+				throw exec_error("pvsamv1", "could not read data line " + util::to_string((int)(inrec + 1)) + " in weather file");
+		wdprov->rewind();
 
-							if (iyear == 0 || save_full_lifetime_variables == 1)
-							{
-								PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
-                                PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)1;
-								PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-								PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-							}
-						}
+		std::vector<PVSubarrayStepIrradiance> steps(nrec * num_subarrays);
+		size_t outputSubarray = enabledSubarrays[0];
 
-						else //non-linear: fixed tilt AND one-axis true-tracking
-						{
-                            // Beam is not derated- all beam derate effects (linear and non-linear) are taken into account in the nonlinear_dc_shading_derate
-							Subarrays[nn]->poa.nonlinearDCShadingDerate = Subarrays[nn]->selfShadingOutputs.m_dc_derate;
+		std::vector<log_item> messages;
+		size_t nrecFirstDay = std::min(nrec, 24 * step_per_hour);
+		for (size_t inrec = 0; inrec < nrecFirstDay; inrec++)
+		{
+			for (size_t nn : enabledSubarrays)
+			{
+				subarrayIrradiance(nn, 0, inrec, records[inrec], nn == outputSubarray,
+					Subarrays[nn]->shadeCalculator, Subarrays[nn]->selfShadingSkyDiffTable, Subarrays[nn]->selfShadingOutputs,
+					steps[inrec * num_subarrays + nn], messages);
+				for (size_t i = 0; i < messages.size(); i++)
+					log(messages[i].text, messages[i].type, messages[i].time);
+				messages.clear();
+			}
+		}
 
-							iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-							ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
+		struct irradiance_task
+		{
+			size_t nn, begin, end;
+			std::vector<std::pair<size_t, log_item>> messages;
+			std::exception_ptr error;
+			size_t errorRecord;
+		};
+
+		std::vector<irradiance_task> tasks;
+		size_t nchunks = std::max((size_t)1, irradianceThreads / enabledSubarrays.size());
+		for (size_t nn : enabledSubarrays)
+		{
+			size_t n = nchunks;
+			if (Subarrays[nn]->shadeMode != Subarray_IO::NO_SHADING && Subarrays[nn]->trackMode != irrad::FIXED_TILT)
+				n = 1;
+			for (size_t chunk = 0; chunk < n; chunk++)
+			{
+				irradiance_task task;
+				task.nn = nn;
+				task.begin = nrecFirstDay + (nrec - nrecFirstDay) * chunk / n;
+				task.end = nrecFirstDay + (nrec - nrecFirstDay) * (chunk + 1) / n;
+				task.errorRecord = nrec;
+				if (task.begin < task.end)
+					tasks.push_back(task);
+			}
+		}
 
-							if (iyear == 0 || save_full_lifetime_variables == 1)
-							{
-								PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-								PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-								PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_dc_derate;
-								PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)1;
-							}
-						}
-					}
-					else
-						throw exec_error("pvsamv1", util::format("Self-shading calculation failed at %d", (int)idx));
+		auto runTask = [&](irradiance_task &task)
+		{
+			size_t nn = task.nn;
+			shading_factor_calculator shadeCalculator = Subarrays[nn]->shadeCalculator;
+			sssky_diffuse_table skyDiffuseTable = Subarrays[nn]->selfShadingSkyDiffTable;
+			ssoutputs selfShadingOutputs = Subarrays[nn]->selfShadingOutputs;
+			std::vector<log_item> stepMessages;
+			for (size_t inrec = task.begin; inrec < task.end && !task.error; inrec++)
+			{
+				try
+				{
+					subarrayIrradiance(nn, 0, inrec, records[inrec], nn == outputSubarray,
+						shadeCalculator, skyDiffuseTable, selfShadingOutputs, steps[inrec * num_subarrays + nn], stepMessages);
 				}
+				catch (...)
+				{
+					task.error = std::current_exception();
+					task.errorRecord = inrec;
+				}
+				for (size_t i = 0; i < stepMessages.size(); i++)
+					task.messages.push_back(std::make_pair(inrec, stepMessages[i]));
+				stepMessages.clear();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < tasks.size(); i++)
+			threads.push_back(std::thread(runTask, std::ref(tasks[i])));
+		if (!tasks.empty())
+			runTask(tasks[0]);
+		for (size_t i = 0; i < threads.size(); i++)
+			threads[i].join();
+
+		// report messages in the order the timestep loop would, up to the first error
+		const irradiance_task *failed = 0;
+		for (size_t i = 0; i < tasks.size(); i++)
+			if (tasks[i].error && (!failed || tasks[i].errorRecord < failed->errorRecord
+				|| (tasks[i].errorRecord == failed->errorRecord && tasks[i].nn < failed->nn)))
+				failed = &tasks[i];
+
+		std::vector<std::tuple<size_t, size_t, const log_item*>> ordered;
+		for (size_t i = 0; i < tasks.size(); i++)
+			for (size_t j = 0; j < tasks[i].messages.size(); j++)
+				ordered.push_back(std::make_tuple(tasks[i].messages[j].first, tasks[i].nn, &tasks[i].messages[j].second));
+		std::stable_sort(ordered.begin(), ordered.end(), [](const std::tuple<size_t, size_t, const log_item*> &a, const std::tuple<size_t, size_t, const log_item*> &b)
+			{ return std::get<0>(a) < std::get<0>(b) || (std::get<0>(a) == std::get<0>(b) && std::get<1>(a) < std::get<1>(b)); });
+		for (size_t i = 0; i < ordered.size(); i++)
+		{
+			if (failed && (std::get<0>(ordered[i]) > failed->errorRecord
+				|| (std::get<0>(ordered[i]) == failed->errorRecord && std::get<1>(ordered[i]) > failed->nn)))
+				break;
+			const log_item *item = std::get<2>(ordered[i]);
+			log(item->text, item->type, item->time);
+		}
+		if (failed)
+			std::rethrow_exception(failed->error);
 
-					double poashad = (radmode == irrad::POA_R) ? ipoa[nn] : (ibeam + iskydiff + ignddiff);
+		PVIrradianceYear &year = *irradianceYear;
+		double totals[PVIrradianceYear::N_TIMESTEP_VALUES];
+		for (size_t inrec = 0; inrec < nrec; inrec++)
+		{
+			combineIrradiance(&steps[inrec * num_subarrays], totals);
+			for (int i = 0; i < PVIrradianceYear::N_TIMESTEP_VALUES; i++)
+				year.timestep(i, inrec) = totals[i];
+			for (size_t nn = 0; nn < num_subarrays; nn++)
+				year.record(nn, inrec, steps[inrec * num_subarrays + nn]);
+		}
+	}
 
-				// determine sub-array contribution to total shaded plane of array for this hour
-				ts_accum_poa_front_shaded += poashad * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+	// irradiance on each subarray in the current timestep
+	std::vector<PVSubarrayStepIrradiance> stepIrradiance(num_subarrays);
+	std::vector<double> ipoa_rear_after_losses(num_subarrays), ipoa_front(num_subarrays), ipoa(num_subarrays), dcShadeFactor(num_subarrays);
+	std::vector<log_item> messages;
 
-				// apply soiling derate to all components of irradiance
-				double soiling_factor = 1.0;
-				int month_idx = wf.month - 1;
-				if (month_idx >= 0 && month_idx < 12)
-				{
-					soiling_factor = Subarrays[nn]->monthlySoiling[month_idx];
-					ibeam *= soiling_factor;
-					iskydiff *= soiling_factor;
-					ignddiff *= soiling_factor;
-					if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-						ipoa[nn] *= soiling_factor;
-						if (soiling_factor < 1 && idx == 0)
-							log("Soiling may already be accounted for in the input POA data. Please confirm that the input data does not contain soiling effects, or remove the additional losses on the Losses page.", SSC_WARNING);
+	//idx is the LIFETIME index in the (possibly subhourly) year of weather data, or the normal index in a non-annual array (lifetime is 1)
+	size_t idx = 0;
+	//for normal annual simulations, this works as expected. for non-annual weather data inputs, nyears is 1,
+	//so iyear will always be 0, meaning that timeseries outputs will be output for the entire length of nrec
+	for (size_t iyear = 0; iyear < nyears; iyear++)
+	{
+		for (size_t inrec = 0; inrec < nrec; inrec++)
+		{
+			idx = inrec + iyear * nrec;
+			if (!wdprov->read(&Irradiance->weatherRecord))
+				throw exec_error("pvsamv1", "could not read data line " + util::to_string((int)(inrec + 1)) + " in weather file");
+
+			weather_record wf = Irradiance->weatherRecord;
+			size_t hour = wf.hour; //this is the current timestamp hour from 0-24 from the weather file
+			size_t hour_of_year = util::hour_of_year(wf.month, wf.day, wf.hour); //this is the index of the hour in the year (0-8759) given the weather file date & timestamp
+
+			// report progress updates to the caller
+			ireport++;
+			if (ireport - ireplast > irepfreq)
+			{
+				percent_complete = percent_baseline + 100.0f *(float)(idx) / (float)(insteps);
+				if (!update("", percent_complete))
+					throw exec_error("pvsamv1", "simulation canceled at hour " + util::to_string(hour_of_year + 1.0) + " in year " + util::to_string((int)iyear + 1) + "in dc loop");
+				ireplast = ireport;
+			}
+
+			// Reset dcPower calculation for new timestep
+			dcPowerNetTotalSystem = 0;
+
+			//update POA data structure indicies if radmode is POA model is enabled
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+				for (size_t nn = 0; nn < num_subarrays; nn++){
+					if (!Subarrays[nn]->enable) continue;
+
+					Subarrays[nn]->poa.poaAll->tDew = wf.tdew;
+					Subarrays[nn]->poa.poaAll->i = inrec;
+					if (wf.hour == 0 && (inrec % step_per_hour == 0)) {
+						Subarrays[nn]->poa.poaAll->dayStart = inrec;
+						Subarrays[nn]->poa.poaAll->doy += 1;
 					}
-					beam_shading_factor *= soiling_factor;
 				}
+			}
 
-				// Calculate total front irradiation after soiling added to shading
-				ipoa_front[nn] = ibeam + iskydiff + ignddiff;
-				ts_accum_poa_front_shaded_soiled += ipoa_front[nn] * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+			// accumulators for radiation power (W) over this
+			// timestep from each subarray
+			double ts_accum_poa_front_total = 0.0;
+			double ts_accum_poa_total_eff = 0.0;
+			double totals[PVIrradianceYear::N_TIMESTEP_VALUES];
+
+			// after the first year of a lifetime simulation, or in every year if the first year was calculated ahead
+			// of the timestep loop, replay the irradiance of the first year
+			bool replay_irradiance = irradianceYear && (iyear > 0 || irradiancePrecalculated);
+			if (replay_irradiance)
+			{
+				PVIrradianceYear &year = *irradianceYear;
+				for (int i = 0; i < PVIrradianceYear::N_TIMESTEP_VALUES; i++)
+					totals[i] = year.timestep(i, inrec);
 
-				// Calculate rear-side irradiance for bifacial modules
-				if (Subarrays[0]->Module->isBifacial)
+				for (size_t nn = 0; nn < num_subarrays; nn++)
 				{
-					bifaciality = Subarrays[0]->Module->bifaciality;
-					double slopeLength = Subarrays[nn]->selfShadingInputs.length * Subarrays[nn]->selfShadingInputs.nmody;
-					if (Subarrays[nn]->selfShadingInputs.mod_orient == 1) {
-						slopeLength = Subarrays[nn]->selfShadingInputs.width * Subarrays[nn]->selfShadingInputs.nmody;
-					}
-					irr.calc_rear_side(Subarrays[0]->Module->bifacialTransmissionFactor, Subarrays[0]->Module->groundClearanceHeight, slopeLength);
-					ipoa_rear[nn] = irr.get_poa_rear();
-					ipoa_rear_after_losses[nn] = ipoa_rear[nn] * (1 - Subarrays[nn]->rearIrradianceLossPercent);
+					stepIrradiance[nn] = year.replay(nn, inrec);
+
+					if (iyear == 0
+						|| !Subarrays[nn]->enable
+						|| Subarrays[nn]->nStrings < 1
+						|| save_full_lifetime_variables != 1)
+						continue;
+
+					// the first-year outputs hold the same values
+					PVSystem->p_poaNominalFront[nn][idx] = PVSystem->p_poaNominalFront[nn][inrec];
+					if (Subarrays[nn]->shadeCalculator.use_shade_db())
+						PVSystem->p_shadeDBShadeFraction[nn][idx] = PVSystem->p_shadeDBShadeFraction[nn][inrec];
+					PVSystem->p_derateSelfShading[nn][idx] = PVSystem->p_derateSelfShading[nn][inrec];
+					PVSystem->p_derateLinear[nn][idx] = PVSystem->p_derateLinear[nn][inrec];
+					PVSystem->p_derateSelfShadingDiffuse[nn][idx] = PVSystem->p_derateSelfShadingDiffuse[nn][inrec];
+					PVSystem->p_derateSelfShadingReflected[nn][idx] = PVSystem->p_derateSelfShadingReflected[nn][inrec];
+					PVSystem->p_poaShadedFront[nn][idx] = PVSystem->p_poaShadedFront[nn][inrec];
+					PVSystem->p_poaShadedSoiledFront[nn][idx] = PVSystem->p_poaShadedSoiledFront[nn][inrec];
+					PVSystem->p_poaBeamFront[nn][idx] = PVSystem->p_poaBeamFront[nn][inrec];
+					PVSystem->p_poaDiffuseFront[nn][idx] = PVSystem->p_poaDiffuseFront[nn][inrec];
+					PVSystem->p_poaRear[nn][idx] = PVSystem->p_poaRear[nn][inrec];
+					PVSystem->p_beamShadingFactor[nn][idx] = PVSystem->p_beamShadingFactor[nn][inrec];
+					PVSystem->p_axisRotation[nn][idx] = PVSystem->p_axisRotation[nn][inrec];
+					PVSystem->p_idealRotation[nn][idx] = PVSystem->p_idealRotation[nn][inrec];
+					PVSystem->p_angleOfIncidence[nn][idx] = PVSystem->p_angleOfIncidence[nn][inrec];
+					PVSystem->p_surfaceTilt[nn][idx] = PVSystem->p_surfaceTilt[nn][inrec];
+					PVSystem->p_surfaceAzimuth[nn][idx] = PVSystem->p_surfaceAzimuth[nn][inrec];
+					PVSystem->p_derateSoiling[nn][idx] = PVSystem->p_derateSoiling[nn][inrec];
 				}
+			}
+			else
+			{
+				// calculate incident irradiance on each subarray
+				for (size_t nn = 0; nn < num_subarrays; nn++)
+				{
+					stepIrradiance[nn] = PVSubarrayStepIrradiance();
+					if (!Subarrays[nn]->enable
+						|| Subarrays[nn]->nStrings < 1)
+						continue; // skip disabled subarrays
+
+					subarrayIrradiance(nn, iyear, inrec, wf, true,
+						Subarrays[nn]->shadeCalculator, Subarrays[nn]->selfShadingSkyDiffTable, Subarrays[nn]->selfShadingOutputs,
+						stepIrradiance[nn], messages);
+					for (size_t i = 0; i < messages.size(); i++)
+						log(messages[i].text, messages[i].type, messages[i].time);
+					messages.clear();
+				}
+				combineIrradiance(&stepIrradiance[0], totals);
 
-				ts_accum_poa_rear += ipoa_rear[nn] * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-				ts_accum_poa_rear_after_losses = ts_accum_poa_rear * (1 - Subarrays[nn]->rearIrradianceLossPercent);
+				if (irradianceYear && iyear == 0)
+				{
+					PVIrradianceYear &year = *irradianceYear;
+					for (int i = 0; i < PVIrradianceYear::N_TIMESTEP_VALUES; i++)
+						year.timestep(i, inrec) = totals[i];
+					for (size_t nn = 0; nn < num_subarrays; nn++)
+						year.record(nn, inrec, stepIrradiance[nn]);
+				}
+			}
 
-				if (iyear == 0 || save_full_lifetime_variables == 1)
+			double solazi = totals[PVIrradianceYear::SUN_AZIMUTH];
+			double solzen = totals[PVIrradianceYear::SUN_ZENITH];
+			double solalt = totals[PVIrradianceYear::SUN_ALTITUDE];
+			int sunup = (int)totals[PVIrradianceYear::SUN_UP];
+			double alb = totals[PVIrradianceYear::ALBEDO];
+			double ts_accum_poa_front_nom = totals[PVIrradianceYear::ACCUM_FRONT_NOMINAL];
+			double ts_accum_poa_front_beam_nom = totals[PVIrradianceYear::ACCUM_FRONT_BEAM_NOMINAL];
+			double ts_accum_poa_front_shaded = totals[PVIrradianceYear::ACCUM_FRONT_SHADED];
+			double ts_accum_poa_front_shaded_soiled = totals[PVIrradianceYear::ACCUM_FRONT_SHADED_SOILED];
+			double ts_accum_poa_rear_after_losses = totals[PVIrradianceYear::ACCUM_REAR_AFTER_LOSSES];
+			double ts_accum_poa_front_beam_eff = totals[PVIrradianceYear::ACCUM_FRONT_BEAM_EFF];
+
+			// save the required irradiance inputs on array plane for the module output calculations
+			for (size_t nn = 0; nn < num_subarrays; nn++)
+			{
+				const PVSubarrayStepIrradiance &step = stepIrradiance[nn];
+				ipoa[nn] = step.poaInput;
+				ipoa_front[nn] = step.poaFrontAfterSoiling;
+				ipoa_rear_after_losses[nn] = step.poaRear;
+
+				if (!Subarrays[nn]->enable
+					|| Subarrays[nn]->nStrings < 1)
 				{
-					// save sub-array level outputs
-					PVSystem->p_poaShadedFront[nn][idx] = (ssc_number_t)poashad;
-					PVSystem->p_poaShadedSoiledFront[nn][idx] = (ssc_number_t)ipoa_front[nn];
-					PVSystem->p_poaBeamFront[nn][idx] = (ssc_number_t)ibeam;
-					PVSystem->p_poaDiffuseFront[nn][idx] = (ssc_number_t)(iskydiff + ignddiff);
-					PVSystem->p_poaRear[nn][idx] = (ssc_number_t)(ipoa_rear_after_losses[nn]);
-					PVSystem->p_beamShadingFactor[nn][idx] = (ssc_number_t)beam_shading_factor;
-					PVSystem->p_axisRotation[nn][idx] = (ssc_number_t)rot;
-					PVSystem->p_idealRotation[nn][idx] = (ssc_number_t)(rot - btd);
-					PVSystem->p_angleOfIncidence[nn][idx] = (ssc_number_t)aoi;
-					PVSystem->p_surfaceTilt[nn][idx] = (ssc_number_t)stilt;
-					PVSystem->p_surfaceAzimuth[nn][idx] = (ssc_number_t)sazi;
-					PVSystem->p_derateSoiling[nn][idx] = (ssc_number_t)soiling_factor;
+					dcShadeFactor[nn] = Subarrays[nn]->shadeCalculator.dc_shade_factor();
+					continue;
 				}
 
-				// accumulate incident total radiation (W) in this timestep (all subarrays)
-				ts_accum_poa_front_beam_eff += ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-
-				// save the required irradiance inputs on array plane for the module output calculations.
-				Subarrays[nn]->poa.poaBeamFront = ibeam;
-				Subarrays[nn]->poa.poaDiffuseFront = iskydiff;
-				Subarrays[nn]->poa.poaGroundFront = ignddiff;
-				Subarrays[nn]->poa.poaRear = ipoa_rear_after_losses[nn];
-				Subarrays[nn]->poa.poaTotal = (radmode == irrad::POA_R) ? ipoa[nn] :(ipoa_front[nn] + ipoa_rear_after_losses[nn] * bifaciality);
-				Subarrays[nn]->poa.angleOfIncidenceDegrees = aoi;
-				Subarrays[nn]->poa.sunUp = sunup;
-				Subarrays[nn]->poa.surfaceTiltDegrees = stilt;
-				Subarrays[nn]->poa.surfaceAzimuthDegrees = sazi;
+				dcShadeFactor[nn] = step.dcShadeFactor;
+				Subarrays[nn]->poa.poaBeamFront = step.poaBeamFront;
+				Subarrays[nn]->poa.poaDiffuseFront = step.poaDiffuseFront;
+				Subarrays[nn]->poa.poaGroundFront = step.poaGroundFront;
+				Subarrays[nn]->poa.poaRear = step.poaRear;
+				Subarrays[nn]->poa.poaTotal = step.poaTotal;
+				Subarrays[nn]->poa.sunUp = step.sunUp != 0;
+				Subarrays[nn]->poa.angleOfIncidenceDegrees = step.angleOfIncidence;
+				Subarrays[nn]->poa.surfaceTiltDegrees = step.surfaceTilt;
+				Subarrays[nn]->poa.surfaceAzimuthDegrees = step.surfaceAzimuth;
+				Subarrays[nn]->poa.nonlinearDCShadingDerate = step.nonlinearDCShadingDerate;
+				Subarrays[nn]->poa.usePOAFromWF = step.usePOAFromWF;
 			}
 
 			std::vector<double> mpptVoltageClipping; //a vector to store power that is clipped due to the inverter MPPT low & high voltage limits for each subarray
@@ -1652,10 +2000,14 @@ void cm_pvsamv1::exec( )
 					double vmax = PVSystem->Inverter->mpptHiVoltage; //the upper MPPT range of the inverter is the high end for string voltages that it will control
 					double vmin = PVSystem->Inverter->mpptLowVoltage; //the lower MPPT range of the inverter is the low end for string voltages that it will control
 					const int NP = 100; //number of points in between max and min voltage to sweep
-					double Pmax = 0; //variable to store the maximum power for comparison between different points along the voltage sweep
-					// sweep voltage, calculating current for each subarray, add all subarray currents together at each voltage
-					for (int i = 0; i < NP; i++)
+
+					//total power of all strings on this MPPT input at point i of the voltage sweep, evaluated at most once per point
+					std::vector<double> sweepPower(NP, -1);
+					auto mpptInputPower = [&](int i)
 					{
+						if (sweepPower[i] >= 0)
+							return sweepPower[i];
+
 						double stringV = vmin + (vmax - vmin)*i / ((double)NP); //voltage of a string at this point in the voltage sweep
 
 						//if the voltage is ok, continue to calculate total power on this MPPT input at this voltage
@@ -1686,15 +2038,62 @@ void cm_pvsamv1::exec( )
 							//add the power from this subarray to the total power
 							P += V * out.Current * (double)Subarrays[nn]->nModulesPerString * (double)Subarrays[nn]->nStrings;
 						}
+						sweepPower[i] = P;
+						return P;
+					};
+
+					//the bracketed search samples every tenth sweep point. if those samples rise to a single peak and then fall, the curve is
+					//treated as unimodal and the maximum is located by bisecting on the sign of the power difference between neighboring
+					//sweep points around the peak sample, which finds the same sweep point as the full sweep in about a fifth of the evaluations.
+					//curves with more than one peak among the samples fall back to the full sweep.
+					bool sweep = true;
+					int iMax = -1;
+					if (PVSystem->mismatchSearch == MISMATCH_BRACKETED)
+					{
+						const int stride = 10;
+						int iPeak = 0;
+						bool falling = false;
+						sweep = false;
+						for (int i = stride; i < NP && !sweep; i += stride)
+						{
+							double dP = mpptInputPower(i) - mpptInputPower(i - stride);
+							if (dP < 0) falling = true;
+							else if (dP > 0 && falling) sweep = true; //a second peak
+							if (mpptInputPower(i) > mpptInputPower(iPeak)) iPeak = i;
+						}
 
-						//check if the total power at this voltage is higher than the power values we've calculated before, if so, set it as the new max
-						if (P > Pmax)
+						if (!sweep)
 						{
-							Pmax = P;
-							stringVoltage = stringV;
+							int lo = std::max(0, iPeak - stride);
+							int hi = std::min(NP - 1, iPeak + stride);
+							while (lo < hi)
+							{
+								int mid = (lo + hi) / 2;
+								if (mpptInputPower(mid + 1) > mpptInputPower(mid)) lo = mid + 1;
+								else hi = mid;
+							}
+							if (mpptInputPower(lo) > 0) iMax = lo;
 						}
 					}
 
+					// sweep voltage, calculating current for each subarray, add all subarray currents together at each voltage
+					if (sweep)
+					{
+						double Pmax = 0; //variable to store the maximum power for comparison between different points along the voltage sweep
+						for (int i = 0; i < NP; i++)
+						{
+							//check if the total power at this voltage is higher than the power values we've calculated before, if so, set it as the new max
+							if (mpptInputPower(i) > Pmax)
+							{
+								Pmax = mpptInputPower(i);
+								iMax = i;
+							}
+						}
+					}
+
+					if (iMax >= 0)
+						stringVoltage = vmin + (vmax - vmin)*iMax / ((double)NP);
+
 				} //now we have the string voltage at which the MPPT input will produce max power, to be used in subsequent calcs
 
 				//now calculate power for each subarray on this mppt input. stringVoltage will still be -1 if mismatch calcs aren't enabled, or the value decided by mismatch calcs if they are enabled
@@ -1907,14 +2306,17 @@ void cm_pvsamv1::exec( )
 
 				// Sara 1/25/16 - shading database derate applied to dc only
 				// shading loss applied to beam if not from shading database
-				Subarrays[nn]->Module->dcPowerW *= Subarrays[nn]->shadeCalculator.dc_shade_factor();
+				Subarrays[nn]->Module->dcPowerW *= dcShadeFactor[nn];
 
 				// scale power and mppt voltage clipping to subarray dimensions
 				Subarrays[nn]->dcPowerSubarray = Subarrays[nn]->Module->dcPowerW * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 				if (iyear == 0 || save_full_lifetime_variables == 1) mpptVoltageClipping[nn] *= Subarrays[nn]->nModulesPerString* Subarrays[nn]->nStrings;
 
 				// Calculate and apply snow coverage losses if activated
-				if (PVSystem->enableSnowModel)
+				// snow-free steps leave the coverage and losses allocated as zero
+				if (PVSystem->enableSnowModel && Subarrays[nn]->snowModel.snowFree((float)wf.snow))
+					Subarrays[nn]->snowModel.skipSnowFree((float)wf.snow);
+				else if (PVSystem->enableSnowModel)
 				{
 					float smLoss = 0.0f;
 
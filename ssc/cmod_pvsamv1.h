@@ -55,6 +55,106 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // comment following define if do not want shading database validation outputs
 //#define SHADE_DB_OUTPUTS
 
+/**
+* Plane-of-array irradiance on one subarray in one timestep after shading and soiling, and the
+* irradiance power (W) it adds to the system totals
+*/
+struct PVSubarrayStepIrradiance
+{
+	PVSubarrayStepIrradiance()
+		: sunAzimuth(0), sunZenith(0), sunAltitude(0), sunUp(0), albedo(0),
+		poaBeamFront(0), poaDiffuseFront(0), poaGroundFront(0), poaRear(0), poaTotal(0), poaInput(0), poaFrontAfterSoiling(0),
+		angleOfIncidence(0), surfaceTilt(0), surfaceAzimuth(0), nonlinearDCShadingDerate(1), dcShadeFactor(1), usePOAFromWF(false),
+		powerFrontNominal(0), powerFrontBeamNominal(0), powerFrontShaded(0), powerFrontShadedSoiled(0), powerRear(0), powerFrontBeamEff(0)
+	{}
+
+	double sunAzimuth, sunZenith, sunAltitude;
+	int sunUp;
+	double albedo;
+
+	double poaBeamFront, poaDiffuseFront, poaGroundFront, poaRear, poaTotal;
+	double poaInput;				///< POA irradiance from the weather file after soiling, for POA input modes
+	double poaFrontAfterSoiling;
+	double angleOfIncidence, surfaceTilt, surfaceAzimuth;
+	double nonlinearDCShadingDerate, dcShadeFactor;
+	bool usePOAFromWF;
+
+	double powerFrontNominal, powerFrontBeamNominal, powerFrontShaded, powerFrontShadedSoiled, powerRear, powerFrontBeamEff;
+};
+
+/**
+* Plane-of-array irradiance on each subarray over one year of weather data.
+* Sun position, tracking, shading and soiling repeat in every year of a lifetime simulation, so the
+* irradiance found in the first year is stored here and replayed in the later years. It is also filled
+* ahead of the timestep loop when the first year is calculated on several threads.
+*/
+class PVIrradianceYear
+{
+public:
+	/// Values stored for each timestep
+	enum { SUN_AZIMUTH, SUN_ZENITH, SUN_ALTITUDE, SUN_UP, ALBEDO,
+		ACCUM_FRONT_NOMINAL, ACCUM_FRONT_BEAM_NOMINAL, ACCUM_FRONT_SHADED, ACCUM_FRONT_SHADED_SOILED,
+		ACCUM_REAR, ACCUM_REAR_AFTER_LOSSES, ACCUM_FRONT_BEAM_EFF, N_TIMESTEP_VALUES };
+
+	/// Values stored for each subarray and timestep
+	enum { POA_BEAM_FRONT, POA_DIFFUSE_FRONT, POA_GROUND_FRONT, POA_REAR, POA_TOTAL, POA_SUN_UP,
+		ANGLE_OF_INCIDENCE, SURFACE_TILT, SURFACE_AZIMUTH, NONLINEAR_DC_SHADING_DERATE, DC_SHADE_FACTOR,
+		FRONT_AFTER_SOILING, N_SUBARRAY_VALUES };
+
+	PVIrradianceYear(size_t nrec, size_t nsubarrays)
+		: m_nrec(nrec)
+	{
+		for (size_t i = 0; i < N_TIMESTEP_VALUES; i++)
+			m_timestep[i].resize(nrec);
+		for (size_t i = 0; i < N_SUBARRAY_VALUES; i++)
+			m_subarray[i].resize(nrec * nsubarrays);
+	}
+
+	double &timestep(int value, size_t inrec) { return m_timestep[value][inrec]; }
+	double &subarray(int value, size_t nn, size_t inrec) { return m_subarray[value][nn * m_nrec + inrec]; }
+
+	/// Store the irradiance on subarray nn, except for its contribution to the system totals
+	void record(size_t nn, size_t inrec, const PVSubarrayStepIrradiance &step)
+	{
+		subarray(POA_BEAM_FRONT, nn, inrec) = step.poaBeamFront;
+		subarray(POA_DIFFUSE_FRONT, nn, inrec) = step.poaDiffuseFront;
+		subarray(POA_GROUND_FRONT, nn, inrec) = step.poaGroundFront;
+		subarray(POA_REAR, nn, inrec) = step.poaRear;
+		subarray(POA_TOTAL, nn, inrec) = step.poaTotal;
+		subarray(POA_SUN_UP, nn, inrec) = step.sunUp;
+		subarray(ANGLE_OF_INCIDENCE, nn, inrec) = step.angleOfIncidence;
+		subarray(SURFACE_TILT, nn, inrec) = step.surfaceTilt;
+		subarray(SURFACE_AZIMUTH, nn, inrec) = step.surfaceAzimuth;
+		subarray(NONLINEAR_DC_SHADING_DERATE, nn, inrec) = step.nonlinearDCShadingDerate;
+		subarray(DC_SHADE_FACTOR, nn, inrec) = step.dcShadeFactor;
+		subarray(FRONT_AFTER_SOILING, nn, inrec) = step.poaFrontAfterSoiling;
+	}
+
+	/// The irradiance stored for subarray nn
+	PVSubarrayStepIrradiance replay(size_t nn, size_t inrec)
+	{
+		PVSubarrayStepIrradiance step;
+		step.poaBeamFront = subarray(POA_BEAM_FRONT, nn, inrec);
+		step.poaDiffuseFront = subarray(POA_DIFFUSE_FRONT, nn, inrec);
+		step.poaGroundFront = subarray(POA_GROUND_FRONT, nn, inrec);
+		step.poaRear = subarray(POA_REAR, nn, inrec);
+		step.poaTotal = subarray(POA_TOTAL, nn, inrec);
+		step.sunUp = (int)subarray(POA_SUN_UP, nn, inrec);
+		step.angleOfIncidence = subarray(ANGLE_OF_INCIDENCE, nn, inrec);
+		step.surfaceTilt = subarray(SURFACE_TILT, nn, inrec);
+		step.surfaceAzimuth = subarray(SURFACE_AZIMUTH, nn, inrec);
+		step.nonlinearDCShadingDerate = subarray(NONLINEAR_DC_SHADING_DERATE, nn, inrec);
+		step.dcShadeFactor = subarray(DC_SHADE_FACTOR, nn, inrec);
+		step.poaFrontAfterSoiling = subarray(FRONT_AFTER_SOILING, nn, inrec);
+		return step;
+	}
+
+private:
+	size_t m_nrec;
+	std::vector<double> m_timestep[N_TIMESTEP_VALUES];
+	std::vector<double> m_subarray[N_SUBARRAY_VALUES];
+};
+
 /**
 * Detailed photovoltaic model in SAM, version 1
 * Contains calculations to process a weather file, parse the irradiance, and evaluate PV subarray power production with AC or DC connected batteries
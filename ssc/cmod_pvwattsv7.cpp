@@ -19,7 +19,11 @@ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <memory>
+#include <thread>
 
 #include "core.h"
 
@@ -88,6 +92,13 @@ public:
 		return m_error.size() == 0;
 	}
 
+	// add the values accumulated by a copy of this diagram
+	void accumulate(const lossdiagram &other)
+	{
+		for (auto it = other.m_map.begin(); it != other.m_map.end(); ++it)
+			m_map[it->first] += it->second;
+	}
+
 	double &operator() (const std::string &name)
 	{
 		auto it = m_map.find(name);
@@ -115,6 +126,9 @@ static var_info _cm_vtab_pvwattsv7[] = {
 		{ SSC_INPUT,        SSC_NUMBER,      "analysis_period",                "Analysis period",                            "years",      "",                                             "Lifetime",            "system_use_lifetime_output=1", "",                          "" },
 		{ SSC_INPUT,        SSC_ARRAY,       "dc_degradation",                 "Annual DC degradation for lifetime simulations","%/year",  "",                                             "Lifetime",            "system_use_lifetime_output=1", "",                          "" },
 
+		{ SSC_INPUT,        SSC_NUMBER,      "chunk_threads",                  "Threads to simulate chunks of the analysis period","",     "1=serial,0=one per processor,>1=split into this many chunks run in parallel","Simulation","?=1",                "INTEGER,MIN=0",                 "" },
+		{ SSC_INPUT,        SSC_NUMBER,      "chunk_warmup",                   "Warm-up simulated ahead of each chunk",       "hr",        "Extended back to a day without snow when the snow model is enabled","Simulation",          "?=24",                    "MIN=0",                         "" },
+
 		{ SSC_INPUT,        SSC_NUMBER,      "system_capacity",                "System size (DC nameplate)",                  "kW",        "",											   "System Design",      "*",                       "",                      "" },
 		{ SSC_INPUT,        SSC_NUMBER,      "module_type",                    "Module type",                                 "0/1/2",     "Standard,Premium,Thin film",                   "System Design",      "?=0",                     "MIN=0,MAX=2,INTEGER",           "" },
 		{ SSC_INPUT,        SSC_NUMBER,      "dc_ac_ratio",                    "DC to AC ratio",                              "ratio",     "",                                             "System Design",      "?=1.1",                   "POSITIVE",                      "" },
@@ -356,7 +370,7 @@ public:
 		}
 		else if (is_assigned("solar_resource_data"))
 		{
-			wdprov = std::unique_ptr<weather_data_provider>(new weatherdata(lookup("solar_resource_data")));
+			wdprov = std::unique_ptr<weather_data_provider>(new weatherdata(lookup_const("solar_resource_data")));
 		}
 		else
 			throw exec_error("pvwattsv7", "no weather data supplied");
@@ -630,8 +644,6 @@ public:
 
 		assign("ts_shift_hours", var_data((ssc_number_t)ts_shift_hours));
 
-		weather_record wf;
-
 		size_t nyears = 1;
 		std::vector<double> degradationFactor;
 		if (as_boolean("system_use_lifetime_output")) {
@@ -717,501 +729,515 @@ public:
 
 		pvwatts_celltemp tccalc(pv.inoct + 273.15, PVWATTS_HEIGHT, ts_hour); //in pvwattsv5 there is some code about previous tcell and poa that doesn't appear to get used, so not adding it here
 
-		double annual_kwh = 0;
-
-		size_t idx_life = 0;
-		float percent = 0;
-		for (size_t y = 0; y < nyears; y++)
+		// the thermal and snow models carry state from one timestep to the next, and the shading and sky diffuse
+		// calculators keep per-step values, so each chunk of the analysis period simulates with its own copies
+		struct pvwatts_chunk
 		{
-			for (size_t idx = 0; idx < nrec; idx++)
+			pvwatts_chunk(const pvwatts_celltemp &tc, const pvsnowmodel &snow, const shading_factor_calculator &sh, const sssky_diffuse_table &sky, const lossdiagram &ld)
+				: tccalc(tc), snowmodel(snow), shad(sh), skyDiffuseTable(sky), losses(ld), begin(0), end(0), warmup(0), badSnowValues(0) { }
+
+			pvwatts_celltemp tccalc;
+			pvsnowmodel snowmodel;
+			shading_factor_calculator shad;
+			sssky_diffuse_table skyDiffuseTable;
+			lossdiagram losses;
+			size_t begin, end, warmup; // lifetime records reported, and the number simulated ahead of them to settle the models
+			int badSnowValues;
+			std::vector<log_item> messages;
+			std::exception_ptr error;
+		};
+
+		bool annualSimulation = wdprov->annualSimulation();
+
+		auto simulateStep = [&](size_t idx_life, const weather_record &wf, pvwatts_chunk &chunk, bool warmup)
+		{
+			size_t y = idx_life / nrec;
+			size_t idx = idx_life % nrec;
+			size_t hour_of_year = util::hour_of_year(wf.month, wf.day, wf.hour);
+			bool lossDiagram = !warmup && y == 0 && annualSimulation;
+			auto message = [&chunk, warmup](const std::string &text, int type, float time) { if (!warmup) chunk.messages.push_back(log_item(type, text, time)); };
+
+			bool tracker_stowing = false;
+
+			// start by defaulting albedo value to 0.2
+			double alb = 0.2;
+
+			// if the snow loss model is enabled, and there's valid snow > 0.5 cm depth, then increase the albedo.
+			// however, if the snow loss model is disabled, do not artificially increase
+			// apparent production if snow covering the modules is not being accounted for
+			if (std::isfinite(wf.snow) && wf.snow > 0.5 && wf.snow < 999
+				&& en_snowloss)
+				alb = 0.6;
+
+			// if the user has defined single value, monthly, or timeseries albedo input, then use the value they've specified
+			if (albedo_len == 1)
+				alb = albedo[0];
+			else if (albedo_len == 12)
+				alb = albedo[wf.month - 1];
+			else if (albedo_len == nrec)
+				alb = albedo[idx];
+			else if (is_assigned("albedo"))
+				message("Albedo array was assigned but is not the correct length (1, 12, or nrec entries). Using a different value.", SSC_WARNING, -1.0f);
+
+			// if the user hasn't specified an albedo, and the weather file contains hourly albedo, use that instead
+			// albedo_len will be zero if the albedo input isn't assigned
+			if (std::isfinite(wf.alb) && wf.alb > 0 && wf.alb < 1 && albedo_len == 0)
+				alb = wf.alb;
+
+
+			irrad irr;
+			irr.set_time(wf.year, wf.month, wf.day, wf.hour, wf.minute,
+				instantaneous ? IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET : ts_hour);
+			irr.set_location(hdr.lat, hdr.lon, hdr.tz);
+			irr.set_sky_model(2, alb);
+			irr.set_beam_diffuse(wf.dn, wf.df);
+
+			int track_mode = 0;
+			switch (pv.type)
 			{
-				if (!wdprov->read(&wf))
-					throw exec_error("pvwattsv7", util::format("could not read data line %d of %d in weather file", (int)(idx + 1), (int)nrec));
-				size_t hour_of_year = util::hour_of_year(wf.month, wf.day, wf.hour);
-
-#define NSTATUS_UPDATES 50  // set this to the number of times a progress update should be issued for the simulation
-				if (nrec > 50) //avoid divide by zero problems in the following if statement- probably don't need a lot of updates otherwise
-				{
-					if (idx % (nrec / NSTATUS_UPDATES) == 0)
-					{
-						percent = 100.0f * ((float)idx_life + 1) / ((float)nlifetime); //3 is the number of technologies we're assuming for this output (pvwatts + fuel cell + battery)
-						// check percentage
-						if (percent > 100.0f) percent = 99.0f;
-						if (!update("", percent, (float)hour_of_year))
-							throw exec_error("pvwattsv7", "simulation canceled at hour " + util::to_string(hour_of_year + 1.0));
-					}
-				}
-
-				bool tracker_stowing = false;
-
-				p_gh[idx] = (ssc_number_t)wf.gh;
-				p_dn[idx] = (ssc_number_t)wf.dn;
-				p_df[idx] = (ssc_number_t)wf.df;
-				p_tamb[idx] = (ssc_number_t)wf.tdry;
-				p_wspd[idx] = (ssc_number_t)wf.wspd;
-				p_snow[idx] = (ssc_number_t)wf.snow; // if there is no snow data in the weather file, this will be NaN- consistent with pvsamv1
-				p_tmod[idx] = (ssc_number_t)wf.tdry;
-
-
-				// start by defaulting albedo value to 0.2
-				double alb = 0.2;
-
-				// if the snow loss model is enabled, and there's valid snow > 0.5 cm depth, then increase the albedo.
-				// however, if the snow loss model is disabled, do not artificially increase
-				// apparent production if snow covering the modules is not being accounted for
-				if (std::isfinite(wf.snow) && wf.snow > 0.5 && wf.snow < 999
-					&& en_snowloss)
-					alb = 0.6;
-
-				// if the user has defined single value, monthly, or timeseries albedo input, then use the value they've specified
-				if (albedo_len == 1)
-					alb = albedo[0];
-				else if (albedo_len == 12)
-					alb = albedo[wf.month - 1];
-				else if (albedo_len == nrec)
-					alb = albedo[idx];
-				else if (is_assigned("albedo"))
-					log("Albedo array was assigned but is not the correct length (1, 12, or nrec entries). Using a different value.", SSC_WARNING);
-
-				// if the user hasn't specified an albedo, and the weather file contains hourly albedo, use that instead
-				// albedo_len will be zero if the albedo input isn't assigned
-				if (std::isfinite(wf.alb) && wf.alb > 0 && wf.alb < 1 && albedo_len == 0)
-					alb = wf.alb;
-
+			case FIXED_RACK:
+			case FIXED_ROOF:
+				track_mode = 0;
+				break;
+			case ONE_AXIS:
+			case ONE_AXIS_BACKTRACKING:
+				track_mode = 1;
+				break;
+			case TWO_AXIS:
+				track_mode = 2;
+				break;
+			case AZIMUTH_AXIS:
+				track_mode = 3;
+				break;
+			}
 
-				irrad irr;
-				irr.set_time(wf.year, wf.month, wf.day, wf.hour, wf.minute,
-					instantaneous ? IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET : ts_hour);
-				irr.set_location(hdr.lat, hdr.lon, hdr.tz);
-				irr.set_sky_model(2, alb);
-				irr.set_beam_diffuse(wf.dn, wf.df);
+			irr.set_surface(track_mode, pv.tilt, pv.azimuth, pv.rotlim,
+				pv.type == ONE_AXIS_BACKTRACKING, // backtracking mode
+				pv.gcr, false, 0.0);
 
-				int track_mode = 0;
-				switch (pv.type)
-				{
-				case FIXED_RACK:
-				case FIXED_ROOF:
-					track_mode = 0;
-					break;
-				case ONE_AXIS:
-				case ONE_AXIS_BACKTRACKING:
-					track_mode = 1;
-					break;
-				case TWO_AXIS:
-					track_mode = 2;
-					break;
-				case AZIMUTH_AXIS:
-					track_mode = 3;
-					break;
-				}
+			int code = irr.calc();
 
-				irr.set_surface(track_mode, pv.tilt, pv.azimuth, pv.rotlim,
-					pv.type == ONE_AXIS_BACKTRACKING, // backtracking mode
-					pv.gcr, false, 0.0);
+			//create variables to store outputs
+			double solazi, solzen, solalt, aoi, stilt, sazi, rot, btd;
+			double dcshadederate = 0, dcsnowderate = 0; // only reported while the sun is up
+			int sunup;
+			double ibeam = 0.0, iskydiff = 0.0, ignddiff = 0.0, irear = 0.0;
+			double poa = 0, tpoa = 0, tmod = 0, dc = 0, ac = 0;
 
-				int code = irr.calc();
+			irr.get_sun(&solazi, &solzen, &solalt, nullptr, nullptr, nullptr, &sunup, nullptr, nullptr, nullptr); //nullptr used when you don't need to retrieve the output
+			irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
+			irr.get_poa(&ibeam, &iskydiff, &ignddiff, nullptr, nullptr, nullptr); //nullptr used when you don't need to retrieve the output
 
-				//create variables to store outputs
-				double solazi, solzen, solalt, aoi, stilt, sazi, rot, btd;
-				int sunup;
-				double ibeam = 0.0, iskydiff = 0.0, ignddiff = 0.0, irear = 0.0;
-				double poa = 0, tpoa = 0, tmod = 0, dc = 0, ac = 0;
+			if (module.bifaciality > 0)
+			{
+				irr.calc_rear_side(bifacialTransmissionFactor, 1, module.length * pv.nmody);
+				irear = irr.get_poa_rear() * module.bifaciality; //total rear irradiance is returned, so must multiply module bifaciality
+			}
 
-				irr.get_sun(&solazi, &solzen, &solalt, nullptr, nullptr, nullptr, &sunup, nullptr, nullptr, nullptr); //nullptr used when you don't need to retrieve the output
-				irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
-				irr.get_poa(&ibeam, &iskydiff, &ignddiff, nullptr, nullptr, nullptr); //nullptr used when you don't need to retrieve the output
+			if (-1 == code)
+			{
+				message(util::format("beam irradiance exceeded extraterrestrial value at record [y:%d m:%d d:%d h:%d]",
+					wf.year, wf.month, wf.day, wf.hour), SSC_NOTICE, -1.0f);
+			}
+			else if (0 != code)
+				throw exec_error("pvwattsv7",
+					util::format("failed to process irradiation on surface (code: %d) [y:%d m:%d d:%d h:%d]",
+						code, wf.year, wf.month, wf.day, wf.hour));
 
-				if (module.bifaciality > 0)
-				{
-					irr.calc_rear_side(bifacialTransmissionFactor, 1, module.length * pv.nmody);
-					irear = irr.get_poa_rear() * module.bifaciality; //total rear irradiance is returned, so must multiply module bifaciality
-				}
+			double aoi_sun = aoi; // reported before any stow
+			double shad_beam = 1.0;
+			if (chunk.shad.fbeam(hour_of_year, wf.minute, solalt, solazi))
+				shad_beam = chunk.shad.beam_shade_factor();
 
-				if (-1 == code)
+			if (sunup > 0)
+			{
+				// save the total available POA for the loss diagram
+				if (lossDiagram) chunk.losses("poa_nominal") += (ibeam + iskydiff + ignddiff)*wm2_to_wh;
+				if (lossDiagram) chunk.losses("poa_loss_bifacial") += (-irear)*wm2_to_wh;
+
+
+				// check for wind stowing on trackers
+				if ((pv.type == ONE_AXIS
+					|| pv.type == ONE_AXIS_BACKTRACKING
+					|| pv.type == TWO_AXIS)
+					&& std::isfinite(wf.wspd) && wf.wspd > 0
+					&& std::isfinite(wstow)
+					&& enable_wind_stow)
 				{
-					log(util::format("beam irradiance exceeded extraterrestrial value at record [y:%d m:%d d:%d h:%d]",
-						wf.year, wf.month, wf.day, wf.hour));
-				}
-				else if (0 != code)
-					throw exec_error("pvwattsv7",
-						util::format("failed to process irradiation on surface (code: %d) [y:%d m:%d d:%d h:%d]",
-							code, wf.year, wf.month, wf.day, wf.hour));
-
-				p_sunup[idx] = (ssc_number_t)sunup;
-				p_aoi[idx] = (ssc_number_t)aoi;
+					double gust = gf * wf.wspd;
 
-				double shad_beam = 1.0;
-				if (shad.fbeam(hour_of_year, wf.minute, solalt, solazi))
-					shad_beam = shad.beam_shade_factor();
-
-				p_shad_beam[idx] = (ssc_number_t)shad_beam;
-
-				if (sunup > 0)
-				{
-					// save the total available POA for the loss diagram
-					if (y==0 && wdprov->annualSimulation()) ld("poa_nominal") += (ibeam + iskydiff + ignddiff)*wm2_to_wh;
-					if (y==0 && wdprov->annualSimulation()) ld("poa_loss_bifacial") += (-irear)*wm2_to_wh;
-
-
-					// check for wind stowing on trackers
-					if ((pv.type == ONE_AXIS
-						|| pv.type == ONE_AXIS_BACKTRACKING
-						|| pv.type == TWO_AXIS)
-						&& std::isfinite(wf.wspd) && wf.wspd > 0
-						&& std::isfinite(wstow)
-						&& enable_wind_stow)
+					if (gust > wstow)
 					{
-						double gust = gf * wf.wspd;
+						// save poa before going into stow position
+						double poa_no_stow = ibeam + iskydiff + ignddiff;
 
-						if (gust > wstow)
+						if (pv.type == TWO_AXIS)
 						{
-							// save poa before going into stow position
-							double poa_no_stow = ibeam + iskydiff + ignddiff;
-
-							if (pv.type == TWO_AXIS)
-							{
-								// two axis tracker stows at the horizontal position
-								// easiest way to do this in two dimensions is to set it as a flat fixed tilt system
-								// because the force to stow flag only fixes one rotation angle, not both
-								irr.set_surface(irrad::FIXED_TILT, // tracking 0=fixed
-									0, 180, // tilt, azimuth
-									0, 0, 0.4, false, 0.0); // rotlim, bt, gcr, force to stow, stow angle
-							}
-							else
-							{
-								// one axis tracker stows at a prescribed rotation angle,
-								// but still need to consider the rotation axis tilt and azimuth
-								double stow_angle = fabs(wind_stow_angle_deg);
-								if (rot < 0) stow_angle = -stow_angle;  // go to stow in the same direction of current tracker position
-
-								irr.set_surface(irrad::SINGLE_AXIS, pv.tilt, pv.azimuth,
-									stow_angle, // rotation angle limit, the forced stow position
-									false, // backtracking mode
-									pv.gcr,
-									true, stow_angle  // force tracker to the rotation limit (stow_angle here)
-								);
-							}
-
-							irr.calc(); // recalculate POA and aoi, and rear side irradiance if bifacial, in the new stow position
-
-							double irear_stow = 0.0;
-							if (module.bifaciality > 0)
-							{
-								irr.calc_rear_side(bifacialTransmissionFactor, 1, module.length * pv.nmody);
-								irear_stow = irr.get_poa_rear() * module.bifaciality; //total rear irradiance is returned, so must multiply module bifaciality
-							}
-
-							irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
-							irr.get_poa(&ibeam, &iskydiff, &ignddiff, nullptr, nullptr, nullptr); //nullptr used when you don't need to retrieve the output
-							double poa_stow = ibeam + iskydiff + ignddiff;
-
-							double stow_loss = (poa_no_stow - poa_stow) + (irear - irear_stow);
-							if (y==0 && wdprov->annualSimulation()) ld("poa_loss_tracker_stow") += stow_loss * wm2_to_wh;
-							irear = irear_stow;
-							tracker_stowing = true;
+							// two axis tracker stows at the horizontal position
+							// easiest way to do this in two dimensions is to set it as a flat fixed tilt system
+							// because the force to stow flag only fixes one rotation angle, not both
+							irr.set_surface(irrad::FIXED_TILT, // tracking 0=fixed
+								0, 180, // tilt, azimuth
+								0, 0, 0.4, false, 0.0); // rotlim, bt, gcr, force to stow, stow angle
 						}
-					}
-
-					// apply hourly external shading factors to beam (if none enabled, factors are 1.0)
-					if (y==0 && wdprov->annualSimulation()) ld("poa_loss_ext_beam_shade") += ibeam * (1.0 - shad_beam)*wm2_to_wh;
-					ibeam *= shad_beam;
-
-					// apply hourly external sky diffuse shading factor (specified as constant, nominally 1.0 if disabled in UI)
-					if (y == 0 && wdprov->annualSimulation()) ld("poa_loss_ext_diff_shade") += (iskydiff + ignddiff)*(1.0 - shad.fdiff())*wm2_to_wh;
-					iskydiff *= shad.fdiff();
-
-					// also applies to back irradiance if sky is blocked
-					irear *= shad.fdiff();
-
-					// save the unselfshaded beam irradiance if nonlinear losses are calculated
-					// to avoid double counting the beam irradiance loss when calculating module power output
-					double ibeam_unselfshaded = ibeam;
-
-					// calculate any self-shading effects in fixed or tracking regular row systems
-					double f_nonlinear = 1.0; //nonlinear shading factor, 1 for no shading
-					double Fskydiff = 1.0; //shading factor for sky diffuse, 1 for no shading
-					double Fgnddiff = 1.0; //shading factor for ground-reflected diffuse, 1 for no shading
-
-
-					if (en_self_shading) //shading applies in each of these three cases- see reference implementation in pvsamv1
-						//&& (pv.nrows >= 10) // note that enabling self-shading for small systems might be suspicious
-						// because the intent of the self-shading algorithms used here are to apply to large systems
-						// however, some testing of the self-shading algorithms for smaller systems doesn't reveal any wildly wrong behavior,
-						// so enabling it for all systems sizes to prevent confusion to users
-					{
-						// first calculate linear shading for one-axis trackers for use in self-shading algorithms
-						double shad1xf = 0.0; // default: zero shade fraction
-						if (pv.type == ONE_AXIS)
+						else
 						{
-							shad1xf = shadeFraction1x(solazi, solzen, pv.tilt, pv.azimuth, pv.gcr, rot);
+							// one axis tracker stows at a prescribed rotation angle,
+							// but still need to consider the rotation axis tilt and azimuth
+							double stow_angle = fabs(wind_stow_angle_deg);
+							if (rot < 0) stow_angle = -stow_angle;  // go to stow in the same direction of current tracker position
+
+							irr.set_surface(irrad::SINGLE_AXIS, pv.tilt, pv.azimuth,
+								stow_angle, // rotation angle limit, the forced stow position
+								false, // backtracking mode
+								pv.gcr,
+								true, stow_angle  // force tracker to the rotation limit (stow_angle here)
+							);
 						}
 
-						// run self-shading calculations for both FIXED_RACK and ONE_AXIS because the non-linear derate applies in both cases (below)
-						ssinputs ssin;
-						ssin.nstrx = (int)(((double)pv.nmodx) / pv.nmodperstr);
-						ssin.nmodx = pv.nmodx;
-						ssin.nmody = pv.nmody;
-						ssin.nrows = pv.nrows;
-						ssin.length = module.length;
-						ssin.width = module.width;
-						ssin.mod_orient = 0; // portrait module orientation
-						ssin.str_orient = 1; // horizontal stringing
-						ssin.row_space = pv.row_spacing;
-						ssin.ndiode = module.ndiode;
-						ssin.Vmp = module.vmp;
-						ssin.mask_angle_calc_method = 0; // worst case mask angle assumption
-						ssin.FF0 = module.ff;
-						ssoutputs ssout;
-
-						if (!ss_exec(ssin,
-								stilt, sazi, //surface tilt and azimuth
-								solzen, solazi, //solar zenith and azimuth
-								wf.dn, // Gb_nor (e.g. DNI)
-								wf.df, //Gdh (e.g. DHI)
-								ibeam*(1.0 - shad1xf), // Gb_poa
-								iskydiff, //poa_sky
-								ignddiff, // poa_gnd
-								alb,
-								pv.type == ONE_AXIS, // is tracking system?
-								module.type == THINFILM,  // is linear shading? (only with long cell thin films)
-								shad1xf,
-                                ssSkyDiffuseTable,
-								ssout))
-						{
-							throw exec_error("pvwattsv7", util::format("Self-shading calculation failed at %d", (int)idx_life));
-						}
+						irr.calc(); // recalculate POA and aoi, and rear side irradiance if bifacial, in the new stow position
 
-						// fixed tilt system with linear self-shading: beam is derated by fixed shade fraction
-						// fixed tilt non-linear self-shading, beam would NOT usually be derated, because non-linear dc derate accounts for it
-						// however, to be able to distinguish between irradiance and non-linear shading in loss diagram:
-						// we will apply it here, BUT, we will use an un-self-shaded irradiance in the power calculations later
-						// so that the loss isn't double counted.
-						if (pv.type == FIXED_RACK)
+						double irear_stow = 0.0;
+						if (module.bifaciality > 0)
 						{
-							if (y == 0 && wdprov->annualSimulation()) ld("poa_loss_self_beam_shade") += ibeam * ssout.m_shade_frac_fixed*wm2_to_wh;
-							ibeam *= (1 - ssout.m_shade_frac_fixed);
+							irr.calc_rear_side(bifacialTransmissionFactor, 1, module.length * pv.nmody);
+							irear_stow = irr.get_poa_rear() * module.bifaciality; //total rear irradiance is returned, so must multiply module bifaciality
 						}
 
-						// one-axis true tracking system with linear self-shading: beam is derated by linear shade fraction for 1-axis trackers
-						// one-axis non-linear self-shading, beam would NOT usually be derated, because non-linear dc derate accounts for it
-						// however, to be able to distinguish between irradiance and non-linear shading in loss diagram:
-						// we will apply it here, BUT, we will use an un-self-shaded irradiance in the power calculations later
-						// so that the loss isn't double counted.
-						else if (pv.type == ONE_AXIS)
-						{
-							if (y == 0 && wdprov->annualSimulation()) ld("poa_loss_self_beam_shade") += ibeam * shad1xf * wm2_to_wh;
-							ibeam *= (1 - shad1xf);
-						}
+						irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
+						irr.get_poa(&ibeam, &iskydiff, &ignddiff, nullptr, nullptr, nullptr); //nullptr used when you don't need to retrieve the output
+						double poa_stow = ibeam + iskydiff + ignddiff;
 
-						// for non-linear self-shading (fixed and one-axis, but not backtracking)
-						// the non-linear dc derate is calculated and we need to save it for later
-						/*if ((pv.type == FIXED_RACK || pv.type == ONE_AXIS) && module.type != THINFILM)
-						{
-							f_nonlinear = ssout.m_dc_derate;
-						}*/ //disconnecting non-linear shading for now due to possible bug in non-linear shading algorithm resulting in 9% loss in annual energy compared to linear case for large systems
+						double stow_loss = (poa_no_stow - poa_stow) + (irear - irear_stow);
+						if (lossDiagram) chunk.losses("poa_loss_tracker_stow") += stow_loss * wm2_to_wh;
+						irear = irear_stow;
+						tracker_stowing = true;
+					}
+				}
+
+				// apply hourly external shading factors to beam (if none enabled, factors are 1.0)
+				if (lossDiagram) chunk.losses("poa_loss_ext_beam_shade") += ibeam * (1.0 - shad_beam)*wm2_to_wh;
+				ibeam *= shad_beam;
+
+				// apply hourly external sky diffuse shading factor (specified as constant, nominally 1.0 if disabled in UI)
+				if (lossDiagram) chunk.losses("poa_loss_ext_diff_shade") += (iskydiff + ignddiff)*(1.0 - chunk.shad.fdiff())*wm2_to_wh;
+				iskydiff *= chunk.shad.fdiff();
+
+				// also applies to back irradiance if sky is blocked
+				irear *= chunk.shad.fdiff();
+
+				// save the unselfshaded beam irradiance if nonlinear losses are calculated
+				// to avoid double counting the beam irradiance loss when calculating module power output
+				double ibeam_unselfshaded = ibeam;
 
-						// for backtracked systems, there is no beam irradiance reduction or non-linear DC derate
-						// however, sky and ground-reflected diffuse are still blocked, so apply those to everything below
+				// calculate any self-shading effects in fixed or tracking regular row systems
+				double f_nonlinear = 1.0; //nonlinear shading factor, 1 for no shading
+				double Fskydiff = 1.0; //shading factor for sky diffuse, 1 for no shading
+				double Fgnddiff = 1.0; //shading factor for ground-reflected diffuse, 1 for no shading
 
-						// always derate diffuse for any self-shaded system,
-						// due to inter-row blocking of sky and ground view factors.
-						// the derates are calculated by the lib_pvshade.cpp:diffuse_reduce() function and are
-						// purely geometric - apply independent of whether DC derate loss is linear or nonlinear
-						Fskydiff = ssout.m_diffuse_derate;
-						Fgnddiff = ssout.m_reflected_derate;
 
+				if (en_self_shading) //shading applies in each of these three cases- see reference implementation in pvsamv1
+					//&& (pv.nrows >= 10) // note that enabling self-shading for small systems might be suspicious
+					// because the intent of the self-shading algorithms used here are to apply to large systems
+					// however, some testing of the self-shading algorithms for smaller systems doesn't reveal any wildly wrong behavior,
+					// so enabling it for all systems sizes to prevent confusion to users
+				{
+					// first calculate linear shading for one-axis trackers for use in self-shading algorithms
+					double shad1xf = 0.0; // default: zero shade fraction
+					if (pv.type == ONE_AXIS)
+					{
+						shad1xf = shadeFraction1x(solazi, solzen, pv.tilt, pv.azimuth, pv.gcr, rot);
 					}
 
-					// apply derate factors to diffuse
-					if (Fskydiff >= -0.00001 && Fskydiff <= 1.00001) //include tolerances due to double representation
+					// run self-shading calculations for both FIXED_RACK and ONE_AXIS because the non-linear derate applies in both cases (below)
+					ssinputs ssin;
+					ssin.nstrx = (int)(((double)pv.nmodx) / pv.nmodperstr);
+					ssin.nmodx = pv.nmodx;
+					ssin.nmody = pv.nmody;
+					ssin.nrows = pv.nrows;
+					ssin.length = module.length;
+					ssin.width = module.width;
+					ssin.mod_orient = 0; // portrait module orientation
+					ssin.str_orient = 1; // horizontal stringing
+					ssin.row_space = pv.row_spacing;
+					ssin.ndiode = module.ndiode;
+					ssin.Vmp = module.vmp;
+					ssin.mask_angle_calc_method = 0; // worst case mask angle assumption
+					ssin.FF0 = module.ff;
+					ssoutputs ssout;
+
+					if (!ss_exec(ssin,
+							stilt, sazi, //surface tilt and azimuth
+							solzen, solazi, //solar zenith and azimuth
+							wf.dn, // Gb_nor (e.g. DNI)
+							wf.df, //Gdh (e.g. DHI)
+							ibeam*(1.0 - shad1xf), // Gb_poa
+							iskydiff, //poa_sky
+							ignddiff, // poa_gnd
+							alb,
+							pv.type == ONE_AXIS, // is tracking system?
+							module.type == THINFILM,  // is linear shading? (only with long cell thin films)
+							shad1xf,
+                                chunk.skyDiffuseTable,
+							ssout))
 					{
-						if (y == 0 && wdprov->annualSimulation()) ld("poa_loss_self_diff_shade") += (1.0 - Fskydiff)*(iskydiff + irear)*wm2_to_wh; //irear is zero if not bifacial
-						iskydiff *= Fskydiff;
-						irear *= Fskydiff;
+						throw exec_error("pvwattsv7", util::format("Self-shading calculation failed at %d", (int)idx_life));
 					}
-					else log(util::format("sky diffuse reduction factor invalid at time %lg: fskydiff=%lg, stilt=%lg", idx, Fskydiff, stilt), SSC_NOTICE, (float)idx);
 
-					if (Fgnddiff >= -0.00001 && Fgnddiff <= 1.00001) //include tolerances due to double representation
+					// fixed tilt system with linear self-shading: beam is derated by fixed shade fraction
+					// fixed tilt non-linear self-shading, beam would NOT usually be derated, because non-linear dc derate accounts for it
+					// however, to be able to distinguish between irradiance and non-linear shading in loss diagram:
+					// we will apply it here, BUT, we will use an un-self-shaded irradiance in the power calculations later
+					// so that the loss isn't double counted.
+					if (pv.type == FIXED_RACK)
 					{
-						if (y == 0 && wdprov->annualSimulation()) ld("poa_loss_self_diff_shade") += (1.0 - Fgnddiff)*ignddiff*wm2_to_wh;
-						ignddiff *= Fgnddiff;
+						if (lossDiagram) chunk.losses("poa_loss_self_beam_shade") += ibeam * ssout.m_shade_frac_fixed*wm2_to_wh;
+						ibeam *= (1 - ssout.m_shade_frac_fixed);
 					}
-					else log(util::format("ground diffuse reduction factor invalid at time %lg: fgnddiff=%lg, stilt=%lg", idx, Fgnddiff, stilt), SSC_NOTICE, (float)idx);
 
+					// one-axis true tracking system with linear self-shading: beam is derated by linear shade fraction for 1-axis trackers
+					// one-axis non-linear self-shading, beam would NOT usually be derated, because non-linear dc derate accounts for it
+					// however, to be able to distinguish between irradiance and non-linear shading in loss diagram:
+					// we will apply it here, BUT, we will use an un-self-shaded irradiance in the power calculations later
+					// so that the loss isn't double counted.
+					else if (pv.type == ONE_AXIS)
+					{
+						if (lossDiagram) chunk.losses("poa_loss_self_beam_shade") += ibeam * shad1xf * wm2_to_wh;
+						ibeam *= (1 - shad1xf);
+					}
 
-					// apply soiling loss to the total effective POA
-					if (is_assigned("soiling"))
+					// for non-linear self-shading (fixed and one-axis, but not backtracking)
+					// the non-linear dc derate is calculated and we need to save it for later
+					/*if ((pv.type == FIXED_RACK || pv.type == ONE_AXIS) && module.type != THINFILM)
 					{
-						double soiling_f = 0.0;
-						if (soiling_len == 1)
-							soiling_f = soiling[0] * 0.01; //convert from percentage to decimal
-						else if (soiling_len == 12)
-							soiling_f = soiling[wf.month - 1] * 0.01; //convert from percentage to decimal
-						else if (soiling_len == nrec)
-							soiling_f = soiling[idx] * 0.01; //convert from percentage to decimal
-						else
-							throw exec_error("pvwattsv7", "soiling input array must have 1, 12, or nrecords values");
+						f_nonlinear = ssout.m_dc_derate;
+					}*/ //disconnecting non-linear shading for now due to possible bug in non-linear shading algorithm resulting in 9% loss in annual energy compared to linear case for large systems
 
-						if (y == 0 && wdprov->annualSimulation()) ld("poa_loss_soiling") += (ibeam + iskydiff + ignddiff) * soiling_f * wm2_to_wh;
+					// for backtracked systems, there is no beam irradiance reduction or non-linear DC derate
+					// however, sky and ground-reflected diffuse are still blocked, so apply those to everything below
 
-						ibeam *= (1.0 - soiling_f);
-						iskydiff *= (1.0 - soiling_f);
-						ignddiff *= (1.0 - soiling_f);
-						// note: assume no soiling on rear side?
-					}
-					else
-						if (y == 0 && wdprov->annualSimulation()) ld("poa_loss_soiling") = 0;
+					// always derate diffuse for any self-shaded system,
+					// due to inter-row blocking of sky and ground view factors.
+					// the derates are calculated by the lib_pvshade.cpp:diffuse_reduce() function and are
+					// purely geometric - apply independent of whether DC derate loss is linear or nonlinear
+					Fskydiff = ssout.m_diffuse_derate;
+					Fgnddiff = ssout.m_reflected_derate;
 
-					// now add up total effective POA, accounting for external and self shading
-					double poa_front = ibeam + iskydiff + ignddiff;
-					poa = poa_front + irear; //irear is zero if not bifacial
+				}
 
-					// dc power nominal before any losses
-					double dc_nom = pv.dc_nameplate*poa / 1000; // Watts_DC * (POA W/m2 / 1000 W/m2 STC value );
-					if (y == 0 && wdprov->annualSimulation()) ld("dc_nominal") += dc_nom * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+				// apply derate factors to diffuse
+				if (Fskydiff >= -0.00001 && Fskydiff <= 1.00001) //include tolerances due to double representation
+				{
+					if (lossDiagram) chunk.losses("poa_loss_self_diff_shade") += (1.0 - Fskydiff)*(iskydiff + irear)*wm2_to_wh; //irear is zero if not bifacial
+					iskydiff *= Fskydiff;
+					irear *= Fskydiff;
+				}
+				else message(util::format("sky diffuse reduction factor invalid at time %lg: fskydiff=%lg, stilt=%lg", idx, Fskydiff, stilt), SSC_NOTICE, (float)idx);
 
-					// module cover module to handle transmitted POA
-					double f_cover = 1.0;
-					if (aoi > AOI_MIN && aoi < AOI_MAX && poa_front > 0)
-					{
-						/*double modifier = iam( aoi, module.ar_glass );
-						double tpoa = poa - ( 1.0 - modifier )*wf.dn*cosd(aoi); */ // previous PVWatts method, skips diffuse calc
+				if (Fgnddiff >= -0.00001 && Fgnddiff <= 1.00001) //include tolerances due to double representation
+				{
+					if (lossDiagram) chunk.losses("poa_loss_self_diff_shade") += (1.0 - Fgnddiff)*ignddiff*wm2_to_wh;
+					ignddiff *= Fgnddiff;
+				}
+				else message(util::format("ground diffuse reduction factor invalid at time %lg: fgnddiff=%lg, stilt=%lg", idx, Fgnddiff, stilt), SSC_NOTICE, (float)idx);
 
-						tpoa = calculateIrradianceThroughCoverDeSoto(
-							aoi, solzen, stilt, ibeam, iskydiff, ignddiff, en_sdm == 0 && module.ar_glass);
-						if (tpoa < 0.0) tpoa = 0.0;
-						if (tpoa > poa) tpoa = poa_front;
 
-						f_cover = tpoa / poa_front;
-					}
+				// apply soiling loss to the total effective POA
+				if (is_assigned("soiling"))
+				{
+					double soiling_f = 0.0;
+					if (soiling_len == 1)
+						soiling_f = soiling[0] * 0.01; //convert from percentage to decimal
+					else if (soiling_len == 12)
+						soiling_f = soiling[wf.month - 1] * 0.01; //convert from percentage to decimal
+					else if (soiling_len == nrec)
+						soiling_f = soiling[idx] * 0.01; //convert from percentage to decimal
+					else
+						throw exec_error("pvwattsv7", "soiling input array must have 1, 12, or nrecords values");
 
-					if (y == 0 && wdprov->annualSimulation()) ld("dc_loss_cover") += (1 - f_cover)*dc_nom * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+					if (lossDiagram) chunk.losses("poa_loss_soiling") += (ibeam + iskydiff + ignddiff) * soiling_f * wm2_to_wh;
 
-					// spectral correction via air mass modifier
-					double f_AM = air_mass_modifier(solzen, hdr.elev, AMdesoto);
-					if (y == 0 && wdprov->annualSimulation()) ld("dc_loss_spectral") += (1 - f_AM)*dc_nom * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+					ibeam *= (1.0 - soiling_f);
+					iskydiff *= (1.0 - soiling_f);
+					ignddiff *= (1.0 - soiling_f);
+					// note: assume no soiling on rear side?
+				}
+				else
+					if (lossDiagram) chunk.losses("poa_loss_soiling") = 0;
 
-					// cell temperature
-					double wspd_corr = wf.wspd < 0 ? 0 : wf.wspd; //correct the wind speed if it is negative
-					tmod = tccalc(poa, wspd_corr, wf.tdry);
+				// now add up total effective POA, accounting for external and self shading
+				double poa_front = ibeam + iskydiff + ignddiff;
+				poa = poa_front + irear; //irear is zero if not bifacial
 
-					/*
-						// optional: maybe can use sandia typical open rack module thermal model
-						double a = -3.56;
-						double b = -0.075;
-						double dT = 3.0;
-						double Tmod = sandia_celltemp_t::sandia_module_temperature( poa, wspd_corr, wf.tdry, 1.0, a, b );
-						tmod = sandia_celltemp_t::sandia_tmod_from_tmodule( Tmod, poa, 1.0, dT);
-					*/
+				// dc power nominal before any losses
+				double dc_nom = pv.dc_nameplate*poa / 1000; // Watts_DC * (POA W/m2 / 1000 W/m2 STC value );
+				if (lossDiagram) chunk.losses("dc_nominal") += dc_nom * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
 
-					// module temperature losses
-					double f_temp = (1.0 + module.gamma*(tmod - 25.0));
-					if (y == 0 && wdprov->annualSimulation()) ld("dc_loss_thermal") += dc_nom * (1.0 - f_temp) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+				// module cover module to handle transmitted POA
+				double f_cover = 1.0;
+				if (aoi > AOI_MIN && aoi < AOI_MAX && poa_front > 0)
+				{
+					/*double modifier = iam( aoi, module.ar_glass );
+					double tpoa = poa - ( 1.0 - modifier )*wf.dn*cosd(aoi); */ // previous PVWatts method, skips diffuse calc
 
-					// nonlinear dc loss from shading
-					if (y == 0 && wdprov->annualSimulation()) ld("dc_loss_nonlinear") += dc_nom * (1.0 - f_nonlinear) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+					tpoa = calculateIrradianceThroughCoverDeSoto(
+						aoi, solzen, stilt, ibeam, iskydiff, ignddiff, en_sdm == 0 && module.ar_glass);
+					if (tpoa < 0.0) tpoa = 0.0;
+					if (tpoa > poa) tpoa = poa_front;
 
-					// dc losses
-					if (y == 0 && wdprov->annualSimulation()) ld("dc_loss_other") += dc_nom * pv.dc_loss_percent * 0.01 * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
-					double f_losses = (1 - pv.dc_loss_percent*0.01);
+					f_cover = tpoa / poa_front;
+				}
 
-					// run the snow loss model
-					double f_snow = 1.0;
-					if (en_snowloss)
+				if (lossDiagram) chunk.losses("dc_loss_cover") += (1 - f_cover)*dc_nom * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+
+				// spectral correction via air mass modifier
+				double f_AM = air_mass_modifier(solzen, hdr.elev, AMdesoto);
+				if (lossDiagram) chunk.losses("dc_loss_spectral") += (1 - f_AM)*dc_nom * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+
+				// cell temperature
+				double wspd_corr = wf.wspd < 0 ? 0 : wf.wspd; //correct the wind speed if it is negative
+				tmod = chunk.tccalc(poa, wspd_corr, wf.tdry);
+
+				/*
+					// optional: maybe can use sandia typical open rack module thermal model
+					double a = -3.56;
+					double b = -0.075;
+					double dT = 3.0;
+					double Tmod = sandia_celltemp_t::sandia_module_temperature( poa, wspd_corr, wf.tdry, 1.0, a, b );
+					tmod = sandia_celltemp_t::sandia_tmod_from_tmodule( Tmod, poa, 1.0, dT);
+				*/
+
+				// module temperature losses
+				double f_temp = (1.0 + module.gamma*(tmod - 25.0));
+				if (lossDiagram) chunk.losses("dc_loss_thermal") += dc_nom * (1.0 - f_temp) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+
+				// nonlinear dc loss from shading
+				if (lossDiagram) chunk.losses("dc_loss_nonlinear") += dc_nom * (1.0 - f_nonlinear) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+
+				// dc losses
+				if (lossDiagram) chunk.losses("dc_loss_other") += dc_nom * pv.dc_loss_percent * 0.01 * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+				double f_losses = (1 - pv.dc_loss_percent*0.01);
+
+				// run the snow loss model
+				double f_snow = 1.0;
+				if (en_snowloss && chunk.snowmodel.snowFree((float)wf.snow))
+					chunk.snowmodel.skipSnowFree((float)wf.snow);
+				else if (en_snowloss)
+				{
+					float smLoss = 0.0f;
+					if (!chunk.snowmodel.getLoss(
+						(float)poa, (float)stilt,
+						(float)wf.wspd, (float)wf.tdry, (float)wf.snow,
+						sunup, (float)ts_hour,
+						smLoss))
 					{
-						float smLoss = 0.0f;
-						if (!snowmodel.getLoss(
-							(float)poa, (float)stilt,
-							(float)wf.wspd, (float)wf.tdry, (float)wf.snow,
-							sunup, (float)ts_hour,
-							smLoss))
-						{
-							if (!snowmodel.good)
-								throw exec_error("pvwattsv7", snowmodel.msg);
-						}
-						f_snow = (1.0 - smLoss);
+						if (!chunk.snowmodel.good)
+							throw exec_error("pvwattsv7", chunk.snowmodel.msg);
 					}
+					f_snow = (1.0 - smLoss);
+				}
 
-					// dc snow loss
-					if (y == 0 && wdprov->annualSimulation()) ld("dc_loss_snow") += dc_nom * (1.0 - f_snow) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
-
-					// calculate actual DC power now with all the derates/losses
-					// remember, that for non-linear self-shading, we don't use derated ibeam for module power
-					// calculations because total loss is encapsulated in the DC derate
-					// but, we derated it earlier so we could break out the beam shading from the non-linear component.
-					// SO: if dcshadedderate < 1.0, then use ibeam_noselfshade
-					double poa_for_power =
-						(f_nonlinear < 1.0 && poa > 0.0) // if there is a nonlinear self-shading derate
-						? (ibeam_unselfshaded + iskydiff + ignddiff) // then use the unshaded beam to calculate eff POA for power calc but adjust for IAM and spectral
-						: (ibeam + iskydiff + ignddiff); // otherwise, use the 'linearly' derated beam irradiance
-					poa_for_power *= f_cover * f_AM; //derate irradiance for module cover and spectral effects
-					poa_for_power += irear * f_AM; // backside irradiance model already includes back cover effects
-
-					if (en_sdm)
-					{
-						// single diode model per PVsyst using representative module parameters for each module type
-						double P_single_module_sdm = sdmml_power(sdm, poa_for_power, tmod);
-						dc = P_single_module_sdm * pv.dc_nameplate / (sdm.Vmp*sdm.Imp);
-					}
-					else
-					{
-						// basic linear PVWatts model
-						dc = pv.dc_nameplate * (poa_for_power / 1000) * f_temp;
-					}
+				// dc snow loss
+				if (lossDiagram) chunk.losses("dc_loss_snow") += dc_nom * (1.0 - f_snow) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+
+				// calculate actual DC power now with all the derates/losses
+				// remember, that for non-linear self-shading, we don't use derated ibeam for module power
+				// calculations because total loss is encapsulated in the DC derate
+				// but, we derated it earlier so we could break out the beam shading from the non-linear component.
+				// SO: if dcshadedderate < 1.0, then use ibeam_noselfshade
+				double poa_for_power =
+					(f_nonlinear < 1.0 && poa > 0.0) // if there is a nonlinear self-shading derate
+					? (ibeam_unselfshaded + iskydiff + ignddiff) // then use the unshaded beam to calculate eff POA for power calc but adjust for IAM and spectral
+					: (ibeam + iskydiff + ignddiff); // otherwise, use the 'linearly' derated beam irradiance
+				poa_for_power *= f_cover * f_AM; //derate irradiance for module cover and spectral effects
+				poa_for_power += irear * f_AM; // backside irradiance model already includes back cover effects
+
+				if (en_sdm)
+				{
+					// single diode model per PVsyst using representative module parameters for each module type
+					double P_single_module_sdm = sdmml_power(sdm, poa_for_power, tmod);
+					dc = P_single_module_sdm * pv.dc_nameplate / (sdm.Vmp*sdm.Imp);
+				}
+				else
+				{
+					// basic linear PVWatts model
+					dc = pv.dc_nameplate * (poa_for_power / 1000) * f_temp;
+				}
 
-					// apply common DC losses here (independent of module model)
-					dc *= f_nonlinear * f_snow * f_losses;
+				// apply common DC losses here (independent of module model)
+				dc *= f_nonlinear * f_snow * f_losses;
 
-					// apply DC degradation
-					dc *= degradationFactor[y];
+				// apply DC degradation
+				dc *= degradationFactor[y];
 
-					// inverter efficiency
-					double etanom = pv.inv_eff_percent*0.01;
-					double etaref = 0.9637;
-					double A = -0.0162;
-					double B = -0.0059;
-					double C = 0.9858;
-					double pdc0 = pv.ac_nameplate / etanom;
-					double plr = dc / pdc0; //power loading ratio of the inverter
-					ac = 0;
+				// inverter efficiency
+				double etanom = pv.inv_eff_percent*0.01;
+				double etaref = 0.9637;
+				double A = -0.0162;
+				double B = -0.0059;
+				double C = 0.9858;
+				double pdc0 = pv.ac_nameplate / etanom;
+				double plr = dc / pdc0; //power loading ratio of the inverter
+				ac = 0;
 
-					if (y == 0 && wdprov->annualSimulation()) ld("ac_nominal") += dc * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+				if (lossDiagram) chunk.losses("ac_nominal") += dc * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
 
-					if (plr > 0)
-					{ // normal operation
-						double eta = (A*plr + B / plr + C)*etanom / etaref;
-						ac = dc * eta;
-					}
+				if (plr > 0)
+				{ // normal operation
+					double eta = (A*plr + B / plr + C)*etanom / etaref;
+					ac = dc * eta;
+				}
 
-					if (y == 0 && wdprov->annualSimulation()) ld("ac_loss_efficiency") += (dc - ac) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+				if (lossDiagram) chunk.losses("ac_loss_efficiency") += (dc - ac) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
 
-					// power clipping
-					double cliploss = ac > pv.ac_nameplate ? ac - pv.ac_nameplate : 0.0;
-					if (y == 0 && wdprov->annualSimulation()) ld("ac_loss_inverter_clipping") += cliploss * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
-					ac -= cliploss;
+				// power clipping
+				double cliploss = ac > pv.ac_nameplate ? ac - pv.ac_nameplate : 0.0;
+				if (lossDiagram) chunk.losses("ac_loss_inverter_clipping") += cliploss * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+				ac -= cliploss;
 
-					// make sure no negative AC values during daytime hour (no parasitic nighttime losses calculated for PVWatts)
-					if (ac < 0) ac = 0;
+				// make sure no negative AC values during daytime hour (no parasitic nighttime losses calculated for PVWatts)
+				if (ac < 0) ac = 0;
 
-					p_dcshadederate[idx] = (ssc_number_t)f_nonlinear;
-					p_dcsnowderate[idx] = (ssc_number_t)f_snow;
-				}
-				else
+				dcshadederate = f_nonlinear;
+				dcsnowderate = f_snow;
+			}
+			else
+			{
+				poa = 0;
+				tpoa = 0;
+				tmod = wf.tdry;
+				dc = 0;
+				ac = 0;
+			}
+
+			// transformer loss (night and day)
+			double iron_loss = pv.xfmr_nll_f * pv.xfmr_rating;
+			double winding_loss = pv.xfmr_ll_f * ac * (ac / pv.xfmr_rating);
+			double xfmr_loss = iron_loss + winding_loss;
+			if (lossDiagram) chunk.losses("ac_loss_transformer") += xfmr_loss * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+			ac -= xfmr_loss;
+
+			if (warmup)
+				return;
+
+			// the timeseries outputs hold the last year of a lifetime simulation
+			if (y + 1 == nyears)
+			{
+				p_gh[idx] = (ssc_number_t)wf.gh;
+				p_dn[idx] = (ssc_number_t)wf.dn;
+				p_df[idx] = (ssc_number_t)wf.df;
+				p_tamb[idx] = (ssc_number_t)wf.tdry;
+				p_wspd[idx] = (ssc_number_t)wf.wspd;
+				p_snow[idx] = (ssc_number_t)wf.snow; // if there is no snow data in the weather file, this will be NaN- consistent with pvsamv1
+
+				p_sunup[idx] = (ssc_number_t)sunup;
+				p_aoi[idx] = (ssc_number_t)aoi_sun;
+				if (sunup > 0)
 				{
-					poa = 0;
-					tpoa = 0;
-					tmod = wf.tdry;
-					dc = 0;
-					ac = 0;
+					p_dcshadederate[idx] = (ssc_number_t)dcshadederate;
+					p_dcsnowderate[idx] = (ssc_number_t)dcsnowderate;
 				}
 
-				// transformer loss (night and day)
-				double iron_loss = pv.xfmr_nll_f * pv.xfmr_rating;
-				double winding_loss = pv.xfmr_ll_f * ac * (ac / pv.xfmr_rating);
-				double xfmr_loss = iron_loss + winding_loss;
-				if (y == 0 && wdprov->annualSimulation()) ld("ac_loss_transformer") += xfmr_loss * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
-				ac -= xfmr_loss;
-
 				p_stow[idx] = (tracker_stowing ? 1.0 : 0.0);
 				p_shad_beam[idx] = (ssc_number_t)shad_beam; // might be updated by 1 axis self shading so report updated value
 
@@ -1220,23 +1246,135 @@ public:
 				p_tmod[idx] = (ssc_number_t)tmod;
 				p_dc[idx] = (ssc_number_t)dc; // power, Watts
 				p_ac[idx] = (ssc_number_t)ac; // power, Watts
+			}
 
-				// accumulate hourly energy (kWh) (was initialized to zero when allocated)
-				p_gen[idx_life] = (ssc_number_t)(ac * haf(hour_of_year) * util::watt_to_kilowatt);
+			// accumulate hourly energy (kWh) (was initialized to zero when allocated)
+			p_gen[idx_life] = (ssc_number_t)(ac * haf(hour_of_year) * util::watt_to_kilowatt);
 
-				if (y == 0 && wdprov->annualSimulation()) { //report first year annual energy
-					annual_kwh += p_gen[idx] / step_per_hour;
-				}
+			if (lossDiagram) chunk.losses("ac_loss_adjustments") += ac * (1.0 - haf(hour_of_year)) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+			if (lossDiagram) chunk.losses("ac_delivered") += ac * haf(hour_of_year) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+		};
 
-				if (y == 0 && wdprov->annualSimulation()) ld("ac_loss_adjustments") += ac * (1.0 - haf(hour_of_year)) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
-				if (y == 0 && wdprov->annualSimulation()) ld("ac_delivered") += ac * haf(hour_of_year) * ts_hour; //ts_hour required to correctly convert to Wh for subhourly data
+		size_t chunkThreads = (as_integer("chunk_threads") > 0) ? (size_t)as_integer("chunk_threads") : (size_t)std::thread::hardware_concurrency();
+		size_t warmupRecords = (size_t)(as_double("chunk_warmup") * step_per_hour);
 
-				idx_life++;
-			}
+		// at least a day in each chunk so the warm-up covers the previous evening
+		size_t nchunks = std::max((size_t)1, std::min(chunkThreads, nlifetime / (24 * step_per_hour)));
+		std::vector<pvwatts_chunk> chunks(nchunks, pvwatts_chunk(tccalc, snowmodel, shad, ssSkyDiffuseTable, ld));
+		for (size_t c = 0; c < nchunks; c++)
+		{
+			chunks[c].begin = nlifetime * c / nchunks;
+			chunks[c].end = nlifetime * (c + 1) / nchunks;
+			chunks[c].warmup = std::min(chunks[c].begin, warmupRecords);
+		}
 
+		// the serial simulation streams the weather file, chunks run in parallel on the records read ahead
+		std::vector<weather_record> records;
+		if (nchunks > 1)
+		{
+			records.resize(nrec);
+			for (size_t idx = 0; idx < nrec; idx++)
+				if (!wdprov->read(&records[idx]))
+					throw exec_error("pvwattsv7", util::format("could not read data line %d of %d in weather file", (int)(idx + 1), (int)nrec));
 			wdprov->rewind();
 		}
 
+		// snow coverage can last for weeks, and the snow model only resets on a daylight step with a snow-free depth,
+		// so a chunk warms up from the latest full day without snow before it; inside the polar circles a day may have
+		// no daylight step, and the chunk warms up from the start of the analysis period
+		if (en_snowloss && nchunks > 1)
+		{
+			size_t day = 24 * step_per_hour;
+			bool polar = std::abs(hdr.lat) > 66.5;
+			for (size_t c = 1; c < nchunks; c++)
+			{
+				size_t snowFreeRun = 0;
+				size_t idx_life = chunks[c].begin;
+				while (idx_life > 0 && snowFreeRun < day && !polar)
+				{
+					idx_life--;
+					snowFreeRun = snowmodel.snowFree((float)records[idx_life % nrec].snow) ? snowFreeRun + 1 : 0;
+				}
+				if (snowFreeRun < day)
+					idx_life = 0;
+				chunks[c].warmup = std::max(chunks[c].warmup, chunks[c].begin - idx_life);
+			}
+		}
+
+		float percent = 0;
+		std::atomic<size_t> firstFailed(nchunks);
+		auto runChunk = [&](pvwatts_chunk &chunk, size_t ichunk)
+		{
+			int badValuesBefore = chunk.snowmodel.badValues;
+			weather_record wf;
+			try
+			{
+				for (size_t idx_life = chunk.begin - chunk.warmup; idx_life < chunk.end && firstFailed > ichunk; idx_life++)
+				{
+					size_t idx = idx_life % nrec;
+					if (records.empty())
+					{
+						if (idx == 0 && idx_life > 0)
+							wdprov->rewind();
+						if (!wdprov->read(&wf))
+							throw exec_error("pvwattsv7", util::format("could not read data line %d of %d in weather file", (int)(idx + 1), (int)nrec));
+					}
+					const weather_record &rec = records.empty() ? wf : records[idx];
+
+					if (idx_life == chunk.begin)
+						badValuesBefore = chunk.snowmodel.badValues;
+
+#define NSTATUS_UPDATES 50  // set this to the number of times a progress update should be issued for the simulation
+					if (ichunk == 0 && nrec > 50) //avoid divide by zero problems in the following if statement- probably don't need a lot of updates otherwise
+					{
+						if (idx % (nrec / NSTATUS_UPDATES) == 0)
+						{
+							size_t hour_of_year = util::hour_of_year(rec.month, rec.day, rec.hour);
+							percent = 100.0f * ((float)(idx_life - chunk.begin) + 1) / ((float)(chunk.end - chunk.begin)); //3 is the number of technologies we're assuming for this output (pvwatts + fuel cell + battery)
+							// check percentage
+							if (percent > 100.0f) percent = 99.0f;
+							if (!update("", percent, (float)hour_of_year))
+								throw exec_error("pvwattsv7", "simulation canceled at hour " + util::to_string(hour_of_year + 1.0));
+						}
+					}
+
+					simulateStep(idx_life, rec, chunk, idx_life < chunk.begin);
+				}
+			}
+			catch (...)
+			{
+				chunk.error = std::current_exception();
+				size_t failed = firstFailed;
+				while (ichunk < failed && !firstFailed.compare_exchange_weak(failed, ichunk));
+			}
+			chunk.badSnowValues = chunk.snowmodel.badValues - badValuesBefore;
+		};
+
+		std::vector<std::thread> threads;
+		for (size_t c = 1; c < nchunks; c++)
+			threads.push_back(std::thread(runChunk, std::ref(chunks[c]), c));
+		runChunk(chunks[0], 0);
+		for (size_t i = 0; i < threads.size(); i++)
+			threads[i].join();
+		wdprov->rewind();
+
+		// stitch the chunks in time order, reporting messages up to the first error
+		int badSnowValues = 0;
+		for (size_t c = 0; c < nchunks; c++)
+		{
+			for (size_t i = 0; i < chunks[c].messages.size(); i++)
+				log(chunks[c].messages[i].text, chunks[c].messages[i].type, chunks[c].messages[i].time);
+			if (chunks[c].error)
+				std::rethrow_exception(chunks[c].error);
+			ld.accumulate(chunks[c].losses);
+			badSnowValues += chunks[c].badSnowValues;
+		}
+
+		double annual_kwh = 0;
+		if (annualSimulation) //report first year annual energy
+			for (size_t idx = 0; idx < nrec; idx++)
+				annual_kwh += p_gen[idx] / step_per_hour;
+
 		// monthly and annual outputs
 		if (wdprov->annualSimulation())
 		{
@@ -1282,8 +1420,8 @@ public:
 		// for battery model, specify a number of inverters
 		assign("inverter_efficiency", var_data((ssc_number_t)(as_double("inv_eff"))));
 			   
-		if (en_snowloss && snowmodel.badValues > 0)
-			log(util::format("The snow model has detected %d bad snow depth values (less than 0 or greater than 610 cm). These values have been set to zero.", snowmodel.badValues), SSC_WARNING);
+		if (en_snowloss && badSnowValues > 0)
+			log(util::format("The snow model has detected %d bad snow depth values (less than 0 or greater than 610 cm). These values have been set to zero.", badSnowValues), SSC_WARNING);
 
 		// assign loss factors to outputs (kwh)
 		if (wdprov->annualSimulation())
@@ -1296,3 +1434,363 @@ public:
 
 DEFINE_MODULE_ENTRY(pvwattsv7, "PVWatts V7 - integrated hourly weather reader and PV system simulator.", 3)
 
+
+static var_info _cm_vtab_pvwattsv7_batch[] = {
+
+	/*   VARTYPE           DATATYPE          NAME                              LABEL                                          UNITS        META                                            GROUP          REQUIRED_IF                 CONSTRAINTS                      UI_HINTS*/
+		{ SSC_INPUT,        SSC_STRING,      "solar_resource_file",            "Weather file path",                          "",           "",                                             "Solar Resource",      "?",                       "",                              "" },
+		{ SSC_INPUT,        SSC_TABLE,       "solar_resource_data",            "Weather data",                               "",           "dn,df,tdry,wspd,lat,lon,tz,elev",              "Solar Resource",      "?",                       "",                              "" },
+		{ SSC_INPUT,        SSC_ARRAY,       "albedo",                         "Albedo",                                     "frac",       "if provided, will overwrite weather file albedo","Solar Resource",    "",                        "",                              "" },
+
+		{ SSC_INPUT,        SSC_NUMBER,      "system_capacity",                "System size (DC nameplate)",                  "kW",        "",                                             "System Design",      "*",                       "",                              "" },
+		{ SSC_INPUT,        SSC_NUMBER,      "module_type",                    "Module type",                                 "0/1/2",     "Standard,Premium,Thin film",                   "System Design",      "?=0",                     "MIN=0,MAX=2,INTEGER",           "" },
+		{ SSC_INPUT,        SSC_NUMBER,      "array_type",                     "Array type",                                  "0/1/2/3/4", "Fixed Rack,Fixed Roof,1Axis,Backtracked,2Axis","System Design",      "*",                       "MIN=0,MAX=4,INTEGER",           "" },
+		{ SSC_INPUT,        SSC_NUMBER,      "gcr",                            "Ground coverage ratio",                       "0..1",      "",                                             "System Design",      "?=0.4",                   "MIN=0.01,MAX=0.99",             "" },
+		{ SSC_INPUT,        SSC_NUMBER,      "rotlim",                         "Tracker rotation angle limit",                "deg",       "",                                             "System Design",      "?=45.0",                  "",                              "" },
+		{ SSC_INPUT,        SSC_NUMBER,      "inv_eff",                        "Inverter efficiency at rated power",          "%",         "",                                             "System Design",      "?=96",                    "MIN=90,MAX=99.5",               "" },
+		{ SSC_INPUT,        SSC_MATRIX,      "configurations",                 "System configurations",                       "",          "one row per configuration: tilt (deg),azimuth (deg),DC to AC ratio,other DC losses (%)","System Design","*",     "",                              "" },
+
+		{ SSC_INPUT,        SSC_NUMBER,      "batch_threads",                  "Threads to simulate configurations",          "",          "0=one per processor",                          "Simulation",         "?=1",                     "INTEGER,MIN=0",                 "" },
+
+		/* outputs */
+		{ SSC_OUTPUT,       SSC_ARRAY,       "annual_energy",                  "Annual energy",                               "kWh",       "one per configuration",                        "Annual",             "*",                       "",                              "" },
+		{ SSC_OUTPUT,       SSC_MATRIX,      "monthly_energy",                 "Monthly energy",                              "kWh",       "one row per configuration",                    "Monthly",            "*",                       "",                              "" },
+		{ SSC_OUTPUT,       SSC_ARRAY,       "solrad_annual",                  "Daily average solar irradiance",              "kWh/m2/day","one per configuration",                        "Annual",             "*",                       "",                              "" },
+		{ SSC_OUTPUT,       SSC_ARRAY,       "capacity_factor",                "Capacity factor",                             "%",         "one per configuration",                        "Annual",             "*",                       "",                              "" },
+		{ SSC_OUTPUT,       SSC_ARRAY,       "kwh_per_kw",                     "Energy yield",                                "kWh/kW",    "one per configuration",                        "Annual",             "*",                       "",                              "" },
+
+		{ SSC_OUTPUT,       SSC_NUMBER,      "lat",                            "Latitude",                                    "deg",       "",                                             "Location",           "*",                       "",                              "" },
+		{ SSC_OUTPUT,       SSC_NUMBER,      "lon",                            "Longitude",                                   "deg",       "",                                             "Location",           "*",                       "",                              "" },
+		{ SSC_OUTPUT,       SSC_NUMBER,      "tz",                             "Time zone",                                   "hr",        "",                                             "Location",           "*",                       "",                              "" },
+		{ SSC_OUTPUT,       SSC_NUMBER,      "elev",                           "Site elevation",                              "m",         "",                                             "Location",           "*",                       "",                              "" },
+
+		var_info_invalid };
+
+/**
+*   PVWatts V7 for many system configurations against one annual weather source. The weather is read once, and
+*   each thread calculates the sun position once per time step for all of its configurations. Each configuration
+*   runs the PVWatts V7 chain without external shading, soiling, snow, bifacial, wind stow, transformer and
+*   availability losses, giving the same energy as pvwattsv7 with those disabled. One-axis trackers share the
+*   self-shading sky diffuse derates cached by tilt between the configurations of a thread, so they agree to rounding.
+*/
+class cm_pvwattsv7_batch : public compute_module
+{
+	enum array_type { FIXED_RACK, FIXED_ROOF, ONE_AXIS, ONE_AXIS_BACKTRACKING, TWO_AXIS };
+	enum { TILT, AZIMUTH, DC_AC_RATIO, LOSSES, NCOLUMNS };
+
+public:
+	cm_pvwattsv7_batch()
+	{
+		add_var_info(_cm_vtab_pvwattsv7_batch);
+	}
+
+	void exec()
+	{
+		std::unique_ptr<weather_data_provider> wdprov;
+		if (is_assigned("solar_resource_file"))
+		{
+			weatherfile *wfile = new weatherfile(as_string("solar_resource_file"));
+			wdprov = std::unique_ptr<weather_data_provider>(wfile);
+			if (!wfile->ok()) throw exec_error("pvwattsv7_batch", wfile->message());
+			if (wfile->has_message()) log(wfile->message(), SSC_WARNING);
+		}
+		else if (is_assigned("solar_resource_data"))
+			wdprov = std::unique_ptr<weather_data_provider>(new weatherdata(lookup_const("solar_resource_data")));
+		else
+			throw exec_error("pvwattsv7_batch", "no weather data supplied");
+
+		size_t nrec = wdprov->nrecords();
+		size_t step_per_hour = nrec / 8760;
+		if (!wdprov->annualSimulation() || step_per_hour < 1 || step_per_hour > 60 || step_per_hour * 8760 != nrec)
+			throw exec_error("pvwattsv7_batch", util::format("invalid number of data records (%d): must be an integer multiple of 8760", (int)nrec));
+		double ts_hour = 1.0 / step_per_hour;
+
+		// assumes instantaneous values, unless hourly file with no minute column specified
+		bool instantaneous = wdprov->has_data_column(weather_data_provider::MINUTE);
+		if (!instantaneous && step_per_hour != 1)
+			throw exec_error("pvwattsv7_batch", "subhourly weather files must specify the minute for each record");
+
+		weather_header hdr;
+		wdprov->header(&hdr);
+		std::vector<weather_record> records(nrec);
+		for (size_t idx = 0; idx < nrec; idx++)
+			if (!wdprov->read(&records[idx]))
+				throw exec_error("pvwattsv7_batch", util::format("could not read data line %d of %d in weather file", (int)(idx + 1), (int)nrec));
+
+		size_t albedo_len = 0;
+		ssc_number_t *albedo = nullptr;
+		if (is_assigned("albedo"))
+		{
+			albedo = as_array("albedo", &albedo_len);
+			if (albedo_len != 1 && albedo_len != 12 && albedo_len != nrec)
+				log("Albedo array was assigned but is not the correct length (1, 12, or nrec entries). Using a different value.", SSC_WARNING);
+		}
+
+		// module and system geometry as in pvwattsv7
+		double dc_nameplate = as_double("system_capacity") * 1000;
+		double inv_eff_percent = as_double("inv_eff");
+		int module_type = as_integer("module_type");
+		static const double gamma[3] = { -0.0037, -0.0035, -0.0032 };
+		static const double ff[3] = { 0.778, 0.780, 0.777 };
+		static const double stc_eff[3] = { 0.19, 0.21, 0.18 };
+		static double AMdesoto[5] = { 0.918093, 0.086257, -0.024459, 0.002816, -0.000126 };
+		double module_width = sqrt(300 / stc_eff[module_type] / 1000.0 / 1.7);
+		double module_length = module_width * 1.7;
+
+		array_type type = (array_type)as_integer("array_type");
+		double inoct = (type == FIXED_ROOF ? 49 : 45) + 273.15;
+		double gcr = as_double("gcr");
+		double rotlim = as_double("rotlim");
+		int track_mode = (type == FIXED_RACK || type == FIXED_ROOF) ? 0 : (type == TWO_AXIS ? 2 : 1);
+
+		bool en_self_shading = (type == FIXED_RACK || type == ONE_AXIS || type == ONE_AXIS_BACKTRACKING);
+		ssinputs ssin;
+		if (en_self_shading)
+		{
+			if (gcr < 0.01 || gcr >= 1.0)
+				throw exec_error("pvwattsv7_batch", "invalid gcr for fixed rack or one axis tracking system");
+			double nmodules = std::max(1.0, ceil(dc_nameplate / 300));
+			int nrows = (int)ceil(sqrt(nmodules));
+			int nmody = (type == ONE_AXIS) ? 1 : 2;
+			int nmodx = std::max(1, nrows / nmody);
+			ssin.nstrx = (int)(((double)nmodx) / 7);
+			ssin.nmodx = nmodx;
+			ssin.nmody = nmody;
+			ssin.nrows = nrows;
+			ssin.length = module_length;
+			ssin.width = module_width;
+			ssin.mod_orient = 0; // portrait module orientation
+			ssin.str_orient = 1; // horizontal stringing
+			ssin.row_space = module_length * nmody / gcr;
+			ssin.ndiode = 3;
+			ssin.Vmp = 60.0;
+			ssin.mask_angle_calc_method = 0; // worst case mask angle assumption
+			ssin.FF0 = ff[module_type];
+		}
+
+		util::matrix_t<double> configurations = as_matrix("configurations");
+		if (configurations.ncols() != NCOLUMNS)
+			throw exec_error("pvwattsv7_batch", util::format("configurations must have %d columns: tilt, azimuth, DC to AC ratio and other DC losses", (int)NCOLUMNS));
+		size_t nconfig = configurations.nrows();
+		for (size_t c = 0; c < nconfig; c++)
+		{
+			if (configurations(c, TILT) < 0 || configurations(c, TILT) > 90
+				|| configurations(c, AZIMUTH) < 0 || configurations(c, AZIMUTH) > 360
+				|| configurations(c, DC_AC_RATIO) <= 0
+				|| configurations(c, LOSSES) < -5 || configurations(c, LOSSES) > 99)
+				throw exec_error("pvwattsv7_batch", util::format("configuration %d is out of range: tilt %lg, azimuth %lg, DC to AC ratio %lg, losses %lg", (int)(c + 1),
+					configurations(c, TILT), configurations(c, AZIMUTH), configurations(c, DC_AC_RATIO), configurations(c, LOSSES)));
+		}
+
+		// calendar month of each record, as accumulate_monthly() counts them
+		std::vector<int> month_of(nrec);
+		for (int m = 0, idx = 0; m < 12; m++)
+			for (size_t n = 0; n < util::nday[m] * 24 * step_per_hour; n++)
+				month_of[idx++] = m;
+
+		ssc_number_t *p_annual = allocate("annual_energy", nconfig);
+		ssc_number_t *p_monthly = allocate("monthly_energy", nconfig, 12);
+		ssc_number_t *p_solrad = allocate("solrad_annual", nconfig);
+		ssc_number_t *p_cf = allocate("capacity_factor", nconfig);
+		ssc_number_t *p_kwhperkw = allocate("kwh_per_kw", nconfig);
+
+		std::vector<pvwatts_celltemp> tccalc(nconfig, pvwatts_celltemp(inoct, PVWATTS_HEIGHT, ts_hour));
+
+		struct batch_worker
+		{
+			size_t begin, end;
+			size_t beamExceeded;
+			std::exception_ptr error;
+		};
+
+		auto runWorker = [&](batch_worker &worker, bool reportProgress)
+		{
+			std::vector<double> annual_gen(worker.end - worker.begin, 0.0), annual_kwh(worker.end - worker.begin, 0.0);
+			std::vector<ssc_number_t> monthly_poa((worker.end - worker.begin) * 12, 0.0f);
+			sssky_diffuse_table ssSkyDiffuseTable;
+			if (en_self_shading)
+				ssSkyDiffuseTable.init(configurations(worker.begin, TILT), gcr);
+
+			for (size_t idx = 0; idx < nrec; idx++)
+			{
+				const weather_record &wf = records[idx];
+				size_t hour_of_year = util::hour_of_year(wf.month, wf.day, wf.hour);
+				if (reportProgress && idx % (nrec / 50) == 0)
+				{
+					if (!update("", 100.0f * (idx + 1) / nrec, (float)hour_of_year))
+						throw exec_error("pvwattsv7_batch", "simulation canceled at hour " + util::to_string(hour_of_year + 1.0));
+				}
+
+				double alb = 0.2;
+				if (albedo_len == 1)
+					alb = albedo[0];
+				else if (albedo_len == 12)
+					alb = albedo[wf.month - 1];
+				else if (albedo_len == nrec)
+					alb = albedo[idx];
+				if (std::isfinite(wf.alb) && wf.alb > 0 && wf.alb < 1 && albedo_len == 0)
+					alb = wf.alb;
+
+				// the sun position is calculated once for the first configuration, then only the surface changes
+				irrad irr;
+				irr.set_time(wf.year, wf.month, wf.day, wf.hour, wf.minute,
+					instantaneous ? IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET : ts_hour);
+				irr.set_location(hdr.lat, hdr.lon, hdr.tz);
+				irr.set_sky_model(2, alb);
+				irr.set_beam_diffuse(wf.dn, wf.df);
+				irr.set_surface(track_mode, configurations(worker.begin, TILT), configurations(worker.begin, AZIMUTH), rotlim, type == ONE_AXIS_BACKTRACKING, gcr, false, 0.0);
+				int code = irr.calc();
+				if (-1 == code)
+					worker.beamExceeded++;
+				else if (0 != code)
+					throw exec_error("pvwattsv7_batch",
+						util::format("failed to process irradiation on surface (code: %d) [y:%d m:%d d:%d h:%d]",
+							code, wf.year, wf.month, wf.day, wf.hour));
+
+				double solazi, solzen, solalt;
+				int sunup;
+				irr.get_sun(&solazi, &solzen, &solalt, nullptr, nullptr, nullptr, &sunup, nullptr, nullptr, nullptr);
+				double f_AM = sunup > 0 ? air_mass_modifier(solzen, hdr.elev, AMdesoto) : 0;
+				double wspd_corr = wf.wspd < 0 ? 0 : wf.wspd;
+				int month = month_of[idx];
+
+				for (size_t c = worker.begin; c < worker.end; c++)
+				{
+					double tilt = configurations(c, TILT), azimuth = configurations(c, AZIMUTH);
+					if (c > worker.begin)
+					{
+						irr.set_surface(track_mode, tilt, azimuth, rotlim, type == ONE_AXIS_BACKTRACKING, gcr, false, 0.0);
+						irr.calc_surface();
+					}
+
+					double poa = 0, ac = 0;
+					if (sunup > 0)
+					{
+						double aoi, stilt, sazi, rot, btd, ibeam, iskydiff, ignddiff;
+						irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
+						irr.get_poa(&ibeam, &iskydiff, &ignddiff, nullptr, nullptr, nullptr);
+
+						if (en_self_shading)
+						{
+							double shad1xf = 0.0;
+							if (type == ONE_AXIS)
+								shad1xf = shadeFraction1x(solazi, solzen, tilt, azimuth, gcr, rot);
+
+							ssoutputs ssout;
+							if (!ss_exec(ssin, stilt, sazi, solzen, solazi, wf.dn, wf.df, ibeam*(1.0 - shad1xf), iskydiff, ignddiff, alb,
+									type == ONE_AXIS, module_type == 2, shad1xf, ssSkyDiffuseTable, ssout))
+								throw exec_error("pvwattsv7_batch", util::format("Self-shading calculation failed at %d", (int)idx));
+
+							if (type == FIXED_RACK)
+								ibeam *= (1 - ssout.m_shade_frac_fixed);
+							else if (type == ONE_AXIS)
+								ibeam *= (1 - shad1xf);
+
+							if (ssout.m_diffuse_derate >= -0.00001 && ssout.m_diffuse_derate <= 1.00001)
+								iskydiff *= ssout.m_diffuse_derate;
+							if (ssout.m_reflected_derate >= -0.00001 && ssout.m_reflected_derate <= 1.00001)
+								ignddiff *= ssout.m_reflected_derate;
+						}
+
+						poa = ibeam + iskydiff + ignddiff;
+
+						double f_cover = 1.0;
+						if (aoi > AOI_MIN && aoi < AOI_MAX && poa > 0)
+						{
+							double tpoa = calculateIrradianceThroughCoverDeSoto(aoi, solzen, stilt, ibeam, iskydiff, ignddiff, true);
+							if (tpoa < 0.0) tpoa = 0.0;
+							if (tpoa > poa) tpoa = poa;
+							f_cover = tpoa / poa;
+						}
+
+						double tmod = tccalc[c](poa, wspd_corr, wf.tdry);
+						double f_temp = (1.0 + gamma[module_type] * (tmod - 25.0));
+						double poa_for_power = poa * (f_cover * f_AM);
+						double dc = dc_nameplate * (poa_for_power / 1000) * f_temp;
+						dc *= (1 - configurations(c, LOSSES) * 0.01);
+
+						// inverter part load efficiency and clipping
+						double ac_nameplate = dc_nameplate / configurations(c, DC_AC_RATIO);
+						double etanom = inv_eff_percent * 0.01;
+						double etaref = 0.9637;
+						double A = -0.0162;
+						double B = -0.0059;
+						double C = 0.9858;
+						double plr = dc / (ac_nameplate / etanom);
+						if (plr > 0)
+						{
+							double eta = (A*plr + B / plr + C)*etanom / etaref;
+							ac = dc * eta;
+						}
+						double cliploss = ac > ac_nameplate ? ac - ac_nameplate : 0.0;
+						ac -= cliploss;
+						if (ac < 0) ac = 0;
+					}
+
+					ssc_number_t gen = (ssc_number_t)(ac * util::watt_to_kilowatt);
+					annual_gen[c - worker.begin] += gen;
+					annual_kwh[c - worker.begin] += gen / step_per_hour;
+					p_monthly[c * 12 + month] += gen;
+					monthly_poa[(c - worker.begin) * 12 + month] += (ssc_number_t)poa;
+				}
+			}
+
+			for (size_t c = worker.begin; c < worker.end; c++)
+			{
+				p_annual[c] = (ssc_number_t)(annual_gen[c - worker.begin] * ts_hour);
+				ssc_number_t solrad = 0;
+				for (int m = 0; m < 12; m++)
+				{
+					p_monthly[c * 12 + m] *= (ssc_number_t)ts_hour;
+					solrad += monthly_poa[(c - worker.begin) * 12 + m] * (ssc_number_t)(0.001 * ts_hour) / util::nday[m];
+				}
+				p_solrad[c] = solrad / 12;
+				double kWhperkW = util::kilowatt_to_watt * annual_kwh[c - worker.begin] / dc_nameplate;
+				p_kwhperkw[c] = (ssc_number_t)kWhperkW;
+				p_cf[c] = (ssc_number_t)(kWhperkW / 87.6);
+			}
+		};
+
+		size_t nthreads = (as_integer("batch_threads") > 0) ? (size_t)as_integer("batch_threads") : (size_t)std::thread::hardware_concurrency();
+		nthreads = std::max((size_t)1, std::min(nthreads, nconfig));
+		std::vector<batch_worker> workers(nthreads);
+		for (size_t t = 0; t < nthreads; t++)
+		{
+			workers[t].begin = nconfig * t / nthreads;
+			workers[t].end = nconfig * (t + 1) / nthreads;
+			workers[t].beamExceeded = 0;
+		}
+
+		auto runCaught = [&](batch_worker &worker, bool reportProgress)
+		{
+			try
+			{
+				if (worker.begin < worker.end)
+					runWorker(worker, reportProgress);
+			}
+			catch (...)
+			{
+				worker.error = std::current_exception();
+			}
+		};
+		std::vector<std::thread> threads;
+		for (size_t t = 1; t < nthreads; t++)
+			threads.push_back(std::thread(runCaught, std::ref(workers[t]), false));
+		runCaught(workers[0], true);
+		for (size_t t = 0; t < threads.size(); t++)
+			threads[t].join();
+		for (size_t t = 0; t < nthreads; t++)
+			if (workers[t].error)
+				std::rethrow_exception(workers[t].error);
+
+		if (workers[0].beamExceeded > 0)
+			log(util::format("beam irradiance exceeded extraterrestrial value at %d records", (int)workers[0].beamExceeded));
+
+		assign("lat", var_data((ssc_number_t)hdr.lat));
+		assign("lon", var_data((ssc_number_t)hdr.lon));
+		assign("tz", var_data((ssc_number_t)hdr.tz));
+		assign("elev", var_data((ssc_number_t)hdr.elev));
+	}
+};
+
+DEFINE_MODULE_ENTRY(pvwattsv7_batch, "PVWatts V7 for many system configurations against one weather source.", 1)
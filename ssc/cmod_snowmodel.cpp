@@ -26,6 +26,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 #include <cmath>
 #include <string>
+#include <vector>
 
 /**********************************************************************************
 ************************************************************************************
@@ -115,20 +116,18 @@ public:
 			}	
 		}
 
-		float loss; 
-
-		for (int i = 0; i < 8760; i++){
-			if (!snowModule.getLoss(poa[i], tilt[i], wSpd[i], tAmb[i], sDep[i], (int)sunup[i], 1.0, loss)){
-				if (snowModule.good) log(snowModule.msg, SSC_WARNING);
-				else{
-					log(snowModule.msg, SSC_ERROR);
-					return;
-				}
+		std::vector<float> loss(8760);
+		if (!snowModule.getLosses(8760, poa, tilt, wSpd, tAmb, sDep, sunup, 1.0, &loss[0])){
+			if (snowModule.good) log(snowModule.msg, SSC_WARNING);
+			else{
+				log(snowModule.msg, SSC_ERROR);
+				return;
 			}
+		}
 
+		for (int i = 0; i < 8760; i++){
 			hrEn_b4Snow[i] = hrEn[i]; 
-			hrEn[i] = hrEn[i] * (1 - loss);
-
+			hrEn[i] = hrEn[i] * (1 - loss[i]);
 		}
 
 		// accumulate monthly and annual values
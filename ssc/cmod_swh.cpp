@@ -190,7 +190,7 @@ public:
         }
         else if (is_assigned("solar_resource_data"))
         {
-            wdprov = std::unique_ptr<weather_data_provider>(new weatherdata(lookup("solar_resource_data")));
+            wdprov = std::unique_ptr<weather_data_provider>(new weatherdata(lookup_const("solar_resource_data")));
         }
         else
             throw exec_error("swh", "no weather data supplied");
@@ -382,7 +382,7 @@ public:
             if (weather_reader.m_weather_data_provider->has_message()) log(weather_reader.m_weather_data_provider->message(), SSC_WARNING);
         }
         if (is_assigned("solar_resource_data")) {
-            weather_reader.m_weather_data_provider = make_shared<weatherdata>(lookup("solar_resource_data"));
+            weather_reader.m_weather_data_provider = make_shared<weatherdata>(lookup_const("solar_resource_data"));
             if (weather_reader.m_weather_data_provider->has_message()) log(weather_reader.m_weather_data_provider->message(), SSC_WARNING);
         }
 
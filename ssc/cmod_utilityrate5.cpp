@@ -480,10 +480,12 @@ public:
 		4. use (kW)  p_load[i] = max(load) over the hour for each hour i
 		5. After above assignment, proceed as before with same outputs
 		*/
-		ssc_number_t *pload = NULL, *pgen;
+		const ssc_number_t *pload = NULL, *pgen;
 		size_t nrec_load = 0, nrec_gen = 0, step_per_hour_gen=1, step_per_hour_load=1;
 		bool bload=false;
-		pgen = as_array("gen", &nrec_gen);
+		number_span gen_span = as_span("gen"); // read-only, so host-provided time series are not copied
+		pgen = gen_span.data();
+		nrec_gen = gen_span.size();
 		// for lifetime analysis
 		size_t nrec_gen_per_year = nrec_gen;
 		if (as_integer("system_use_lifetime_output") == 1)
@@ -497,7 +499,9 @@ public:
 		if (is_assigned("load"))
 		{ // hourly or sub hourly loads for single year
 			bload = true;
-			pload = as_array("load", &nrec_load);
+			number_span load_span = as_span("load");
+			pload = load_span.data();
+			nrec_load = load_span.size();
 			step_per_hour_load = nrec_load / 8760;
 			if (step_per_hour_load < 1 || step_per_hour_load > 60 || step_per_hour_load * 8760 != nrec_load)
 				throw exec_error("utilityrate5", util::format("invalid number of load records (%d): must be an integer multiple of 8760", (int)nrec_load));
@@ -20,10 +20,10 @@ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <string>
-#include <fstream>
+#include <limits>
 #include "core.h"
 #include "lib_util.h"
-#include "lib_weatherfile.cpp"
+#include "lib_text_tokenizer.h"
 
 static var_info _cm_wave_file_reader[] = {
 /*   VARTYPE           DATATYPE         NAME                           LABEL                                        UNITS     META                      GROUP                 REQUIRED_IF                CONSTRAINTS        UI_HINTS*/
@@ -51,6 +51,21 @@ static var_info _cm_wave_file_reader[] = {
 
 var_info_invalid };
 
+/// splits "33.4 N" into its words, keeping empty words between repeated spaces
+static std::vector<std::string> split_words(const std::string &s)
+{
+	std::vector<std::string> words;
+	size_t start = 0;
+	while (start < s.length())
+	{
+		size_t end = s.find(' ', start);
+		if (end == std::string::npos) end = s.length();
+		words.push_back(s.substr(start, end - start));
+		start = end + 1;
+	}
+	return words;
+}
+
 class cm_wave_file_reader : public compute_module
 {
 public:
@@ -70,26 +85,24 @@ public:
 		}
 
 
-		std::string buf, buf1;
-		std::ifstream ifs(file);
+		text_tokenizer tok(file);
 
-		if (!ifs.is_open())
+		if (!tok.ok())
 		{
 			throw exec_error("wave_file_reader", "could not open file for reading: " + file);
 		}
 
-		std::vector<std::string> values;
 		// header if not use_specific_wf_file
 		if (as_integer("use_specific_wf_wave") == 0)
 		{
-			getline(ifs, buf);
-			getline(ifs, buf1);
-
 			// header name value pairs
-			std::vector<std::string> keys = split(buf);
-			values = split(buf1);
-			int ncols = (int)keys.size();
-			int ncols1 = (int)values.size();
+			tok.next_line();
+			int ncols = (int)tok.split();
+			tok.next_line();
+			int ncols1 = (int)tok.split();
+			std::vector<std::string> values;
+			for (int i = 0; i < ncols1; i++)
+				values.push_back(tok.field_str(i));
 
 			if (ncols != ncols1 || ncols < 13)
 			{
@@ -102,7 +115,7 @@ public:
 			assign("country", var_data(values[3]));
 			// lat with S is negative
 			ssc_number_t dlat = std::numeric_limits<double>::quiet_NaN();
-			std::vector<std::string> slat = split(values[4], ' ');
+			std::vector<std::string> slat = split_words(values[4]);
 			if (slat.size() > 0)
 			{
 				dlat = std::stod(slat[0]);
@@ -114,7 +127,7 @@ public:
 			assign("lat", var_data(dlat));
 			// lon with W is negative
 			ssc_number_t dlon = std::numeric_limits<double>::quiet_NaN();
-			std::vector<std::string> slon = split(values[5], ' ');
+			std::vector<std::string> slon = split_words(values[5]);
 			if (slon.size() > 0)
 			{
 				dlon = std::stod(slon[0]);
@@ -136,19 +149,21 @@ public:
 		ssc_number_t *mat = allocate("wave_resource_matrix", 21, 22);
 		for (size_t r = 0; r < 21; r++)
 		{
-			getline(ifs, buf);
-			values.clear();
-			values = split(buf);
-			if (values.size() != 22)
+			tok.next_line();
+			size_t ncols = tok.split();
+			if (ncols != 22)
 			{
-				throw exec_error("wave_file_reader", "incorrect number of data columns: " + std::to_string(values.size()));
+				throw exec_error("wave_file_reader", "incorrect number of data columns: " + std::to_string(ncols));
 			}
 			for (size_t c = 0; c < 22; c++)
 			{
+				double x;
 				if (r == 0 && c == 0)
 					mat[r*22+c] = 0.0;
+				else if (text_tokenizer::parse_double(tok.field(c), tok.field(c) + tok.field_length(c), &x))
+					mat[r * 22 + c] = x;
 				else
-					mat[r * 22 + c] = std::stod(values[c]);
+					mat[r * 22 + c] = std::stod(tok.field_str(c));
 			}
 		}
 		return;
@@ -1116,7 +1116,7 @@ bool shading_factor_calculator::fbeam(size_t hour_of_year, double minute, double
 }
 
 
-bool shading_factor_calculator::fbeam_shade_db(ShadeDB8_mpp * p_shadedb, size_t hour, double minute, double solalt, double solazi, double gpoa, double dpoa, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi)
+bool shading_factor_calculator::fbeam_shade_db(const ShadeDB8_mpp * p_shadedb, size_t hour, double minute, double solalt, double solazi, double gpoa, double dpoa, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi)
 {
 	bool ok = false;
 	double dc_factor = 1.0;
@@ -1204,7 +1204,7 @@ bool weatherdata::check_continuous_single_year(bool leapyear)
 	return true;
 }
 
-weatherdata::weatherdata( var_data *data_table )
+weatherdata::weatherdata( const var_data *data_table )
 {
 	m_startSec = m_stepSec = m_nRecords = 0;
 	m_index = 0;
@@ -1227,21 +1227,21 @@ weatherdata::weatherdata( var_data *data_table )
 	// make sure two types of irradiance are provided
 	size_t nrec = 0;
 	int n_irr = 0;
-	if (var_data *value = data_table->table.lookup("df"))
+	if (const var_data *value = data_table->table.lookup_const("df"))
 	{
 		if (value->type == SSC_ARRAY){
 			nrec = value->num.length();
 			n_irr++;
 		}
 	}
-	if (var_data *value = data_table->table.lookup("dn"))
+	if (const var_data *value = data_table->table.lookup_const("dn"))
 	{
 		if (value->type == SSC_ARRAY){
 			nrec = value->num.length();
 			n_irr++;
 		}
 	}
-	if (var_data *value = data_table->table.lookup("gh"))
+	if (const var_data *value = data_table->table.lookup_const("gh"))
 	{
 		if (value->type == SSC_ARRAY){
 			nrec = value->num.length();
@@ -1250,7 +1250,7 @@ weatherdata::weatherdata( var_data *data_table )
 	}
 	if (nrec == 0 || n_irr < 2) //poa required if two other types of irradiance are not defined
 	{
-		if (var_data *value = data_table->table.lookup("poa")) //if poa is supplied, use it to specify nrec
+		if (const var_data *value = data_table->table.lookup_const("poa")) //if poa is supplied, use it to specify nrec
 		{
 			if (value->type == SSC_ARRAY) {
 				nrec = value->num.length();
@@ -1420,12 +1420,12 @@ int weatherdata::name_to_id( const char *name )
 	return -1;
 }
 
-weatherdata::vec weatherdata::get_vector( var_data *v, const char *name, size_t *len )
+weatherdata::vec weatherdata::get_vector( const var_data *v, const char *name, size_t *len )
 {
 	vec x;
 	x.p = 0;
 	x.len = 0;
-	if ( var_data *value = v->table.lookup( name ) )
+	if ( const var_data *value = v->table.lookup_const( name ) )
 	{
 		if ( value->type == SSC_ARRAY )
 		{
@@ -1447,9 +1447,9 @@ weatherdata::vec weatherdata::get_vector( var_data *v, const char *name, size_t
 	return x;
 }
 
-ssc_number_t weatherdata::get_number( var_data *v, const char *name )
+ssc_number_t weatherdata::get_number( const var_data *v, const char *name )
 {
-	if ( var_data *value = v->table.lookup( name ) )
+	if ( const var_data *value = v->table.lookup_const( name ) )
 	{
 		if ( value->type == SSC_NUMBER )
 			return value->num;
@@ -131,7 +131,7 @@ public:
 	// beam and diffuse loss factors (0: full loss, 1: no loss )
 	bool fbeam(size_t hour_of_year, double minute, double solalt, double solazi);
 	// shading database instantiated once outside of shading factor calculator
-	bool fbeam_shade_db(ShadeDB8_mpp * p_shadedb, size_t hour, double minute, double solalt, double solazi, double gpoa = 0.0, double dpoa = 0.0, double pv_cell_temp = 0.0, int mods_per_str = 0, double str_vmp_stc = 0.0, double mppt_lo = 0.0, double mppt_hi = 0.0);
+	bool fbeam_shade_db(const ShadeDB8_mpp * p_shadedb, size_t hour, double minute, double solalt, double solazi, double gpoa = 0.0, double dpoa = 0.0, double pv_cell_temp = 0.0, int mods_per_str = 0, double str_vmp_stc = 0.0, double mppt_lo = 0.0, double mppt_hi = 0.0);
 	double fdiff();
 
 	double beam_shade_factor();
@@ -144,12 +144,12 @@ class weatherdata : public weather_data_provider
 	std::vector<size_t> m_columns;
 
 	struct vec {
-		ssc_number_t *p;
+		const ssc_number_t *p;
 		size_t len;
 	};
 
-	vec get_vector(var_data *v, const char *name, size_t *len = nullptr);
-	ssc_number_t get_number(var_data *v, const char *name);
+	vec get_vector(const var_data *v, const char *name, size_t *len = nullptr);
+	ssc_number_t get_number(const var_data *v, const char *name);
 
 	int name_to_id(const char *name);
 
@@ -160,7 +160,7 @@ public:
 	and read weather record information.
 	If wet-bulb temperature or dew point are missing, calculate using tdry, pres & rhum or tdry & rhum, respectively.
 	Interpolates meteorological data if requested.*/
-	weatherdata(var_data *data_table);
+	weatherdata(const var_data *data_table);
 	virtual ~weatherdata();
 
 	void set_counter_to(size_t cur_index);
@@ -130,7 +130,7 @@ bool compute_module::evaluate() {
         }
     };
 
-    auto ArraySquaredError = [&](ssc_number_t *a, ssc_number_t *b, size_t n) -> void {
+    auto ArraySquaredError = [&](const ssc_number_t *a, const ssc_number_t *b, size_t n) -> void {
         for (size_t i = 0; i < n; i++) {
             NumberSquaredError(a[i], b[i]);
         }
@@ -139,7 +139,7 @@ bool compute_module::evaluate() {
     std::function<bool(var_table *, var_table *)> TableSquaredError = [&](var_table *a, var_table *b) -> bool {
         for (auto it = a->first(); it != nullptr; it = a->next()) {
             std::string variable_name(it);
-            var_data *variable_data = a->lookup(variable_name);
+            const var_data *variable_data = a->lookup_const(variable_name);
 
             switch (variable_data->type) {
                 case SSC_STRING: {
@@ -163,18 +163,17 @@ bool compute_module::evaluate() {
                     break;
                 }
                 case SSC_ARRAY: {
-                    size_t n_elements_cur, n_elements_prev;
-                    ssc_number_t *array_cur = a->as_array(variable_name, &n_elements_cur);
-                    ssc_number_t *array_prev = b->as_array(variable_name, &n_elements_prev);
+                    number_span array_cur = a->as_span(variable_name);
+                    number_span array_prev = b->as_span(variable_name);
 
-                    if (n_elements_cur != n_elements_prev) {
+                    if (array_cur.size() != array_prev.size()) {
                         float time = -1.;
                         log("Changing array variable length in ssc_equations is not allowed.", SSC_ERROR,
                             time);       // probably could add later
                         return false;
                     }
 
-                    ArraySquaredError(array_cur, array_prev, n_elements_cur);
+                    ArraySquaredError(array_cur.data(), array_prev.data(), array_cur.size());
                     break;
                 }
                 case SSC_MATRIX: {
@@ -192,7 +191,7 @@ bool compute_module::evaluate() {
                     break;
                 }
                 case SSC_TABLE: {
-                    auto tab = &variable_data->table;
+                    auto tab = &a->lookup(variable_name)->table;
 
                     if (!b->is_assigned(variable_name)) {
                         float time = -1.;
@@ -226,7 +225,7 @@ bool compute_module::evaluate() {
     };
 
     var_table var_table_prev_iter;              // don't initial here or it will use the (bad) default copy constructor
-    var_table_prev_iter = *m_vartab;            // instead using explicity implemented copy assignment operator which does a deep copy
+    var_table_prev_iter = *m_vartab;            // instead using explicity implemented copy assignment operator, which shares entries until written
 
     do {
         squared_error = 0.;
@@ -266,7 +265,7 @@ bool compute_module::verify(const std::string &phase, int check_var_type) {
             if (check_required(vi->name)) {
                 // if the variable is required, make sure it exists (in the var_table)
                 // and that it is of the correct data type
-                var_data *dat = lookup(vi->name);
+                const var_data *dat = m_vartab->lookup_const(vi->name);
                 if (!dat) {
                     log(phase + ": variable '" + std::string(vi->name) + "' (" + std::string(vi->label) +
                         ") required but not assigned");
@@ -403,6 +402,11 @@ var_data *compute_module::lookup(const std::string &name) {
     return m_vartab->lookup(name);
 }
 
+const var_data *compute_module::lookup_const(const std::string &name) const {
+    if (!m_vartab) throw general_error("invalid data container object reference");
+    return m_vartab->lookup_const(name);
+}
+
 var_data *compute_module::assign(const std::string &name, const var_data &value) {
     if (!m_vartab) throw general_error("invalid data container object reference");
     return m_vartab->assign(name, value);
@@ -542,16 +546,86 @@ bool compute_module::get_matrix(const std::string &name, util::matrix_t<ssc_numb
     else throw general_error("compute_module error: var_table does not exist.");
 }
 
+number_span compute_module::as_span(const std::string &name) {
+    if (m_vartab) return m_vartab->as_span(name);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+var_data *compute_module::lookup(var_handle &handle) {
+    if (!m_vartab) throw general_error("invalid data container object reference");
+    return m_vartab->lookup(handle);
+}
+
+var_data *compute_module::assign(var_handle &handle, const var_data &value) {
+    if (!m_vartab) throw general_error("invalid data container object reference");
+    return m_vartab->assign(handle, value);
+}
+
+ssc_number_t *compute_module::allocate(var_handle &handle, size_t length) {
+    if (m_vartab) return m_vartab->allocate(handle, length);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+ssc_number_t *compute_module::allocate(var_handle &handle, size_t nrows, size_t ncols) {
+    if (m_vartab) return m_vartab->allocate(handle, nrows, ncols);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+bool compute_module::is_assigned(var_handle &handle) {
+    if (m_vartab) return m_vartab->is_assigned(handle);
+    else return false;
+}
+
+int compute_module::as_integer(var_handle &handle) {
+    if (m_vartab) return m_vartab->as_integer(handle);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+bool compute_module::as_boolean(var_handle &handle) {
+    if (m_vartab) return m_vartab->as_boolean(handle);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+ssc_number_t compute_module::as_number(var_handle &handle) {
+    if (m_vartab) return m_vartab->as_number(handle);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+double compute_module::as_double(var_handle &handle) {
+    if (m_vartab) return m_vartab->as_double(handle);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+const char *compute_module::as_string(var_handle &handle) {
+    if (m_vartab) return m_vartab->as_string(handle);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+ssc_number_t *compute_module::as_array(var_handle &handle, size_t *count) {
+    if (m_vartab) return m_vartab->as_array(handle, count);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+ssc_number_t *compute_module::as_matrix(var_handle &handle, size_t *rows, size_t *cols) {
+    if (m_vartab) return m_vartab->as_matrix(handle, rows, cols);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
+number_span compute_module::as_span(var_handle &handle) {
+    if (m_vartab) return m_vartab->as_span(handle);
+    else throw general_error("compute_module error: var_table does not exist.");
+}
+
 
 ssc_number_t compute_module::get_operand_value(const std::string &input, const std::string &cur_var_name) {
     if (input.length() < 1) throw check_error(cur_var_name, "input is null to get_operand_value", input);
 
     if (isalpha(input[0])) {
-        var_data *v = lookup(input);
+        const var_data *v = m_vartab->lookup_const(input);
         if (!v)
             throw check_error(cur_var_name, "unassigned referenced", input);
         if (v->type != SSC_NUMBER) throw check_error(cur_var_name, "number type required", input);
-        return v->num;
+        return v->num.value();
     } else {
         double x = 0;
         if (!util::to_double(input, &x)) throw check_error(cur_var_name, "number conversion", input);
@@ -627,29 +701,29 @@ bool compute_module::check_required(const std::string &name) {
 
                     if (lhs == "na") // check if variable name in 'rhs' is not assigned
                     {
-                        expr_result = lookup(rhs) == NULL ? 1 : 0;
+                        expr_result = m_vartab->lookup_const(rhs) == NULL ? 1 : 0;
                     } else if (lhs == "a") // check if variable name in 'rhs' is assigned
                     {
-                        expr_result = lookup(rhs) != NULL ? 1 : 0;
+                        expr_result = m_vartab->lookup_const(rhs) != NULL ? 1 : 0;
                     } else if (lhs == "abt") // check if variable in 'rhs' is assigned, boolean type, and value true
                     {
-                        var_data *v;
-                        if (((v = lookup(rhs)) != 0) && v->type == SSC_NUMBER && ((int) v->num) != 0)
+                        const var_data *v;
+                        if (((v = m_vartab->lookup_const(rhs)) != 0) && v->type == SSC_NUMBER && ((int) v->num.value()) != 0)
                             return 1;
                         else
                             return 0;
                     } else if (lhs == "abf") // check if variable in 'rhs' is assigned, boolean type, and value false
                     {
-                        var_data *v;
-                        if (((v = lookup(rhs)) != 0) && v->type == SSC_NUMBER && ((int) v->num) == 0)
+                        const var_data *v;
+                        if (((v = m_vartab->lookup_const(rhs)) != 0) && v->type == SSC_NUMBER && ((int) v->num.value()) == 0)
                             return 1;
                         else
                             return 0;
                     } else if (lhs == "naof") // check if variable is not assigned OR boolean value is 'false'
                     {
-                        var_data *v;
-                        if ((v = lookup(rhs)) == 0) return 1;
-                        if (v->type == SSC_NUMBER && ((int) v->num) == 0) return 1;
+                        const var_data *v;
+                        if ((v = m_vartab->lookup_const(rhs)) == 0) return 1;
+                        if (v->type == SSC_NUMBER && ((int) v->num.value()) == 0) return 1;
 
                         return 0;
                     } else {
@@ -701,7 +775,9 @@ bool compute_module::check_constraints(const std::string &name, std::string &fai
 
     if (inf.constraints == NULL) return true; // pass if no constraints defined
 
-    var_data &dat = value(name);
+    const var_data *pdat = m_vartab->lookup_const(name);
+    if (!pdat) throw general_error("ssc variable does not exist: '" + name + "'");
+    const var_data &dat = *pdat;
 
     std::vector<std::string> exprlist = util::split(inf.constraints, ",");
     for (std::vector<std::string>::iterator it = exprlist.begin(); it != exprlist.end(); ++it) {
@@ -804,7 +880,7 @@ bool compute_module::check_constraints(const std::string &name, std::string &fai
             } else if (test == "length_equal") {
                 if (dat.type != SSC_ARRAY)
                     throw constraint_error(name, "cannot test for length_equal with non-array type", expr);
-                var_data *other = lookup(rhs);
+                const var_data *other = m_vartab->lookup_const(rhs);
                 if (!other) throw constraint_error(name, "length_equal cannot find variable to test against", expr);
                 if (other->type == SSC_ARRAY) {
                     if (dat.num.length() != other->num.length()) fail_constraint(
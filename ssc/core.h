@@ -222,6 +222,7 @@ public:
 	const var_info &info( const std::string &name );
 	bool is_ssc_array_output( const std::string &name );
 	var_data *lookup( const std::string &name );
+	const var_data *lookup_const( const std::string &name ) const;
 	var_data *assign( const std::string &name, const var_data &value );
 	ssc_number_t *allocate( const std::string &name, size_t length );
 	ssc_number_t *allocate( const std::string &name, size_t nrows, size_t ncols );
@@ -247,6 +248,22 @@ public:
 	util::matrix_t<size_t> as_matrix_unsigned_long(const std::string & name);
 	util::matrix_t<double> as_matrix_transpose(const std::string & name);
 	bool get_matrix(const std::string &name, util::matrix_t<ssc_number_t> &mat);
+	number_span as_span( const std::string &name );
+
+	/* handle-based versions of the above for variables accessed repeatedly, see var_handle */
+	var_data *lookup( var_handle &handle );
+	var_data *assign( var_handle &handle, const var_data &value );
+	ssc_number_t *allocate( var_handle &handle, size_t length );
+	ssc_number_t *allocate( var_handle &handle, size_t nrows, size_t ncols );
+	bool is_assigned( var_handle &handle );
+	int as_integer( var_handle &handle );
+	bool as_boolean( var_handle &handle );
+	ssc_number_t as_number( var_handle &handle );
+	double as_double( var_handle &handle );
+	const char *as_string( var_handle &handle );
+	ssc_number_t *as_array( var_handle &handle, size_t *count );
+	ssc_number_t *as_matrix( var_handle &handle, size_t *rows, size_t *cols );
+	number_span as_span( var_handle &handle );
 
 	size_t check_timestep_seconds( double t_start, double t_end, double t_step ) ;
 
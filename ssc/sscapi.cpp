@@ -48,11 +48,17 @@
 *******************************************************************************************************/
 
 #include <stdio.h>
+#include <atomic>
 #include <cstring>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "lib_util.h"
+#include "lib_pv_shade_loss_mpp.h"
+#include "lib_weatherfile.h"
 #include "core.h"
 #include "sscapi.h"
 
@@ -90,6 +96,7 @@ extern module_entry_info
 	cm_entry_pvwattsv1_poa,
 	cm_entry_pvwattsv5,
 	cm_entry_pvwattsv7,
+	cm_entry_pvwattsv7_batch,
 	cm_entry_pvwattsv5_1ts,
 	cm_entry_pv6parmod,
 	cm_entry_pvsandiainv,
@@ -187,6 +194,7 @@ static module_entry_info *module_table[] = {
 	&cm_entry_pvwattsv1_poa,
 	&cm_entry_pvwattsv5,
 	&cm_entry_pvwattsv7,
+	&cm_entry_pvwattsv7_batch,
 	&cm_entry_pvwattsv5_1ts,
 	&cm_entry_pvsandiainv,
 	&cm_entry_wfreader,
@@ -491,6 +499,21 @@ SSCEXPORT void ssc_data_free( ssc_data_t p_data )
 	if (vt) delete vt;
 }
 
+SSCEXPORT ssc_data_t ssc_data_copy( ssc_data_t p_data )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt) return 0;
+	return static_cast<ssc_data_t>( new var_table( *vt ) );
+}
+
+SSCEXPORT void ssc_data_merge( ssc_data_t p_data, ssc_data_t p_source, int overwrite_existing )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_table *src = static_cast<var_table*>(p_source);
+	if (!vt || !src) return;
+	vt->merge( *src, overwrite_existing != 0 );
+}
+
 SSCEXPORT void ssc_data_clear( ssc_data_t p_data )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
@@ -517,7 +540,7 @@ SSCEXPORT int ssc_data_query( ssc_data_t p_data, const char *name )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
 	if (!vt) return SSC_INVALID;
-	var_data *dat = vt->lookup(name);
+	const var_data *dat = vt->lookup_const(name);
 	if (!dat) return SSC_INVALID;
 	else return dat->type;
 }
@@ -587,6 +610,24 @@ SSCEXPORT void ssc_data_set_matrix( ssc_data_t p_data, const char *name, ssc_num
 	vt->assign( name, var_data(pvalues, nrows, ncols) );
 }
 
+SSCEXPORT void ssc_data_set_array_ref( ssc_data_t p_data, const char *name, const ssc_number_t *pvalues, int length )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt) return;
+	var_data *dat = vt->assign( name, var_data() );
+	dat->type = SSC_ARRAY;
+	dat->num.borrow( const_cast<ssc_number_t*>(pvalues), 1, length > 0 ? (size_t)length : 0 );
+}
+
+SSCEXPORT void ssc_data_set_matrix_ref( ssc_data_t p_data, const char *name, const ssc_number_t *pvalues, int nrows, int ncols )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt) return;
+	var_data *dat = vt->assign( name, var_data() );
+	dat->type = SSC_MATRIX;
+	dat->num.borrow( const_cast<ssc_number_t*>(pvalues), nrows > 0 ? (size_t)nrows : 0, ncols > 0 ? (size_t)ncols : 0 );
+}
+
 SSCEXPORT void ssc_data_set_table( ssc_data_t p_data, const char *name, ssc_data_t table )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
@@ -627,7 +668,7 @@ SSCEXPORT const char *ssc_data_get_string( ssc_data_t p_data, const char *name )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
 	if (!vt) return 0;
-	var_data *dat = vt->lookup(name);
+	const var_data *dat = vt->lookup_const(name);
 	if (!dat || dat->type != SSC_STRING) return 0;
 	return dat->str.c_str();
 }
@@ -637,7 +678,7 @@ SSCEXPORT ssc_bool_t ssc_data_get_number( ssc_data_t p_data, const char *name, s
 	if (!value) return 0;
 	var_table *vt = static_cast<var_table*>(p_data);
 	if (!vt) return 0;
-	var_data *dat = vt->lookup(name);
+	const var_data *dat = vt->lookup_const(name);
 	if (!dat || dat->type != SSC_NUMBER) return 0;
 	*value = dat->num;
 	return 1;
@@ -700,6 +741,111 @@ SSCEXPORT ssc_var_t ssc_data_get_data_matrix(ssc_data_t p_data, const char *name
     return dat;
 }
 
+/*************************** pre-resolved variable keys ***************************/
+
+SSCEXPORT ssc_key_t ssc_key_create( const char *name )
+{
+	if (!name) return 0;
+	return static_cast<ssc_key_t>( new var_handle( name ) );
+}
+
+SSCEXPORT void ssc_key_free( ssc_key_t p_key )
+{
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (vh) delete vh;
+}
+
+SSCEXPORT int ssc_data_key_query( ssc_data_t p_data, ssc_key_t p_key )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (!vt || !vh) return SSC_INVALID;
+	const var_data *dat = vt->lookup_const(*vh);
+	if (!dat) return SSC_INVALID;
+	else return dat->type;
+}
+
+SSCEXPORT void ssc_data_key_set_string( ssc_data_t p_data, ssc_key_t p_key, const char *value )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (!vt || !vh) return;
+	vt->assign( *vh, var_data( std::string(value) ) );
+}
+
+SSCEXPORT void ssc_data_key_set_number( ssc_data_t p_data, ssc_key_t p_key, ssc_number_t value )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (!vt || !vh) return;
+	var_data *dat = vt->lookup(*vh);
+	if (dat && dat->type == SSC_NUMBER)
+		dat->num = value; // overwrite in place, avoids constructing a temporary
+	else
+		vt->assign( *vh, var_data( value ) );
+}
+
+SSCEXPORT void ssc_data_key_set_array( ssc_data_t p_data, ssc_key_t p_key, ssc_number_t *pvalues, int length )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (!vt || !vh) return;
+	vt->assign( *vh, var_data( pvalues, length ) );
+}
+
+SSCEXPORT void ssc_data_key_set_matrix( ssc_data_t p_data, ssc_key_t p_key, ssc_number_t *pvalues, int nrows, int ncols )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (!vt || !vh) return;
+	vt->assign( *vh, var_data( pvalues, nrows, ncols ) );
+}
+
+SSCEXPORT const char *ssc_data_key_get_string( ssc_data_t p_data, ssc_key_t p_key )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (!vt || !vh) return 0;
+	const var_data *dat = vt->lookup_const(*vh);
+	if (!dat || dat->type != SSC_STRING) return 0;
+	return dat->str.c_str();
+}
+
+SSCEXPORT ssc_bool_t ssc_data_key_get_number( ssc_data_t p_data, ssc_key_t p_key, ssc_number_t *value )
+{
+	if (!value) return 0;
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (!vt || !vh) return 0;
+	const var_data *dat = vt->lookup_const(*vh);
+	if (!dat || dat->type != SSC_NUMBER) return 0;
+	*value = dat->num;
+	return 1;
+}
+
+SSCEXPORT ssc_number_t *ssc_data_key_get_array( ssc_data_t p_data, ssc_key_t p_key, int *length )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (!vt || !vh) return 0;
+	var_data *dat = vt->lookup(*vh);
+	if (!dat || dat->type != SSC_ARRAY) return 0;
+	if (length) *length = (int) dat->num.length();
+	return dat->num.data();
+}
+
+SSCEXPORT ssc_number_t *ssc_data_key_get_matrix( ssc_data_t p_data, ssc_key_t p_key, int *nrows, int *ncols )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	var_handle *vh = static_cast<var_handle*>(p_key);
+	if (!vt || !vh) return 0;
+	var_data *dat = vt->lookup(*vh);
+	if (!dat || dat->type != SSC_MATRIX) return 0;
+	if (nrows) *nrows = (int) dat->num.nrows();
+	if (ncols) *ncols = (int) dat->num.ncols();
+	return dat->num.data();
+}
+
 void json_to_ssc_var(const Json::Value& json_val, ssc_var_t ssc_val){
     if (!ssc_val)
         return;
@@ -1039,7 +1185,7 @@ SSCEXPORT ssc_bool_t ssc_module_exec_simple( const char *name, ssc_data_t p_data
 
 SSCEXPORT const char *ssc_module_exec_simple_nothread( const char *name, ssc_data_t p_data )
 {
-static char p_internal_buf[256];
+static thread_local char p_internal_buf[256];
 
 	ssc_module_t p_mod = ssc_module_create( name );
 	if (!p_mod) return 0;
@@ -1069,13 +1215,28 @@ static char p_internal_buf[256];
 	return result ? 0 : p_internal_buf;
 }
 
-static int sg_defaultPrint = 1;
+static std::atomic<int> sg_defaultPrint(1);
 
 SSCEXPORT void ssc_module_exec_set_print( int print )
 {
 	sg_defaultPrint = print;
 }
 
+SSCEXPORT void ssc_set_weather_cache_dir( const char *path )
+{
+	weatherfile::set_cache_dir( path ? path : "" );
+}
+
+SSCEXPORT void ssc_set_weather_memory_cache( int n_files )
+{
+	weatherfile::set_shared_cache_size( n_files > 0 ? (size_t)n_files : 0 );
+}
+
+SSCEXPORT void ssc_set_shade_database_cache( const char *file )
+{
+	ShadeDB8_mpp::set_cache_file( file ? file : "" );
+}
+
 SSCEXPORT ssc_bool_t ssc_module_exec( ssc_module_t p_mod, ssc_data_t p_data )
 {
 	return ssc_module_exec_with_handler( p_mod, p_data, sg_defaultPrint ? default_internal_handler : default_internal_handler_no_print, 0 );
@@ -1137,6 +1298,189 @@ SSCEXPORT ssc_bool_t ssc_module_exec_with_handler(
 	return cm->compute( &h, vt ) ? 1 : 0;
 }
 
+/*************************** batch execution ***************************/
+
+typedef ssc_bool_t (*ssc_handler_func)( ssc_module_t, ssc_handler_t, int, float, float, const char *, const char *, void * );
+
+// shared by all workers of one ssc_module_exec_batch call
+class batch_state
+{
+public:
+	batch_state( int n_cases, ssc_handler_func f, void *d )
+		: m_hfunc(f), m_hdata(d), m_percent(n_cases, 0.0f), m_sum(0.0f), m_cancelled(false) {  }
+
+	bool cancelled() const { return m_cancelled.load(); }
+	void cancel() { m_cancelled = true; }
+
+	void log( compute_module *cm, handler_interface *hi, const std::string &text, int type, float time )
+	{
+		if (!m_hfunc) return;
+		std::lock_guard<std::mutex> guard( m_lock );
+		(*m_hfunc)( static_cast<ssc_module_t>( cm ), static_cast<ssc_handler_t>( hi ),
+					SSC_LOG, (float)type, time, text.c_str(), 0, m_hdata );
+	}
+
+	// records the progress of one case and reports the progress of the whole batch
+	bool update( compute_module *cm, handler_interface *hi, int index, const std::string &text, float percent, float time )
+	{
+		std::lock_guard<std::mutex> guard( m_lock );
+		m_sum += percent - m_percent[index];
+		m_percent[index] = percent;
+
+		if (m_hfunc && !m_cancelled
+			&& !(*m_hfunc)( static_cast<ssc_module_t>( cm ), static_cast<ssc_handler_t>( hi ),
+							SSC_UPDATE, m_sum / (float)m_percent.size(), time, text.c_str(), 0, m_hdata ))
+			m_cancelled = true;
+
+		return !m_cancelled;
+	}
+
+private:
+	ssc_handler_func m_hfunc;
+	void *m_hdata;
+	std::mutex m_lock; // serializes calls to the user's handler
+	std::vector<float> m_percent;
+	float m_sum;
+	std::atomic<bool> m_cancelled;
+};
+
+class batch_exec_handler : public handler_interface
+{
+private:
+	batch_state &m_batch;
+	int m_index;
+
+public:
+	batch_exec_handler( compute_module *cm, batch_state &batch, int index )
+		: handler_interface(cm), m_batch(batch), m_index(index) {  }
+
+	int index() const { return m_index; }
+
+	virtual void on_log( const std::string &text, int type, float time )
+	{
+		m_batch.log( module(), this, text, type, time );
+	}
+
+	virtual bool on_update( const std::string &text, float percent, float time )
+	{
+		return m_batch.update( module(), this, m_index, text, percent, time );
+	}
+};
+
+// per-worker queues of case indices: a worker takes cases from the front of its own
+// queue and, once that is empty, steals from the back of the others
+class batch_queues
+{
+public:
+	batch_queues( int n_cases, int n_workers ) : m_queues( n_workers )
+	{
+		for (int i = 0; i < n_cases; i++)
+			m_queues[i % n_workers].cases.push_back( i );
+	}
+
+	bool next( size_t worker, int *index )
+	{
+		for (size_t k = 0; k < m_queues.size(); k++)
+		{
+			queue &q = m_queues[ (worker + k) % m_queues.size() ];
+			std::lock_guard<std::mutex> guard( q.lock );
+			if (q.cases.empty()) continue;
+			if (k == 0) { *index = q.cases.front(); q.cases.pop_front(); }
+			else { *index = q.cases.back(); q.cases.pop_back(); }
+			return true;
+		}
+		return false;
+	}
+
+private:
+	struct queue {
+		std::mutex lock;
+		std::deque<int> cases;
+	};
+	std::vector<queue> m_queues;
+};
+
+static bool exec_batch_case( const char *name, var_table *vt, batch_state &batch, int index )
+{
+	compute_module *cm = static_cast<compute_module*>( ssc_module_create( name ) );
+	if (!cm) return false;
+
+	batch_exec_handler h( cm, batch, index );
+	bool ok = false;
+	if (!vt)
+		h.on_log( "invalid data object provided", SSC_ERROR, -1.0f );
+	else
+	{
+		try {
+			ok = cm->compute( &h, vt );
+		} catch (std::exception &e) {
+			h.on_log( std::string("exec fail(") + name + "): " + e.what(), SSC_ERROR, -1.0f );
+		} catch (...) {
+			h.on_log( std::string("exec fail(") + name + "): unknown exception", SSC_ERROR, -1.0f );
+		}
+	}
+
+	if (!batch.cancelled())
+		batch.update( cm, &h, index, ok ? "case finished" : "case failed", 100.0f, -1.0f );
+
+	ssc_module_free( cm );
+	return ok;
+}
+
+SSCEXPORT int ssc_module_exec_batch(
+	const char *name,
+	ssc_data_t *p_cases,
+	int n_cases,
+	int n_threads,
+	ssc_bool_t *p_results,
+	ssc_bool_t (*pf_handler)( ssc_module_t, ssc_handler_t, int action, float f0, float f1, const char *s0, const char *s1, void *user_data ),
+	void *pf_user_data )
+{
+	if (!name || !p_cases || n_cases <= 0) return 0;
+
+	if (p_results)
+		for (int i = 0; i < n_cases; i++)
+			p_results[i] = 0;
+
+	// validate the module name once rather than failing every case
+	ssc_module_t p_mod = ssc_module_create( name );
+	if (!p_mod) return 0;
+	ssc_module_free( p_mod );
+
+	if (n_threads <= 0) n_threads = (int)std::thread::hardware_concurrency();
+	if (n_threads <= 0) n_threads = 1;
+	if (n_threads > n_cases) n_threads = n_cases;
+
+	batch_state batch( n_cases, pf_handler, pf_user_data );
+	batch_queues queues( n_cases, n_threads );
+	std::atomic<int> n_ok( 0 );
+
+	auto worker = [&]( size_t id ) {
+		int index;
+		while (!batch.cancelled() && queues.next( id, &index ))
+		{
+			bool ok = exec_batch_case( name, static_cast<var_table*>( p_cases[index] ), batch, index );
+			if (p_results) p_results[index] = ok ? 1 : 0;
+			if (ok) n_ok++;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < n_threads; i++)
+		threads.push_back( std::thread( worker, (size_t)i ) );
+	worker( 0 ); // the calling thread is worker 0
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+
+	return n_ok.load();
+}
+
+SSCEXPORT int ssc_module_exec_batch_case( ssc_handler_t p_handler )
+{
+	batch_exec_handler *bh = dynamic_cast<batch_exec_handler*>( static_cast<handler_interface*>( p_handler ) );
+	return bh ? bh->index() : -1;
+}
+
 
 SSCEXPORT void ssc_module_extproc_output( ssc_handler_t p_handler, const char *output_line )
 {
@@ -1164,20 +1508,27 @@ SSCEXPORT void __ssc_segfault()
 	std::string mystr = *pstr;
 }
 
-static std::string* s_python_path;
+static std::mutex s_python_path_lock;
+static std::string s_python_path;
 
 SSCEXPORT void set_python_path(const char* abs_path) {
     if (util::dir_exists(abs_path)){
-        delete s_python_path;
-        s_python_path = new std::string(abs_path);
+        std::lock_guard<std::mutex> guard(s_python_path_lock);
+        s_python_path = abs_path;
     }
     else
         throw(std::runtime_error("set_python_path error. Python directory doesn't not exist: " + std::string(abs_path)));
 }
 
 SSCEXPORT const char *get_python_path() {
-    if (s_python_path)
-        return s_python_path->c_str();
+    // each thread gets its own copy, so the pointer stays valid if another thread sets a new path
+    static thread_local std::string path;
+    {
+        std::lock_guard<std::mutex> guard(s_python_path_lock);
+        path = s_python_path;
+    }
+    if (!path.empty())
+        return path.c_str();
     else
         throw(std::runtime_error("get_python_path error. Path does not exist. Set with 'set_python_path' first."));
 }
@@ -183,6 +183,16 @@ SSCEXPORT ssc_data_t ssc_data_create();
 /** Frees the memory associated with a data object, where p_data is the data container to free. */
 SSCEXPORT void ssc_data_free( ssc_data_t p_data );
 
+/** Creates a copy of a data object. Variables are shared with the source until one of the two
+ * objects modifies them, so copying costs time proportional to the number of variables rather than
+ * their size, which keeps cloning a large base case cheap in parametric runs. Array and matrix
+ * pointers obtained from p_data before the copy must not be written through afterwards. */
+SSCEXPORT ssc_data_t ssc_data_copy( ssc_data_t p_data );
+
+/** Adds the variables of p_source to p_data, sharing them as ssc_data_copy() does. Variables that
+ * already exist in p_data are replaced only if overwrite_existing is nonzero. */
+SSCEXPORT void ssc_data_merge( ssc_data_t p_data, ssc_data_t p_source, int overwrite_existing );
+
 /** Clears all of the variables in a data object. Type becomes SSC_INVALID. */
 SSCEXPORT void ssc_data_clear( ssc_data_t p_data );
 
@@ -237,6 +247,12 @@ SSCEXPORT void ssc_data_set_array( ssc_data_t p_data, const char *name, ssc_numb
 /** Assigns value of type @a SSC_MATRIX . Matrices are specified as a continuous array, in row-major order.  Example: the matrix [[5,2,3],[9,1,4]] is stored as [5,2,3,9,1,4]. */
 SSCEXPORT void ssc_data_set_matrix( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int nrows, int ncols );
 
+/** Assigns value of type @a SSC_ARRAY that refers to the caller's memory instead of copying it. The memory is treated as read-only and must stay valid until the variable is reassigned, unassigned, or the data object is freed. Copies of the data object share the same reference. */
+SSCEXPORT void ssc_data_set_array_ref( ssc_data_t p_data, const char *name, const ssc_number_t *pvalues, int length );
+
+/** Assigns value of type @a SSC_MATRIX that refers to the caller's memory in row-major order, with the same lifetime requirements as ssc_data_set_array_ref. */
+SSCEXPORT void ssc_data_set_matrix_ref( ssc_data_t p_data, const char *name, const ssc_number_t *pvalues, int nrows, int ncols );
+
 /** Assigns value of type @a SSC_TABLE. */
 SSCEXPORT void ssc_data_set_table( ssc_data_t p_data, const char *name, ssc_data_t table );
 
@@ -274,6 +290,60 @@ SSCEXPORT ssc_var_t ssc_data_get_data_matrix(ssc_data_t p_data, const char *name
 
 /**@}*/
 
+/** @name Pre-resolved variable keys.
+A key holds a variable name that has been normalized once and remembers where the variable was last found. Reading and writing through a key skips the name hashing done by the functions above, which adds up when the same variables are accessed many times, e.g. by batch drivers. A key can be used with any data object, and is cheapest when reused with the same one. Keys are not synchronized: use one key per thread.
+
+   \verbatim
+	ssc_key_t k_ghi = ssc_key_create( "gh" );
+	for (int i = 0; i < ncases; i++)
+	{
+		int len;
+		ssc_number_t *ghi = ssc_data_key_get_array( cases[i], k_ghi, &len );
+		...
+	}
+	ssc_key_free( k_ghi );
+    \endverbatim
+*/
+/**@{*/
+
+/** An opaque reference to a pre-resolved variable name. */
+typedef void* ssc_key_t;
+
+/** Creates a key for the variable with the given name, which must be freed with ssc_key_free. */
+SSCEXPORT ssc_key_t ssc_key_create( const char *name );
+
+/** Frees a key created with ssc_key_create. */
+SSCEXPORT void ssc_key_free( ssc_key_t p_key );
+
+/** Querys the data object for the data type of the variable referenced by the key, or SSC_INVALID if not found. */
+SSCEXPORT int ssc_data_key_query( ssc_data_t p_data, ssc_key_t p_key );
+
+/** Assigns value of type @a SSC_STRING */
+SSCEXPORT void ssc_data_key_set_string( ssc_data_t p_data, ssc_key_t p_key, const char *value );
+
+/** Assigns value of type @a SSC_NUMBER */
+SSCEXPORT void ssc_data_key_set_number( ssc_data_t p_data, ssc_key_t p_key, ssc_number_t value );
+
+/** Assigns value of type @a SSC_ARRAY */
+SSCEXPORT void ssc_data_key_set_array( ssc_data_t p_data, ssc_key_t p_key, ssc_number_t *pvalues, int length );
+
+/** Assigns value of type @a SSC_MATRIX, in row-major order. */
+SSCEXPORT void ssc_data_key_set_matrix( ssc_data_t p_data, ssc_key_t p_key, ssc_number_t *pvalues, int nrows, int ncols );
+
+/** Returns the value of a @a SSC_STRING variable referenced by the key. */
+SSCEXPORT const char *ssc_data_key_get_string( ssc_data_t p_data, ssc_key_t p_key );
+
+/** Returns the value of a @a SSC_NUMBER variable referenced by the key. */
+SSCEXPORT ssc_bool_t ssc_data_key_get_number( ssc_data_t p_data, ssc_key_t p_key, ssc_number_t *value );
+
+/** Returns the reference of a @a SSC_ARRAY variable referenced by the key. */
+SSCEXPORT ssc_number_t *ssc_data_key_get_array( ssc_data_t p_data, ssc_key_t p_key, int *length );
+
+/** Returns the reference of a @a SSC_MATRIX variable referenced by the key, in row-major order. */
+SSCEXPORT ssc_number_t *ssc_data_key_get_matrix( ssc_data_t p_data, ssc_key_t p_key, int *nrows, int *ncols );
+
+/**@}*/
+
 /** Json and ssc_data_t conversion functions
  *
  * Numerical json values (int, bool, real) map to SSC_NUMBER type.
@@ -385,10 +455,19 @@ SSCEXPORT const char *ssc_info_uihint( ssc_info_t p_inf );
 /** Specify whether the built-in execution handler prints messages and progress updates to the command line console. */
 SSCEXPORT void ssc_module_exec_set_print( int print );
 
+/** Sets a folder in which weather files read by compute modules are cached in a binary format after they are first parsed.  Later reads of an unchanged file memory-map the cache instead of parsing the text again, which helps when many simulations share the same weather files.  An empty string or NULL (the default) turns caching off. */
+SSCEXPORT void ssc_set_weather_cache_dir( const char *path );
+
+/** Sets how many recently read weather files are kept in memory and shared by later simulations in the same process.  Simulations that read a file already held, unchanged on disk, share its data instead of reading and storing their own copy.  The default is 8; zero turns sharing off and releases the held files. */
+SSCEXPORT void ssc_set_weather_memory_cache( int n_files );
+
+/** Sets a file holding an uncompressed copy of the PV partial shading database, which is otherwise decompressed the first time a simulation in the process uses it.  The file is written when it does not exist yet and memory-mapped when it does.  An empty string or NULL (the default) turns the cache off.  Has no effect once the database has been loaded. */
+SSCEXPORT void ssc_set_shade_database_cache( const char *file );
+
 /** The simplest way to run a computation module over a data set. Simply specify the name of the module, and a data set.  If the whole process succeeded, the function returns 1, otherwise 0.  No error messages are available. This function can be thread-safe, depending on the computation module used. If the computation module requires the execution of external binary executables, it is not thread-safe. However, simpler implementations that do all calculations internally are probably thread-safe.  Unfortunately there is no standard way to report the thread-safety of a particular computation module. */
 SSCEXPORT ssc_bool_t ssc_module_exec_simple( const char *name, ssc_data_t p_data );
 
-/** Another very simple way to run a computation module over a data set. The function returns NULL on success.  If something went wrong, the first error message is returned. Because the returned string references a common internal data container, this function is never thread-safe.  */
+/** Another very simple way to run a computation module over a data set. The function returns NULL on success.  If something went wrong, the first error message is returned. The returned string references an internal buffer owned by the calling thread, and remains valid until the next call to this function on the same thread.  */
 SSCEXPORT const char *ssc_module_exec_simple_nothread( const char *name, ssc_data_t p_data );
 
 /** @name Action/notification types that can be sent to a handler function:
@@ -413,6 +492,23 @@ SSCEXPORT ssc_bool_t ssc_module_exec_with_handler(
 	ssc_bool_t (*pf_handler)( ssc_module_t, ssc_handler_t, int action, float f0, float f1, const char *s0, const char *s1, void *user_data ),
 	void *pf_user_data );
 
+/** Runs the compute module with the given name over n_cases data sets on a pool of n_threads worker threads (n_threads <= 0 uses one per hardware thread, the calling thread is one of the workers). Each case gets its own module instance, and cases are balanced across workers by work stealing. Returns the number of cases that succeeded; if p_results is not NULL it receives 1 or 0 for each case.
+ *
+ * pf_handler may be NULL. Calls to it are serialized, so it does not need to be thread-safe. SSC_LOG messages are forwarded from every case as they are logged; use ssc_module_exec_batch_case() on the ssc_handler_t argument to find the case a message belongs to. SSC_UPDATE reports the progress of the whole batch in f0, and returning 0 from it cancels the batch: running cases are asked to stop and no further cases are started.
+ *
+ * The data sets must be distinct objects. Use ssc_data_copy() to derive them cheaply from a common base case. */
+SSCEXPORT int ssc_module_exec_batch(
+	const char *name,
+	ssc_data_t *p_cases,
+	int n_cases,
+	int n_threads,
+	ssc_bool_t *p_results,
+	ssc_bool_t (*pf_handler)( ssc_module_t, ssc_handler_t, int action, float f0, float f1, const char *s0, const char *s1, void *user_data ),
+	void *pf_user_data );
+
+/** Returns the index of the case that a handler call made during ssc_module_exec_batch() belongs to, or -1 if the handler is not from a batch run. */
+SSCEXPORT int ssc_module_exec_batch_case( ssc_handler_t p_handler );
+
 /** @name Message types:*/
 /**@{*/
 #define SSC_NOTICE 1
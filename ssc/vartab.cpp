@@ -20,6 +20,8 @@ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <atomic>
+
 #include "lib_util.h"
 #include "vartab.h"
 
@@ -39,7 +41,7 @@ var_data::var_data(std::vector<int> arr) : type(SSC_ARRAY) {
     }
 }
 
-const char *var_data::type_name()
+const char *var_data::type_name() const
 {
 	if (type < 6) return var_data_types[ (int)type ];
 	else return NULL;
@@ -95,7 +97,7 @@ std::string var_data::to_string( const var_data &value )
 	return "<invalid>";
 }
 
-std::vector<double> var_data::arr_vector()
+std::vector<double> var_data::arr_vector() const
 {
     if (type != SSC_ARRAY)
         throw std::runtime_error("arr_vector error: var_data type not SSC_ARRAY.");
@@ -106,7 +108,7 @@ std::vector<double> var_data::arr_vector()
     return v;
 }
 
-std::vector<std::vector<double>> var_data::matrix_vector()
+std::vector<std::vector<double>> var_data::matrix_vector() const
 {
     if (type != SSC_MATRIX)
         throw std::runtime_error("arr_matrix error: var_data type not SSC_MATRIX.");
@@ -192,7 +194,17 @@ bool var_data::parse( unsigned char type, const std::string &buf, var_data &valu
 	return false;
 }
 
-var_table::var_table() : m_iterator(m_hash.begin())
+// process-wide source of table generations, so that a (table, generation) pair
+// seen by a var_handle can never be reused by another table at the same address
+static std::atomic<size_t> sg_vartabGeneration(1);
+
+var_handle::var_handle( const std::string &name )
+    : m_name(util::lower_case(name)), m_table(nullptr), m_data(nullptr), m_generation(0)
+{
+	/* nothing to do here */
+}
+
+var_table::var_table() : m_iterator(m_hash.begin()), m_generation(sg_vartabGeneration++)
 {
 	/* nothing to do here */
 }
@@ -206,36 +218,89 @@ var_table::~var_table()
 	clear();
 }
 
+void var_table::invalidate_handles()
+{
+    m_generation = sg_vartabGeneration++;
+}
+
 var_table &var_table::operator=( const var_table &rhs )
 {
+	if (this == &rhs) return *this;
+
 	clear();
 
+	// share the entries, they are copied on the first mutable access by either table
 	for ( var_hash::const_iterator it = rhs.m_hash.begin();
 		it != rhs.m_hash.end();
 		++it )
-		assign_match_case( (*it).first, *((*it).second) );
+	{
+		++(it->second->m_refs);
+		m_hash[ it->first ] = it->second;
+	}
+
+	// rhs is left untouched: its handles may now cache shared entries, but every write through a
+	// handle checks the entry's reference count first and unshares it. rhs may itself be a shared
+	// nested table that other threads are reading.
 
 	return *this;
 }
 
+void var_table::release( var_data *v )
+{
+	if ( --(v->m_refs) == 0 )
+		delete v;
+}
+
 void var_table::clear()
 {
 	for (var_hash::iterator it = m_hash.begin(); it != m_hash.end(); ++it)
-	{
-		// debug heap corruption
-		delete it->second; // delete the var_data object
-	}
+		release( it->second );
 	if (!m_hash.empty()) m_hash.clear();
+	invalidate_handles();
+}
+
+var_hash::iterator var_table::find( const std::string &name )
+{
+    var_hash::iterator it = m_hash.find(name);
+    if (it == m_hash.end())
+      it = m_hash.find( util::lower_case(name));
+    return it;
+}
+
+var_hash::const_iterator var_table::find( const std::string &name ) const
+{
+    var_hash::const_iterator it = m_hash.find(name);
+    if (it == m_hash.end())
+      it = m_hash.find( util::lower_case(name));
+    return it;
+}
+
+var_data *var_table::writable( var_hash::iterator it, bool keep_value )
+{
+    var_data *v = it->second;
+    if ( v->m_refs.load() > 1 )
+    {
+        // still shared with a copy of this table: give this table its own entry
+        var_data *own = keep_value ? new var_data(*v) : new var_data;
+        release( v );
+        it->second = own;
+        invalidate_handles();
+        v = own;
+    }
+    return v;
 }
 
 var_data *var_table::assign( const std::string &name, const var_data &val )
 {
-	var_data *v = lookup(name);
-	if (!v)
+	var_data *v;
+	var_hash::iterator it = find(name);
+	if (it == m_hash.end())
 	{
 		v = new var_data;
 		m_hash[ util::lower_case(name) ] = v;
 	}
+	else
+		v = writable( it, false );
 
 	v->copy(val);
 	return v;
@@ -243,34 +308,46 @@ var_data *var_table::assign( const std::string &name, const var_data &val )
 
 var_data *var_table::assign_match_case( const std::string &name, const var_data &val )
 {
-    var_data *v = lookup(name);
-    if (!v)
+    var_data *v;
+    var_hash::iterator it = find(name);
+    if (it == m_hash.end())
     {
         v = new var_data;
         m_hash[ name ] = v;
     }
+    else
+        v = writable( it, false );
 
     v->copy(val);
     return v;
 }
 
 void var_table::merge(const var_table &rhs, bool overwrite_existing){
+    if (this == &rhs) return;
+
     for ( var_hash::const_iterator it = rhs.m_hash.begin();
           it != rhs.m_hash.end();
           ++it ){
-        if (is_assigned(it->first)){
-            if (overwrite_existing)
-                assign_match_case( (*it).first, *((*it).second) );
+        var_hash::iterator cur = find( it->first );
+        if (cur == m_hash.end())
+        {
+            ++(it->second->m_refs);
+            m_hash[ it->first ] = it->second;
+        }
+        else if (overwrite_existing && cur->second != it->second)
+        {
+            ++(it->second->m_refs);
+            release( cur->second );
+            cur->second = it->second;
+            invalidate_handles();
         }
-        else
-            assign_match_case( (*it).first, *((*it).second) );
     }
 }
 
 
 bool var_table::is_assigned( const std::string &name )
 {
-    return (lookup(name) != 0);
+    return (lookup_const(name) != 0);
 }
 
 void var_table::unassign( const std::string &name )
@@ -278,8 +355,9 @@ void var_table::unassign( const std::string &name )
 	var_hash::iterator it = m_hash.find( util::lower_case(name) );
 	if (it != m_hash.end())
 	{
-		delete (*it).second; // delete the associated data
+		release( (*it).second ); // delete the associated data once no other table shares it
 		m_hash.erase( it );
+		invalidate_handles();
 	}
 }
 
@@ -298,13 +376,14 @@ bool var_table::rename_match_case( const std::string &oldname, const std::string
 
         var_data *data = it->second; // save ptr to data
         m_hash.erase( it );
+        invalidate_handles();
 
         // if a variable with 'newname' already exists,
         // delete its data, and reassign the name to the new data
         it = m_hash.find( lcnewname );
         if ( it != m_hash.end() )
         {
-            delete it->second;
+            release( it->second );
             it->second = data;
         }
         else // otherwise, just add a new itme
@@ -318,11 +397,9 @@ bool var_table::rename_match_case( const std::string &oldname, const std::string
 
 var_data *var_table::lookup( const std::string &name )
 {
-    var_hash::iterator it = m_hash.find(name);
-    if (it == m_hash.end())
-      it = m_hash.find( util::lower_case(name));
+    var_hash::iterator it = find(name);
     if ( it != m_hash.end() )
-      return (*it).second;
+      return writable( it );
     else
       return NULL;
 }
@@ -331,11 +408,32 @@ var_data *var_table::lookup_match_case( const std::string &name )
 {
     var_hash::iterator it = m_hash.find( name );
     if ( it != m_hash.end() )
-        return (*it).second;
+        return writable( it );
     else
         return NULL;
 }
 
+const var_data *var_table::lookup_const( const std::string &name ) const
+{
+    var_hash::const_iterator it = find(name);
+    if ( it != m_hash.end() )
+      return (*it).second;
+    else
+      return NULL;
+}
+
+var_data *var_table::lookup( var_handle &handle )
+{
+    if (!is_cached(handle) || handle.m_data->m_refs.load() > 1)
+    {
+        var_hash::iterator it = find(handle.m_name);
+        handle.m_data = (it != m_hash.end()) ? writable( it ) : NULL;
+        handle.m_table = this;
+        handle.m_generation = m_generation; // after writable(), which may start a new generation
+    }
+    return handle.m_data;
+}
+
 const char *var_table::first( )
 {
 	m_iterator = m_hash.begin();
@@ -370,27 +468,27 @@ const char *var_table::next()
 }
 
 void vt_get_int(var_table* vt, const std::string& name, int* lvalue) {
-	if (var_data* vd = vt->lookup(name)) *lvalue = (int)vd->num;
+	if (const var_data* vd = vt->lookup_const(name)) *lvalue = (int)vd->num.value();
 	else throw std::runtime_error(std::string(name) + std::string(" must be assigned."));
 }
 
 void vt_get_uint(var_table* vt, const std::string& name, size_t* lvalue) {
-    if (var_data* vd = vt->lookup(name)) *lvalue = (size_t)vd->num;
+    if (const var_data* vd = vt->lookup_const(name)) *lvalue = (size_t)vd->num.value();
     else throw std::runtime_error(std::string(name) + std::string(" must be assigned."));
 }
 
 void vt_get_bool(var_table* vt, const std::string& name, bool* lvalue) {
-    if (var_data* vd = vt->lookup(name)) *lvalue = (bool)vd->num;
+    if (const var_data* vd = vt->lookup_const(name)) *lvalue = (bool)vd->num.value();
     else throw std::runtime_error(std::string(name) + std::string(" must be assigned."));
 }
 
 void vt_get_number(var_table* vt, const std::string& name, double* lvalue) {
-	if (var_data* vd = vt->lookup(name)) *lvalue = vd->num;
+	if (const var_data* vd = vt->lookup_const(name)) *lvalue = vd->num.value();
 	else throw std::runtime_error(std::string(name) + std::string(" must be assigned."));
 }
 
 void vt_get_array_vec(var_table* vt, const std::string& name, std::vector<double>& vec_double) {
-	if (var_data* vd = vt->lookup(name)){
+	if (const var_data* vd = vt->lookup_const(name)){
 	    if (vd->type != SSC_ARRAY)
             throw std::runtime_error(std::string(name) + std::string(" must be array type."));
 	    vec_double = vd->arr_vector();
@@ -399,7 +497,7 @@ void vt_get_array_vec(var_table* vt, const std::string& name, std::vector<double
 }
 
 void vt_get_array_vec(var_table* vt, const std::string& name, std::vector<int>& vec_int) {
-    if (var_data* vd = vt->lookup(name)){
+    if (const var_data* vd = vt->lookup_const(name)){
         if (vd->type != SSC_ARRAY)
             throw std::runtime_error(std::string(name) + std::string(" must be array type."));
         vec_int.clear();
@@ -411,7 +509,7 @@ void vt_get_array_vec(var_table* vt, const std::string& name, std::vector<int>&
 }
 
 void vt_get_matrix(var_table* vt, const std::string& name, util::matrix_t<double>& matrix) {
-	if (var_data* vd = vt->lookup(name)){
+	if (const var_data* vd = vt->lookup_const(name)){
         if (vd->type == SSC_ARRAY)
         {
             std::vector<double> vec_double = vd->arr_vector();
@@ -427,61 +525,61 @@ void vt_get_matrix(var_table* vt, const std::string& name, util::matrix_t<double
 }
 
 void vt_get_matrix_vec(var_table* vt, const std::string& name, std::vector<std::vector<double>>& mat) {
-    if (var_data* vd = vt->lookup(name))
+    if (const var_data* vd = vt->lookup_const(name))
         mat = vd->matrix_vector();
     else throw std::runtime_error(std::string(name)+std::string(" must be assigned."));
 }
 
 int var_table::as_integer( const std::string &name )
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_NUMBER) throw cast_error("integer", *x, name);
-    return static_cast<int>(x->num);
+    return static_cast<int>(x->num.value());
 }
 size_t var_table::as_unsigned_long(const std::string &name)
 {
-    var_data*x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_NUMBER) throw cast_error("unsigned long", *x, name);
-    return static_cast<size_t>(x->num);
+    return static_cast<size_t>(x->num.value());
 }
 
 bool var_table::as_boolean( const std::string &name )
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_NUMBER) throw cast_error("boolean", *x, name);
-    return static_cast<bool> ( (int)(x->num!=0) );
+    return static_cast<bool> ( (int)(x->num.value()!=0) );
 }
 
 float var_table::as_float( const std::string &name )
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_NUMBER) throw cast_error("float", *x, name);
-    return static_cast<float>(x->num);
+    return static_cast<float>(x->num.value());
 }
 
 ssc_number_t var_table::as_number( const std::string &name )
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_NUMBER) throw cast_error("ssc_number_t", *x, name);
-    return x->num;
+    return x->num.value();
 }
 
 double var_table::as_double( const std::string &name )
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_NUMBER) throw cast_error("double", *x, name);
-    return static_cast<double>(x->num);
+    return static_cast<double>(x->num.value());
 }
 
 const char *var_table::as_string( const std::string &name )
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_STRING) throw cast_error("string", *x, name);
     return x->str.c_str();
@@ -492,18 +590,19 @@ ssc_number_t *var_table::as_array( const std::string &name, size_t *count )
     var_data* x = lookup(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_ARRAY) throw cast_error("array", *x, name);
+    x->num.detach(); // callers may write through the pointer, use as_span for read-only access
     if (count) *count = x->num.length();
     return x->num.data();
 }
 
 std::vector<int> var_table::as_vector_integer(const std::string &name)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_ARRAY) throw cast_error("array", *x, name);
     size_t len = x->num.length();
     std::vector<int> v(len);
-    ssc_number_t *p = x->num.data();
+    const ssc_number_t *p = x->num.data();
     for (size_t k = 0; k<len; k++)
         v[k] = static_cast<int>(p[k]);
     return v;
@@ -511,12 +610,12 @@ std::vector<int> var_table::as_vector_integer(const std::string &name)
 
 std::vector<ssc_number_t> var_table::as_vector_ssc_number_t(const std::string &name)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_ARRAY) throw cast_error("array", *x, name);
     size_t len = x->num.length();
     std::vector<ssc_number_t> v(len);
-    ssc_number_t *p = x->num.data();
+    const ssc_number_t *p = x->num.data();
     for (size_t k = 0; k<len; k++)
         v[k] = static_cast<ssc_number_t>(p[k]);
     return v;
@@ -524,48 +623,48 @@ std::vector<ssc_number_t> var_table::as_vector_ssc_number_t(const std::string &n
 
 std::vector<double> var_table::as_vector_double(const std::string &name)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_ARRAY) throw cast_error("array", *x, name);
     size_t len = x->num.length();
     std::vector<double> v(len);
-    ssc_number_t *p = x->num.data();
+    const ssc_number_t *p = x->num.data();
     for (size_t k=0;k<len;k++)
         v[k] = static_cast<double>(p[k]);
     return v;
 }
 std::vector<float> var_table::as_vector_float(const std::string &name)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_ARRAY) throw cast_error("array", *x, name);
     size_t len = x->num.length();
     std::vector<float> v(len);
-    ssc_number_t *p = x->num.data();
+    const ssc_number_t *p = x->num.data();
     for (size_t k = 0; k<len; k++)
         v[k] = static_cast<float>(p[k]);
     return v;
 }
 std::vector<size_t> var_table::as_vector_unsigned_long(const std::string &name)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_ARRAY) throw cast_error("array", *x, name);
     size_t len = x->num.length();
     std::vector<size_t> v(len);
-    ssc_number_t *p = x->num.data();
+    const ssc_number_t *p = x->num.data();
     for (size_t k = 0; k<len; k++)
         v[k] = static_cast<size_t>(p[k]);
     return v;
 }
 std::vector<bool> var_table::as_vector_bool(const std::string &name)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_ARRAY) throw cast_error("array", *x, name);
     size_t len = x->num.length();
     std::vector<bool> v(len);
-    ssc_number_t *p = x->num.data();
+    const ssc_number_t *p = x->num.data();
     for (size_t k = 0; k<len; k++)
         v[k] = p[k] != 0;
     return v;
@@ -576,6 +675,7 @@ ssc_number_t *var_table::as_matrix( const std::string &name, size_t *rows, size_
     var_data* x = lookup(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_MATRIX) throw cast_error("matrix", *x, name);
+    x->num.detach();
     if (rows) *rows = x->num.nrows();
     if (cols) *cols = x->num.ncols();
     return x->num.data();
@@ -583,7 +683,7 @@ ssc_number_t *var_table::as_matrix( const std::string &name, size_t *rows, size_
 
 util::matrix_t<double> var_table::as_matrix(const std::string &name)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_MATRIX) throw cast_error("matrix", *x, name);
 
@@ -597,7 +697,7 @@ util::matrix_t<double> var_table::as_matrix(const std::string &name)
 
 util::matrix_t<size_t> var_table::as_matrix_unsigned_long(const std::string &name)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_MATRIX) throw cast_error("matrix", *x, name);
 
@@ -612,7 +712,7 @@ util::matrix_t<size_t> var_table::as_matrix_unsigned_long(const std::string &nam
 
 util::matrix_t<double> var_table::as_matrix_transpose(const std::string &name)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_MATRIX) throw cast_error("matrix", *x, name);
 
@@ -626,12 +726,14 @@ util::matrix_t<double> var_table::as_matrix_transpose(const std::string &name)
 
 bool var_table::get_matrix(const std::string &name, util::matrix_t<ssc_number_t> &mat)
 {
-    var_data* x = lookup(name);
+    const var_data* x = lookup_const(name);
     if (!x) throw general_error(name + " not assigned");
     if (x->type != SSC_MATRIX) throw cast_error("matrix", *x, name);
 
     size_t nrows, ncols;
-    ssc_number_t *arr = as_matrix(name, &nrows, &ncols);
+    nrows = x->num.nrows();
+    ncols = x->num.ncols();
+    const ssc_number_t *arr = x->num.data();
 
     if (nrows < 1 || ncols < 1)
         return false;
@@ -644,6 +746,19 @@ bool var_table::get_matrix(const std::string &name, util::matrix_t<ssc_number_t>
     return true;
 }
 
+static number_span make_span( const var_data *x, const std::string &name )
+{
+    if (x->type != SSC_ARRAY && x->type != SSC_MATRIX) throw cast_error("array or matrix", *x, name);
+    return number_span(x->num.data(), x->num.nrows(), x->num.ncols());
+}
+
+number_span var_table::as_span( const std::string &name )
+{
+    const var_data* x = lookup_const(name);
+    if (!x) throw general_error(name + " not assigned");
+    return make_span(x, name);
+}
+
 ssc_number_t *var_table::allocate( const std::string &name, size_t length )
 {
     var_data *v = assign(name, var_data());
@@ -667,3 +782,129 @@ util::matrix_t<ssc_number_t>& var_table::allocate_matrix( const std::string &nam
     v->num.resize_fill(nrows, ncols, 0.0);
     return v->num;
 }
+
+bool var_table::is_cached( const var_handle &handle ) const
+{
+    return handle.m_table == this && handle.m_generation == m_generation && handle.m_data;
+}
+
+const var_data *var_table::lookup_const( var_handle &handle ) const
+{
+    // reads may go straight to an entry that is still shared with a copy of this table
+    if (!is_cached(handle))
+    {
+        var_hash::const_iterator it = find(handle.m_name);
+        handle.m_data = (it != m_hash.end()) ? it->second : NULL;
+        handle.m_table = this;
+        handle.m_generation = m_generation;
+    }
+    return handle.m_data;
+}
+
+const var_data *var_table::checked_read( var_handle &handle ) const
+{
+    const var_data *x = lookup_const(handle);
+    if (!x) throw general_error(handle.name() + " not assigned");
+    return x;
+}
+
+bool var_table::is_assigned( var_handle &handle )
+{
+    return lookup_const(handle) != NULL;
+}
+
+var_data *var_table::checked_lookup( var_handle &handle )
+{
+    var_data* x = lookup(handle);
+    if (!x) throw general_error(handle.name() + " not assigned");
+    return x;
+}
+
+var_data *var_table::assign( var_handle &handle, const var_data &value )
+{
+    if (!is_cached(handle) || handle.m_data->m_refs.load() > 1)
+    {
+        handle.m_data = assign(handle.name(), value);
+        handle.m_table = this;
+        handle.m_generation = m_generation;
+        return handle.m_data;
+    }
+
+    handle.m_data->copy(value);
+    return handle.m_data;
+}
+
+ssc_number_t *var_table::allocate( var_handle &handle, size_t length )
+{
+    var_data *v = assign(handle, var_data());
+    v->type = SSC_ARRAY;
+    v->num.resize_fill( length, 0.0 );
+    return v->num.data();
+}
+
+ssc_number_t *var_table::allocate( var_handle &handle, size_t nrows, size_t ncols )
+{
+    var_data *v = assign(handle, var_data());
+    v->type = SSC_MATRIX;
+    v->num.resize_fill(nrows, ncols, 0.0);
+    return v->num.data();
+}
+
+int var_table::as_integer( var_handle &handle )
+{
+    const var_data* x = checked_read(handle);
+    if (x->type != SSC_NUMBER) throw cast_error("integer", *x, handle.name());
+    return static_cast<int>(x->num.value());
+}
+
+bool var_table::as_boolean( var_handle &handle )
+{
+    const var_data* x = checked_read(handle);
+    if (x->type != SSC_NUMBER) throw cast_error("boolean", *x, handle.name());
+    return static_cast<bool> ( (int)(x->num.value()!=0) );
+}
+
+ssc_number_t var_table::as_number( var_handle &handle )
+{
+    const var_data* x = checked_read(handle);
+    if (x->type != SSC_NUMBER) throw cast_error("ssc_number_t", *x, handle.name());
+    return x->num.value();
+}
+
+double var_table::as_double( var_handle &handle )
+{
+    const var_data* x = checked_read(handle);
+    if (x->type != SSC_NUMBER) throw cast_error("double", *x, handle.name());
+    return static_cast<double>(x->num.value());
+}
+
+const char *var_table::as_string( var_handle &handle )
+{
+    const var_data* x = checked_read(handle);
+    if (x->type != SSC_STRING) throw cast_error("string", *x, handle.name());
+    return x->str.c_str();
+}
+
+ssc_number_t *var_table::as_array( var_handle &handle, size_t *count )
+{
+    var_data* x = checked_lookup(handle);
+    if (x->type != SSC_ARRAY) throw cast_error("array", *x, handle.name());
+    x->num.detach();
+    if (count) *count = x->num.length();
+    return x->num.data();
+}
+
+ssc_number_t *var_table::as_matrix( var_handle &handle, size_t *rows, size_t *cols )
+{
+    var_data* x = checked_lookup(handle);
+    if (x->type != SSC_MATRIX) throw cast_error("matrix", *x, handle.name());
+    x->num.detach();
+    if (rows) *rows = x->num.nrows();
+    if (cols) *cols = x->num.ncols();
+    return x->num.data();
+}
+
+number_span var_table::as_span( var_handle &handle )
+{
+    return make_span(checked_read(handle), handle.name());
+}
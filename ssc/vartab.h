@@ -23,6 +23,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef __lib_vartab_h
 #define __lib_vartab_h
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -38,9 +39,69 @@ using std::unordered_map;
 #endif
 
 class var_data;
+class var_table;
 
 typedef unordered_map< std::string, var_data* > var_hash;
 
+/**
+ * A pre-resolved reference to a variable name. The name is lower-cased once on construction and the
+ * var_data* it resolves to is cached along with the identity of the table it came from, so repeated
+ * reads and writes through the handle skip the string hashing done by the name-based accessors.
+ * The cache is refreshed automatically when used with a different table, or after the table has
+ * removed or renamed entries. A handle is not synchronized: share it across threads only if each
+ * thread uses its own copy.
+ */
+class var_handle
+{
+public:
+    var_handle() : m_table(nullptr), m_data(nullptr), m_generation(0) {}
+    explicit var_handle( const std::string &name );
+
+    const std::string &name() const { return m_name; }
+
+private:
+    friend class var_table;
+
+    std::string m_name;
+    const var_table *m_table;
+    var_data *m_data;
+    size_t m_generation;
+};
+
+/**
+ * Read-only view of the numbers held by an SSC_ARRAY or SSC_MATRIX variable, in row-major order.
+ * Unlike the as_vector_* getters nothing is copied, which also holds for variables that borrow
+ * caller-owned memory through ssc_data_set_array_ref or ssc_data_set_matrix_ref.
+ */
+class number_span
+{
+public:
+    number_span() : m_data(nullptr), m_nrows(0), m_ncols(0) {}
+    number_span( const ssc_number_t *data, size_t nrows, size_t ncols ) : m_data(data), m_nrows(nrows), m_ncols(ncols) {}
+
+    const ssc_number_t *data() const { return m_data; }
+    size_t size() const { return m_nrows * m_ncols; }
+    size_t nrows() const { return m_nrows; }
+    size_t ncols() const { return m_ncols; }
+    bool empty() const { return size() == 0; }
+
+    const ssc_number_t &operator[]( size_t i ) const { return m_data[i]; }
+    const ssc_number_t &at( size_t r, size_t c ) const { return m_data[r * m_ncols + c]; }
+    const ssc_number_t *begin() const { return m_data; }
+    const ssc_number_t *end() const { return m_data + size(); }
+
+private:
+    const ssc_number_t *m_data;
+    size_t m_nrows, m_ncols;
+};
+
+/**
+ * Copying a var_table is O(number of keys): entries are reference counted and shared with the
+ * source table until either side asks for a mutable var_data*, at which point that one entry is
+ * copied. Read-only getters (is_assigned, as_number, as_span, as_vector_*, ...) never copy.
+ * Pointers returned by lookup(), as_array() or allocate() must not be written through after the
+ * table has been copied; look the variable up again instead.
+ */
 class var_table
 {
 public:
@@ -59,6 +120,10 @@ public:
 	const char *key(int pos);
 	unsigned int size() { return (unsigned int)m_hash.size(); }
 
+    // resolve a handle against this table, NULL if not assigned
+    var_data *lookup( var_handle &handle );
+    const var_data *lookup_const( var_handle &handle ) const;
+
     // setters
     ssc_number_t *allocate( const std::string &name, size_t length );
     ssc_number_t *allocate( const std::string &name, size_t nrows, size_t ncols );
@@ -70,6 +135,7 @@ public:
 	// getters
 	var_data *lookup( const std::string &name );
 	var_data *lookup_match_case( const std::string &name );
+    const var_data *lookup_const( const std::string &name ) const;
     size_t as_unsigned_long(const std::string &name);
     int as_integer( const std::string &name );
     bool as_boolean( const std::string &name );
@@ -89,11 +155,36 @@ public:
     util::matrix_t<size_t> as_matrix_unsigned_long(const std::string & name);
     util::matrix_t<double> as_matrix_transpose(const std::string & name);
     bool get_matrix(const std::string &name, util::matrix_t<ssc_number_t> &mat);
+    number_span as_span( const std::string &name );
+
+    // handle-based setters and getters, see var_handle
+    var_data *assign( var_handle &handle, const var_data &value );
+    ssc_number_t *allocate( var_handle &handle, size_t length );
+    ssc_number_t *allocate( var_handle &handle, size_t nrows, size_t ncols );
+    bool is_assigned( var_handle &handle );
+    int as_integer( var_handle &handle );
+    bool as_boolean( var_handle &handle );
+    ssc_number_t as_number( var_handle &handle );
+    double as_double( var_handle &handle );
+    const char *as_string( var_handle &handle );
+    ssc_number_t *as_array( var_handle &handle, size_t *count );
+    ssc_number_t *as_matrix( var_handle &handle, size_t *rows, size_t *cols );
+    number_span as_span( var_handle &handle );
 
     unordered_map< std::string, var_data*>* get_hash() {return &m_hash;};
 private:
+    void invalidate_handles();
+    var_hash::iterator find( const std::string &name );
+    var_hash::const_iterator find( const std::string &name ) const;
+    var_data *writable( var_hash::iterator it, bool keep_value = true );
+    static void release( var_data *v );
+    bool is_cached( const var_handle &handle ) const;
+    const var_data *checked_read( var_handle &handle ) const;
+    var_data *checked_lookup( var_handle &handle );
+
 	var_hash m_hash;
 	var_hash::iterator m_iterator;
+	size_t m_generation; // changes whenever an entry is removed, renamed or unshared
 };
 
 
@@ -118,33 +209,29 @@ public:
     var_data(const std::vector<std::vector<var_data>>& vd_mat): type(SSC_DATMAT) { mat = vd_mat; }
 
 
-    const char *type_name();
+    const char *type_name() const;
 	static std::string type_name(int type);
 
 	std::string to_string();
 	static std::string to_string( const var_data &value );
 
-	std::vector<double> arr_vector();
-	std::vector<std::vector<double>> matrix_vector();
+	std::vector<double> arr_vector() const;
+	std::vector<std::vector<double>> matrix_vector() const;
 
 	static bool parse( unsigned char type, const std::string &buf, var_data &value );
 
 	var_data &operator=(const var_data &rhs) { copy(rhs); return *this; }
 	void copy( const var_data &rhs ) {
+	    if (this == &rhs) return;
 	    type=rhs.type;
-	    num=rhs.num;
+	    if (rhs.num.is_borrowed()) // share the view rather than copying caller-owned memory
+	        num.borrow(const_cast<ssc_number_t*>(rhs.num.data()), rhs.num.nrows(), rhs.num.ncols());
+	    else
+	        num=rhs.num;
 	    str=rhs.str;
 	    table = rhs.table;
-	    for (const auto& i : rhs.vec){
-	        vec.push_back(i);
-	    }
-        for (const auto& i : rhs.mat){
-            std::vector<var_data> vt;
-            for (const auto& j : i){
-                vt.push_back(j);
-            }
-            mat.push_back(vt);
-        }
+	    vec = rhs.vec;
+	    mat = rhs.mat;
 	}
 
 	void clear(){
@@ -163,6 +250,9 @@ public:
 	std::vector<var_data> vec;
     std::vector<std::vector<var_data>> mat;
 
+private:
+    friend class var_table;
+    std::atomic<int> m_refs{1}; // number of tables holding this entry, not copied
 };
 
 class general_error : public std::exception
@@ -176,7 +266,7 @@ public:
 class cast_error : public general_error
 {
 public:
-    cast_error(const char *target_type, var_data &source, const std::string &name)
+    cast_error(const char *target_type, const var_data &source, const std::string &name)
             : general_error( "cast fail: <" + std::string(target_type) + "> from " + std::string(source.type_name()) + " for: " + name ) { }
 };
 
@@ -419,3 +419,85 @@ TEST_F(AutoFOM_lib_battery_dispatch, DispatchFOM_ACAutoSubhourly) {
     }
 }
 
+
+TEST_F(AutoFOM_lib_battery_dispatch, DispatchFOM_ACOptimized) {
+    double dtHour = 1;
+    std::vector<double> revenue;
+    for (int mode : {dispatch_t::FOM_LOOK_AHEAD, dispatch_t::FOM_OPTIMIZED}) {
+        if (dispatchAuto) {
+            delete batteryModel;
+            delete dispatchAuto;
+            delete m_sharedInverter;
+        }
+        CreateBattery(dtHour);
+        dispatchAuto = new dispatch_automatic_front_of_meter_t(batteryModel, dtHour, 10, 100, 1, 49960, 49960, max_power,
+                                                               max_power, max_power, max_power, 1, mode, dispatch_t::FRONT, 1, 18, 1, true, true, false,
+                                                               false, 77000, 0, 1, 0.005, ppaRate, ur, 98, 98, 98);
+        dispatchAuto->update_pv_data(pv);
+        dispatchAuto->update_cliploss_data(clip);
+        batteryPower = dispatchAuto->getBatteryPower();
+        batteryPower->connectionMode = ChargeController::AC_CONNECTED;
+        batteryPower->voltageSystem = 600;
+        batteryPower->setSharedInverter(m_sharedInverter);
+
+        double value = 0;
+        for (size_t h = 0; h < 48; h++) {
+            batteryPower->powerGeneratedBySystem = pv[h];
+            batteryPower->powerPV = pv[h];
+            batteryPower->powerPVClipped = clip[h];
+
+            dispatchAuto->update_dispatch(h, 0, h);
+            if (mode == dispatch_t::FOM_OPTIMIZED && h < 5) {
+                EXPECT_NEAR(batteryPower->powerBatteryTarget, -clip[h], 0.1) << "clipped energy not stored at hour " << h;
+            }
+            dispatchAuto->dispatch(0, h, 0);
+            value += ppaRate[h] * batteryPower->powerGrid * dtHour;
+        }
+        revenue.push_back(value);
+    }
+    // the optimized schedule sells more in total than the heuristic with the same perfect forecast
+    EXPECT_GT(revenue[1], revenue[0]);
+}
+
+TEST_F(AutoFOM_lib_battery_dispatch, DispatchFOM_ACOptimizedLastDayOfYear) {
+    double dtHour = 1;
+    CreateBattery(dtHour);
+
+    // a year of the daily price pattern, with the clipping day moved to the last day of the year
+    std::vector<double> ppaYear, pvYear(8760, 0.), clipYear(8760, 0.);
+    for (size_t h = 0; h < 8760; h++)
+        ppaYear.push_back(ppaRate[h % 24]);
+    size_t lastDay = 8760 - 24;
+    for (size_t h = 0; h < 18; h++) {
+        pvYear[lastDay + 6 + h] = pv[h];
+        clipYear[lastDay + 6 + h] = clip[h];
+    }
+
+    dispatchAuto = new dispatch_automatic_front_of_meter_t(batteryModel, dtHour, 10, 100, 1, 49960, 49960, max_power,
+                                                           max_power, max_power, max_power, 1, dispatch_t::FOM_OPTIMIZED, dispatch_t::FRONT, 1, 18, 1, true, true, false,
+                                                           false, 77000, 0, 1, 0.005, ppaYear, ur, 98, 98, 98);
+    dispatchAuto->update_pv_data(pvYear);
+    dispatchAuto->update_cliploss_data(clipYear);
+    batteryPower = dispatchAuto->getBatteryPower();
+    batteryPower->connectionMode = ChargeController::AC_CONNECTED;
+    batteryPower->voltageSystem = 600;
+    batteryPower->setSharedInverter(m_sharedInverter);
+
+    double sold = 0;
+    for (size_t h = lastDay; h < 8760; h++) {
+        batteryPower->powerGeneratedBySystem = pvYear[h];
+        batteryPower->powerPV = pvYear[h];
+        batteryPower->powerPVClipped = clipYear[h];
+
+        dispatchAuto->update_dispatch(h, 0, h);
+        // daytime prices are low enough that PV charges on top of the clipping
+        if (clipYear[h] > 0) {
+            EXPECT_LE(batteryPower->powerBatteryTarget, -clipYear[h] + 0.1) << "clipped energy not stored at hour " << h;
+        }
+        dispatchAuto->dispatch(0, h, 0);
+        if (h % 24 >= 17 && h % 24 < 22)
+            sold += batteryPower->powerBatteryDC * dtHour;
+    }
+    // the stored clipping is sold in the evening peak of the last day
+    EXPECT_GT(sold, 0);
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <cmath>
+
+#include "lib_battery_dispatch_lp.h"
+
+class lib_battery_dispatch_lp_test : public ::testing::Test
+{
+protected:
+    size_t n = 24;
+    dispatch_lp_t::horizon_t horizon;
+
+    void SetUp() override {
+        horizon.energy_initial = 10;
+        horizon.energy_min = 10;
+        horizon.energy_max = 100;
+        horizon.power_charge_max = 25;
+        horizon.can_pv_charge = true;
+        horizon.can_clip_charge = true;
+        horizon.can_grid_charge = true;
+        horizon.eta_pv_charge = 0.95;
+        horizon.eta_grid_charge = 0.95;
+        horizon.eta_discharge = 0.95;
+        horizon.cycle_cost = 0.01;
+        for (size_t t = 0; t < n; t++) {
+            horizon.price.push_back(t < 12 ? 0.02 : 0.10);
+            horizon.power_pv.push_back(0);
+            horizon.power_clipped.push_back(0);
+            horizon.power_discharge_max.push_back(25);
+        }
+        horizon.price_grid = horizon.price;
+    }
+};
+
+TEST_F(lib_battery_dispatch_lp_test, ArbitrageChargesLowDischargesHigh) {
+    dispatch_lp_t lp(n, 1.0);
+    ASSERT_TRUE(lp.solve(horizon));
+
+    double charged = 0, discharged = 0;
+    for (size_t t = 0; t < n; t++) {
+        double P = lp.power_target(t);
+        EXPECT_GE(P, -25 - 1e-6);
+        EXPECT_LE(P, 25 + 1e-6);
+        if (t < 12)
+            EXPECT_LE(P, 1e-6) << "discharging at low price step " << t;
+        else
+            EXPECT_GE(P, -1e-6) << "charging at high price step " << t;
+        charged += std::fmax(-P, 0.);
+        discharged += std::fmax(P, 0.);
+        EXPECT_GE(lp.energy(t), 10 - 1e-6);
+        EXPECT_LE(lp.energy(t), 100 + 1e-6);
+    }
+    EXPECT_NEAR(charged, 90, 1e-6);
+    EXPECT_NEAR(discharged, 90, 1e-6);
+    EXPECT_NEAR(lp.energy(n - 1), 10, 1e-6);
+
+    // equally priced steps are used as early as possible
+    EXPECT_NEAR(lp.energy(3), 100, 1e-6);
+    EXPECT_NEAR(lp.energy(15), 10, 1e-6);
+
+    double expected = 90 * (0.10 * 0.95 - 0.01) - 90 * 0.02 / 0.95;
+    EXPECT_NEAR(lp.objective(), expected, 1e-3 * expected);
+}
+
+TEST_F(lib_battery_dispatch_lp_test, CapturesClippedEnergy) {
+    horizon.can_grid_charge = false;
+    for (size_t t = 0; t < n; t++) {
+        horizon.price[t] = 0.05;
+        horizon.power_pv[t] = t < 12 ? 500 : 0;
+        horizon.power_clipped[t] = t < 5 ? 20 : 0;
+    }
+    horizon.price_grid = horizon.price;
+
+    dispatch_lp_t lp(n, 1.0);
+    ASSERT_TRUE(lp.solve(horizon));
+
+    // storing PV that could be sold loses money at a flat price, storing clipped PV does not
+    double charged = 0;
+    for (size_t t = 0; t < n; t++) {
+        double P = lp.power_target(t);
+        EXPECT_GE(P, -horizon.power_clipped[t] - 1e-6) << "charging more than the clipped power at step " << t;
+        charged += std::fmax(-P, 0.);
+    }
+    EXPECT_NEAR(charged, 90, 1e-6);
+    double expected = 90 * (0.05 * 0.95 - 0.01);
+    EXPECT_NEAR(lp.objective(), expected, 1e-3 * expected);
+}
+
+TEST_F(lib_battery_dispatch_lp_test, NoTradeWithoutSpread) {
+    horizon.energy_initial = 50;
+    for (size_t t = 0; t < n; t++)
+        horizon.price[t] = 0.01;
+    horizon.price_grid = horizon.price;
+
+    // discharging is not worth the cycling cost, and charging can't be recovered
+    dispatch_lp_t lp(n, 1.0);
+    ASSERT_TRUE(lp.solve(horizon));
+    for (size_t t = 0; t < n; t++)
+        EXPECT_NEAR(lp.power_target(t), 0, 1e-6);
+    EXPECT_NEAR(lp.objective(), 0, 1e-6);
+}
+
+TEST_F(lib_battery_dispatch_lp_test, RollingHorizonStartsFromPreviousBasis) {
+    dispatch_lp_t lp(n, 1.0);
+    ASSERT_TRUE(lp.solve(horizon));
+    EXPECT_GT(lp.iterations(), 0);
+
+    // an unchanged horizon is already optimal
+    ASSERT_TRUE(lp.solve(horizon));
+    EXPECT_EQ(lp.iterations(), 0);
+
+    // roll the horizon forward, a reused model needs fewer iterations than a new one
+    long long warm = 0, cold = 0;
+    for (size_t h = 1; h < 48; h++) {
+        dispatch_lp_t::horizon_t rolled = horizon;
+        for (size_t t = 0; t < n; t++) {
+            rolled.price[t] = horizon.price[(t + h) % n];
+            rolled.price_grid[t] = rolled.price[t];
+        }
+        rolled.energy_initial = lp.energy(0);
+
+        ASSERT_TRUE(lp.solve(rolled));
+        warm += lp.iterations();
+
+        dispatch_lp_t fresh(n, 1.0);
+        ASSERT_TRUE(fresh.solve(rolled));
+        cold += fresh.iterations();
+        EXPECT_NEAR(lp.objective(), fresh.objective(), 1e-6) << "horizon " << h;
+    }
+    EXPECT_LT(2 * warm, cold);
+}
+
+TEST_F(lib_battery_dispatch_lp_test, NoChargeAndDischargeInOneStep) {
+    horizon.energy_initial = 50;
+    for (size_t t = 0; t < n; t++) {
+        horizon.price[t] = 0.18;
+        horizon.price_grid[t] = 0.06;
+    }
+
+    // buying from the grid while selling would pay in every step if it were allowed
+    dispatch_lp_t lp(n, 1.0);
+    ASSERT_TRUE(lp.solve(horizon));
+
+    // the objective is then exactly what the net power targets earn
+    double earned = 0;
+    for (size_t t = 0; t < n; t++) {
+        double P = lp.power_target(t);
+        if (P > 0)
+            earned += P * (0.18 * 0.95 - 0.01);
+        else
+            earned += P * 0.06 / 0.95;
+    }
+    EXPECT_NEAR(lp.objective(), earned, 1e-3 * earned);
+    EXPECT_GT(earned, 0);
+}
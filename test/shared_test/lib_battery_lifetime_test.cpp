@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <random>
 
 //#include "lib_battery_capacity.h"
 #include "lib_battery.h"
@@ -59,6 +60,33 @@ TEST_F(lib_battery_lifetime_cycle_test, runCycleLifetimeTest) {
 }
 
 
+TEST_F(lib_battery_lifetime_cycle_test, CachedBracketsMatchNewModel) {
+    double table_vals[27] = {10, 0, 100, 10, 8000, 85, 10, 16000, 70,
+                             50, 0, 100, 50, 3000, 80, 50, 6000, 60,
+                             100, 0, 100, 100, 1000, 80, 100, 2000, 50};
+    util::matrix_t<double> table;
+    table.assign(table_vals, 9, 3);
+    lifetime_cycle_t model(table);
+
+    // models copied from a running one look up the lifetime matrix from scratch
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> dist(0, 100);
+    for (size_t i = 0; i < 5000; i++) {
+        model.runCycleLifetime(dist(gen));
+        std::unique_ptr<lifetime_cycle_t> copy(model.clone());
+        ASSERT_EQ(copy->estimateCycleDamage(), model.estimateCycleDamage()) << i;
+
+        double DOD = dist(gen);
+        copy->runCycleLifetime(DOD);
+        model.runCycleLifetime(DOD);
+        ASSERT_EQ(copy->capacity_percent(), model.capacity_percent()) << i;
+
+        cycle_state s = model.get_state();
+        ASSERT_EQ(s.rainflow_peaks.size(), (size_t)s.rainflow_jlt) << i;
+    }
+    EXPECT_GT(model.cycles_elapsed(), 2000);
+}
+
 TEST_F(lib_battery_lifetime_cycle_test, replaceBatteryTest) {
     double DOD = 5;       // not used but required for function
     int idx = 0;
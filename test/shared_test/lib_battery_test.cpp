@@ -1,4 +1,5 @@
 #include <cmath>
+#include <sstream>
 #include <gtest/gtest.h>
 
 #include "logger.h"
@@ -347,6 +348,43 @@ TEST_F(lib_battery_test, runDuplicates) {
     EXPECT_NE(volt_state3->cell_voltage, volt_state2->cell_voltage);
 }
 
+TEST_F(lib_battery_test, CheckpointRollback) {
+    // cycle the battery so that the rainflow peaks are in use
+    for (size_t i = 0; i < 48; i++)
+        batteryModel->runCurrent(i % 6 < 3 ? 20. : -20.);
+
+    auto to_string = [](const battery_state &s) { std::ostringstream os; os << s; return os.str(); };
+    std::string before = to_string(batteryModel->get_state());
+
+    battery_state snapshot;
+    battery_t copy(*batteryModel);
+    batteryModel->checkpoint(snapshot);
+    batteryModel->checkpoint(copy);
+    EXPECT_EQ(to_string(snapshot), before);
+    EXPECT_EQ(to_string(copy.get_state()), before);
+
+    std::vector<double> power;
+    for (size_t i = 0; i < 12; i++) {
+        batteryModel->runCurrent(i < 5 ? 30. : -15.);
+        power.push_back(batteryModel->get_state().P);
+    }
+    std::string after = to_string(batteryModel->get_state());
+    ASSERT_NE(after, before);
+
+    // the snapshot holds its own copy of the lifetime state, so it is unchanged by running the battery
+    EXPECT_EQ(to_string(snapshot), before);
+    batteryModel->rollback(snapshot);
+    EXPECT_EQ(to_string(batteryModel->get_state()), before);
+    for (size_t i = 0; i < 12; i++) {
+        batteryModel->runCurrent(i < 5 ? 30. : -15.);
+        EXPECT_EQ(batteryModel->get_state().P, power[i]) << "step " << i;
+    }
+    EXPECT_EQ(to_string(batteryModel->get_state()), after);
+
+    batteryModel->rollback(copy);
+    EXPECT_EQ(to_string(batteryModel->get_state()), before);
+}
+
 TEST_F(lib_battery_test, createFromParams) {
     auto params = std::make_shared<battery_params>(batteryModel->get_params());
     auto bat = battery_t(params);
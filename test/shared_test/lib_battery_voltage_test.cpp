@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <functional>
+
+#include "6par_newton.h"
 
 //#include "lib_battery_capacity.h"
 #include "lib_battery.h"
@@ -321,6 +324,52 @@ TEST_F(voltage_dynamic_lib_battery_voltage_test, calculateMaxDischargeSubMinute)
     EXPECT_NEAR(cap->SOC(), 90.345, 1e-3);
 }
 
+TEST_F(voltage_dynamic_lib_battery_voltage_test, currentForTargetMatchesNewtonSolver){
+    size_t n_compared = 0;
+    for (double dt_hour : {1., 0.25, 1. / 60}) {
+        CreateModel(dt_hour);
+        double qmax = cap->qmax();
+        for (double SOC = 5; SOC <= 95; SOC += 5) {
+            double q = qmax * SOC * 0.01;
+            double max_current;
+            double max_charge = model->calculate_max_charge_w(q, qmax, 0, &max_current);
+            double max_discharge = model->calculate_max_discharge_w(q, qmax, 0, &max_current);
+            for (double fraction = -1; fraction <= 1; fraction += 0.125) {
+                double P = fraction > 0 ? fraction * max_discharge : -fraction * max_charge;
+                double I = model->calculate_current_for_target_w(P, q, qmax, 0);
+                if (P == 0) {
+                    EXPECT_EQ(I, 0);
+                    continue;
+                }
+
+                // power at the end of the time step, the residual previously handed to the generic Newton solver
+                std::function<void(const double *, double *)> f = [&](const double *x, double *resid) {
+                    resid[0] = x[0] * model->calculate_voltage_for_current(x[0], q - x[0] * dt_hour, qmax, 0) - P;
+                };
+                EXPECT_NEAR(I * model->calculate_voltage_for_current(I, q - I * dt_hour, qmax, 0), P, 1e-6 * fabs(P))
+                    << "dt " << dt_hour << " SOC " << SOC << " fraction " << fraction;
+
+                // the maximum discharge power can be met on both sides of the peak, the lower current is returned
+                if (fraction == 1) {
+                    EXPECT_LE(I, max_current * (1 + 1e-9)) << "dt " << dt_hour << " SOC " << SOC;
+                    continue;
+                }
+                double x[1] = {P / (n_cells_series * Vnom)}, resid[1];
+                bool check = false;
+                newton<double, std::function<void(const double *, double *)>, 1>(x, resid, check, f, 100, 1e-6, 1e-6, 0.7);
+
+                // the generic solver diverges charging well past full within short time steps
+                if (fabs(resid[0]) > 1e-6 * fabs(P))
+                    continue;
+                EXPECT_NEAR(I, x[0], 1e-4 * fmax(1, fabs(x[0])))
+                    << "dt " << dt_hour << " SOC " << SOC << " fraction " << fraction;
+                n_compared++;
+            }
+        }
+    }
+    EXPECT_GT(n_compared, 700);
+}
+
 TEST_F(voltage_table_lib_battery_voltage_test, updateCapacityTest){
     double dt_hour = 1;
     CreateModel(dt_hour);
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <stdlib.h>
 
 #include "lib_irradproc_test.h"
@@ -479,6 +480,87 @@ TEST_F(SunsetCaseIrradProc, CalcTestRadMode0_lib_irradproc){
 	*/
 }
 
+/**
+*   The batch irradiance processor must reproduce the scalar calc() path for every time step:
+*   hourly and 15 minute years at mid-latitude and arctic locations, fixed and tracked surfaces, all sky models
+*/
+TEST_F(IrradTest, CalcBatchMatchesScalar_lib_irradproc) {
+	vector<double> latitudes = { 39.77, 66.9, -17.75 };
+	vector<double> longitudes = { -105.22, -162.6, -179.3 };
+	vector<double> time_zones = { -7, -9, 12 };
+	vector<int> radiation_modes = { irrad::DN_DF, irrad::DN_GH, irrad::GH_DF };
+	vector<double> steps = { 1.0, 0.25 };
+
+	for (size_t loc = 0; loc < latitudes.size(); loc++) {
+		for (double delt : steps) {
+			int tracking = (int)loc;	// fixed, single axis and two axis
+			int sky = (int)loc;			// isotropic, hdkr and perez
+			int radmode = radiation_modes[loc];
+
+			irrad_batch batch;
+			batch.radiationMode = radmode;
+			size_t n = (size_t)(8760 / delt);
+			batch.resize(n);
+			batch.albedo.resize(n);
+			for (size_t i = 0; i < n; i++) {
+				double t = i * delt;
+				int m = util::month_of(t);
+				batch.year[i] = 2010;
+				batch.month[i] = m;
+				batch.day[i] = util::day_of_month(m, t);
+				batch.hour[i] = (int)t % 24;
+				batch.minute[i] = (t - (int)t) * 60 + delt * 30;
+				batch.globalHorizontal[i] = 300 + 100 * sin(t);
+				batch.directNormal[i] = 200 + 100 * cos(t);
+				batch.diffuseHorizontal[i] = 100;
+				batch.albedo[i] = (m > 3 && m < 11) ? 0.2 : 0.6;
+			}
+
+			irrad x;
+			x.set_location(latitudes[loc], longitudes[loc], time_zones[loc]);
+			x.set_sky_model(sky, 0.2);
+			x.set_surface(tracking, 30, 180, 45, tracking == 1, 0.4, false, 0);
+			x.calc_batch(batch, delt);
+
+			for (size_t i = 0; i < n; i++) {
+				irrad y;
+				y.set_time(batch.year[i], batch.month[i], batch.day[i], batch.hour[i], batch.minute[i], delt);
+				y.set_location(latitudes[loc], longitudes[loc], time_zones[loc]);
+				y.set_sky_model(sky, batch.albedo[i]);
+				y.set_surface(tracking, 30, 180, 45, tracking == 1, 0.4, false, 0);
+				if (radmode == irrad::DN_DF) y.set_beam_diffuse(batch.directNormal[i], batch.diffuseHorizontal[i]);
+				else if (radmode == irrad::DN_GH) y.set_global_beam(batch.globalHorizontal[i], batch.directNormal[i]);
+				else y.set_global_diffuse(batch.globalHorizontal[i], batch.diffuseHorizontal[i]);
+				int code = y.calc();
+				ASSERT_EQ(batch.code[i], code) << "location " << loc << ", step " << i;
+
+				double sun[6], angles[5], poa[6];
+				int sunup;
+				y.get_sun(&sun[0], &sun[1], &sun[2], &sun[3], &sun[4], &sun[5], &sunup, 0, 0, 0);
+				y.get_angles(&angles[0], &angles[1], &angles[2], &angles[3], &angles[4]);
+				y.get_poa(&poa[0], &poa[1], &poa[2], &poa[3], &poa[4], &poa[5]);
+
+				vector<double> batch_sun = { batch.sunAzimuth[i], batch.sunZenith[i], batch.sunElevation[i], batch.sunDeclination[i], batch.sunrise[i], batch.sunset[i] };
+				vector<double> batch_angles = { batch.angleOfIncidence[i], batch.surfaceTilt[i], batch.surfaceAzimuth[i], batch.axisRotation[i], batch.backtrackDifference[i] };
+				vector<double> batch_poa = { batch.poaBeam[i], batch.poaSkyDiffuse[i], batch.poaGroundDiffuse[i], batch.poaIsotropic[i], batch.poaCircumsolar[i], batch.poaHorizon[i] };
+				ASSERT_EQ(batch.sunUp[i], sunup) << "location " << loc << ", step " << i;
+				for (int k = 0; k < 6; k++)
+					ASSERT_DOUBLE_EQ(batch_sun[k], sun[k]) << "location " << loc << ", step " << i << ", sun parameter " << k;
+				for (int k = 0; k < 5; k++)
+					ASSERT_DOUBLE_EQ(batch_angles[k], angles[k]) << "location " << loc << ", step " << i << ", angle parameter " << k;
+				for (int k = 0; k < 6; k++)
+					ASSERT_DOUBLE_EQ(batch_poa[k], poa[k]) << "location " << loc << ", step " << i << ", poa parameter " << k;
+			}
+		}
+	}
+
+	// plane-of-array inputs need the decomposition state kept by calc()
+	irrad_batch poa_batch;
+	poa_batch.radiationMode = irrad::POA_R;
+	irrad x;
+	EXPECT_LT(x.calc_batch(poa_batch, 1.0), 0);
+}
+
 /**
 *   Test Sky Configuration factors.  These factors do not change with time, just system geometry
 */
@@ -607,4 +689,98 @@ TEST_F(BifacialIrradTest, TestRearSurfaceIrradiance)
 			ASSERT_NEAR(rearIrradiance[i], expectedRearIrradiance[i], e) << "Failed at t = " << t << " i = " << i;
 		}
 	}
-}
\ No newline at end of file
+}
+/**
+*   Rear-side irradiance with tabulated view factors against the full calculation, over the weather of the bifacialvf test case
+*/
+class BifacialViewFactorsTest : public BifacialIrradTest {
+protected:
+	std::vector<double> weather;
+
+	void SetUp() {
+		BifacialIrradTest::SetUp();
+		readDataFromTextFile(weatherFile, weather);
+	}
+
+	// rear-side irradiance at every daytime step in the weather file, with the view factors if given, and the time taken if asked
+	std::vector<double> rearIrradiance(double clearance, const bifacial_view_factors *viewFactors, double *seconds = 0) {
+		std::vector<double> rear;
+		std::chrono::duration<double> elapsed(0);
+		for (size_t t = 0; t + 10 <= weather.size(); t += 10) {
+			irrad x;
+			x.set_surface(tracking, tilt, azim, rotlim, backtrack, gcr, false, 0.0);
+			x.set_beam_diffuse(weather[t + 5], weather[t + 6]);
+			x.set_time((int)weather[t], (int)weather[t + 1], (int)weather[t + 2], (int)weather[t + 3], weather[t + 4], 1);
+			x.set_location(lat, lon, tz);
+			x.set_sky_model(skyModel, albedo);
+			x.calc();
+			for (size_t i = 0; i < 3; i++)
+				x.set_sun_component(i, weather[t + 7 + i]);
+
+			auto start = std::chrono::steady_clock::now();
+			if (viewFactors)
+				x.calc_rear_side(transmissionFactor, *viewFactors);
+			else
+				x.calc_rear_side(transmissionFactor, clearance, slopeLength);
+			elapsed += std::chrono::steady_clock::now() - start;
+			rear.push_back(x.get_poa_rear());
+		}
+		if (seconds)
+			*seconds = elapsed.count();
+		return rear;
+	}
+};
+
+TEST_F(BifacialViewFactorsTest, FixedTiltMatchesFullCalculation_lib_irradproc) {
+	bifacial_view_factors viewFactors;
+	viewFactors.setup(gcr, clearanceGround, slopeLength, false, std::vector<double>(1, tilt));
+
+	std::vector<double> full = rearIrradiance(clearanceGround, 0);
+	std::vector<double> table = rearIrradiance(clearanceGround, &viewFactors);
+	ASSERT_EQ(full.size(), table.size());
+	for (size_t i = 0; i < full.size(); i++)
+		ASSERT_NEAR(table[i], full[i], 1e-9 * fmax(1.0, fabs(full[i]))) << "step " << i;
+}
+
+TEST_F(BifacialViewFactorsTest, TrackerInterpolatesBetweenTilts_lib_irradproc) {
+	tracking = 1;
+	tilt = 0;
+	rotlim = 60;
+	backtrack = true;
+	double clearance = 1.5;
+
+	bifacial_view_factors viewFactors;
+	viewFactors.setup(gcr, clearance, slopeLength, true, bifacial_view_factors::tilt_range(1.0));
+
+	std::vector<double> full = rearIrradiance(clearance, 0);
+	std::vector<double> table = rearIrradiance(clearance, &viewFactors);
+	ASSERT_EQ(full.size(), table.size());
+	double total = 0, total_table = 0;
+	for (size_t i = 0; i < full.size(); i++) {
+		total += full[i];
+		total_table += table[i];
+	}
+	// interpolating between 1 degree tilts stays within 0.02% of the annual rear irradiance
+	EXPECT_NEAR(total_table, total, 2e-4 * total);
+}
+
+/// Full rear-side calculation against the tabulated view factors for a tracker, run with --gtest_also_run_disabled_tests
+TEST_F(BifacialViewFactorsTest, DISABLED_TrackerThroughput_lib_irradproc) {
+	tracking = 1;
+	tilt = 0;
+	rotlim = 60;
+	backtrack = true;
+	double clearance = 1.5;
+
+	auto setup_start = std::chrono::steady_clock::now();
+	bifacial_view_factors viewFactors;
+	viewFactors.setup(gcr, clearance, slopeLength, true, bifacial_view_factors::tilt_range(1.0));
+	double setup_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - setup_start).count();
+
+	double full_s, table_s;
+	std::vector<double> full = rearIrradiance(clearance, 0, &full_s);
+	std::vector<double> table = rearIrradiance(clearance, &viewFactors, &table_s);
+	ASSERT_EQ(full.size(), table.size());
+	printf("seconds for %d steps: full calculation %lg, tabulated %lg (%.1f times faster) after a %lg second table setup\n",
+		(int)full.size(), full_s, table_s, full_s / table_s, setup_s);
+}
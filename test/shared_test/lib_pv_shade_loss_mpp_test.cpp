@@ -0,0 +1,96 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "lib_pv_shade_loss_mpp.h"
+#include "lib_util.h"
+
+namespace {
+
+// every VMPP and IMPP vector for two strings, which spans the start and end of the database
+std::vector<double> two_string_vectors(const ShadeDB8_mpp &db) {
+	std::vector<double> all;
+	for (size_t d = 1; d <= 10; d++) {
+		for (size_t t = 1; t <= 10; t++) {
+			for (size_t S = 1; S <= db.n_choose_k(t + 1, t); S++) {
+				std::vector<double> v = db.get_vector(2, d, t, S, ShadeDB8_mpp::VMPP);
+				std::vector<double> i = db.get_vector(2, d, t, S, ShadeDB8_mpp::IMPP);
+				all.insert(all.end(), v.begin(), v.end());
+				all.insert(all.end(), i.begin(), i.end());
+			}
+		}
+	}
+	std::vector<double> last = db.get_vector(8, 10, 10, db.n_choose_k(17, 10), ShadeDB8_mpp::IMPP);
+	all.insert(all.end(), last.begin(), last.end());
+	return all;
+}
+
+}
+
+TEST(ShadeDB8Test, SharedInstanceIsCreatedOnce_lib_pv_shade_loss_mpp) {
+	std::vector<const ShadeDB8_mpp *> seen(4);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < seen.size(); t++)
+		threads.push_back(std::thread([&seen, t]() { seen[t] = ShadeDB8_mpp::shared().get(); }));
+	for (auto &th : threads)
+		th.join();
+
+	std::shared_ptr<const ShadeDB8_mpp> held = ShadeDB8_mpp::shared();
+	const ShadeDB8_mpp *db = held.get();
+	ASSERT_NE(db, nullptr);
+
+	ShadeDB8_mpp own;
+	own.init();
+	EXPECT_EQ(db->get_error(), own.get_error());
+	if (db->get_error().empty()) {
+		for (auto p : seen)
+			EXPECT_EQ(p, db);
+		EXPECT_EQ(two_string_vectors(*db), two_string_vectors(own));
+	}
+	else {
+		// a database that failed to load is not kept, every caller gets a new attempt
+		EXPECT_NE(ShadeDB8_mpp::shared().get(), db);
+	}
+}
+
+TEST(ShadeDB8Test, CacheRoundTrip_lib_pv_shade_loss_mpp) {
+	std::string file = ::testing::TempDir() + "shade_db8_test.bin";
+	util::remove_file(file.c_str());
+
+	ShadeDB8_mpp decompressed;
+	decompressed.init();
+
+	ShadeDB8_mpp::set_cache_file(file);
+	ShadeDB8_mpp writer, reader;
+	writer.init();
+	reader.init();
+	ShadeDB8_mpp::set_cache_file("");
+
+	// a database that failed to decompress is never cached
+	EXPECT_EQ(util::file_exists(file.c_str()), decompressed.get_error().empty());
+	EXPECT_EQ(two_string_vectors(writer), two_string_vectors(decompressed));
+	EXPECT_EQ(two_string_vectors(reader), two_string_vectors(decompressed));
+
+	util::remove_file(file.c_str());
+}
+
+TEST(ShadeDB8Test, IgnoresInvalidCache_lib_pv_shade_loss_mpp) {
+	std::string file = ::testing::TempDir() + "shade_db8_invalid.bin";
+	{
+		util::stdfile fp(file, "wb");
+		ASSERT_TRUE(fp.ok());
+		fputs("not a shading database", fp);
+	}
+
+	ShadeDB8_mpp decompressed, cached;
+	decompressed.init();
+	ShadeDB8_mpp::set_cache_file(file);
+	cached.init();
+	ShadeDB8_mpp::set_cache_file("");
+
+	EXPECT_EQ(cached.get_error(), decompressed.get_error());
+	EXPECT_EQ(two_string_vectors(cached), two_string_vectors(decompressed));
+	util::remove_file(file.c_str());
+}
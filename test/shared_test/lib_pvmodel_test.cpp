@@ -0,0 +1,162 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "lib_pvmodel.h"
+
+/**
+*   Explicit Lambert W single-diode solutions against the iterative solvers they replace,
+*   over operating conditions of a 72-cell crystalline module scaled the way cec6par_module_t does.
+*/
+class SingleDiodeTest : public ::testing::Test {
+protected:
+	struct operating_point { double a, Il, Io, Rs, Rsh, Voc0; };
+	std::vector<operating_point> points;
+
+	void SetUp() override {
+		double a_ref = 1.9, Il_ref = 7.5, Io_ref = 6e-10, Rs = 0.3, Rsh_ref = 300, Voc_ref = 44.5;
+		double muIsc = 0.004, Tref = 298.15, eg0 = 1.121, KB = 8.618e-5;
+		for (double G = 25; G <= 1200; G += 25) {
+			for (double Tc = -10; Tc <= 75; Tc += 5) {
+				double T = Tc + 273.15;
+				double EG = eg0 * (1 - 0.0002677 * (T - Tref));
+				operating_point p;
+				p.a = a_ref * T / Tref;
+				p.Il = G / 1000 * (Il_ref + muIsc * (T - Tref));
+				p.Io = Io_ref * pow(T / Tref, 3) * exp(1 / KB * (eg0 / Tref - EG / T));
+				p.Rs = Rs;
+				p.Rsh = Rsh_ref * 1000 / G;
+				p.Voc0 = Voc_ref;
+				points.push_back(p);
+			}
+		}
+	}
+};
+
+TEST(LambertWTest, SolvesDefiningEquation_lib_pvmodel) {
+	for (double logx = -50; logx <= 5000; logx += (logx < 10 ? 0.01 : 7.3)) {
+		double w = lambertw_exp(logx);
+		ASSERT_GT(w, 0) << "logx " << logx;
+		ASSERT_NEAR(w + log(w), logx, 1e-12 * fmax(1, fabs(logx))) << "logx " << logx;
+	}
+	EXPECT_NEAR(lambertw_exp(0), 0.5671432904097838, 1e-15);
+	EXPECT_NEAR(lambertw_exp(1), 1, 1e-15);
+}
+
+TEST_F(SingleDiodeTest, AgreesWithIterativeSolvers_lib_pvmodel) {
+	for (auto &p : points) {
+		double Voc_iter = openvoltage_5par(p.Voc0, p.a, p.Il, p.Io, p.Rsh);
+		double Voc = openvoltage_5par_lambertw(p.Voc0, p.a, p.Il, p.Io, p.Rsh);
+		ASSERT_NEAR(Voc, Voc_iter, 1e-3) << "Il " << p.Il << " a " << p.a;
+
+		// no current flows at open circuit, where series resistance has no effect
+		EXPECT_NEAR(current_5par_lambertw(Voc, p.a, p.Il, p.Io, 0, p.Rsh), 0, 1e-9);
+
+		double Vmp_iter, Imp_iter, Vmp, Imp;
+		double Pmp_iter = maxpower_5par(Voc_iter, p.a, p.Il, p.Io, p.Rs, p.Rsh, &Vmp_iter, &Imp_iter);
+		double Pmp = maxpower_5par_lambertw(Voc, p.a, p.Il, p.Io, p.Rs, p.Rsh, &Vmp, &Imp);
+		ASSERT_NEAR(Pmp, Pmp_iter, 1e-4 * Pmp_iter) << "Il " << p.Il << " a " << p.a;
+		ASSERT_NEAR(Vmp, Vmp_iter, 0.05) << "Il " << p.Il << " a " << p.a;
+
+		std::vector<double> V, I(50);
+		for (int k = 0; k < 50; k++)
+			V.push_back(Voc * k / 50.0);
+		current_5par_lambertw(V.size(), &V[0], &I[0], p.a, p.Il, p.Io, p.Rs, p.Rsh);
+		for (size_t k = 0; k < V.size(); k++) {
+			double I_iter = current_5par(V[k], 0.9 * p.Il, p.a, p.Il, p.Io, p.Rs, p.Rsh);
+			ASSERT_NEAR(I[k], I_iter, 1e-5) << "V " << V[k] << " Il " << p.Il << " a " << p.a;
+			ASSERT_EQ(I[k], current_5par_lambertw(V[k], p.a, p.Il, p.Io, p.Rs, p.Rsh));
+		}
+	}
+}
+
+TEST_F(SingleDiodeTest, OutOfRangeParametersFallBack_lib_pvmodel) {
+	// non-physical shunt resistance from extrapolated low-irradiance fits uses the iterative path
+	EXPECT_EQ(current_5par_lambertw(10, 1.9, 5, 6e-10, 0.3, -50), current_5par(10, 0.9 * 5, 1.9, 5, 6e-10, 0.3, -50));
+	EXPECT_EQ(openvoltage_5par_lambertw(44.5, 1.9, 5, 0, 300), openvoltage_5par(44.5, 1.9, 5, 0, 300));
+	EXPECT_NEAR(openvoltage_5par_lambertw(44.5, 1.9, 0, 6e-10, 300), 0, 1e-12);
+}
+
+TEST_F(SingleDiodeTest, BatchOfOperatingPoints_lib_pvmodel) {
+	size_t n = points.size();
+	std::vector<double> V(n), I(n), a(n), Il(n), Io(n), Rs(n), Rsh(n);
+	for (size_t i = 0; i < n; i++) {
+		auto &p = points[i];
+		V[i] = 0.8 * openvoltage_5par(p.Voc0, p.a, p.Il, p.Io, p.Rsh);
+		a[i] = p.a; Il[i] = p.Il; Io[i] = p.Io; Rs[i] = p.Rs; Rsh[i] = p.Rsh;
+	}
+	// a point with a non-physical shunt resistance falls back to the iterative solver on its own
+	Rsh[n / 2] = -50;
+
+	current_5par_lambertw(n, &V[0], &I[0], &a[0], &Il[0], &Io[0], &Rs[0], &Rsh[0]);
+	for (size_t i = 0; i < n; i++) {
+		ASSERT_EQ(I[i], current_5par_lambertw(V[i], a[i], Il[i], Io[i], Rs[i], Rsh[i])) << "point " << i;
+		ASSERT_NEAR(I[i], current_5par(V[i], 0.9 * Il[i], a[i], Il[i], Io[i], Rs[i], Rsh[i]), 1e-5) << "point " << i;
+	}
+}
+
+/// Iterative against Lambert W solver time per operating point, run with --gtest_also_run_disabled_tests
+TEST_F(SingleDiodeTest, DISABLED_Throughput_lib_pvmodel) {
+	typedef std::chrono::steady_clock clock;
+	const int repeat = 10;
+	double sum_iter = 0, sum = 0;
+	size_t n = points.size();
+	std::vector<double> Voc(n), V(100), I(100);
+	std::vector<double> Vp(n), Ip(n), a(n), Il(n), Io(n), Rs(n), Rsh(n);
+
+	auto t0 = clock::now();
+	for (int r = 0; r < repeat; r++)
+		for (size_t i = 0; i < n; i++)
+			sum_iter += Voc[i] = openvoltage_5par(points[i].Voc0, points[i].a, points[i].Il, points[i].Io, points[i].Rsh);
+	auto t1 = clock::now();
+	for (int r = 0; r < repeat; r++)
+		for (auto &p : points)
+			sum += openvoltage_5par_lambertw(p.Voc0, p.a, p.Il, p.Io, p.Rsh);
+	auto t2 = clock::now();
+	for (int r = 0; r < repeat; r++)
+		for (size_t i = 0; i < n; i++)
+			sum_iter += maxpower_5par(Voc[i], points[i].a, points[i].Il, points[i].Io, points[i].Rs, points[i].Rsh);
+	auto t3 = clock::now();
+	for (int r = 0; r < repeat; r++)
+		for (size_t i = 0; i < n; i++)
+			sum += maxpower_5par_lambertw(Voc[i], points[i].a, points[i].Il, points[i].Io, points[i].Rs, points[i].Rsh);
+	auto t4 = clock::now();
+	for (int r = 0; r < repeat; r++)
+		for (size_t i = 0; i < n; i++)
+			for (int k = 0; k < 100; k++)
+				sum_iter += current_5par(Voc[i] * k / 100.0, 0.9 * points[i].Il, points[i].a, points[i].Il, points[i].Io, points[i].Rs, points[i].Rsh);
+	auto t5 = clock::now();
+	for (int r = 0; r < repeat; r++) {
+		for (size_t i = 0; i < n; i++) {
+			for (int k = 0; k < 100; k++)
+				V[k] = Voc[i] * k / 100.0;
+			current_5par_lambertw(V.size(), &V[0], &I[0], points[i].a, points[i].Il, points[i].Io, points[i].Rs, points[i].Rsh);
+			for (int k = 0; k < 100; k++)
+				sum += I[k];
+		}
+	}
+	auto t6 = clock::now();
+	for (size_t i = 0; i < n; i++) {
+		Vp[i] = 0.8 * Voc[i];
+		a[i] = points[i].a; Il[i] = points[i].Il; Io[i] = points[i].Io; Rs[i] = points[i].Rs; Rsh[i] = points[i].Rsh;
+	}
+	for (int r = 0; r < repeat; r++)
+		for (size_t i = 0; i < n; i++)
+			sum_iter += current_5par(Vp[i], 0.9 * Il[i], a[i], Il[i], Io[i], Rs[i], Rsh[i]);
+	auto t7 = clock::now();
+	for (int r = 0; r < repeat; r++) {
+		current_5par_lambertw(n, &Vp[0], &Ip[0], &a[0], &Il[0], &Io[0], &Rs[0], &Rsh[0]);
+		for (size_t i = 0; i < n; i++)
+			sum += Ip[i];
+	}
+	auto t8 = clock::now();
+
+	EXPECT_NEAR(sum, sum_iter, 1e-4 * sum_iter);
+	auto us = [&](clock::time_point a, clock::time_point b) { return std::chrono::duration<double>(b - a).count() * 1e6 / (repeat * n); };
+	printf("microseconds per operating point, iterative vs Lambert W: open circuit voltage %.2f vs %.2f, max power %.2f vs %.2f, "
+		"100 point I-V sweep %.2f vs %.2f, current at one voltage per point %.2f vs %.2f\n",
+		us(t0, t1), us(t1, t2), us(t2, t3), us(t3, t4), us(t4, t5), us(t5, t6), us(t6, t7), us(t7, t8));
+}
@@ -0,0 +1,31 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "lib_pvshade.h"
+
+TEST(SkyDiffuseTableTest, InterpolatedMatchesIntegrated_lib_pvshade) {
+	for (double gcr = 0.05; gcr < 0.99; gcr += 0.0637) {
+		for (double tilt = 0.1; tilt < 90; tilt += 0.733) {
+			double tol = (tilt < 85 && gcr > 0.1) ? 3e-4 : 2e-3;
+			ASSERT_NEAR(sssky_diffuse_table::interpolated(tilt, gcr), sssky_diffuse_table::integrate(tilt, gcr), tol)
+				<< "tilt " << tilt << " gcr " << gcr;
+		}
+	}
+
+	// on the grid the interpolation returns the integrated derate
+	EXPECT_DOUBLE_EQ(sssky_diffuse_table::interpolated(30, 0.3), sssky_diffuse_table::integrate(30, 0.3));
+	EXPECT_DOUBLE_EQ(sssky_diffuse_table::interpolated(90, 0.99), sssky_diffuse_table::integrate(90, 0.99));
+}
+
+TEST(SkyDiffuseTableTest, LookupOutsideGridIntegrates_lib_pvshade) {
+	EXPECT_EQ(sssky_diffuse_table::interpolated(-5, 0.4), -1);
+	EXPECT_EQ(sssky_diffuse_table::interpolated(30, 0.995), -1);
+
+	sssky_diffuse_table computed, table;
+	computed.init(20, 0.4);
+	table.init(20, 0.4, true);
+	EXPECT_NEAR(table.lookup(20), computed.lookup(20), 1e-12);
+	EXPECT_NEAR(table.lookup(47.3), computed.lookup(47.3), 3e-4);
+	EXPECT_EQ(table.lookup(95), computed.lookup(95));
+}
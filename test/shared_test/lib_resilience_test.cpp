@@ -639,3 +639,43 @@ TEST_F(ResilienceTest_lib_resilience, PVWattsACHourly_Charge)
     for (size_t i = 0; i < cdf.size(); i++)
         EXPECT_NEAR(cdf[i] + survival_fx[i], 1., 1e-3) << i;
 }
+
+TEST_F(ResilienceTest_lib_resilience, RestartedOutagesMatchNewBatteries)
+{
+    // batt is ac-connected
+    CreateBattery(true, 1, 0. ,1., 1.);
+
+    // outages restarting depleted batteries survive as long as outages given a new copy of the dispatch
+    resilience_runner resilience(batt);
+    const double voltage = 500;
+    const size_t n = 24;
+    std::vector<std::shared_ptr<dispatch_resilience>> new_batteries;
+    std::vector<size_t> steps_survived(n, 0);
+    std::vector<bool> depleted(n, false);
+    for (size_t i = 0; i < n; i++){
+        batt->initialize_time(0, i, 0);
+        resilience.add_battery_at_outage_timestep(*dispatch, i);
+        new_batteries.emplace_back(std::make_shared<dispatch_resilience>(*dispatch, i));
+
+        double pv_kwac = i % 6 == 5 ? 3. : 0.;
+        resilience.run_surviving_batteries(load[i], pv_kwac, 0, 0, 0, 0);
+        for (size_t j = 0; j <= i; j++){
+            if (depleted[j])
+                continue;
+            depleted[j] = !new_batteries[j]->run_outage_step_ac(load[i], pv_kwac);
+            steps_survived[j] = new_batteries[j]->get_indices_survived();
+        }
+        batt->advance(vartab, ac[i], voltage, load[i]);
+    }
+
+    auto survived_hours = resilience.get_hours_survived();
+    size_t n_depleted = 0;
+    for (size_t j = 0; j < n; j++){
+        if (!depleted[j])
+            continue;
+        EXPECT_EQ(survived_hours[j], steps_survived[j]) << "outage starting at " << j;
+        n_depleted++;
+    }
+    EXPECT_GT(n_depleted, n / 2);
+    EXPECT_EQ(resilience.get_n_surviving_batteries(), n - n_depleted);
+}
@@ -196,11 +196,12 @@ TEST_F(sharedInverterTest_lib_shared_inverter, tempDerateTest_lib_shared_inverte
 TEST_F(sharedInverterTest_lib_shared_inverter, calculateEffForACPower){
     inv->calculateACPower(sandia.Pdco / 1000., sandia.Vdco, 25);
 
-    // really small ac output
+    // really small ac output, reached at low efficiency just above the start-up power Pso
     double p_kwac = .05;
     double p_kwdc = inv->calculateRequiredDCPower(p_kwac, sandia.Vdco, 25);
     inv->calculateACPower(p_kwdc, sandia.Vdco, 25);
-    EXPECT_LT(inv->powerAC_kW, p_kwac) << "inverter efficiency too low to produce required ac";
+    EXPECT_GT(p_kwdc * 1000., sandia.Pso);
+    EXPECT_NEAR(inv->powerAC_kW, p_kwac, 1e-6) << "inverter should produce small ac at low efficiency";
 
     // range of ac values
     for (auto p : {0.05, 0.95, 1.}){
@@ -228,3 +229,116 @@ TEST_F(sharedInverterTest_lib_shared_inverter, calculateEffForACPower){
         EXPECT_NEAR(inv->powerAC_kW, -sandia.Paco / 1000., 1e-3) << "inverter cannot produce more than max (negative) Paco";
     }
 }
+
+/// The direct inverses give the same DC power as the iterative solver and reproduce the AC target
+TEST_F(sharedInverterTest_lib_shared_inverter, requiredDCPowerInverse_lib_shared_inverter){
+    partload_inverter_t partload;
+    partload.Paco = 4000;
+    partload.Pdco = 4150;
+    partload.Vdco = 400;
+    partload.Pntare = 1;
+    partload.Partload = {0, 5, 10, 20, 30, 50, 75, 100, 120};
+    partload.Efficiency = {0, 88, 93, 95.5, 96.3, 96.8, 96.7, 96.5, 96.2};
+
+    std::vector<SharedInverter*> direct = {new SharedInverter(SharedInverter::SANDIA_INVERTER, 10, &sandia, nullptr, nullptr),
+                                           new SharedInverter(SharedInverter::PARTLOAD_INVERTER, 10, nullptr, &partload, nullptr)};
+    std::vector<double> paco_kw = {sandia.Paco * 10 / 1000., partload.Paco * 10 / 1000.};
+
+    // a derate curve that never applies sends the same inverters through the solver
+    std::vector<SharedInverter*> solved;
+    for (auto inverter : direct) {
+        solved.push_back(new SharedInverter(*inverter));
+        ASSERT_EQ(solved.back()->setTempDerateCurves({{400., 1000., -0.1}}), 0);
+    }
+
+    for (size_t i = 0; i < direct.size(); i++) {
+        for (double V : {500., 630., 800.}) {
+            // below clipping, where the DC power for an AC target is unique
+            for (int pct = 2; pct < 100; pct += 2) {
+                double kwac = pct / 100. * paco_kw[i];
+                double kwdc = direct[i]->calculateRequiredDCPower(kwac, V, 25);
+
+                // the solver can stall when its first guess is clipped, so compare where it converged
+                double kwdc_solved = solved[i]->calculateRequiredDCPower(kwac, V, 25);
+                solved[i]->calculateACPower(kwdc_solved, V, 25);
+                if (fabs(solved[i]->powerAC_kW - kwac) < 1e-6 * kwac)
+                    EXPECT_NEAR(kwdc, kwdc_solved, 1e-5 * kwdc) << "model " << i << " V " << V << " ac " << kwac;
+
+                direct[i]->calculateACPower(kwdc, V, 25);
+                EXPECT_NEAR(direct[i]->powerAC_kW, kwac, 1e-9 * kwac) << "model " << i << " V " << V << " ac " << kwac;
+
+                // battery charging runs the same curve with negative power
+                EXPECT_DOUBLE_EQ(direct[i]->calculateRequiredDCPower(-kwac, V, 25), -kwdc);
+            }
+
+            // at and above clipping, the DC power where clipping starts
+            double kwdc = direct[i]->calculateRequiredDCPower(1.05 * paco_kw[i], V, 25);
+            direct[i]->calculateACPower(kwdc, V, 25);
+            EXPECT_NEAR(direct[i]->powerAC_kW, paco_kw[i], 1e-9 * paco_kw[i]);
+            EXPECT_EQ(direct[i]->powerClipLoss_kW, 0);
+        }
+    }
+    for (auto inverter : direct) delete inverter;
+    for (auto inverter : solved) delete inverter;
+}
+
+/// OND efficiency curves tabulated at initialization against the splines they are built from
+TEST(ondInverterTest_lib_shared_inverter, efficiencyTableMatchesSpline_lib_shared_inverter){
+    ond_inverter ond;
+    ond.PNomConv = 500000;
+    ond.PMaxOUT = 600000;
+    ond.VOutConv = 300;
+    ond.VMppMin = 450;
+    ond.VMPPMax = 825;
+    ond.VAbsMax = 1000;
+    ond.PSeuil = 2500;
+    ond.PNomDC = 500000;
+    ond.PMaxDC = 600000;
+    ond.IMaxDC = 1375;
+    ond.INomDC = 1145;
+    ond.INomAC = 965;
+    ond.IMaxAC = 1160;
+    ond.TPNom = 50;
+    ond.TPMax = 25;
+    ond.TPLim1 = 51;
+    ond.TPLimAbs = 60;
+    ond.PLim1 = 495000;
+    ond.PLimAbs = 0;
+    ond.NbInputs = 15;
+    ond.NbMPPT = 1;
+    ond.Aux_Loss = 350;
+    ond.Night_Loss = 65;
+    ond.lossRDc = 0.01162243;
+    ond.lossRAc = 0.001552915;
+    ond.effCurve_elements = 3;
+    ond.doAllowOverpower = -1;
+    ond.doUseTemperatureLimit = -1;
+    ond.ModeOper = "MPPT";
+    ond.CompPMax = "Lim";
+    ond.CompVMax = "Lim";
+    ond.ModeAffEnum = "Efficiencyf_PIn";
+    double V[3] = {450, 600, 825};
+    double Pdc[3][8] = {{2500, 25400, 50400, 100000, 149700, 249900, 375300, 500000},
+                        {2500, 25300, 50600, 100400, 149900, 249900, 375300, 500000},
+                        {2500, 25600, 50500, 100000, 150000, 250200, 375600, 500000}};
+    double eta[3][8] = {{0, 0.937, 0.966, 0.981, 0.986, 0.986, 0.983, 0.981},
+                        {0, 0.925, 0.968, 0.976, 0.9810001, 0.984, 0.982, 0.98},
+                        {0, 0.8469999, 0.97, 0.958, 0.971, 0.976, 0.976, 0.974}};
+    for (int j = 0; j < 3; j++) {
+        ond.VNomEff[j] = V[j];
+        for (int i = 0; i < 100; i++) {
+            ond.effCurve_Pdc[j][i] = i < 8 ? Pdc[j][i] : 0;
+            ond.effCurve_eta[j][i] = i < 8 ? eta[j][i] : 0;
+            ond.effCurve_Pac[j][i] = ond.effCurve_Pdc[j][i] * ond.effCurve_eta[j][i];
+        }
+    }
+    ond.initializeManual();
+
+    // the 2048 point table stays within 5e-7 of the spline it samples, relative to the efficiency
+    for (int j = 0; j < 3; j++) {
+        for (double P = 100; P <= 650000; P += 37.3) {
+            double spline = ond.calcEfficiencySpline(P, j);
+            ASSERT_NEAR(ond.calcEfficiency(P, j), spline, 5e-7 * spline) << "curve " << j << " Pdc " << P;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "lib_snowmodel.h"
+
+TEST(SnowModelTest, SnowFreeSpansMatchStepByStep_lib_snowmodel) {
+	// a synthetic winter with snowfalls, melts, snow-free weeks and a few bad depth readings
+	size_t n = 2000;
+	std::vector<double> poa(n), tilt(n, 30), wspd(n), tdry(n), depth(n), sunup(n);
+	for (size_t i = 0; i < n; i++) {
+		int hr = i % 24;
+		sunup[i] = (hr >= 7 && hr <= 17) ? 1 : 0;
+		poa[i] = sunup[i] > 0 ? 600 * sin(M_PI * (hr - 6) / 12.0) : 0;
+		wspd[i] = 2 + (i % 7);
+		tdry[i] = -5 + 10 * sin(2 * M_PI * i / 240.0);
+		size_t day = i / 24;
+		if (day % 20 < 6)
+			depth[i] = 15 * (6 - day % 20) / 6.0;
+		else
+			depth[i] = (i % 37 == 0) ? 0.5 : 0;
+	}
+	depth[300] = -1;
+	depth[1500] = 2000;
+
+	pvsnowmodel stepwise, spans;
+	stepwise.setup(2, 30);
+	spans.setup(2, 30);
+
+	std::vector<float> expected(n), loss(n);
+	bool stepwiseGood = true;
+	for (size_t i = 0; i < n; i++)
+		stepwiseGood &= stepwise.getLoss((float)poa[i], (float)tilt[i], (float)wspd[i], (float)tdry[i], (float)depth[i], (int)sunup[i], 1.0, expected[i]);
+
+	EXPECT_EQ(spans.getLosses(n, &poa[0], &tilt[0], &wspd[0], &tdry[0], &depth[0], &sunup[0], 1.0, &loss[0]), stepwiseGood);
+	EXPECT_EQ(loss, expected);
+	EXPECT_EQ(spans.badValues, stepwise.badValues);
+	EXPECT_EQ(spans.coverage, stepwise.coverage);
+	EXPECT_EQ(spans.previousDepth, stepwise.previousDepth);
+
+	double total = 0;
+	for (float l : loss) total += l;
+	EXPECT_GT(total, 0);
+}
@@ -0,0 +1,200 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "lib_text_tokenizer.h"
+
+namespace {
+
+std::string write_temp(const std::string &name, const std::string &text) {
+    std::string file = ::testing::TempDir() + name;
+    FILE *fp = fopen(file.c_str(), "wb");
+    fwrite(text.data(), 1, text.size(), fp);
+    fclose(fp);
+    return file;
+}
+
+// the per-line parsing the weather and wind readers used before text_tokenizer
+std::vector<std::string> getline_split(const std::string &line, char delim = ',') {
+    std::vector<std::string> fields;
+    std::string token;
+    std::istringstream ss(line);
+    while (std::getline(ss, token, delim))
+        fields.push_back(token);
+    return fields;
+}
+
+bool same_float(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0 || (std::isnan(a) && std::isnan(b));
+}
+
+// every field of a file as a float, NaN where it does not parse, the old way and with text_tokenizer
+std::vector<float> parse_with_getline(const std::string &file) {
+    std::vector<float> values;
+    std::ifstream ifs(file);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        for (auto &field : getline_split(line)) {
+            float v;
+            try { v = std::stof(field); }
+            catch (const std::exception &) { v = std::numeric_limits<float>::quiet_NaN(); }
+            values.push_back(v);
+        }
+    }
+    return values;
+}
+
+bool parse_with_tokenizer(const std::string &file, std::vector<float> &values) {
+    text_tokenizer tok(file);
+    if (!tok.ok())
+        return false;
+    while (tok.next_line()) {
+        size_t n = tok.split();
+        for (size_t i = 0; i < n; i++) {
+            float v;
+            if (!text_tokenizer::parse_float(tok.field(i), tok.field(i) + tok.field_length(i), &v))
+                v = std::numeric_limits<float>::quiet_NaN();
+            values.push_back(v);
+        }
+    }
+    return true;
+}
+
+const char *resource_files[] = {"weather.csv", "weather_30m.epw", "weather_15mInterpolated.csv", "wind.srw",
+                                "AR Northwestern-Flat Lands-15min.srw"};
+
+}
+
+TEST(text_tokenizer_test, lines_and_fields_match_getline) {
+    std::string text = "a,b,\n\n1,,2\r\n  x , y\n,\nlast,no newline";
+    std::string file = write_temp("tokenizer_lines.csv", text);
+
+    text_tokenizer tok(file);
+    ASSERT_TRUE(tok.ok());
+    EXPECT_EQ(tok.count_lines(), 6);
+    EXPECT_EQ(tok.count_lines(true), 1);
+
+    std::istringstream ref(text);
+    std::string line;
+    while (std::getline(ref, line)) {
+        ASSERT_TRUE(tok.next_line());
+        EXPECT_EQ(tok.line_str(), line);
+        EXPECT_EQ(tok.eof(), ref.eof());
+        std::vector<std::string> fields = getline_split(line);
+        ASSERT_EQ(tok.split(), fields.size()) << line;
+        for (size_t i = 0; i < fields.size(); i++)
+            EXPECT_EQ(tok.field_str(i), fields[i]);
+    }
+    EXPECT_FALSE(tok.next_line());
+    EXPECT_TRUE(tok.eof());
+
+    tok.rewind();
+    tok.next_line();
+    tok.next_line();
+    tok.next_line();
+    tok.next_line();
+    tok.trim_line();
+    EXPECT_EQ(tok.line_str(), "x , y");
+    std::remove(file.c_str());
+}
+
+TEST(text_tokenizer_test, numbers_match_c_library) {
+    std::vector<std::string> inputs = {"0", "-0", "12", "  7.5", "+3.25e2", "1e-3", ".5", "5.", "1.e5", "-.75",
+                                       "1013.25", "-112.016667", "33.433333", "0.1", "0.3", "99.9", "9999",
+                                       "1e39", "1e-50", "123456789012345678901234", "0x1A", "inf", "nan",
+                                       "abc", "", "-", "1e", "2e+", "17,3", "6.02214076e23", "4.9e-324"};
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> digits(0, 9), len(1, 9), exps(-30, 30);
+    for (int k = 0; k < 20000; k++) {
+        std::string s = (k % 3 == 0) ? "-" : "";
+        int n = len(rng), dot = len(rng) % (n + 1);
+        for (int i = 0; i < n; i++) {
+            if (i == dot) s += '.';
+            s += (char)('0' + digits(rng));
+        }
+        if (k % 5 == 0) s += "e" + std::to_string(exps(rng));
+        inputs.push_back(s);
+    }
+
+    for (auto &s : inputs) {
+        const char *begin = s.c_str(), *end = begin + s.length();
+        char *lib_end = nullptr;
+
+        errno = 0;
+        float lib_f = strtof(begin, &lib_end);
+        bool lib_f_ok = lib_end != begin && errno != ERANGE;
+        float f = -1;
+        const char *q = text_tokenizer::parse_float(begin, end, &f);
+        ASSERT_EQ(q != nullptr, lib_f_ok) << s;
+        if (q) {
+            EXPECT_EQ(q, lib_end) << s;
+            EXPECT_TRUE(same_float(f, lib_f)) << s << ": " << f << " vs " << lib_f;
+        }
+
+        errno = 0;
+        double lib_d = strtod(begin, &lib_end);
+        bool lib_d_ok = lib_end != begin && errno != ERANGE;
+        double d = -1;
+        q = text_tokenizer::parse_double(begin, end, &d);
+        ASSERT_EQ(q != nullptr, lib_d_ok) << s;
+        if (q) {
+            EXPECT_EQ(q, lib_end) << s;
+            EXPECT_TRUE(std::memcmp(&d, &lib_d, sizeof(d)) == 0 || (std::isnan(d) && std::isnan(lib_d))) << s;
+        }
+    }
+
+    int x = 0;
+    const char *t = " -42,";
+    EXPECT_EQ(text_tokenizer::parse_int(t, t + 5, &x), t + 4);
+    EXPECT_EQ(x, -42);
+    t = "99999999999";
+    EXPECT_EQ(text_tokenizer::parse_int(t, t + 11, &x), nullptr);
+}
+
+/// Checks that text_tokenizer parses the test resource files to the same values as the old getline/stringstream/stof approach
+TEST(text_tokenizer_test, parse_matches_getline) {
+    for (auto name : resource_files) {
+        std::string file = std::string(std::getenv("SSCDIR")) + "/test/input_docs/" + name;
+
+        std::vector<float> old_values = parse_with_getline(file);
+        std::vector<float> new_values;
+        new_values.reserve(old_values.size());
+        ASSERT_TRUE(parse_with_tokenizer(file, new_values)) << file;
+
+        ASSERT_EQ(old_values.size(), new_values.size()) << name;
+        for (size_t i = 0; i < old_values.size(); i++)
+            ASSERT_TRUE(same_float(old_values[i], new_values[i])) << name << " value " << i;
+    }
+}
+
+/// Compares parse throughput of the old getline/stringstream/stof approach with text_tokenizer on the test resource files,
+/// run with --gtest_also_run_disabled_tests
+TEST(text_tokenizer_test, DISABLED_parse_throughput) {
+    for (auto name : resource_files) {
+        std::string file = std::string(std::getenv("SSCDIR")) + "/test/input_docs/" + name;
+        std::ifstream ifs(file, std::ios::binary | std::ios::ate);
+        double bytes = (double)ifs.tellg();
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<float> old_values = parse_with_getline(file);
+        auto t1 = std::chrono::steady_clock::now();
+        std::vector<float> new_values;
+        ASSERT_TRUE(parse_with_tokenizer(file, new_values)) << file;
+        auto t2 = std::chrono::steady_clock::now();
+        ASSERT_EQ(old_values.size(), new_values.size()) << name;
+
+        double old_s = std::chrono::duration<double>(t1 - t0).count();
+        double new_s = std::chrono::duration<double>(t2 - t1).count();
+        printf("%-40s %6.1f MB/s getline+stof, %6.1f MB/s text_tokenizer\n", name,
+               bytes / old_s / 1e6, bytes / new_s / 1e6);
+    }
+}
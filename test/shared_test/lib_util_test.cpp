@@ -78,4 +78,66 @@ TEST(sscapiTest, SSC_DATMAT_test)
     for (size_t i = 0; i < 4; i++)
         ssc_var_free(vd[i]);
     ssc_data_free(data);
-}
\ No newline at end of file
+}
+TEST(libUtilTests, matrix_t_borrow)
+{
+    double values[4] = {1, 2, 3, 4};
+    util::matrix_t<double> mat;
+    mat.borrow(values, 2, 2);
+    EXPECT_TRUE(mat.is_borrowed());
+    EXPECT_EQ(mat.data(), values);
+    EXPECT_EQ(mat.at(1, 0), 3);
+
+    // copies do not alias the borrowed memory
+    util::matrix_t<double> copy(mat);
+    EXPECT_FALSE(copy.is_borrowed());
+    copy.at(0, 0) = 10;
+    EXPECT_EQ(values[0], 1);
+
+    // resizing or assigning detaches before writing
+    mat.resize_fill(2, 2, 0.);
+    EXPECT_FALSE(mat.is_borrowed());
+    EXPECT_EQ(values[3], 4);
+
+    mat.borrow(values, 2, 2);
+    mat.fill(7.);
+    EXPECT_FALSE(mat.is_borrowed());
+    EXPECT_EQ(values[0], 1);
+
+    mat.borrow(values, 2, 2);
+    mat.set_value(8., 1, 1);
+    EXPECT_FALSE(mat.is_borrowed());
+    EXPECT_EQ(values[3], 4);
+    EXPECT_EQ(mat.at(1, 0), 3);
+
+    mat.borrow(values, 1, 4);
+    mat.detach();
+    mat[0] = 5;
+    EXPECT_EQ(values[0], 1);
+    EXPECT_EQ(mat[3], 4);
+}
+
+TEST(libUtilTests, write_file_atomic)
+{
+    std::string file = ::testing::TempDir() + "lib_util_write_file_atomic.bin";
+    auto write_text = [](const char *text) {
+        return [text](FILE *fp) { return fputs(text, fp) >= 0; };
+    };
+    auto read_text = [&file]() {
+        util::mapped_file map(file);
+        return map.ok() ? std::string(map.data(), map.size()) : std::string();
+    };
+
+    ASSERT_TRUE(util::write_file_atomic(file, write_text("first")));
+    EXPECT_EQ(read_text(), "first");
+
+    // replaces an existing file
+    ASSERT_TRUE(util::write_file_atomic(file, write_text("second")));
+    EXPECT_EQ(read_text(), "second");
+
+    // a failed write leaves the existing file as it was
+    EXPECT_FALSE(util::write_file_atomic(file, [](FILE *fp) { fputs("partial", fp); return false; }));
+    EXPECT_EQ(read_text(), "second");
+
+    util::remove_file(file.c_str());
+}
@@ -4,6 +4,7 @@
 
 #include <gtest/gtest.h>
 #include "lib_weatherfile.h"
+#include "lib_util.h"
 #include "../ssc/common.h"
 #include "vartab.h"
 
@@ -147,6 +148,137 @@ TEST_F(weatherfileTest, EPWNoLineEndingsTest_lib_weatherfile) {
 	EXPECT_TRUE(wf.nrecords() == 8760 );
 }
 
+/// expects every record and header field of two opened weather files to match exactly
+static void expect_same_weather(weatherfile &a, weatherfile &b) {
+	EXPECT_EQ(a.type(), b.type());
+	EXPECT_EQ(a.header().location, b.header().location);
+	EXPECT_EQ(a.header().city, b.header().city);
+	EXPECT_EQ(a.header().lat, b.header().lat);
+	EXPECT_EQ(a.header().tz, b.header().tz);
+	EXPECT_EQ(a.start_sec(), b.start_sec());
+	EXPECT_EQ(a.step_sec(), b.step_sec());
+	ASSERT_EQ(a.nrecords(), b.nrecords());
+	for (size_t c = 0; c < weather_data_provider::_MAXCOL_; c++)
+		EXPECT_EQ(a.has_data_column(c), b.has_data_column(c)) << "column " << c;
+
+	weather_record ra, rb;
+	for (size_t i = 0; i < a.nrecords(); i++) {
+		ASSERT_TRUE(a.read(&ra));
+		ASSERT_TRUE(b.read(&rb));
+		ASSERT_EQ(ra.hour, rb.hour) << "record " << i;
+		ASSERT_EQ(ra.minute, rb.minute) << "record " << i;
+		ASSERT_EQ(ra.dn, rb.dn) << "record " << i;
+		ASSERT_EQ(ra.tdry, rb.tdry) << "record " << i;
+		ASSERT_TRUE(ra.twet == rb.twet || (std::isnan(ra.twet) && std::isnan(rb.twet))) << "record " << i;
+	}
+}
+
+TEST_F(weatherfileTest, convertToCache_lib_weatherfile) {
+	char filepath[1024];
+	sprintf(filepath, "%s/test/input_docs/weather_30m.epw", std::getenv("SSCDIR"));
+	std::string cache = ::testing::TempDir() + "weather_30m.wfc";
+
+	ASSERT_TRUE(weatherfile::convert_to_cache(filepath, cache));
+	ASSERT_TRUE(wf.open(filepath));
+	weatherfile cached;
+	ASSERT_TRUE(cached.open(cache));
+	expect_same_weather(wf, cached);
+
+	// copies keep the mapped cache alive after the original is gone
+	cached.rewind();
+	weatherfile copy(cached);
+	cached = weatherfile();
+	wf.rewind();
+	expect_same_weather(wf, copy);
+	util::remove_file(cache.c_str());
+}
+
+TEST_F(weatherfileTest, cacheDir_lib_weatherfile) {
+	char filepath[1024];
+	sprintf(filepath, "%s/test/input_docs/weather-noRHum.csv", std::getenv("SSCDIR"));
+	ASSERT_TRUE(wf.open(filepath));
+
+	weatherfile::set_cache_dir(::testing::TempDir());
+	std::string cache = weatherfile::cache_file(filepath);
+	util::remove_file(cache.c_str());
+
+	// keep the shared memory cache from serving these constructions
+	weatherfile::clear_shared_cache();
+	weatherfile first(filepath);
+	EXPECT_TRUE(first.ok());
+	EXPECT_TRUE(util::file_exists(cache.c_str())) << "first open writes the cache";
+	weatherfile::clear_shared_cache();
+	weatherfile second(filepath);
+	EXPECT_TRUE(second.ok());
+	weatherfile::set_cache_dir("");
+
+	// constructor shifted the hours of both to 0-23 in the same way
+	weatherfile::clear_shared_cache();
+	weatherfile parsed(filepath);
+	expect_same_weather(parsed, second);
+	util::remove_file(cache.c_str());
+}
+
+TEST_F(weatherfileTest, cacheDirStale_lib_weatherfile) {
+	char filepath[1024];
+	std::string copy = ::testing::TempDir() + "cached_weather.csv";
+	weatherfile::set_cache_dir(::testing::TempDir());
+
+	sprintf(filepath, "%s/test/input_docs/weather-noRHum.csv", std::getenv("SSCDIR"));
+	fputs(util::read_file(filepath).c_str(), util::stdfile(copy, "w"));
+	ASSERT_TRUE(wf.open(copy));
+	EXPECT_EQ(wf.header().location, "875760");
+
+	// a changed file is parsed again instead of being read from its old cache
+	sprintf(filepath, "%s/test/input_cases/pvsamv1_data/USA AZ Phoenix (TMY2).csv", std::getenv("SSCDIR"));
+	fputs(util::read_file(filepath).c_str(), util::stdfile(copy, "w"));
+	weatherfile changed;
+	ASSERT_TRUE(changed.open(copy));
+	EXPECT_EQ(changed.header().location, "23183");
+
+	util::remove_file(weatherfile::cache_file(copy).c_str());
+	util::remove_file(copy.c_str());
+	weatherfile::set_cache_dir("");
+}
+
+TEST_F(weatherfileTest, sharedCache_lib_weatherfile) {
+	char filepath[1024];
+	sprintf(filepath, "%s/test/input_docs/weather-noRHum.csv", std::getenv("SSCDIR"));
+	std::string copy = ::testing::TempDir() + "shared_weather.csv";
+	fputs(util::read_file(filepath).c_str(), util::stdfile(copy, "w"));
+	ASSERT_GT(weatherfile::shared_cache_size(), 0u);
+
+	// readers of the same file share its data but keep their own position
+	weatherfile first(copy);
+	weatherfile second(copy);
+	ASSERT_TRUE(first.ok());
+	ASSERT_TRUE(second.ok());
+	weather_record r;
+	ASSERT_TRUE(first.read(&r));
+	ASSERT_TRUE(first.read(&r));
+	EXPECT_EQ(first.get_counter_value(), 2);
+	EXPECT_EQ(second.get_counter_value(), 0);
+	first.rewind();
+	expect_same_weather(first, second);
+
+	// a reader outlives the cache entry it was made from
+	weatherfile::clear_shared_cache();
+	weatherfile parsed(filepath);
+	second.rewind();
+	expect_same_weather(parsed, second);
+
+	// a changed file is read again
+	sprintf(filepath, "%s/test/input_cases/pvsamv1_data/USA AZ Phoenix (TMY2).csv", std::getenv("SSCDIR"));
+	fputs(util::read_file(filepath).c_str(), util::stdfile(copy, "w"));
+	weatherfile changed(copy);
+	ASSERT_TRUE(changed.ok());
+	EXPECT_EQ(changed.header().location, "23183");
+	EXPECT_EQ(changed.nrecords(), 8760u);
+
+	util::remove_file(copy.c_str());
+	weatherfile::clear_shared_cache();
+}
+
 /**
 * \class weatherdataTest
 *
@@ -392,6 +392,109 @@ TEST_F(CMPvsamv1PowerIntegration_cmod_pvsamv1, NoFinancialModelSystemDesign)
 	}
 }
 
+/// The bracketed mismatch search finds the same string voltages as the full voltage sweep
+TEST_F(CMPvsamv1PowerIntegration_cmod_pvsamv1, MismatchBracketedSearch)
+{
+	pvsamv_nofinancial_default(data);
+
+	std::map<std::string, double> pairs;
+	pairs["subarray1_modules_per_string"] = 6;
+	pairs["subarray2_modules_per_string"] = 6;
+	pairs["subarray3_modules_per_string"] = 6;
+	pairs["subarray4_modules_per_string"] = 6;
+	pairs["inverter_count"] = 22;
+	pairs["subarray1_nstrings"] = 14;
+	pairs["subarray2_enable"] = 1;
+	pairs["subarray2_nstrings"] = 15;
+	pairs["subarray2_azimuth"] = 90;
+	pairs["subarray3_enable"] = 1;
+	pairs["subarray3_nstrings"] = 10;
+	pairs["subarray3_tilt"] = 45;
+	pairs["subarray4_enable"] = 1;
+	pairs["subarray4_nstrings"] = 10;
+	pairs["subarray4_track_mode"] = 1;
+	pairs["enable_mismatch_vmax_calc"] = 1;
+
+	std::vector<std::string> outputs = { "inverterMPPT1_DCVoltage", "dc_net", "gen" };
+	std::vector<std::vector<ssc_number_t>> results;
+	for (int search = 0; search < 2; search++)
+	{
+		pairs["mismatch_search"] = search;
+		int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+		ASSERT_FALSE(pvsam_errors);
+		for (auto &name : outputs)
+		{
+			int n = 0;
+			ssc_number_t *values = ssc_data_get_array(data, name.c_str(), &n);
+			ASSERT_EQ(n, 8760) << name;
+			results.push_back(std::vector<ssc_number_t>(values, values + n));
+		}
+	}
+
+	for (size_t k = 0; k < outputs.size(); k++)
+		for (size_t i = 0; i < 8760; i++)
+			ASSERT_EQ(results[k][i], results[k + outputs.size()][i]) << outputs[k] << " hour " << i;
+}
+
+/// Interpolated self-shading sky diffuse derates stay close to the integrated ones for a one-axis tracker
+TEST_F(CMPvsamv1PowerIntegration_cmod_pvsamv1, SelfShadingSkyDiffuseTable)
+{
+	pvsamv_nofinancial_default(data);
+
+	std::map<std::string, double> pairs;
+	pairs["subarray1_track_mode"] = 1;
+	pairs["subarray1_backtrack"] = 0;
+	pairs["subarray1_shade_mode"] = 1;
+	pairs["subarray1_gcr"] = 0.45;
+
+	std::vector<std::vector<ssc_number_t>> gen;
+	std::vector<ssc_number_t> annual_energy;
+	for (int table = 0; table < 2; table++)
+	{
+		pairs["subarray1_selfshade_table"] = table;
+		int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+		ASSERT_FALSE(pvsam_errors);
+		int n = 0;
+		ssc_number_t *values = ssc_data_get_array(data, "gen", &n);
+		ASSERT_EQ(n, 8760);
+		gen.push_back(std::vector<ssc_number_t>(values, values + n));
+		ssc_number_t energy;
+		ssc_data_get_number(data, "annual_energy", &energy);
+		annual_energy.push_back(energy);
+	}
+
+	EXPECT_NEAR(annual_energy[1], annual_energy[0], 1e-4 * annual_energy[0]);
+	for (size_t i = 0; i < 8760; i++)
+		ASSERT_NEAR(gen[1][i], gen[0][i], 1e-3 * fabs(gen[0][i]) + 1e-6) << "hour " << i;
+}
+
+/// Bifacial tracker rear-side irradiance interpolated from tabulated view factors stays close to the per-step calculation
+TEST_F(CMPvsamv1PowerIntegration_cmod_pvsamv1, BifacialTrackerViewFactorTable)
+{
+	pvsamv_nofinancial_default(data);
+
+	std::map<std::string, double> pairs;
+	pairs["subarray1_track_mode"] = 1;
+	pairs["subarray1_backtrack"] = 1;
+	pairs["cec_is_bifacial"] = 1;
+	pairs["cec_bifacial_transmission_factor"] = 0.013;
+	pairs["cec_bifaciality"] = 0.65;
+	pairs["cec_bifacial_ground_clearance_height"] = 1;
+
+	std::vector<ssc_number_t> annual_energy;
+	for (int table = 0; table < 2; table++)
+	{
+		pairs["subarray1_bifacial_table"] = table;
+		int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+		ASSERT_FALSE(pvsam_errors);
+		ssc_number_t energy;
+		ssc_data_get_number(data, "annual_energy", &energy);
+		annual_energy.push_back(energy);
+	}
+
+	EXPECT_NEAR(annual_energy[1], annual_energy[0], 1e-4 * annual_energy[0]);
+}
+
 /// Test PVSAMv1 with default no-financial model and different shading options
 TEST_F(CMPvsamv1PowerIntegration_cmod_pvsamv1, NoFinancialModelShading)
 {
@@ -731,6 +834,104 @@ TEST_F(CMPvsamv1PowerIntegration_cmod_pvsamv1, lifetime_outputs)
 
 }
 
+/// Later years of a lifetime simulation reuse the first-year irradiance, with self-shading and tracking enabled
+TEST_F(CMPvsamv1PowerIntegration_cmod_pvsamv1, lifetime_irradiance_replay)
+{
+	std::map<std::string, double> pairs;
+	pairs["system_use_lifetime_output"] = 1;
+	pairs["save_full_lifetime_variables"] = 1;
+	pairs["analysis_period"] = 3;
+	pairs["subarray1_track_mode"] = 1;
+	pairs["subarray1_backtrack"] = 0;
+	pairs["subarray1_shade_mode"] = 1;
+	double dc_degradation[1] = { 0 };
+	ssc_data_set_array(data, "dc_degradation", (ssc_number_t*)dc_degradation, 1);
+
+	int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	ASSERT_FALSE(pvsam_errors);
+
+	int n = 0;
+	ssc_number_t *poa = ssc_data_get_array(data, "subarray1_poa_eff", &n);
+	ssc_number_t *dc = ssc_data_get_array(data, "dc_net", nullptr);
+	ssc_number_t *derate = ssc_data_get_array(data, "subarray1_ss_derate", nullptr);
+	ASSERT_EQ(n, 3 * 8760);
+	double annual_poa = 0;
+	for (size_t i = 0; i < 8760; i++) {
+		annual_poa += poa[i];
+		for (size_t y = 1; y < 3; y++) {
+			ASSERT_EQ(poa[i], poa[i + y * 8760]) << "hour " << i << " in year " << y + 1;
+			ASSERT_EQ(dc[i], dc[i + y * 8760]) << "hour " << i << " in year " << y + 1;
+			ASSERT_EQ(derate[i], derate[i + y * 8760]) << "hour " << i << " in year " << y + 1;
+		}
+	}
+	EXPECT_GT(annual_poa, 0);
+}
+
+
+/// Calculating the first-year subarray irradiance ahead of the timestep loop on several threads gives the same outputs
+TEST_F(CMPvsamv1PowerIntegration_cmod_pvsamv1, SubarrayIrradianceThreads)
+{
+	std::map<std::string, double> pairs;
+	pairs["system_use_lifetime_output"] = 1;
+	pairs["save_full_lifetime_variables"] = 1;
+	pairs["analysis_period"] = 2;
+	pairs["subarray1_nstrings"] = 14;
+	pairs["subarray1_track_mode"] = 1;
+	pairs["subarray1_backtrack"] = 0;
+	pairs["subarray1_shade_mode"] = 1;
+	pairs["subarray2_enable"] = 1;
+	pairs["subarray2_nstrings"] = 15;
+	pairs["subarray2_azimuth"] = 90;
+	pairs["subarray2_shade_mode"] = 2;
+	pairs["subarray3_enable"] = 1;
+	pairs["subarray3_nstrings"] = 10;
+	pairs["subarray3_tilt"] = 45;
+	pairs["inverter_count"] = 22;
+	pairs["cec_is_bifacial"] = 1;
+	pairs["cec_bifacial_transmission_factor"] = 0.013;
+	pairs["cec_bifaciality"] = 0.65;
+	pairs["cec_bifacial_ground_clearance_height"] = 1;
+	double dc_degradation[1] = { 0.5 };
+	ssc_data_set_array(data, "dc_degradation", (ssc_number_t*)dc_degradation, 1);
+
+	// beam and diffuse, then total and diffuse with hourly and 15 minute weather
+	for (int config = 0; config < 3; config++)
+	{
+		int irrad_mode = config ? 2 : 0;
+		pairs["irrad_mode"] = irrad_mode;
+		if (config == 2)
+		{
+			ssc_data_set_string(data, "solar_resource_file", solar_resource_path_15_min);
+			pairs["analysis_period"] = 1;
+		}
+		std::map<std::string, std::vector<ssc_number_t>> serial;
+		for (int threads = 1; threads >= 0; threads--)
+		{
+			pairs["irrad_threads"] = threads ? 1 : 7; // two threads for each subarray
+			int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+			ASSERT_FALSE(pvsam_errors);
+
+			for (const char *name = ssc_data_first(data); name; name = ssc_data_next(data))
+			{
+				if (ssc_data_query(data, name) != SSC_ARRAY)
+					continue;
+				int n = 0;
+				ssc_number_t *values = ssc_data_get_array(data, name, &n);
+				std::vector<ssc_number_t> v(values, values + n);
+				if (threads)
+					serial[name] = v;
+				else if (serial.count(name))
+				{
+					ASSERT_EQ(v.size(), serial[name].size()) << name;
+					for (size_t i = 0; i < v.size(); i++)
+						if (!std::isnan(v[i]) || !std::isnan(serial[name][i]))
+							ASSERT_EQ(v[i], serial[name][i]) << name << " index " << i << " configuration " << config;
+				}
+			}
+		}
+		EXPECT_GT(serial["gen"].size(), 0);
+	}
+}
 
 TEST_F(CMPvsamv1PowerIntegration_cmod_pvsamv1, NonAnnual)
 {
@@ -224,6 +224,128 @@ TEST_F(CMPvwattsV7Integration_cmod_pvwattsv7, BifacialTest_cmod_pvwattsv7) {
     EXPECT_GT(annual_energy_bi/annual_energy_mono, 1.04);
 }
 
+/// Test PVWattsV7 split into chunks of the analysis period simulated on several threads against the serial simulation
+TEST_F(CMPvwattsV7Integration_cmod_pvwattsv7, ChunkedThreads_cmod_pvwattsv7) {
+
+	// relative difference allowed in annual energy, from the thermal model restarting after the warm-up
+	double chunked_tolerance = 1e-5;
+
+	char subhourly[256];
+	sprintf(subhourly, "%s/test/input_cases/pvsamv1_data/LosAngeles_WeatherFile_15min.csv", SSCDIR);
+
+	char snowy[256];
+	sprintf(snowy, "%s/test/input_cases/swh_residential_data/fargo_nd_46.9_-96.8_mts1_60_tmy.csv", SSCDIR);
+
+	for (int variant = 0; variant < 4; variant++)
+	{
+		// each variant changes the default case on its own
+		ssc_data_clear(data);
+		pvwattsv7_nofinancial_testfile(data);
+
+		std::map<std::string, double> pairs;
+		if (variant == 1)
+		{
+			// self-shaded tracker over a lifetime, so chunks cross the year boundary
+			pairs["array_type"] = 2;
+			pairs["tilt"] = 0;
+			pairs["system_use_lifetime_output"] = 1;
+			pairs["analysis_period"] = 2;
+			double dc_degradation[1] = { 0.5 };
+			ssc_data_set_array(data, "dc_degradation", (ssc_number_t*)dc_degradation, 1);
+		}
+		else if (variant == 2)
+			ssc_data_set_string(data, "solar_resource_file", subhourly);
+		else if (variant == 3)
+		{
+			// snow lying for weeks across the chunk boundaries
+			ssc_data_set_string(data, "solar_resource_file", snowy);
+			pairs["en_snowloss"] = 1;
+		}
+
+		pairs["chunk_threads"] = 1;
+		ASSERT_FALSE(modify_ssc_data_and_run_module(data, "pvwattsv7", pairs));
+		ssc_number_t serial_energy;
+		ssc_data_get_number(data, "annual_energy", &serial_energy);
+		int n_serial;
+		ssc_number_t *gen = ssc_data_get_array(data, "gen", &n_serial);
+		std::vector<ssc_number_t> serial_gen(gen, gen + n_serial);
+
+		for (int threads : { 2, 5, 12 })
+		{
+			pairs["chunk_threads"] = threads;
+			ASSERT_FALSE(modify_ssc_data_and_run_module(data, "pvwattsv7", pairs));
+			ssc_number_t annual_energy;
+			ssc_data_get_number(data, "annual_energy", &annual_energy);
+			EXPECT_NEAR(annual_energy, serial_energy, chunked_tolerance * serial_energy) << "variant " << variant << " threads " << threads;
+
+			int n;
+			gen = ssc_data_get_array(data, "gen", &n);
+			ASSERT_EQ(n, n_serial);
+			for (int i = 0; i < n; i++)
+				ASSERT_NEAR(gen[i], serial_gen[i], 1e-3) << "variant " << variant << " threads " << threads << " step " << i;
+		}
+	}
+}
+
+/// Test PVWattsV7 batch module against single configuration PVWattsV7 runs
+TEST_F(CMPvwattsV7Integration_cmod_pvwattsv7, BatchConfigurations_cmod_pvwattsv7) {
+
+	// tilt, azimuth, DC to AC ratio, losses
+	ssc_number_t configurations[] = {
+		20, 180, 1.2f, 14.08f,
+		35, 200, 1.1f, 10,
+		10, 90, 1.4f, 5,
+		0, 270, 1.2f, 14.08f,
+		45, 160, 0.9f, -2 };
+	size_t nconfig = sizeof(configurations) / sizeof(configurations[0]) / 4;
+
+	for (int array_type : { 0, 1, 2, 3, 4 })
+	{
+		ssc_data_t batch = ssc_data_create();
+		ssc_data_set_string(batch, "solar_resource_file", ssc_data_get_string(data, "solar_resource_file"));
+		ssc_data_set_number(batch, "system_capacity", 4);
+		ssc_data_set_number(batch, "array_type", array_type);
+		ssc_data_set_number(batch, "gcr", 0.4f);
+		ssc_data_set_matrix(batch, "configurations", configurations, (int)nconfig, 4);
+		ssc_data_set_number(batch, "batch_threads", 2);
+		ASSERT_FALSE(run_module(batch, "pvwattsv7_batch"));
+
+		int n, nrows, ncols;
+		ssc_number_t *annual_energy = ssc_data_get_array(batch, "annual_energy", &n);
+		ssc_number_t *monthly_energy = ssc_data_get_matrix(batch, "monthly_energy", &nrows, &ncols);
+		ssc_number_t *capacity_factor = ssc_data_get_array(batch, "capacity_factor", &n);
+		ssc_number_t *solrad_annual = ssc_data_get_array(batch, "solrad_annual", &n);
+		ASSERT_EQ(n, (int)nconfig);
+		ASSERT_EQ(nrows, (int)nconfig);
+		ASSERT_EQ(ncols, 12);
+
+		// one-axis trackers share the self-shading sky diffuse derates cached by tilt between configurations
+		double tolerance = (array_type == 2 || array_type == 3) ? 1e-6 : 0;
+		for (size_t c = 0; c < nconfig; c++)
+		{
+			std::map<std::string, double> pairs;
+			pairs["array_type"] = array_type;
+			pairs["tilt"] = configurations[c * 4];
+			pairs["azimuth"] = configurations[c * 4 + 1];
+			pairs["dc_ac_ratio"] = configurations[c * 4 + 2];
+			pairs["losses"] = configurations[c * 4 + 3];
+			ASSERT_FALSE(modify_ssc_data_and_run_module(data, "pvwattsv7", pairs));
+
+			ssc_number_t expected;
+			ssc_data_get_number(data, "annual_energy", &expected);
+			EXPECT_NEAR(annual_energy[c], expected, tolerance * expected) << "array type " << array_type << " configuration " << c;
+			ssc_data_get_number(data, "capacity_factor", &expected);
+			EXPECT_NEAR(capacity_factor[c], expected, tolerance * expected) << "array type " << array_type << " configuration " << c;
+			ssc_data_get_number(data, "solrad_annual", &expected);
+			EXPECT_NEAR(solrad_annual[c], expected, tolerance * expected) << "array type " << array_type << " configuration " << c;
+			ssc_number_t *monthly = ssc_data_get_array(data, "monthly_energy", &n);
+			for (int m = 0; m < 12; m++)
+				EXPECT_NEAR(monthly_energy[c * 12 + m], monthly[m], tolerance * monthly[m]) << "array type " << array_type << " configuration " << c << " month " << m;
+		}
+		ssc_data_free(batch);
+	}
+}
+
 /* this test isn't passing currently even though it's working in the UI, so commenting out for now
 /// Test PVWattsV7 with snow model
 TEST_F(CMPvwattsV7Integration, SnowModelTest_cmod_pvwattsv7) {
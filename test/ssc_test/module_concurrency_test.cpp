@@ -0,0 +1,200 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../ssc/vartab.h"
+#include "../input_cases/pvsamv1_common_data.h"
+
+/**
+ * Runs compute modules from several threads at once and compares every run against a serial run of the
+ * same case. Every registered module is run on empty data, which only reaches input validation; full
+ * simulations with bit-identical outputs are checked for the modules that can be set up from the in-repo
+ * test inputs, listed in module_concurrency_test.simulations_bit_identical. Configure with
+ * -Dsanitize_thread=ON to run these tests under ThreadSanitizer.
+ */
+
+namespace {
+
+const int n_threads = 4;
+
+ssc_bool_t quiet_handler(ssc_module_t, ssc_handler_t, int, float, float, const char *, const char *, void *) {
+    return 1;
+}
+
+std::vector<std::string> module_names() {
+    std::vector<std::string> names;
+    int i = 0;
+    while (ssc_entry_t p_entry = ssc_module_entry(i++))
+        names.push_back(ssc_entry_name(p_entry));
+    return names;
+}
+
+// runs a module over the data and returns the result followed by its log
+std::string exec_logged(const std::string &name, ssc_data_t data) {
+    ssc_module_t p_mod = ssc_module_create(name.c_str());
+    if (!p_mod) return "could not create " + name;
+
+    std::string log = ssc_module_exec_with_handler(p_mod, data, quiet_handler, nullptr) ? "ok" : "failed";
+    const char *text;
+    int type = 0, i = 0;
+    while ((text = ssc_module_log(p_mod, i++, &type, nullptr)))
+        log += "\n" + std::to_string(type) + ": " + text;
+
+    ssc_module_free(p_mod);
+    return log;
+}
+
+// true if both tables hold the same variables with bit-identical values
+::testing::AssertionResult same_values(var_table *a, var_table *b) {
+    if (a->size() != b->size())
+        return ::testing::AssertionFailure() << "tables have " << a->size() << " and " << b->size() << " variables";
+
+    for (auto const &it : *a->get_hash()) {
+        const var_data *x = it.second;
+        const var_data *y = b->lookup_const(it.first);
+        if (!y)
+            return ::testing::AssertionFailure() << it.first << " is missing";
+        if (x->type != y->type)
+            return ::testing::AssertionFailure() << it.first << " changed type";
+        if (x->str != y->str)
+            return ::testing::AssertionFailure() << it.first << " differs: " << x->str << " vs " << y->str;
+        bool numeric = x->type == SSC_NUMBER || x->type == SSC_ARRAY || x->type == SSC_MATRIX;
+        if (numeric && (x->num.nrows() != y->num.nrows() || x->num.ncols() != y->num.ncols()
+            || std::memcmp(x->num.data(), y->num.data(), x->num.ncells() * sizeof(ssc_number_t)) != 0))
+            return ::testing::AssertionFailure() << it.first << " differs";
+        if (x->type == SSC_TABLE) {
+            ::testing::AssertionResult nested = same_values(const_cast<var_table *>(&x->table), const_cast<var_table *>(&y->table));
+            if (!nested) return nested;
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+void pvwattsv7_case(ssc_data_t data) {
+    char file[256];
+    sprintf(file, "%s/test/input_cases/pvsamv1_data/USA AZ Phoenix (TMY2).csv", std::getenv("SSCDIR"));
+    ssc_data_set_string(data, "solar_resource_file", file);
+    ssc_data_set_number(data, "system_capacity", 4);
+    ssc_data_set_number(data, "module_type", 0);
+    ssc_data_set_number(data, "dc_ac_ratio", 1.2);
+    ssc_data_set_number(data, "array_type", 0);
+    ssc_data_set_number(data, "tilt", 20);
+    ssc_data_set_number(data, "azimuth", 180);
+    ssc_data_set_number(data, "gcr", 0.4);
+    ssc_data_set_number(data, "losses", 14.08);
+    ssc_data_set_number(data, "inv_eff", 96);
+    ssc_data_set_number(data, "adjust:constant", 0);
+}
+
+void windpower_case(ssc_data_t data) {
+    char file[256];
+    sprintf(file, "%s/test/input_docs/wind.srw", std::getenv("SSCDIR"));
+    ssc_data_set_string(data, "wind_resource_filename", file);
+    ssc_data_set_number(data, "wind_resource_shear", 0.14);
+    ssc_data_set_number(data, "wind_resource_turbulence_coeff", 0.1);
+    ssc_data_set_number(data, "system_capacity", 6000);
+    ssc_data_set_number(data, "wind_resource_model_choice", 0);
+    ssc_data_set_number(data, "wind_turbine_rotor_diameter", 77);
+    ssc_data_set_number(data, "wind_turbine_hub_ht", 80);
+    ssc_data_set_number(data, "wind_turbine_max_cp", 0.45);
+    ssc_number_t speeds[41], power[41];
+    for (int i = 0; i < 41; i++) {
+        speeds[i] = i;
+        power[i] = (i < 4 || i > 25) ? 0 : (i > 12 ? 1500 : 1500. * (i - 3) * (i - 3) / 81.);
+    }
+    ssc_data_set_array(data, "wind_turbine_powercurve_windspeeds", speeds, 41);
+    ssc_data_set_array(data, "wind_turbine_powercurve_powerout", power, 41);
+    ssc_number_t x[4] = {0, 616, 1232, 1848}, y[4] = {0, 0, 0, 0};
+    ssc_data_set_array(data, "wind_farm_xCoordinates", x, 4);
+    ssc_data_set_array(data, "wind_farm_yCoordinates", y, 4);
+    ssc_data_set_number(data, "wind_farm_wake_model", 0);
+    ssc_data_set_number(data, "adjust:constant", 0);
+}
+
+void pvsamv1_case(ssc_data_t data) {
+    pvsamv_nofinancial_default(data);
+}
+
+} // namespace
+
+/// Input validation of every registered module, run over an empty data set from several threads at once.
+/// This reaches the missing-input errors of each module, not its simulation.
+TEST(module_concurrency_test, all_modules_input_validation) {
+    std::vector<std::string> names = module_names();
+    ASSERT_FALSE(names.empty());
+
+    std::vector<std::string> serial;
+    for (auto &name : names) {
+        ssc_data_t data = ssc_data_create();
+        serial.push_back(exec_logged(name, data));
+        ssc_data_free(data);
+    }
+
+    std::vector<std::vector<std::string>> logs(n_threads, std::vector<std::string>(names.size()));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; t++) {
+        threads.push_back(std::thread([&, t]() {
+            // start each thread at a different module so different modules overlap
+            for (size_t k = 0; k < names.size(); k++) {
+                size_t i = (k + t * names.size() / n_threads) % names.size();
+                ssc_data_t data = ssc_data_create();
+                logs[t][i] = exec_logged(names[i], data);
+                ssc_data_free(data);
+            }
+        }));
+    }
+    for (auto &th : threads)
+        th.join();
+
+    for (int t = 0; t < n_threads; t++)
+        for (size_t i = 0; i < names.size(); i++)
+            EXPECT_EQ(logs[t][i], serial[i]) << names[i] << " on thread " << t;
+}
+
+/// Full simulations run from several threads give the same results as serial runs, for the modules that
+/// have a complete case in the test inputs
+TEST(module_concurrency_test, simulations_bit_identical) {
+    struct sim_case {
+        const char *module;
+        void (*setup)(ssc_data_t);
+    };
+    std::vector<sim_case> cases = {{"pvwattsv7", pvwattsv7_case}, {"windpower", windpower_case},
+                                   {"pvsamv1", pvsamv1_case}};
+
+    for (auto &c : cases) {
+        ssc_data_t base = ssc_data_create();
+        c.setup(base);
+
+        ssc_data_t serial = ssc_data_copy(base);
+        ASSERT_EQ(exec_logged(c.module, serial).substr(0, 2), "ok") << c.module;
+
+        const int n_runs = 2 * n_threads;
+        std::vector<ssc_data_t> runs;
+        for (int i = 0; i < n_runs; i++)
+            runs.push_back(ssc_data_copy(base));
+
+        std::vector<std::string> logs(n_runs);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < n_threads; t++) {
+            threads.push_back(std::thread([&, t]() {
+                for (int i = t; i < n_runs; i += n_threads)
+                    logs[i] = exec_logged(c.module, runs[i]);
+            }));
+        }
+        for (auto &th : threads)
+            th.join();
+
+        for (int i = 0; i < n_runs; i++) {
+            EXPECT_EQ(logs[i].substr(0, 2), "ok") << c.module << " run " << i << ": " << logs[i];
+            EXPECT_TRUE(same_values(static_cast<var_table *>(serial), static_cast<var_table *>(runs[i])))
+                                << c.module << " run " << i;
+            ssc_data_free(runs[i]);
+        }
+        ssc_data_free(serial);
+        ssc_data_free(base);
+    }
+}
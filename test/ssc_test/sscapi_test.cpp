@@ -110,3 +110,257 @@ TEST(sscapi_test, ssc_data_to_json) {
 
 }
 
+
+TEST(sscapi_test, var_handle) {
+    var_table vt;
+    var_handle h("Num");
+    EXPECT_EQ(vt.lookup(h), nullptr);
+
+    vt.assign(h, var_data(1.));
+    EXPECT_EQ(vt.as_double(h), 1.);
+    EXPECT_EQ(vt.as_double("num"), 1.);
+    var_data* cached = vt.lookup(h);
+
+    vt.assign("num", var_data(2.));
+    EXPECT_EQ(vt.lookup(h), cached);
+    EXPECT_EQ(vt.as_integer(h), 2);
+
+    // removing and reassigning must not leave the handle pointing at freed data
+    vt.unassign("num");
+    EXPECT_EQ(vt.lookup(h), nullptr);
+    vt.assign("num", var_data(3.));
+    EXPECT_EQ(vt.as_number(h), 3.);
+
+    var_table other;
+    other.assign("num", var_data(4.));
+    EXPECT_EQ(other.as_double(h), 4.);
+    EXPECT_EQ(vt.as_double(h), 3.);
+
+    var_handle arr("arr");
+    ssc_number_t* p = vt.allocate(arr, 3);
+    p[2] = 5.;
+    size_t n = 0;
+    EXPECT_EQ(vt.as_array(arr, &n)[2], 5.);
+    EXPECT_EQ(n, 3);
+    EXPECT_THROW(vt.as_double(arr), cast_error);
+    var_handle missing("missing");
+    EXPECT_THROW(vt.as_double(missing), general_error);
+}
+
+TEST(sscapi_test, ssc_data_key) {
+    ssc_data_t dat = ssc_data_create();
+    ssc_key_t key = ssc_key_create("val");
+
+    EXPECT_EQ(ssc_data_key_query(dat, key), SSC_INVALID);
+    ssc_data_key_set_number(dat, key, 1.);
+    ssc_number_t val = 0;
+    EXPECT_TRUE(ssc_data_key_get_number(dat, key, &val));
+    EXPECT_EQ(val, 1.);
+    ssc_data_get_number(dat, "val", &val);
+    EXPECT_EQ(val, 1.);
+
+    ssc_number_t arr[4] = {1, 2, 3, 4};
+    ssc_data_key_set_matrix(dat, key, arr, 2, 2);
+    int nr, nc;
+    ssc_number_t* mat = ssc_data_key_get_matrix(dat, key, &nr, &nc);
+    ASSERT_NE(mat, nullptr);
+    EXPECT_EQ(nr, 2);
+    EXPECT_EQ(mat[3], 4);
+    EXPECT_FALSE(ssc_data_key_get_number(dat, key, &val));
+
+    ssc_data_key_set_string(dat, key, "str");
+    EXPECT_STRCASEEQ(ssc_data_key_get_string(dat, key), "str");
+
+    ssc_data_clear(dat);
+    EXPECT_EQ(ssc_data_key_get_string(dat, key), nullptr);
+
+    ssc_key_free(key);
+    ssc_data_free(dat);
+}
+
+TEST(sscapi_test, ssc_data_set_array_ref) {
+    ssc_number_t arr[6] = {1, 2, 3, 4, 5, 6};
+    ssc_data_t dat = ssc_data_create();
+    ssc_data_set_array_ref(dat, "arr", arr, 6);
+    ssc_data_set_matrix_ref(dat, "mat", arr, 2, 3);
+
+    int n = 0, nr = 0, nc = 0;
+    EXPECT_EQ(ssc_data_get_array(dat, "arr", &n), arr);
+    EXPECT_EQ(n, 6);
+    EXPECT_EQ(ssc_data_get_matrix(dat, "mat", &nr, &nc), arr);
+    EXPECT_EQ(nc, 3);
+
+    auto vt = static_cast<var_table *>(dat);
+    number_span span = vt->as_span("mat");
+    EXPECT_EQ(span.data(), arr);
+    EXPECT_EQ(span.at(1, 2), 6);
+    EXPECT_EQ(vt->as_vector_double("arr")[5], 6);
+
+    // copies of the table share the reference
+    var_table copy(*vt);
+    EXPECT_EQ(copy.as_span("arr").data(), arr);
+
+    // mutable access takes a private copy so the caller's buffer is never written
+    size_t len = 0;
+    ssc_number_t* p = vt->as_array("arr", &len);
+    EXPECT_NE(p, arr);
+    p[0] = 10;
+    EXPECT_EQ(arr[0], 1);
+    EXPECT_EQ(copy.as_span("arr")[0], 1);
+
+    ssc_data_free(dat);
+}
+
+TEST(sscapi_test, ssc_data_copy) {
+    ssc_data_t base = ssc_data_create();
+    ssc_number_t arr[3] = {1, 2, 3};
+    ssc_data_set_array(base, "arr", arr, 3);
+    ssc_data_set_number(base, "num", 1);
+    ssc_data_t tab = ssc_data_create();
+    ssc_data_set_number(tab, "inner", 5);
+    ssc_data_set_table(base, "tab", tab);
+    ssc_data_free(tab);
+
+    // the copy shares storage with the base case until one of them writes
+    ssc_data_t run = ssc_data_copy(base);
+    auto vt_base = static_cast<var_table *>(base);
+    auto vt_run = static_cast<var_table *>(run);
+    EXPECT_EQ(vt_base->lookup_const("arr"), vt_run->lookup_const("arr"));
+    EXPECT_EQ(vt_run->as_span("arr").data(), vt_base->as_span("arr").data());
+
+    var_handle h_arr("arr");
+    EXPECT_EQ(vt_run->as_span(h_arr)[1], 2);
+
+    int len = 0;
+    ssc_number_t *p = ssc_data_get_array(run, "arr", &len);
+    ASSERT_EQ(len, 3);
+    p[1] = 20;
+    ssc_data_set_number(run, "num", 2);
+    ssc_data_set_number(ssc_data_get_table(run, "tab"), "inner", 6);
+
+    ssc_number_t val = 0;
+    EXPECT_EQ(ssc_data_get_array(base, "arr", &len)[1], 2);
+    EXPECT_EQ(vt_run->as_span(h_arr)[1], 20);
+    ssc_data_get_number(base, "num", &val);
+    EXPECT_EQ(val, 1);
+    ssc_data_get_number(run, "num", &val);
+    EXPECT_EQ(val, 2);
+    ssc_data_get_number(ssc_data_get_table(base, "tab"), "inner", &val);
+    EXPECT_EQ(val, 5);
+    ssc_data_get_number(ssc_data_get_table(run, "tab"), "inner", &val);
+    EXPECT_EQ(val, 6);
+
+    // entries shared with a freed table stay valid
+    ssc_data_free(base);
+    EXPECT_EQ(vt_run->as_span("arr")[0], 1);
+
+    ssc_data_t merged = ssc_data_create();
+    ssc_data_set_number(merged, "num", 3);
+    ssc_data_merge(merged, run, 0);
+    ssc_data_get_number(merged, "num", &val);
+    EXPECT_EQ(val, 3);
+    EXPECT_EQ(ssc_data_query(merged, "arr"), SSC_ARRAY);
+    ssc_data_merge(merged, run, 1);
+    ssc_data_get_number(merged, "num", &val);
+    EXPECT_EQ(val, 2);
+
+    ssc_data_free(run);
+    ssc_data_free(merged);
+}
+
+TEST(sscapi_test, ssc_data_copy_handles) {
+    var_table base;
+    base.assign("num", var_data((ssc_number_t)1));
+    var_table inner;
+    inner.assign("inner", var_data((ssc_number_t)5));
+    base.assign("tab", var_data(inner));
+
+    // a handle resolved before the copy still unshares the entry when written through
+    var_handle h_num("num");
+    EXPECT_EQ(base.as_number(h_num), 1);
+    var_table copy(base);
+    base.assign(h_num, var_data((ssc_number_t)2));
+    EXPECT_EQ(base.as_number(h_num), 2);
+    EXPECT_EQ(copy.as_number("num"), 1);
+
+    // unsharing a table entry copies the nested table without touching the shared one
+    const var_data *shared_tab = copy.lookup_const("tab");
+    var_table copy2(copy);
+    EXPECT_EQ(copy2.lookup_const("tab"), shared_tab);
+    var_data *own_tab = copy2.lookup("tab");
+    EXPECT_NE(own_tab, shared_tab);
+    own_tab->table.assign("inner", var_data((ssc_number_t)6));
+    EXPECT_EQ(shared_tab->table.lookup_const("inner")->num.value(), 5);
+    EXPECT_EQ(copy.lookup_const("tab"), shared_tab);
+}
+
+static ssc_bool_t batch_test_handler(ssc_module_t, ssc_handler_t p_handler, int action, float f0, float, const char *,
+                                     const char *, void *user_data) {
+    auto progress = static_cast<std::vector<float> *>(user_data);
+    if (action == SSC_UPDATE) {
+        EXPECT_GE(ssc_module_exec_batch_case(p_handler), 0);
+        progress->push_back(f0);
+    }
+    return 1;
+}
+
+TEST(sscapi_test, ssc_module_exec_batch) {
+    ssc_data_t base = ssc_data_create();
+    ssc_data_set_number(base, "alb", .2);
+    ssc_data_set_number(base, "beam", 0.612);
+    ssc_data_set_number(base, "day", 6);
+    ssc_data_set_number(base, "diffuse", 162.91);
+    ssc_data_set_number(base, "hour", 13);
+    ssc_data_set_number(base, "lat", 39.744);
+    ssc_data_set_number(base, "lon", -105.1778);
+    ssc_data_set_number(base, "minute", 20);
+    ssc_data_set_number(base, "month", 1);
+    ssc_data_set_number(base, "tamb", 10.79);
+    ssc_data_set_number(base, "tz", -7);
+    ssc_data_set_number(base, "wspd", 1.4500);
+    ssc_data_set_number(base, "year", 2019);
+    ssc_data_set_number(base, "array_type", 2);
+    ssc_data_set_number(base, "azimuth", 180);
+    ssc_data_set_number(base, "dc_ac_ratio", 1.2);
+    ssc_data_set_number(base, "gcr", 0.4);
+    ssc_data_set_number(base, "inv_eff", 96);
+    ssc_data_set_number(base, "losses", 0);
+    ssc_data_set_number(base, "module_type", 0);
+    ssc_data_set_number(base, "tilt", 0);
+
+    const int n_cases = 16;
+    std::vector<ssc_data_t> cases;
+    for (int i = 0; i < n_cases; i++) {
+        cases.push_back(ssc_data_copy(base));
+        ssc_data_set_number(cases.back(), "system_capacity", 100 * (i + 1));
+    }
+    ssc_data_unassign(cases[3], "tamb");
+
+    std::vector<ssc_bool_t> results(n_cases);
+    std::vector<float> progress;
+    int n_ok = ssc_module_exec_batch("pvwattsv5_1ts", &cases[0], n_cases, 4, &results[0], batch_test_handler, &progress);
+    EXPECT_EQ(n_ok, n_cases - 1);
+    EXPECT_EQ(results[3], 0);
+    ASSERT_FALSE(progress.empty());
+    EXPECT_FLOAT_EQ(progress.back(), 100);
+
+    // cases match serial runs on the same inputs
+    for (int i = 0; i < n_cases; i++) {
+        if (i == 3) continue;
+        EXPECT_EQ(results[i], 1);
+        ssc_data_t serial = ssc_data_copy(base);
+        ssc_data_set_number(serial, "system_capacity", 100 * (i + 1));
+        ASSERT_TRUE(ssc_module_exec_simple("pvwattsv5_1ts", serial));
+        ssc_number_t ac_batch = 0, ac_serial = 0;
+        ssc_data_get_number(cases[i], "ac", &ac_batch);
+        ssc_data_get_number(serial, "ac", &ac_serial);
+        EXPECT_EQ(ac_batch, ac_serial);
+        ssc_data_free(serial);
+    }
+
+    EXPECT_EQ(ssc_module_exec_batch("not_a_module", &cases[0], n_cases, 4, nullptr, nullptr, nullptr), 0);
+
+    for (auto &c : cases)
+        ssc_data_free(c);
+    ssc_data_free(base);
+}